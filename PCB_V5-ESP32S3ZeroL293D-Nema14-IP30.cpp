@@ -171,6 +171,30 @@ int myfixedstepmode = FIXEDSTEPMODE;
 int mystepsperrev = STEPSPERREVOLUTION;
 
 
+// ----------------------------------------------------------------------
+// FOCUSER STATE SNAPSHOT
+// Position, target, moving and temperature as read by servers and display
+// ----------------------------------------------------------------------
+#include "focuser_state.h"
+FOCUSER_STATE *focuserstate;
+
+
+// ----------------------------------------------------------------------
+// WEB PAGE FILE CACHE
+// SPIFFS files sent by the Web, Management and ASCOM servers
+// ----------------------------------------------------------------------
+#include "file_cache.h"
+FILE_CACHE *filecache;
+
+
+// ----------------------------------------------------------------------
+// SHARED HTTP SERVER
+// Connections of the Web, Management and ASCOM servers, see ENABLE_SHAREDHTTP
+// ----------------------------------------------------------------------
+#include "http_server.h"
+HTTP_ENGINE *httpengine = NULL;
+
+
 // ----------------------------------------------------------------------
 // ASCOM SERVER
 // Default Configuration: Included
@@ -889,6 +913,16 @@ void duckdns_refreshtime(int rt) {
 }
 
 
+// ----------------------------------------------------------------------
+// void publish_focuser_state(void);
+// Publish the focuser state for the servers and display, called from
+// loop() and after each tcp/ip command so a reply sees its own move
+// ----------------------------------------------------------------------
+void publish_focuser_state() {
+  focuserstate->publish(driverboard->getposition(), ftargetPosition, isMoving, temp);
+}
+
+
 // ----------------------------------------------------------------------
 // get wifi signal strength (in stationmode)
 // long getrssi(int);
@@ -973,8 +1007,6 @@ bool readwificonfig(char *xSSID, char *xPASSWORD, char *ySSID, char *yPASSWORD)
 #if defined(WIFICONFIGTYPE)
 #if (WIFICONFIGTYPE == READWIFICONFIG)
   const String filename = "/wificonfig.jsn";
-  String SSID_1, SSID_2;
-  String PASSWORD_1, PASSWORD_2;
 
   // SPIFFS may have failed to start
   if (!filesystemloaded) {
@@ -982,26 +1014,20 @@ bool readwificonfig(char *xSSID, char *xPASSWORD, char *ySSID, char *yPASSWORD)
   }
   File f = SPIFFS.open(filename, "r");
   if (f) {
-    String fdata = f.readString();
-    f.close();
-
     // allocate json buffer, assistant = 192
-    DynamicJsonDocument doc(250);
-    DeserializationError jerror = deserializeJson(doc, fdata);
+    StaticJsonDocument<250> doc;
+    // deserialize straight from the file
+    DeserializationError jerror = deserializeJson(doc, f);
+    f.close();
     if (!jerror) {
       // Decode JSON/Extract values
-      SSID_1 = doc["mySSID"].as<const char *>();
-      PASSWORD_1 = doc["myPASSWORD"].as<const char *>();
-      SSID_2 = doc["mySSID_1"].as<const char *>();
-      PASSWORD_2 = doc["myPASSWORD_1"].as<const char *>();
-
       // get first pair
-      SSID_1.toCharArray(xSSID, SSID_1.length() + 1);
-      PASSWORD_1.toCharArray(xPASSWORD, PASSWORD_1.length() + 1);
+      strlcpy(xSSID, doc["mySSID"] | "", 64);
+      strlcpy(xPASSWORD, doc["myPASSWORD"] | "", 64);
 
       // get second pair
-      SSID_2.toCharArray(ySSID, SSID_2.length() + 1);
-      PASSWORD_2.toCharArray(yPASSWORD, PASSWORD_2.length() + 1);
+      strlcpy(ySSID, doc["mySSID_1"] | "", 64);
+      strlcpy(yPASSWORD, doc["myPASSWORD_1"] | "", 64);
       return true;
     }
   }
@@ -1043,7 +1069,7 @@ bool wifiMultiSuccessful() {
     bool ap_sta = doc["ap_sta"] | true;
     if (ap_sta) {
       WiFi.mode(WIFI_MODE_APSTA);
-      WiFi.softAP(ControllerData->get_devicename().c_str(), doc["ap_sta_psk"] | "");
+      WiFi.softAP(ControllerData->get_devicename(), doc["ap_sta_psk"] | "");
     } else {
       WiFi.mode(WIFI_MODE_STA);
     }
@@ -1128,24 +1154,12 @@ void load_vars() {
   websrvr_status = V_STOPPED;
 
   // cached vars
-  String tmp;
-  tmp = ControllerData->get_devicename();
-  tmp.toCharArray(devicename, tmp.length() + 1);
-
-  tmp = ControllerData->get_wp_titlecolor();
-  tmp.toCharArray(titlecolor, tmp.length() + 1);
-
-  tmp = ControllerData->get_wp_subtitlecolor();
-  tmp.toCharArray(subtitlecolor, tmp.length() + 1);
-
-  tmp = ControllerData->get_wp_headercolor();
-  tmp.toCharArray(headercolor, tmp.length() + 1);
-
-  tmp = ControllerData->get_wp_textcolor();
-  tmp.toCharArray(textcolor, tmp.length() + 1);
-
-  tmp = ControllerData->get_wp_backcolor();
-  tmp.toCharArray(backcolor, tmp.length() + 1);
+  strlcpy(devicename, ControllerData->get_devicename(), sizeof(devicename));
+  strlcpy(titlecolor, ControllerData->get_wp_titlecolor(), sizeof(titlecolor));
+  strlcpy(subtitlecolor, ControllerData->get_wp_subtitlecolor(), sizeof(subtitlecolor));
+  strlcpy(headercolor, ControllerData->get_wp_headercolor(), sizeof(headercolor));
+  strlcpy(textcolor, ControllerData->get_wp_textcolor(), sizeof(textcolor));
+  strlcpy(backcolor, ControllerData->get_wp_backcolor(), sizeof(backcolor));
 }
 
 
@@ -1177,6 +1191,10 @@ void setup() {
   boot_msg_print(T_START);
   boot_msg_println(T_CONTROLLERDATA);
   ControllerData = new CONTROLLER_DATA();
+  filecache = new FILE_CACHE();
+#if defined(ENABLE_SHAREDHTTP)
+  httpengine = new HTTP_ENGINE();
+#endif
 
 
   //-------------------------------------------------
@@ -1338,6 +1356,8 @@ void setup() {
   ftargetPosition = ControllerData->get_fposition();
   driverboard = new DRIVER_BOARD();
   driverboard->start(ControllerData->get_fposition());
+  focuserstate = new FOCUSER_STATE();
+  publish_focuser_state();
 
   // Range checks for safety reasons
   ControllerData->set_brdstepmode((ControllerData->get_brdstepmode() < 1) ? 1 : ControllerData->get_brdstepmode());
@@ -1706,19 +1726,32 @@ void loop() {
 
   esp_task_wdt_reset();
 
+  // publish state changed by the last focuser state and options pass
+  publish_focuser_state();
+
   // handle all the server loop checks, for new client or client requests
+  // each server can start a move, so publish after each one
+
+  // check shared http server for new clients and requests
+  if (httpengine != NULL) {
+    httpengine->handleClient();
+    publish_focuser_state();
+  }
 
   // check ASCOM server for new clients
-  ascomsrvr->loop();
+  ascomsrvr->loop(Parked);
+  publish_focuser_state();
 
   // check management server for new clients
   mngsrvr->loop(Parked);
+  publish_focuser_state();
 
   // check TCP/IP Server for new clients
   tcpipsrvr->loop(Parked);
 
   // check Web Server for new clients
   websrvr->loop(Parked);
+  publish_focuser_state();
 
   // Check Debug Server for client connections and requests
   if (debugsrvr_status == V_RUNNING) {
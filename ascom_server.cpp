@@ -15,7 +15,11 @@
 #include "SPIFFS.h"
 #include <SPI.h>
 #include <WiFi.h>
-#include <WebServer.h>
+#include "http_server.h"
+extern HTTP_ENGINE *httpengine;
+#include "html_template.h"
+#include "file_server.h"
+#include "status_events.h"
 // ASCOM ALPACA DISCOVERY PROTOCOL USES UDP
 #include <WiFiUdp.h>
 
@@ -41,6 +45,9 @@ extern ASCOM_SERVER *ascomsrvr;
 #include "temp_probe.h"
 extern TEMP_PROBE *tempprobe;
 
+#include "focuser_state.h"
+extern FOCUSER_STATE *focuserstate;
+
 
 // ----------------------------------------------------------------------
 // EXTERNS
@@ -50,8 +57,6 @@ extern char ipStr[];
 extern volatile bool halt_alert;
 extern portMUX_TYPE halt_alertMux;
 extern long ftargetPosition;
-extern byte isMoving;
-extern float temp;
 extern bool filesystemloaded;
 // system uptime days:hours:minutes
 extern char systemuptime[12];
@@ -187,6 +192,10 @@ void ascomget_position() {
   ascomsrvr->get_position();
 }
 
+void ascomget_status() {
+  ascomsrvr->get_status();
+}
+
 void ascomset_halt() {
   ascomsrvr->set_halt();
 }
@@ -259,7 +268,7 @@ bool ASCOM_SERVER::start(void) {
   // if _ascomserver has not already been created
   if (this->_loaded == false) {
     // create instance of an ASCOM server
-    _ascomserver = new WebServer(ControllerData->get_ascomsrvr_port());
+    _ascomserver = new HTTP_SERVER(ControllerData->get_ascomsrvr_port(), httpengine);
   }
 
   // check alpaca discovery state: ensure it is running
@@ -299,8 +308,11 @@ bool ASCOM_SERVER::start(void) {
   _ascomserver->on("/api/v1/focuser/0/tempcompavailable", HTTP_GET, ascomget_tempcompavailable);
   _ascomserver->on("/api/v1/focuser/0/move", HTTP_PUT, ascomset_move);
   _ascomserver->on("/api/v1/focuser/0/supportedactions", HTTP_GET, ascomget_supportedactions);
+  // all polled fields in one reply, not part of the Alpaca api
+  _ascomserver->on("/status", HTTP_GET, ascomget_status);
   // handle url not found 404
   _ascomserver->onNotFound(ascomget_notfound);
+  file_headers(_ascomserver);
   _ascomserver->begin();
 
   this->_loaded = true;
@@ -337,11 +349,12 @@ void ASCOM_SERVER::stop(void) {
 // ----------------------------------------------------------------------
 // Checks for any new clients or existing client requests
 // ----------------------------------------------------------------------
-void ASCOM_SERVER::loop() {
+void ASCOM_SERVER::loop(bool parked) {
   // avoid a crash
   if (this->_loaded == false) {
     return;
   }
+  _parked = parked;
   _ascomserver->handleClient();
   // check for ASCOM discovery received packets
   ascomsrvr->checkASCOMALPACADiscovery();
@@ -383,17 +396,9 @@ void ASCOM_SERVER::file_sys_error(void) {
 // ----------------------------------------------------------------------
 // Send reponse header to client
 // ----------------------------------------------------------------------
-void ASCOM_SERVER::sendmyheader() {
-  _ascomserver->client().println("HTTP/1.1 200 OK");
-  _ascomserver->client().println("Content-type:text/html");
-  _ascomserver->client().println();
-}
-
-// ----------------------------------------------------------------------
-// Send response body to client
-// ----------------------------------------------------------------------
-void ASCOM_SERVER::sendmycontent(String pg) {
-  _ascomserver->client().print(pg);
+void ASCOM_SERVER::sendmyheader(size_t len) {
+  _ascomserver->setContentLength(len);
+  _ascomserver->send(NORMALWEBPAGE, TEXTPAGETYPE, "");
 }
 
 // ----------------------------------------------------------------------
@@ -544,8 +549,7 @@ void ASCOM_SERVER::get_setup() {
   // url /setup [mapped to /ascomhome]
   // The web page must describe the overall device, including name, manufacturer and version number.
   // content-type: text/html
-  String _ASpg;
-  _ASpg.reserve(1900);  // 306-02  1592
+  static HTML_TEMPLATE _ASpg("/ascomhome.html");
 
   debug_server_println("Alpaca-get_setup()");
 
@@ -555,22 +559,14 @@ void ASCOM_SERVER::get_setup() {
   }
 
   // spiffs was started earlier when server was started so assume it has started
-  if (SPIFFS.exists("/ascomhome.html")) {
+  if (_ASpg.load()) {
     debug_server_println("-get /ascomhome.html");
 
-    File file = SPIFFS.open("/ascomhome.html", "r");
-    _ASpg = file.readString();
-    file.close();
-
     // process for dynamic data
-    String bcol = ControllerData->get_wp_backcolor();
-    _ASpg.replace("%BKC%", bcol);
-    String txtcol = ControllerData->get_wp_textcolor();
-    _ASpg.replace("%TXC%", txtcol);
-    String ticol = ControllerData->get_wp_titlecolor();
-    _ASpg.replace("%TIC%", ticol);
-    String hcol = ControllerData->get_wp_headercolor();
-    _ASpg.replace("%HEC%", hcol);
+    _ASpg.replace("%BKC%", ControllerData->get_wp_backcolor());
+    _ASpg.replace("%TXC%", ControllerData->get_wp_textcolor());
+    _ASpg.replace("%TIC%", ControllerData->get_wp_titlecolor());
+    _ASpg.replace("%HEC%", ControllerData->get_wp_headercolor());
     // IP Address
     _ASpg.replace("%IPS%", ipStr);
     // Alpaca port number
@@ -592,14 +588,14 @@ void ASCOM_SERVER::get_setup() {
     _ASpg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    _ASpg = ASCOMSERVERNOTFOUNDSTR;
+    _ASpg.set_text(ASCOMSERVERNOTFOUNDSTR);
   }
   _ASCOMServerTransactionID++;
 
   debug_server_print("/ascomhome.html ");
   debug_server_println(_ASpg.length());
-  sendmyheader();
-  sendmycontent(_ASpg);
+  sendmyheader(_ASpg.length());
+  _ASpg.render(_ascomserver->content());
 }
 
 // ----------------------------------------------------------------------
@@ -615,8 +611,7 @@ void ASCOM_SERVER::get_focusersetup() {
     return;
   }
 
-  String _ASpg;
-  _ASpg.reserve(3500);  // 306-02  3157
+  static HTML_TEMPLATE _ASpg("/ascomsetup.html");
 
   if (setup_type == PosT) {
     // if set focuser position
@@ -759,7 +754,7 @@ Get_Handler:
   // Build /ascomsetup
   debug_server_println("Alpaca-request /setup/v1/focuser/0/setup");
   // convert current values of focuserposition and focusermaxsteps to string types
-  String fpbuffer = String(driverboard->getposition());
+  String fpbuffer = String(focuserstate->get_position());
   String mxbuffer = String(ControllerData->get_maxstep());
   String smbuffer = String(ControllerData->get_brdstepmode());
   switch (ControllerData->get_brdstepmode()) {
@@ -864,20 +859,12 @@ Get_Handler:
 
   // various sections are built, now load the /ascomsetup page and replace sections
   // construct setup page of ascom server
-  if (SPIFFS.exists("/ascomsetup.html")) {
-    File file = SPIFFS.open("/ascomsetup.html", "r");
-    _ASpg = file.readString();
-    file.close();
-
+  if (_ASpg.load()) {
     // process for dynamic data
-    String bcol = ControllerData->get_wp_backcolor();
-    _ASpg.replace("%BKC%", bcol);
-    String txtcol = ControllerData->get_wp_textcolor();
-    _ASpg.replace("%TXC%", txtcol);
-    String ticol = ControllerData->get_wp_titlecolor();
-    _ASpg.replace("%TIC%", ticol);
-    String hcol = ControllerData->get_wp_headercolor();
-    _ASpg.replace("%HEC%", hcol);
+    _ASpg.replace("%BKC%", ControllerData->get_wp_backcolor());
+    _ASpg.replace("%TXC%", ControllerData->get_wp_textcolor());
+    _ASpg.replace("%TIC%", ControllerData->get_wp_titlecolor());
+    _ASpg.replace("%HEC%", ControllerData->get_wp_headercolor());
     // position
     _ASpg.replace("%FPB%", fpbuffer);
     // maxsteps
@@ -904,14 +891,14 @@ Get_Handler:
     _ASpg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    _ASpg = ASCOMSERVERNOTFOUNDSTR;
+    _ASpg.set_text(ASCOMSERVERNOTFOUNDSTR);
   }
   // now send the ASCOM setup page
   _ASCOMServerTransactionID++;
   debug_server_print("/setup/v1/focuser/0/setup ");
   debug_server_println(_ASpg.length());
-  sendmyheader();
-  sendmycontent(_ASpg);
+  sendmyheader(_ASpg.length());
+  _ASpg.render(_ascomserver->content());
 }
 
 
@@ -1211,12 +1198,20 @@ void ASCOM_SERVER::get_temperature() {
   _ASCOMErrorMessage = "";
   getURLParameters();
   // addclientinfo adds clientid, clienttransactionid, servertransactionid, errornumber, errormessage and terminating }
-  jsonretstr = "{\"value\":" + String(temp, 2) + ",\"errornumber\":0,\"errormessage\":\"\" }";
+  jsonretstr = "{\"value\":" + String(focuserstate->get_temp(), 2) + ",\"errornumber\":0,\"errormessage\":\"\" }";
 
   // sendreply builds http header, sets content type, and then sends jsonretstr
   sendreply(NORMALWEBPAGE, JSONPAGETYPE, jsonretstr);
 }
 
+// ----------------------------------------------------------------------
+// get_status()
+// position, target, moving, temperature, park and coil power in one reply
+// ----------------------------------------------------------------------
+void ASCOM_SERVER::get_status() {
+  send_status(_ascomserver, _parked);
+}
+
 // ----------------------------------------------------------------------
 // get_position()
 // ----------------------------------------------------------------------
@@ -1231,7 +1226,7 @@ void ASCOM_SERVER::get_position() {
   _ASCOMErrorMessage = "";
   getURLParameters();
   // addclientinfo adds clientid, clienttransactionid, servertransactionid, errornumber, errormessage and terminating }
-  jsonretstr = "{\"value\":" + String(driverboard->getposition()) + ",\"errornumber\":0,\"errormessage\":\"\" }";
+  jsonretstr = "{\"value\":" + String(focuserstate->get_position()) + ",\"errornumber\":0,\"errormessage\":\"\" }";
 
   // sendreply builds http header, sets content type, and then sends jsonretstr
   sendreply(NORMALWEBPAGE, JSONPAGETYPE, jsonretstr);
@@ -1278,7 +1273,7 @@ void ASCOM_SERVER::get_ismoving() {
   _ASCOMErrorMessage = "";
   getURLParameters();
   // addclientinfo adds clientid, clienttransactionid, servertransactionid, errornumber, errormessage and terminating }
-  if (isMoving == 1) {
+  if (focuserstate->get_ismoving() == true) {
     jsonretstr = "{\"value\":1,\"errornumber\":0,\"errormessage\":\"\" }";
   } else {
     jsonretstr = "{\"value\":0,\"errornumber\":0,\"errormessage\":\"\" }";
@@ -1465,6 +1460,11 @@ void ASCOM_SERVER::get_notfound() {
   String message = T_NOTFOUND;
   String jsonretstr = "";
 
+  // a file used by the setup pages, eg css or images
+  if (send_file(_ascomserver, _ascomserver->uri())) {
+    return;
+  }
+
   message += "URI: ";
   message += _ascomserver->uri();
   message += "\nMethod: ";
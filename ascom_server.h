@@ -9,7 +9,7 @@
 #define _ascom_server_h
 // Required for ASCOM ALPACA DISCOVERY PROTOCOL
 #include <WiFiUdp.h>
-#include <WebServer.h>
+#include "http_server.h"
 
 
 // ----------------------------------------------------------------------
@@ -21,7 +21,7 @@ public:
 
   bool start(void);
   void stop(void);
-  void loop(void);
+  void loop(bool);
   byte get_state(void);
   byte get_loaded(void);
 
@@ -29,8 +29,7 @@ public:
   void get_notfound(void);
   void file_sys_error(void);
 
-  void sendmyheader(void);
-  void sendmycontent(String);
+  void sendmyheader(size_t);
   void checkASCOMALPACADiscovery(void);
   void sendreply(int, String, String);
   void getURLParameters(void);
@@ -62,13 +61,15 @@ public:
   void get_tempcompavailable(void);
   void set_move(void);
   void get_supportedactions(void);
+  void get_status(void);
 
 private:
   void notloaded(void);
 
   byte _state = V_STOPPED;
   bool _loaded = false;
-  WebServer *_ascomserver;
+  bool _parked = true;
+  HTTP_SERVER *_ascomserver;
   bool _ascomdiscovery = false;
   char _packetBuffer[255] = { 0 };
   bool _discoverystate = false;
@@ -0,0 +1,65 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 BOARD DEFINITIONS TABLE
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// Copyright Holger M, 2019-2021. All Rights Reserved.
+// board_table.h
+// ----------------------------------------------------------------------
+
+#ifndef _board_table_h
+#define _board_table_h
+
+#include <Arduino.h>
+#include "boarddefs.h"
+
+
+// ----------------------------------------------------------------------
+// BOARD DEFINITION
+// The fields of a /boards/xx.jsn board file, -1 is pin not used
+// ----------------------------------------------------------------------
+struct Board_Def {
+  int brdnum;
+  const char *name;
+  int maxstepmode;
+  int stepmode;
+  int enpin;
+  int steppin;
+  int dirpin;
+  int temppin;
+  int hpswpin;
+  int inledpin;
+  int outledpin;
+  int pb1pin;
+  int pb2pin;
+  int irpin;
+  int stepsrev;
+  int fixedsmode;
+  int brdpins[4];
+  unsigned long msdelay;
+};
+
+
+// ----------------------------------------------------------------------
+// BOARD TABLE
+// Compiled into flash. ControllerData looks up the board by number when
+// board_config.jsn does not exist, eg after a firmware upload.
+// A board that is not in the table, and CUSTOMBRD, is loaded from its
+// board file /boards/xx.jsn
+//
+// Boards in the table
+//   PRO2ESP32DRV8825
+// Boards still loaded from /boards/xx.jsn
+//   PRO2ESP32ULN2003 (45), PRO2ESP32L298N (46), PRO2ESP32L293DMINI (47),
+//   PRO2ESP32L9110S (48), PRO2ESP32R3WEMOS (49), PRO2ESP32TMC2225 (56),
+//   PRO2ESP32TMC2209 (57), PRO2ESP32TMC2209P (58), PRO2ESP32ST6128 (59),
+//   PRO2ESP32LOLINS2MINI (60)
+// Only add a board with the pins of its shipped /boards/xx.jsn file, the
+// table replaces the file for a first boot and for a reset to defaults
+//
+// X(brdnum, "name", maxstepmode, stepmode, enpin, steppin, dirpin,
+//   temppin, hpswpin, inledpin, outledpin, pb1pin, pb2pin, irpin,
+//   stepsrev, fixedsmode, brdpin0, brdpin1, brdpin2, brdpin3, msdelay)
+// ----------------------------------------------------------------------
+#define BOARD_TABLE(X) \
+  X(PRO2ESP32DRV8825, "PRO2ESP32DRV8825", 32, 1, 14, 33, 32, 13, 4, 18, 19, 34, 35, 15, -1, -1, 27, 26, 25, -1, 4000)
+
+#endif  // _board_table_h
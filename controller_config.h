@@ -178,6 +178,38 @@
 // Default settings HPSW : Disabled, Stall Guard : 100
 
 
+// ----------------------------------------------------------------------
+// TCP/IP SERVER CLIENTS
+// Number of clients that can be connected to the TCP/IP server at once,
+// 1-16. When all are in use a new client replaces the least recently
+// active one. Each client is a socket, more than 6 needs the lwIP socket
+// limit CONFIG_LWIP_MAX_SOCKETS raised
+// ----------------------------------------------------------------------
+#define TCPIPCLIENTS 4
+
+
+// ----------------------------------------------------------------------
+// SHARED HTTP SERVER
+// The Web, Management and ASCOM servers share one set of connections and
+// buffers, polled once each loop, instead of one set each. Each server
+// keeps its port. Servers given the same port share it, a request goes to
+// the server that has its URL, eg /api/ to ASCOM, /admin1 to Management
+// ----------------------------------------------------------------------
+// To share one HTTP server, uncomment the next line
+//#define ENABLE_SHAREDHTTP 1
+
+
+// ----------------------------------------------------------------------
+// WEB PAGE FILE CACHE
+// Bytes of RAM used to keep web pages, css and images read from SPIFFS,
+// so a page loaded again is sent from RAM. FILECACHEPSRAM is used when
+// the board has PSRAM. A file bigger than a quarter of the cache is
+// always read from SPIFFS
+// ----------------------------------------------------------------------
+#define FILECACHESIZE 32768
+#define FILECACHEPSRAM 262144
+
+
 // ----------------------------------------------------------------------
 // DO NOT CHANGE
 // CHECK BOARD AND HW OPTIONS
@@ -194,6 +226,11 @@
 #endif  // #ifdef USE_SSH1106
 #endif  // #ifdef USE_SSD1306
 
+// tcp/ip client slots
+#if (TCPIPCLIENTS < 1) || (TCPIPCLIENTS > 16)
+#error err: TCPIPCLIENTS must be 1-16
+#endif
+
 // cannot run Duckdns with ACCESSPOINT
 #if (CONTROLLERMODE == ACCESSPOINT)
 #if defined(ENABLE_DUCKDNS)
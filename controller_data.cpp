@@ -45,6 +45,8 @@ extern CONTROLLER_DATA *ControllerData;
 #include "driver_board.h"
 extern DRIVER_BOARD *driverboard;
 
+#include "board_table.h"
+
 
 // ----------------------------------------------------------------------
 // OTA DATA
@@ -104,6 +106,27 @@ extern portMUX_TYPE displaytimeMux;
 #define BOARDDATASIZE 1024
 // Position and Direction raw data 22, ArduinoJson Assistant 32
 #define BOARDVARDATASIZE 64
+// Largest controller config section, Motion, ArduinoJson Assistant 720
+#define SECTIONDATASIZE 1024
+// all Cntlr_Sections
+#define SECTIONS_ALL ((1 << Section_Count) - 1)
+// Config files are written to file.tmp then renamed, file.bak is the last good copy
+#define CONFIGTMPEXT ".tmp"
+#define CONFIGBAKEXT ".bak"
+
+
+// ----------------------------------------------------------------------
+// limit a setting to the range given in controller_schema.h
+// ----------------------------------------------------------------------
+template<typename T> static T schema_range(T value, double lo, double hi) {
+  if (value < lo) {
+    return (T)lo;
+  }
+  if (value > hi) {
+    return (T)hi;
+  }
+  return value;
+}
 
 
 // ----------------------------------------------------------------------
@@ -114,6 +137,9 @@ CONTROLLER_DATA::CONTROLLER_DATA(void) {
   save_var_flag = -1;
   save_board_flag = -1;
   save_cntlr_flag = -1;
+  _dirty_sections = SECTIONS_ALL;
+  _cntlr_unsaved = false;
+  _cntlr_jsonvalid = false;
 
   // mount SPIFFS
   CNTLRDATA_print(T_CONTROLLERDATA);
@@ -140,120 +166,35 @@ bool CONTROLLER_DATA::LoadConfiguration() {
   CNTLRDATA_print(T_LOAD);
   CNTLRDATA_println(file_cntlr_config);
   // Focuser persistant data - Open cntlr_config.jsn file for reading
-  if (SPIFFS.exists(file_cntlr_config) == false) {
-    CNTLRDATA_println(T_NOTFOUND);
-    LoadDefaultPersistantData();
-  } else {
-    // file exists so open it
-    File cfile = SPIFFS.open(file_cntlr_config, "r");
-
-    String cdata;
-    cdata.reserve(DEFAULTCONFIGSIZE);
-    cdata = cfile.readString();
-    cfile.close();
-    CNTLRDATA_print("size ");
-    CNTLRDATA_println(cdata.length());
-    CNTLRDATA_print("data ");
-    CNTLRDATA_println(cdata);
-
+  {
     // Allocate a temporary JsonDocument
-    DynamicJsonDocument doc_per(DEFAULTCONFIGSIZE);
-    // Deserialize the JSON document
-    DeserializationError error = deserializeJson(doc_per, cdata);
-    if (error) {
-      CNTLRDATA_println(T_DESERIALISEERROR);
+    StaticJsonDocument<DEFAULTCONFIGSIZE> doc_per;
+    // Deserialize cntlr_config.jsn, or the last good copy if the file is missing or damaged
+    if (LoadJsonFile(file_cntlr_config, doc_per) == false) {
       LoadDefaultPersistantData();
     } else {
-      // maxstep
-      this->maxstep = doc_per["maxstep"];
+      // settings in controller_schema.h, missing keys take the default value
+#define X(sec, type, member, accessor, k, def, lo, hi, setter) \
+  this->member = schema_range(doc_per[k] | (type)(def), lo, hi);
+      CNTLR_VALUE_SETTINGS(X)
+#undef X
+#define X(sec, member, accessor, k, def, len, setter) \
+  strlcpy(this->member, doc_per[k] | (const char *)(def), sizeof(this->member));
+      CNTLR_TEXT_SETTINGS(X)
+#undef X
+      this->pad_pageoption(this->display_pageoption);
       // presets
       for (int i = 0; i < 10; i++) {
         this->focuserpreset[i] = doc_per["preset"][i];
       }
-      // SERVERS - SERVICES
-      this->ascomsrvr_enable = doc_per["ascom_en"];
-      this->ascomsrvr_port = doc_per["ascom_port"];
-      this->debugsrvr_enable = doc_per["dbg_en"];
-      this->debugsrvr_port = doc_per["dbg_port"];
-      this->debugsrvr_out = doc_per["dbg_out"];
-      this->duckdns_enable = doc_per["ddns_en"];
-      this->duckdns_domain = doc_per["ddns_d"].as<const char *>();
-      this->duckdns_refreshtime = doc_per["ddns_r"];
-      this->duckdns_token = doc_per["ddns_t"].as<const char *>();
-      this->mngsrvr_enable = doc_per["mngt_en"];
-      this->mngsrvr_port = doc_per["mngt_port"];
-      this->ota_id = doc_per["ota_id"].as<const char *>();
-      this->ota_name = doc_per["ota_name"].as<const char *>();
-      this->ota_password = doc_per["ota_pwd"].as<const char *>();
-      this->tcpipsrvr_enable = doc_per["tcp_en"];
-      this->tcpipsrvr_port = doc_per["tcp_port"];
-      this->websrvr_enable = doc_per["ws_en"];
-      this->websrvr_port = doc_per["ws_port"];
-      // DEVICES
-      // display
-      this->display_enable = doc_per["d_en"];
-      this->display_pageoption = doc_per["d_pgopt"].as<const char *>();
-      this->display_pagetime = doc_per["d_pgtime"];
-      this->display_updateonmove = doc_per["d_updmove"];
-      // hpsw
-      this->hpswitch_enable = doc_per["hpsw_en"];
-      this->hpswmsg_enable = doc_per["hpswmsg_en"];
+      // stall guard
       this->stallguard_state = doc_per["stall_st"];
-      this->stallguard_value = doc_per["stall_val"];
-      this->tmc2209current = doc_per["tmc2209mA"];
-      this->tmc2225current = doc_per["tmc2225mA"];
-      // leds
-      this->inoutled_enable = doc_per["led_en"];
-      this->inoutled_mode = doc_per["led_mode"];
-      // joysticks
-      this->joystick1_enable = doc_per["joy1_en"];
-      this->joystick2_enable = doc_per["joy2_en"];
-      // pushbuttons
-      this->pushbutton_enable = doc_per["pb_en"];
-      this->pushbutton_steps = doc_per["pb_steps"];
-      // temperature probe enable
-      this->tempprobe_enable = doc_per["t_en"];
-      // steps per degree temperature coefficient value
-      this->tempcoefficient = doc_per["t_coe"];
-      // indicates if temperature compensation is enabled
-      this->tempcomp_enable = doc_per["t_comp_en"];
-      // temperature display mode, Celcius=1, Fahrenheit=0
-      this->tempmode = doc_per["t_mod"];
-      // 9 - 12
-      this->tempresolution = doc_per["t_res"];
-      this->tcavailable = doc_per["t_tcavail"];
-      this->tcdirection = doc_per["t_tcdir"];
-      // backlash
-      this->backlash_in_enable = doc_per["blin_en"];
-      this->backlashsteps_in = doc_per["blin_steps"];
-      this->backlash_out_enable = doc_per["blout_en"];
-      this->backlashsteps_out = doc_per["blout_steps"];
-      // coil power
-      this->coilpower_enable = doc_per["cp_en"];
-      // delay after move
-      this->delayaftermove_enable = doc_per["dam-en"];
-      this->delayaftermove_time = doc_per["dam_time"];
-      // devicename
-      this->devicename = doc_per["devname"].as<const char *>();
-      // file list format
-      this->filelistformat = doc_per["filelist"];
-      // motorspeed slow, med, fast
-      this->motorspeed = doc_per["mspeed"];
-      // park
-      this->park_enable = doc_per["park_en"];
-      this->park_time = doc_per["park_time"];
-      // reverse
-      this->reverse_enable = doc_per["rdir_en"];
-      // stepsize, if 1, controller returns step size
-      this->stepsize_enable = doc_per["ss_en"];
-      // stepsize in microns. ie 7.2 - value * 10, so real stepsize = stepsize / 10 (maxval = 25.6)
-      this->stepsize = doc_per["ss_val"];
-      // web page colors
-      this->titlecolor = doc_per["ticol"].as<const char *>();
-      this->subtitlecolor = doc_per["scol"].as<const char *>();
-      this->headercolor = doc_per["hcol"].as<const char *>();
-      this->textcolor = doc_per["tcol"].as<const char *>();
-      this->backcolor = doc_per["bcol"].as<const char *>();
+      // cache the sections, the first save then only serializes what has changed
+      for (int s = 0; s < Section_Count; s++) {
+        SerializeSection((Cntlr_Sections)s, this->_section_json[s]);
+      }
+      this->_dirty_sections = 0;
+      this->_cntlr_jsonvalid = false;
       CNTLRDATA_println(T_LOADED);
     }
   }
@@ -261,30 +202,11 @@ bool CONTROLLER_DATA::LoadConfiguration() {
   // LOAD CONTROLLER BOARD DATA
   CNTLRDATA_print(T_LOAD);
   CNTLRDATA_println(file_board_config);
-  if (SPIFFS.exists(file_board_config) == false) {
-    CNTLRDATA_println(T_NOTFOUND);
-    LoadDefaultBoardData();
-  } else {
-    // board_config.jsn board data
-    // file exists so open it
-    File bfile = SPIFFS.open(file_board_config, "r");
-    String bdata;
-    bdata.reserve(BOARDDATASIZE);
-
-    bdata = bfile.readString();
-    bfile.close();
-    CNTLRDATA_print("-size ");
-    CNTLRDATA_println(bdata.length());
-    CNTLRDATA_print("-data ");
-    CNTLRDATA_println(bdata);
-
+  {
     // Allocate a temporary JsonDocument
-    DynamicJsonDocument doc_brd(BOARDDATASIZE);
-
-    // Deserialize the JSON document
-    DeserializationError error = deserializeJson(doc_brd, bdata);
-    if (error) {
-      CNTLRDATA_println(T_DESERIALISEERROR);
+    StaticJsonDocument<BOARDDATASIZE> doc_brd;
+    // Deserialize board_config.jsn, or the last good copy if the file is missing or damaged
+    if (LoadJsonFile(file_board_config, doc_brd) == false) {
       LoadDefaultBoardData();
     } else {
       /*
@@ -292,7 +214,7 @@ bool CONTROLLER_DATA::LoadConfiguration() {
         "dirpin":32,"temppin":13,"hpswpin":4,"inledpin":18,"outledpin":19,"pb1pin":34,"pb2pin":35,"irpin":15,
         "brdnum":60, "stepsrev":-1,"fixedsmode":-1,"brdpins":[27,26,25,-1],"msdelay":4000 }
       */
-      this->board = doc_brd["board"].as<const char *>();
+      strlcpy(this->board, doc_brd["board"] | "", sizeof(this->board));
       this->maxstepmode = doc_brd["maxstepmode"];
       this->stepmode = doc_brd["stepmode"];
       this->enablepin = doc_brd["enpin"];
@@ -321,30 +243,12 @@ bool CONTROLLER_DATA::LoadConfiguration() {
   CNTLRDATA_print(T_LOAD);
   CNTLRDATA_println(file_cntlr_var);
 
-  if (SPIFFS.exists(file_cntlr_var) == false) {
-    CNTLRDATA_println(T_NOTFOUND);
-    LoadDefaultVariableData();
-  } else {
+  {
     // controller variable data (position, direction)
-    // file exists so open it
-    File vfile = SPIFFS.open(file_cntlr_var, "r");
-    String vdata;
-    vdata.reserve(BOARDVARDATASIZE);
-
-    vdata = vfile.readString();
-    vfile.close();
-    CNTLRDATA_print("-size ");
-    CNTLRDATA_println(vdata.length());
-    CNTLRDATA_print("-data ");
-    CNTLRDATA_println(vdata);
-
     // Allocate a temporary JsonDocument
-    DynamicJsonDocument doc_var(BOARDVARDATASIZE);
-
-    // Deserialize the JSON document
-    DeserializationError error = deserializeJson(doc_var, vdata);
-    if (error) {
-      CNTLRDATA_println(T_DESERIALISEERROR);
+    StaticJsonDocument<BOARDVARDATASIZE> doc_var;
+    // Deserialize cntlr_var.jsn, or the last good copy if the file is missing or damaged
+    if (LoadJsonFile(file_cntlr_var, doc_var) == false) {
       LoadDefaultVariableData();
     } else {
       // get last focuser position and last focuser move direction
@@ -379,108 +283,19 @@ void CONTROLLER_DATA::LoadDefaultVariableData() {
 // Creates a default config setting file and saves it to spiffs
 // ----------------------------------------------------------------------
 void CONTROLLER_DATA::LoadDefaultPersistantData() {
-  this->maxstep = DEFAULTMAXSTEPS;
+  // every section has to be written
+  this->_dirty_sections = SECTIONS_ALL;
+  // Set the initial defaults for a controller
+#define X(sec, type, member, accessor, k, def, lo, hi, setter) this->member = (type)(def);
+  CNTLR_VALUE_SETTINGS(X)
+#undef X
+#define X(sec, member, accessor, k, def, len, setter) strlcpy(this->member, def, sizeof(this->member));
+  CNTLR_TEXT_SETTINGS(X)
+#undef X
   for (int i = 0; i < 10; i++) {
     this->focuserpreset[i] = 0;
   }
-
-  // Set the initial defaults for a controller
-  // SERVERS - SERVICES
-  this->ascomsrvr_enable = V_NOTENABLED;
-  this->ascomsrvr_port = ASCOMSERVERPORT;
-
-  this->debugsrvr_enable = V_NOTENABLED;
-  this->debugsrvr_port = debugsrvr_port;
-  this->debugsrvr_out = DEBUGSERVEROUTPUTPORT;
-
-  // DUCKDNS from /defines/duckdns_defines.h
-  this->duckdns_enable = V_NOTENABLED;
-  this->duckdns_domain = String(duckdnsdomain);
-  this->duckdns_refreshtime = DUCKDNS_REFRESHRATE;
-  this->duckdns_token = String(duckdnstoken);
-
-  this->mngsrvr_enable = V_ENABLED;
-  this->mngsrvr_port = MNGSERVERPORT;
-
-  // OTA from /defines/otaupdates_defines.h
-  this->ota_id = String(OTAID);
-  this->ota_name = String(OTAName);
-  this->ota_password = String(OTAPassword);
-
-  this->tcpipsrvr_enable = V_ENABLED;
-  this->tcpipsrvr_port = TCPIPSERVERPORT;
-
-  this->websrvr_enable = V_NOTENABLED;
-  this->websrvr_port = WEBSERVERPORT;
-
-  // DISPLAY
-  this->display_enable = V_NOTENABLED;
-  this->display_pageoption = "11111111";
-  this->display_pagetime = V_DISPLAYPAGETIMEMIN;
-  this->display_updateonmove = V_ENABLED;
-
-  // HPSW
-  this->hpswitch_enable = V_NOTENABLED;
-  this->hpswmsg_enable = V_NOTENABLED;
-
-  // stall guard
   this->stallguard_state = Use_None;
-  this->stallguard_value = STALL_VALUE;
-  // tmc2209 and tmc2225 from boarddefs.h
-  this->tmc2209current = TMC2209CURRENT;
-  this->tmc2225current = TMC2225CURRENT;
-
-  // LEDS
-  this->inoutled_enable = V_NOTENABLED;
-  this->inoutled_mode = LEDPULSE;
-
-  // JOYSTICKS
-  this->joystick1_enable = V_NOTENABLED;
-  this->joystick2_enable = V_NOTENABLED;
-
-  // PUSHBUTTONS
-  this->pushbutton_enable = V_NOTENABLED;
-  this->pushbutton_steps = PUSHBUTTON_STEPS;
-
-  // TEMPERATURE PROBE
-  this->tempprobe_enable = V_NOTENABLED;
-  this->tempcoefficient = DEFAULT_FALSE;
-  this->tempcomp_enable = V_NOTENABLED;
-  this->tempmode = V_CELSIUS;
-  this->tempresolution = DEFAULTTEMPRESOLUTION;
-  this->tcavailable = V_NOTENABLED;
-  this->tcdirection = TC_DIRECTION_IN;
-
-  // BACKLASH
-  this->backlash_in_enable = V_NOTENABLED;
-  this->backlashsteps_in = DEFAULT_FALSE;
-  this->backlash_out_enable = V_NOTENABLED;
-  this->backlashsteps_out = DEFAULT_FALSE;
-  // coil power
-  this->coilpower_enable = V_NOTENABLED;
-  // delay after move
-  this->delayaftermove_enable = V_NOTENABLED;
-  this->delayaftermove_time = 25;
-  // devicename
-  this->devicename = String(project_name);
-  // file list format
-  this->filelistformat = LISTLONG;
-  // motorspeed
-  this->motorspeed = FAST;
-  // park
-  this->park_enable = V_NOTENABLED;
-  this->park_time = DEFAULTPARKTIME;
-  // reverse
-  this->reverse_enable = V_NOTENABLED;
-  // stepsize
-  this->stepsize_enable = V_NOTENABLED;
-  this->stepsize = DEFAULTSTEPSIZE;
-  // web page colors
-  this->titlecolor = DEFAULTTITLECOLOR;
-  this->subtitlecolor = DEFAULTSUBTITLECOLOR;
-  this->headercolor = DEFAULTHEADERCOLOR;
-  this->textcolor = DEFAULTTEXTCOLLOR;
-  this->backcolor = DEFAULTBACKCOLOR;
 
   SavePersitantConfiguration();
 }
@@ -492,9 +307,16 @@ void CONTROLLER_DATA::LoadDefaultPersistantData() {
 void CONTROLLER_DATA::LoadDefaultBoardData() {
   // we are here because board_config.jsn was not found
   // we can load the default board configuration from DRVBRD defined - DefaultBoardName in .ino file
-  // Driver board data - Open the specific board config .jsn file for reading
+  // a board in board_table.h is set from flash without reading a file,
+  // CUSTOMBRD and other boards are read from the board config .jsn file
 
   // cannot use this->boardnumber because the value has not been set yet
+  if ((myboardnumber != CUSTOMBRD) && (LoadBoardTable(myboardnumber) == true)) {
+    CNTLRDATA_println("CD LoadDefaultBoardData table");
+    SaveBoardConfiguration();
+    return;
+  }
+
   // Load the board file from /boards, make up filename first
   String brdfile = "/boards/" + String(myboardnumber) + ".jsn";
   CNTLRDATA_println("CD LoadDefaultBoardData");
@@ -506,7 +328,7 @@ void CONTROLLER_DATA::LoadDefaultBoardData() {
     CNTLRDATA_println(T_LOADED);
   } else {
     // a board config file could not be loaded, so create a dummy one
-    this->board = "Unknown";
+    strlcpy(this->board, "Unknown", sizeof(this->board));
     this->maxstepmode = -1;
     this->stepmode = 1;
     this->enablepin = -1;
@@ -536,15 +358,9 @@ void CONTROLLER_DATA::LoadDefaultBoardData() {
 // Reset focuser settings to defaults : tcpip_server.cpp case 42:
 // ----------------------------------------------------------------------
 void CONTROLLER_DATA::SetFocuserDefaults(void) {
-  if (SPIFFS.exists(file_cntlr_config)) {
-    SPIFFS.remove(file_cntlr_config);
-  }
-  if (SPIFFS.exists(file_board_config)) {
-    SPIFFS.remove(file_board_config);
-  }
-  if (SPIFFS.exists(file_cntlr_var)) {
-    SPIFFS.remove(file_cntlr_var);
-  }
+  RemoveConfigFile(file_cntlr_config);
+  RemoveConfigFile(file_board_config);
+  RemoveConfigFile(file_cntlr_var);
   LoadDefaultPersistantData();
   LoadDefaultBoardData();
   LoadDefaultVariableData();
@@ -644,20 +460,6 @@ bool CONTROLLER_DATA::SaveVariableConfiguration() {
   CNTLRDATA_print("CD SaveVariableConfiguration ");
   CNTLRDATA_println(file_cntlr_var);
 
-  // Delete existing file
-  if (SPIFFS.exists(file_cntlr_var)) {
-    SPIFFS.remove(file_cntlr_var);
-  }
-
-  // Open file for writing
-  CNTLRDATA_print(T_OPENFILE);
-  CNTLRDATA_println(file_cntlr_var);
-  File vfile = SPIFFS.open(file_cntlr_var, "w");
-  if (!vfile) {
-    CNTLRDATA_println(T_ERROR);
-    return false;
-  }
-
   // Allocate a temporary JsonDocument
   // Don't forget to change the capacity to match your requirements.
   // Use arduinojson.org/assistant to compute the capacity.
@@ -668,17 +470,7 @@ bool CONTROLLER_DATA::SaveVariableConfiguration() {
   doc["fdir"] = this->focuserdirection;
 
   // save settings to file
-  if (serializeJson(doc, vfile) == 0) {
-    CNTLRDATA_println(T_DESERIALISEERROR);
-    vfile.close();
-    return false;
-  } else {
-    CNTLRDATA_print(T_SAVED);
-    CNTLRDATA_println(file_cntlr_var);
-    vfile.close();
-    return true;
-  }
-  return false;
+  return SaveJsonFile(file_cntlr_var, doc);
 }
 
 
@@ -687,683 +479,372 @@ bool CONTROLLER_DATA::SaveVariableConfiguration() {
 // ----------------------------------------------------------------------
 bool CONTROLLER_DATA::SavePersitantConfiguration() {
   CNTLRDATA_println("CD SavePersitantConfiguration ");
-  CNTLRDATA_println(file_cntlr_var);
+  CNTLRDATA_println(file_cntlr_config);
+
+  UpdateSections();
 
-  if (SPIFFS.exists(file_cntlr_config)) {
-    SPIFFS.remove(file_cntlr_config);
+  // changes that were reverted within the save window do not need a write
+  if ((this->_cntlr_unsaved == false) && SPIFFS.exists(file_cntlr_config)) {
+    CNTLRDATA_println("-unchanged");
+    return true;
   }
 
-  // Open file for writing
-  CNTLRDATA_println(T_OPENFILE);
-  File file = SPIFFS.open(file_cntlr_config, "w");
-  if (!file) {
-    CNTLRDATA_println(T_OPENERROR);
+  // write the cached sections as one JSON object
+  File tfile = OpenTmpFile(file_cntlr_config);
+  if (!tfile) {
     return false;
   }
+  size_t expected = 2 + (Section_Count - 1);
+  size_t len = tfile.print('{');
+  for (int s = 0; s < Section_Count; s++) {
+    if (s != 0) {
+      len += tfile.print(',');
+    }
+    len += tfile.print(this->_section_json[s]);
+    expected += this->_section_json[s].length();
+  }
+  len += tfile.print('}');
+  tfile.close();
 
-  // Allocate a temporary JsonDocument
-  // Don't forget to change the capacity to match your requirements.
-  // Use arduinojson.org/assistant to compute the capacity.
-  // 303 - 1170, Size 1536
-  StaticJsonDocument<DEFAULTCONFIGSIZE> doc;
-
-  doc["maxstep"] = this->maxstep;
-  for (int i = 0; i < 10; i++) {
-    doc["preset"][i] = this->focuserpreset[i];
-  };
-  // SERVERS - SERVICES
-  doc["ascom_en"] = this->ascomsrvr_enable;
-  doc["ascom_port"] = this->ascomsrvr_port;
-  doc["dbg_en"] = this->debugsrvr_enable;
-  doc["dbg_port"] = this->debugsrvr_port;
-  doc["dbg_out"] = this->debugsrvr_out;
-  doc["ddns_en"] = this->duckdns_enable;
-  doc["ddns_d"] = this->duckdns_domain;
-  doc["ddns_r"] = this->duckdns_refreshtime;
-  doc["ddns_t"] = this->duckdns_token;
-  doc["mngt_en"] = this->mngsrvr_enable;
-  doc["mngt_port"] = this->mngsrvr_port;
-  doc["ota_id"] = this->ota_id;
-  doc["ota_name"] = this->ota_name;
-  doc["ota_pwd"] = this->ota_password;
-  doc["tcp_en"] = this->tcpipsrvr_enable;
-  doc["tcp_port"] = this->tcpipsrvr_port;
-  doc["ws_en"] = this->websrvr_enable;
-  doc["ws_port"] = this->websrvr_port;
-
-  // DEVICES
-  // display
-  doc["d_en"] = this->display_enable;
-  doc["d_pgopt"] = this->display_pageoption;
-  doc["d_pgtime"] = this->display_pagetime;
-  doc["d_updmove"] = this->display_updateonmove;
-  // hpsw
-  doc["hpsw_en"] = this->hpswitch_enable;
-  doc["hpswmsg_en"] = this->hpswitch_enable;
-  // stall guard
-  doc["stall_st"] = this->stallguard_state;
-  doc["stall_val"] = this->stallguard_value;
-  // tmc currents
-  doc["tmc2209mA"] = this->tmc2209current;
-  doc["tmc2225mA"] = this->tmc2225current;
-  // leds
-  doc["led_en"] = this->inoutled_enable;
-  doc["led_mode"] = this->inoutled_mode;
-  // joysticks
-  doc["joy1_en"] = this->joystick1_enable;
-  doc["joy2_en"] = this->joystick2_enable;
-  // pushbuttons
-  doc["pb_en"] = this->pushbutton_enable;
-  doc["pb_steps"] = this->pushbutton_steps;
-  // temperature probe
-  doc["t_en"] = this->tempprobe_enable;
-  doc["t_coe"] = this->tempcoefficient;
-  doc["t_comp_en"] = this->tempcomp_enable;
-  doc["t_mod"] = this->tempmode;
-  doc["t_res"] = this->tempresolution;
-  doc["t_tcavail"] = this->tcavailable;
-  doc["t_tcdir"] = this->tcdirection;
-  // backlash
-  doc["blin_en"] = this->backlash_in_enable;
-  doc["blin_steps"] = this->backlashsteps_in;
-  doc["blout_en"] = this->backlash_out_enable;
-  doc["blout_steps"] = this->backlashsteps_out;
-  // coil power
-  doc["cp_en"] = this->coilpower_enable;
-  // delay after move
-  doc["dam_en"] = this->delayaftermove_enable;
-  doc["dam_time"] = this->delayaftermove_time;
-  // devicename
-  doc["devname"] = this->devicename;
-  // file list format
-  doc["filelist"] = this->filelistformat;
-  // motorspeed
-  doc["mspeed"] = this->motorspeed;
-  // park
-  doc["park_en"] = this->park_enable;
-  doc["park_time"] = this->park_time;
-  // reverse
-  doc["rdir_en"] = this->reverse_enable;
-  // stepsize
-  doc["ss_en"] = this->stepsize_enable;
-  doc["ss_val"] = this->stepsize;
-  // web page colors
-  doc["ticol"] = this->titlecolor;
-  doc["scol"] = this->subtitlecolor;
-  doc["hcol"] = this->headercolor;
-  doc["tcol"] = this->textcolor;
-  doc["bcol"] = this->backcolor;
-  // Serialize JSON to file
-  if (serializeJson(doc, file) == 0) {
-    CNTLRDATA_println(T_DESERIALISEERROR);
-    file.close();
+  if (CommitTmpFile(file_cntlr_config, (len == expected) ? len : 0) == false) {
     return false;
-  } else {
-    CNTLRDATA_print(T_SAVED);
-    CNTLRDATA_println(file_cntlr_config);
-    file.close();
-    return true;
   }
+  this->_cntlr_unsaved = false;
+  return true;
 }
 
 
 // ----------------------------------------------------------------------
-// Save Board Data to file board_config.jsn
+// Serialize only the sections that have changed since the last update,
+// by a save or by get_cntlr_json()
 // ----------------------------------------------------------------------
-bool CONTROLLER_DATA::SaveBoardConfiguration() {
-
-  CNTLRDATA_print("CD SaveBoardConfiguration ");
-  CNTLRDATA_println(file_board_config);
-
-  if (SPIFFS.exists(file_board_config)) {
-    SPIFFS.remove(file_board_config);
-  } else {
-    CNTLRDATA_println(T_NOTFOUND);
+void CONTROLLER_DATA::UpdateSections(void) {
+  for (int s = 0; s < Section_Count; s++) {
+    if (this->_dirty_sections & (1 << s)) {
+      String frag;
+      SerializeSection((Cntlr_Sections)s, frag);
+      if (frag != this->_section_json[s]) {
+        this->_section_json[s] = frag;
+        this->_cntlr_unsaved = true;
+        this->_cntlr_jsonvalid = false;
+      }
+    }
   }
+  this->_dirty_sections = 0;
+}
 
-  // Open file for writing
-  CNTLRDATA_println(T_OPENFILE);
-  File bfile = SPIFFS.open(file_board_config, "w");
-  if (!bfile) {
-    CNTLRDATA_println(T_OPENERROR);
-    return false;
-  } else {
-    // Allocate a temporary JsonDocument
-    // Don't forget to change the capacity to match your requirements.
-    // Use arduinojson.org/assistant to compute the capacity.
-    StaticJsonDocument<BOARDDATASIZE> doc_brd;
-    // Set the values in the document
-    doc_brd["board"] = this->board;
-    doc_brd["maxstepmode"] = this->maxstepmode;
-    doc_brd["stepmode"] = this->stepmode;
-    doc_brd["enpin"] = this->enablepin;
-    doc_brd["steppin"] = this->steppin;
-    doc_brd["dirpin"] = this->dirpin;
-    doc_brd["temppin"] = this->temppin;
-    doc_brd["hpswpin"] = this->hpswpin;
-    doc_brd["inledpin"] = this->inledpin;
-    doc_brd["outledpin"] = this->outledpin;
-    doc_brd["pb1pin"] = this->pb1pin;
-    doc_brd["pb2pin"] = this->pb2pin;
-    doc_brd["irpin"] = this->irpin;
-    doc_brd["brdnum"] = this->boardnumber;
-    doc_brd["stepsrev"] = this->stepsperrev;
-    doc_brd["fixedsmode"] = this->fixedstepmode;
-    for (int i = 0; i < 4; i++) {
-      doc_brd["brdpins"][i] = this->boardpins[i];
-    }
-    doc_brd["msdelay"] = this->msdelay;
 
-    // Serialize JSON to file
-    if (serializeJson(doc_brd, bfile) == 0) {
-      CNTLRDATA_println(T_DESERIALISEERROR);
-      bfile.close();
-      return false;
-    } else {
-      CNTLRDATA_print(T_SAVED);
-      CNTLRDATA_println(file_board_config);
-      bfile.close();
+// ----------------------------------------------------------------------
+// Controller settings as one JSON object, the same as cntlr_config.jsn
+// after the next save. Rebuilt from the cached sections only when one
+// has changed
+// ----------------------------------------------------------------------
+const String &CONTROLLER_DATA::get_cntlr_json(void) {
+  UpdateSections();
+  if (this->_cntlr_jsonvalid == false) {
+    size_t len = 2 + (Section_Count - 1);
+    for (int s = 0; s < Section_Count; s++) {
+      len += this->_section_json[s].length();
+    }
+    this->_cntlr_json = "";
+    this->_cntlr_json.reserve(len);
+    this->_cntlr_json += '{';
+    for (int s = 0; s < Section_Count; s++) {
+      if (s != 0) {
+        this->_cntlr_json += ',';
+      }
+      this->_cntlr_json += this->_section_json[s];
     }
+    this->_cntlr_json += '}';
+    this->_cntlr_jsonvalid = true;
   }
-  return true;
+  return this->_cntlr_json;
 }
 
 
 // ----------------------------------------------------------------------
-// Controller_Data Methods
+// Board data as one JSON object, the same as board_config.jsn after the
+// next save. Board data is set from many places, so it is serialized on
+// each call, into a buffer kept between calls
 // ----------------------------------------------------------------------
-
-// FOCUSER POSITION
-long CONTROLLER_DATA::get_fposition() {
-  return this->fposition;
+const String &CONTROLLER_DATA::get_board_json(void) {
+  StaticJsonDocument<BOARDDATASIZE> doc_brd;
+  BoardDocument(doc_brd);
+  this->_board_json = "";
+  serializeJson(doc_brd, this->_board_json);
+  return this->_board_json;
 }
 
-void CONTROLLER_DATA::set_fposition(long fposition) {
-  this->fposition = fposition;
-  portENTER_CRITICAL(&varMux);
-  save_var_flag = 0;
-  portEXIT_CRITICAL(&varMux);
-}
 
-// FOCUSER DIRECTION
-byte CONTROLLER_DATA::get_focuserdirection() {
-  return this->focuserdirection;
-}
+// ----------------------------------------------------------------------
+// Serialize one section of the controller data to a JSON fragment
+// The fragment is the list of members without the enclosing { }
+// ----------------------------------------------------------------------
+void CONTROLLER_DATA::SerializeSection(Cntlr_Sections section, String &frag) {
+  // Allocate a temporary JsonDocument
+  // Largest section is Motion, 33 members and 10 presets
+  StaticJsonDocument<SECTIONDATASIZE> doc;
 
-void CONTROLLER_DATA::set_focuserdirection(byte newdir) {
-  this->focuserdirection = newdir;
-}
+  if (section == Section_Motion) {
+    for (int i = 0; i < 10; i++) {
+      doc["preset"][i] = this->focuserpreset[i];
+    }
+    doc["stall_st"] = this->stallguard_state;
+  }
+#define X(sec, type, member, accessor, k, def, lo, hi, setter) \
+  if ((sec) == section) { \
+    doc[k] = this->member; \
+  }
+  CNTLR_VALUE_SETTINGS(X)
+#undef X
+#define X(sec, member, accessor, k, def, len, setter) \
+  if ((sec) == section) { \
+    doc[k] = this->member; \
+  }
+  CNTLR_TEXT_SETTINGS(X)
+#undef X
 
-// MAXSTEPS
-long CONTROLLER_DATA::get_maxstep() {
-  return this->maxstep;
+  frag = "";
+  serializeJson(doc, frag);
+  // strip the enclosing { }
+  frag = frag.substring(1, frag.length() - 1);
 }
 
-void CONTROLLER_DATA::set_maxstep(long newval) {
-  this->StartDelayedUpdate(this->maxstep, newval);
-}
 
-// PRESETS
-long CONTROLLER_DATA::get_focuserpreset(byte idx) {
-  return this->focuserpreset[idx % 10];
-}
+// ----------------------------------------------------------------------
+// Save Board Data to file board_config.jsn
+// ----------------------------------------------------------------------
+bool CONTROLLER_DATA::SaveBoardConfiguration() {
 
-void CONTROLLER_DATA::set_focuserpreset(byte idx, long pos) {
-  this->StartDelayedUpdate(this->focuserpreset[idx % 10], pos);
-}
+  CNTLRDATA_print("CD SaveBoardConfiguration ");
+  CNTLRDATA_println(file_board_config);
 
-// ASCOM ALPACA SERVER
-byte CONTROLLER_DATA::get_ascomsrvr_enable(void) {
-  return this->ascomsrvr_enable;
-}
+  // Allocate a temporary JsonDocument
+  // Don't forget to change the capacity to match your requirements.
+  // Use arduinojson.org/assistant to compute the capacity.
+  StaticJsonDocument<BOARDDATASIZE> doc_brd;
+  BoardDocument(doc_brd);
 
-void CONTROLLER_DATA::set_ascomsrvr_enable(byte newstate) {
-  this->StartDelayedUpdate(this->ascomsrvr_enable, newstate);
+  // Serialize JSON to file
+  return SaveJsonFile(file_board_config, doc_brd);
 }
 
-unsigned long CONTROLLER_DATA::get_ascomsrvr_port(void) {
-  return this->ascomsrvr_port;
-}
 
-void CONTROLLER_DATA::set_ascomsrvr_port(unsigned long newport) {
-  this->StartDelayedUpdate(this->ascomsrvr_port, newport);
+// ----------------------------------------------------------------------
+// Set the board data in a document, as saved in board_config.jsn
+// ----------------------------------------------------------------------
+void CONTROLLER_DATA::BoardDocument(JsonDocument &doc_brd) {
+  doc_brd["board"] = this->board;
+  doc_brd["maxstepmode"] = this->maxstepmode;
+  doc_brd["stepmode"] = this->stepmode;
+  doc_brd["enpin"] = this->enablepin;
+  doc_brd["steppin"] = this->steppin;
+  doc_brd["dirpin"] = this->dirpin;
+  doc_brd["temppin"] = this->temppin;
+  doc_brd["hpswpin"] = this->hpswpin;
+  doc_brd["inledpin"] = this->inledpin;
+  doc_brd["outledpin"] = this->outledpin;
+  doc_brd["pb1pin"] = this->pb1pin;
+  doc_brd["pb2pin"] = this->pb2pin;
+  doc_brd["irpin"] = this->irpin;
+  doc_brd["brdnum"] = this->boardnumber;
+  doc_brd["stepsrev"] = this->stepsperrev;
+  doc_brd["fixedsmode"] = this->fixedstepmode;
+  for (int i = 0; i < 4; i++) {
+    doc_brd["brdpins"][i] = this->boardpins[i];
+  }
+  doc_brd["msdelay"] = this->msdelay;
 }
 
-// BACKLASH
-byte CONTROLLER_DATA::get_backlash_in_enable(void) {
-  return this->backlash_in_enable;
-  // apply backlash when moving in [0=!enabled, 1=enabled]
-}
 
-void CONTROLLER_DATA::set_backlash_in_enable(byte newstate) {
-  this->StartDelayedUpdate(this->backlash_in_enable, newstate);
+// ----------------------------------------------------------------------
+// Transactional write of a JSON document to a config file
+// The document is written to file.tmp and the size of the written file is
+// verified. The current file is then kept as file.bak and file.tmp renamed
+// to file, so a reset at any point leaves a complete copy on SPIFFS
+// ----------------------------------------------------------------------
+bool CONTROLLER_DATA::SaveJsonFile(const String &filename, JsonDocument &doc) {
+  File tfile = OpenTmpFile(filename);
+  if (!tfile) {
+    return false;
+  }
+  size_t len = serializeJson(doc, tfile);
+  tfile.close();
+  return CommitTmpFile(filename, (len == measureJson(doc)) ? len : 0);
 }
 
-byte CONTROLLER_DATA::get_backlash_out_enable(void) {
-  return this->backlash_out_enable;
-  // apply backlash when moving out [0=!enabled, 1=enabled]
-}
 
-void CONTROLLER_DATA::set_backlash_out_enable(byte newstate) {
-  this->StartDelayedUpdate(this->backlash_out_enable, newstate);
-}
+// ----------------------------------------------------------------------
+// Open file.tmp for writing, removing any tmp file left behind by an
+// interrupted save
+// ----------------------------------------------------------------------
+File CONTROLLER_DATA::OpenTmpFile(const String &filename) {
+  String tmpfile = filename + CONFIGTMPEXT;
 
-byte CONTROLLER_DATA::get_backlashsteps_in(void) {
-  return this->backlashsteps_in;
+  if (SPIFFS.exists(tmpfile)) {
+    SPIFFS.remove(tmpfile);
+  }
+  CNTLRDATA_print(T_OPENFILE);
+  CNTLRDATA_println(tmpfile);
+  File tfile = SPIFFS.open(tmpfile, "w");
+  if (!tfile) {
+    CNTLRDATA_println(T_OPENERROR);
+  }
+  return tfile;
 }
 
-void CONTROLLER_DATA::set_backlashsteps_in(byte newval) {
-  this->StartDelayedUpdate(this->backlashsteps_in, newval);
-}
 
-byte CONTROLLER_DATA::get_backlashsteps_out(void) {
-  return this->backlashsteps_out;
-}
+// ----------------------------------------------------------------------
+// Verify file.tmp holds len bytes, then swap it with file
+// ----------------------------------------------------------------------
+bool CONTROLLER_DATA::CommitTmpFile(const String &filename, size_t len) {
+  String tmpfile = filename + CONFIGTMPEXT;
+  String bakfile = filename + CONFIGBAKEXT;
+
+  // verify, a full file system or a failed write leaves a short file
+  size_t flen = 0;
+  File tfile = SPIFFS.open(tmpfile, "r");
+  if (tfile) {
+    flen = tfile.size();
+    tfile.close();
+  }
+  if ((len == 0) || (flen != len)) {
+    CNTLRDATA_println(T_ERROR);
+    SPIFFS.remove(tmpfile);
+    return false;
+  }
 
-void CONTROLLER_DATA::set_backlashsteps_out(byte newval) {
-  this->StartDelayedUpdate(this->backlashsteps_out, newval);
+  // swap, the current file becomes the last good copy
+  if (SPIFFS.exists(filename)) {
+    if (SPIFFS.exists(bakfile)) {
+      SPIFFS.remove(bakfile);
+    }
+    SPIFFS.rename(filename, bakfile);
+  }
+  if (SPIFFS.rename(tmpfile, filename) == false) {
+    CNTLRDATA_println(T_ERROR);
+    return false;
+  }
+  CNTLRDATA_print(T_SAVED);
+  CNTLRDATA_println(filename);
+  return true;
 }
 
-// COILPOWER
-byte CONTROLLER_DATA::get_coilpower_enable(void) {
-  return this->coilpower_enable;
-  // state of coil power, 0 = !enabled, 1= enabled
-}
 
-void CONTROLLER_DATA::set_coilpower_enable(byte newstate) {
-  this->StartDelayedUpdate(this->coilpower_enable, newstate);
-}
+// ----------------------------------------------------------------------
+// Load a JSON document from a config file
+// If the file is missing or cannot be deserialised, the last good copy
+// file.bak is used. The damaged file is removed so that the next save
+// does not overwrite the good copy
+// ----------------------------------------------------------------------
+bool CONTROLLER_DATA::LoadJsonFile(const String &filename, JsonDocument &doc) {
+  String bakfile = filename + CONFIGBAKEXT;
+  const String *files[2] = { &filename, &bakfile };
+
+  for (int i = 0; i < 2; i++) {
+    if (SPIFFS.exists(*files[i]) == false) {
+      CNTLRDATA_print(T_NOTFOUND);
+      CNTLRDATA_println(*files[i]);
+      continue;
+    }
+    File file = SPIFFS.open(*files[i], "r");
+    CNTLRDATA_print("-size ");
+    CNTLRDATA_println(file.size());
 
-// DELAY AFTER MOVE
-byte CONTROLLER_DATA::get_delayaftermove_enable(void) {
-  return this->delayaftermove_enable;
+    // Deserialize the JSON document straight from the file
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error) {
+      CNTLRDATA_print(T_DESERIALISEERROR);
+      CNTLRDATA_println(*files[i]);
+      continue;
+    }
+    if ((i == 1) && SPIFFS.exists(filename)) {
+      SPIFFS.remove(filename);
+    }
+    return true;
+  }
+  return false;
 }
 
-void CONTROLLER_DATA::set_delayaftermove_enable(byte newstate) {
-  this->StartDelayedUpdate(this->delayaftermove_enable, newstate);
-}
 
-byte CONTROLLER_DATA::get_delayaftermove_time(void) {
-  return this->delayaftermove_time;
-}
+// ----------------------------------------------------------------------
+// Remove a config file, and the tmp and bak files used by SaveJsonFile()
+// ----------------------------------------------------------------------
+void CONTROLLER_DATA::RemoveConfigFile(const String &filename) {
+  String tmpfile = filename + CONFIGTMPEXT;
+  String bakfile = filename + CONFIGBAKEXT;
 
-void CONTROLLER_DATA::set_delayaftermove_time(byte newtime) {
-  this->StartDelayedUpdate(this->delayaftermove_time, newtime);
+  if (SPIFFS.exists(filename)) {
+    SPIFFS.remove(filename);
+  }
+  if (SPIFFS.exists(tmpfile)) {
+    SPIFFS.remove(tmpfile);
+  }
+  if (SPIFFS.exists(bakfile)) {
+    SPIFFS.remove(bakfile);
+  }
 }
 
-// DEBUG SERVER
-byte CONTROLLER_DATA::get_debugsrvr_enable(void) {
-  return this->debugsrvr_enable;
-}
 
-void CONTROLLER_DATA::set_debugsrvr_enable(byte newstate) {
-  this->StartDelayedUpdate(this->debugsrvr_enable, newstate);
-}
+// ----------------------------------------------------------------------
+// Controller_Data Methods
+// ----------------------------------------------------------------------
 
-unsigned long CONTROLLER_DATA::get_debugsrvr_port() {
-  return this->debugsrvr_port;
+// FOCUSER POSITION
+long CONTROLLER_DATA::get_fposition() {
+  return this->fposition;
 }
 
-void CONTROLLER_DATA::set_debugsrvr_port(unsigned long newport) {
-  this->StartDelayedUpdate(this->debugsrvr_port, newport);
+void CONTROLLER_DATA::set_fposition(long fposition) {
+  this->fposition = fposition;
+  portENTER_CRITICAL(&varMux);
+  save_var_flag = 0;
+  portEXIT_CRITICAL(&varMux);
 }
 
-byte CONTROLLER_DATA::get_debugsrvr_out() {
-  return this->debugsrvr_out;
+// FOCUSER DIRECTION
+byte CONTROLLER_DATA::get_focuserdirection() {
+  return this->focuserdirection;
 }
 
-void CONTROLLER_DATA::set_debugsrvr_out(byte newout) {
-  this->StartDelayedUpdate(this->debugsrvr_out, newout);
+void CONTROLLER_DATA::set_focuserdirection(byte newdir) {
+  this->focuserdirection = newdir;
 }
 
-// DEVICENAME
-String CONTROLLER_DATA::get_devicename(void) {
-  return this->devicename;
+// PRESETS
+long CONTROLLER_DATA::get_focuserpreset(byte idx) {
+  return this->focuserpreset[idx % 10];
 }
 
-void CONTROLLER_DATA::set_devicename(String newname) {
-  this->StartDelayedUpdate(this->devicename, newname);
+void CONTROLLER_DATA::set_focuserpreset(byte idx, long pos) {
+  this->StartDelayedUpdate(Section_Motion, this->focuserpreset[idx % 10], pos);
 }
 
 // DISPLAY
-byte CONTROLLER_DATA::get_display_enable(void) {
-  return this->display_enable;
-}
-
-void CONTROLLER_DATA::set_display_enable(byte newstate) {
-  this->StartDelayedUpdate(this->display_enable, newstate);
-}
-
-int CONTROLLER_DATA::get_display_pagetime(void) {
-  return this->display_pagetime;
-}
-
 void CONTROLLER_DATA::set_display_pagetime(int newtime) {
+  newtime = schema_range(newtime, V_DISPLAYPAGETIMEMIN, V_DISPLAYPAGETIMEMAX);
   portENTER_CRITICAL(&displaytimeMux);
   display_maxcount = newtime * 10;
   portEXIT_CRITICAL(&displaytimeMux);
-  this->StartDelayedUpdate(this->display_pagetime, newtime);
+  this->StartDelayedUpdate(Section_Display, this->display_pagetime, newtime);
 }
 
-String CONTROLLER_DATA::get_display_pageoption(void) {
-  String tmp = this->display_pageoption;
-  while (tmp.length() < 8) {
-    tmp = tmp + "0";
-  }
-  tmp = tmp + "";
-  this->display_pageoption = tmp;
-  return this->display_pageoption;
+// pageoption is always held padded to 8 pages
+void CONTROLLER_DATA::set_display_pageoption(const char *newoption) {
+  char tmp[PAGEOPTIONLEN];
+  strlcpy(tmp, newoption, sizeof(tmp));
+  this->pad_pageoption(tmp);
+  this->StartDelayedUpdate(Section_Display, this->display_pageoption, sizeof(this->display_pageoption), tmp);
 }
 
-void CONTROLLER_DATA::set_display_pageoption(String newoption) {
-  String tmp = newoption;
-  while (tmp.length() < 8) {
-    tmp = tmp + "0";
+// pad a page option string, missing pages are 0
+void CONTROLLER_DATA::pad_pageoption(char *option) {
+  size_t len = strlen(option);
+  while (len < (PAGEOPTIONLEN - 1)) {
+    option[len++] = '0';
   }
-  tmp = tmp + "";
-  this->display_pageoption = tmp;
-  this->StartDelayedUpdate(this->display_pageoption, newoption);
-}
-
-byte CONTROLLER_DATA::get_display_updateonmove(void) {
-  return this->display_updateonmove;
-}
-
-void CONTROLLER_DATA::set_display_updateonmove(byte newstate) {
-  this->StartDelayedUpdate(this->display_updateonmove, newstate);
-}
-
-// DUCKDNS
-byte CONTROLLER_DATA::get_duckdns_enable(void) {
-  return this->duckdns_enable;
-}
-
-void CONTROLLER_DATA::set_duckdns_enable(byte newstate) {
-  this->StartDelayedUpdate(this->duckdns_enable, newstate);
-}
-
-String CONTROLLER_DATA::get_duckdns_domain(void) {
-  return this->duckdns_domain;
-}
-
-void CONTROLLER_DATA::set_duckdns_domain(String newdomain) {
-  this->StartDelayedUpdate(this->duckdns_domain, newdomain);
-}
-
-String CONTROLLER_DATA::get_duckdns_token(void) {
-  return this->duckdns_token;
-}
-
-void CONTROLLER_DATA::set_duckdns_token(String newtoken) {
-  this->StartDelayedUpdate(this->duckdns_token, newtoken);
-}
-
-unsigned int CONTROLLER_DATA::get_duckdns_refreshtime(void) {
-  return this->duckdns_refreshtime;
-}
-
-void CONTROLLER_DATA::set_duckdns_refreshtime(unsigned int newtime) {
-  this->StartDelayedUpdate(this->duckdns_refreshtime, newtime);
-}
-
-// FILE LIST FORMAT
-byte CONTROLLER_DATA::get_filelistformat(void) {
-  return this->filelistformat;
-}
-
-void CONTROLLER_DATA::set_filelistformat(byte newlistformat) {
-  this->StartDelayedUpdate(this->filelistformat, newlistformat);
-}
-
-// HOME POSITION SWITCH
-byte CONTROLLER_DATA::get_hpswitch_enable(void) {
-  return this->hpswitch_enable;
-}
-
-void CONTROLLER_DATA::set_hpswitch_enable(byte newstate) {
-  this->StartDelayedUpdate(this->hpswitch_enable, newstate);
-}
-
-byte CONTROLLER_DATA::get_hpswmsg_enable(void) {
-  return this->hpswmsg_enable;
-}
-
-void CONTROLLER_DATA::set_hpswmsg_enable(byte newstate) {
-  this->StartDelayedUpdate(this->hpswmsg_enable, newstate);
-}
-
-// JOYSTICKS
-byte CONTROLLER_DATA::get_joystick1_enable(void) {
-  return this->joystick1_enable;
-}
-
-void CONTROLLER_DATA::set_joystick1_enable(byte newstate) {
-  this->StartDelayedUpdate(this->joystick1_enable, newstate);
-}
-
-byte CONTROLLER_DATA::get_joystick2_enable(void) {
-  return this->joystick2_enable;
-}
-
-void CONTROLLER_DATA::set_joystick2_enable(byte newstate) {
-  this->StartDelayedUpdate(this->joystick2_enable, newstate);
-}
-
-// LEDS
-byte CONTROLLER_DATA::get_inoutled_enable(void) {
-  return this->inoutled_enable;
-}
-
-void CONTROLLER_DATA::set_inoutled_enable(byte newstate) {
-  this->StartDelayedUpdate(this->inoutled_enable, newstate);
-}
-
-byte CONTROLLER_DATA::get_inoutled_mode(void) {
-  return this->inoutled_mode;
-}
-
-void CONTROLLER_DATA::set_inoutled_mode(byte newmode) {
-  this->StartDelayedUpdate(this->inoutled_mode, newmode);
-}
-
-// MANAGEMENT SERVER
-byte CONTROLLER_DATA::get_mngsrvr_enable(void) {
-  return this->mngsrvr_enable;
-}
-
-void CONTROLLER_DATA::set_mngsrvr_enable(byte newstate) {
-  this->StartDelayedUpdate(this->mngsrvr_enable, newstate);
-}
-
-unsigned long CONTROLLER_DATA::get_mngsrvr_port(void) {
-  return this->mngsrvr_port;
-}
-
-void CONTROLLER_DATA::set_mngsrvr_port(unsigned long newport) {
-  this->StartDelayedUpdate(this->mngsrvr_port, newport);
-}
-
-// MOTOR SPEED
-byte CONTROLLER_DATA::get_motorspeed(void) {
-  return this->motorspeed;
-}
-
-void CONTROLLER_DATA::set_motorspeed(byte newval) {
-  this->StartDelayedUpdate(this->motorspeed, newval);
-}
-
-// OTA
-String CONTROLLER_DATA::get_ota_name(void) {
-  return this->ota_name;
-}
-
-void CONTROLLER_DATA::set_ota_name(String newname) {
-  this->StartDelayedUpdate(this->ota_name, newname);
-}
-
-String CONTROLLER_DATA::get_ota_password(void) {
-  return this->ota_password;
-}
-
-void CONTROLLER_DATA::set_ota_password(String newpwd) {
-  this->StartDelayedUpdate(this->ota_password, newpwd);
-}
-
-String CONTROLLER_DATA::get_ota_id(void) {
-  return this->ota_id;
-}
-
-void CONTROLLER_DATA::set_ota_id(String newid) {
-  this->StartDelayedUpdate(this->ota_id, newid);
-}
-
-// PARK
-byte CONTROLLER_DATA::get_park_enable(void) {
-  return this->park_enable;
-}
-
-void CONTROLLER_DATA::set_park_enable(byte newstate) {
-  this->StartDelayedUpdate(this->park_enable, newstate);
-}
-
-int CONTROLLER_DATA::get_parktime(void) {
-  return this->park_time;
-}
-
-void CONTROLLER_DATA::set_parktime(int newtime) {
-  this->StartDelayedUpdate(this->park_time, newtime);
-}
-
-// PUSH BUTTONS
-byte CONTROLLER_DATA::get_pushbutton_enable(void) {
-  return this->pushbutton_enable;
-}
-
-void CONTROLLER_DATA::set_pushbutton_enable(byte newstate) {
-  this->StartDelayedUpdate(this->pushbutton_enable, newstate);
-}
-
-int CONTROLLER_DATA::get_pushbutton_steps(void) {
-  return this->pushbutton_steps;
-}
-
-void CONTROLLER_DATA::set_pushbutton_steps(int newval) {
-  this->StartDelayedUpdate(this->pushbutton_steps, newval);
-}
-
-// REVERSE
-byte CONTROLLER_DATA::get_reverse_enable(void) {
-  return this->reverse_enable;
-  // state for reverse direction, 0 = !enabled, 1= enabled
-}
-
-void CONTROLLER_DATA::set_reverse_enable(byte newstate) {
-  this->StartDelayedUpdate(this->reverse_enable, newstate);
-}
-
-// STEPMODE
-
-
-// STEPSIZE
-byte CONTROLLER_DATA::get_stepsize_enable(void) {
-  return this->stepsize_enable;
-  // if 1, controller returns step size
-}
-
-void CONTROLLER_DATA::set_stepsize_enable(byte newstate) {
-  this->StartDelayedUpdate(this->stepsize_enable, newstate);
-}
-
-float CONTROLLER_DATA::get_stepsize(void) {
-  return this->stepsize;
-  // this is the actual measured focuser stepsize in microns amd is reported to ASCOM, so must be valid
-  // the amount in microns that the focuser tube moves in one step of the motor
-}
-
-void CONTROLLER_DATA::set_stepsize(float newval) {
-  this->StartDelayedUpdate(this->stepsize, newval);
-  // the step size in microns, ie 7.2 - value * 10, so real stepsize = stepsize / 10 (maxval = 25.6)
-}
-
-// TCPIP SERVER
-byte CONTROLLER_DATA::get_tcpipsrvr_enable(void) {
-  return this->tcpipsrvr_enable;
-}
-
-void CONTROLLER_DATA::set_tcpipsrvr_enable(byte newstate) {
-  this->StartDelayedUpdate(this->tcpipsrvr_enable, newstate);
-}
-
-unsigned long CONTROLLER_DATA::get_tcpipsrvr_port(void) {
-  return this->tcpipsrvr_port;
-}
-
-void CONTROLLER_DATA::set_tcpipsrvr_port(unsigned long newport) {
-  this->StartDelayedUpdate(this->tcpipsrvr_port, newport);
-}
-
-// TEMPERATURE
-byte CONTROLLER_DATA::get_tempmode(void) {
-  return this->tempmode;
-  // temperature display mode, Celcius=1, Fahrenheit=0
-}
-
-void CONTROLLER_DATA::set_tempmode(byte newmode) {
-  this->StartDelayedUpdate(this->tempmode, newmode);
-  // temperature display mode, Celcius=1, Fahrenheit=0
-}
-
-byte CONTROLLER_DATA::get_tempprobe_enable(void) {
-  return this->tempprobe_enable;
-}
-
-void CONTROLLER_DATA::set_tempprobe_enable(byte newstate) {
-  this->StartDelayedUpdate(this->tempprobe_enable, newstate);
-}
-
-byte CONTROLLER_DATA::get_tempcomp_enable(void) {
-  return this->tempcomp_enable;
-  // indicates if temperature compensation is enabled
-}
-
-void CONTROLLER_DATA::set_tempcomp_enable(byte newstate) {
-  this->StartDelayedUpdate(this->tempcomp_enable, newstate);
-}
-
-int CONTROLLER_DATA::get_tempcoefficient(void) {
-  return this->tempcoefficient;
-  // steps per degree temperature coefficient value (maxval=256)
-}
-
-void CONTROLLER_DATA::set_tempcoefficient(int newval) {
-  this->StartDelayedUpdate(this->tempcoefficient, newval);
-  // steps per degree temperature coefficient value (maxval=256)
-}
-
-byte CONTROLLER_DATA::get_tempresolution(void) {
-  return this->tempresolution;
-  // resolution of temperature measurement 9-12
-}
-
-void CONTROLLER_DATA::set_tempresolution(byte newval) {
-  this->StartDelayedUpdate(this->tempresolution, newval);
-}
-
-byte CONTROLLER_DATA::get_tcdirection(void) {
-  return this->tcdirection;
-  // indicates the direction in which temperature compensation is applied
-}
-
-void CONTROLLER_DATA::set_tcdirection(byte newdirection) {
-  this->StartDelayedUpdate(this->tcdirection, newdirection);
-}
-
-byte CONTROLLER_DATA::get_tcavailable(void) {
-  return this->tcavailable;
-}
-
-void CONTROLLER_DATA::set_tcavailable(byte newval) {
-  this->StartDelayedUpdate(this->tcavailable, newval);
+  option[PAGEOPTIONLEN - 1] = 0;
 }
 
 // TMC STEPPERS
@@ -1372,89 +853,236 @@ tmc2209stallguard CONTROLLER_DATA::get_stallguard_state(void) {
 }
 
 void CONTROLLER_DATA::set_stallguard_state(tmc2209stallguard newstate) {
-  this->StartDelayedUpdate(this->stallguard_state, newstate);
-}
-
-byte CONTROLLER_DATA::get_stallguard_value(void) {
-  return this->stallguard_value;
+  this->StartDelayedUpdate(Section_Motion, this->stallguard_state, newstate);
 }
 
-void CONTROLLER_DATA::set_stallguard_value(byte newval) {
-  this->StartDelayedUpdate(this->stallguard_value, newval);
-}
-
-int CONTROLLER_DATA::get_tmc2225current(void) {
-  return this->tmc2225current;
-}
-
-void CONTROLLER_DATA::set_tmc2225current(int newval) {
-  this->StartDelayedUpdate(this->tmc2225current, newval);
-}
 
-int CONTROLLER_DATA::get_tmc2209current(void) {
-  return this->tmc2209current;
-}
+// ----------------------------------------------------------------------
+// Settings accessors generated from controller_schema.h
+// ----------------------------------------------------------------------
+#define SCHEMA_SETTER_AUTO(sec, type, member, accessor, lo, hi) \
+  void CONTROLLER_DATA::set_##accessor(type newval) { \
+    this->StartDelayedUpdate(sec, this->member, schema_range(newval, lo, hi)); \
+  }
+#define SCHEMA_SETTER_CUSTOM(sec, type, member, accessor, lo, hi)
+
+#define X(sec, type, member, accessor, k, def, lo, hi, setter) \
+  type CONTROLLER_DATA::get_##accessor(void) { \
+    return this->member; \
+  } \
+  SCHEMA_SETTER_##setter(sec, type, member, accessor, lo, hi)
+CNTLR_VALUE_SETTINGS(X)
+#undef X
+
+#define SCHEMA_TEXTSETTER_AUTO(sec, member, accessor) \
+  void CONTROLLER_DATA::set_##accessor(const char *newval) { \
+    this->StartDelayedUpdate(sec, this->member, sizeof(this->member), newval); \
+  }
+#define SCHEMA_TEXTSETTER_CUSTOM(sec, member, accessor)
 
-void CONTROLLER_DATA::set_tmc2209current(int newval) {
-  this->StartDelayedUpdate(this->tmc2209current, newval);
-}
+#define X(sec, member, accessor, k, def, len, setter) \
+  const char *CONTROLLER_DATA::get_##accessor(void) { \
+    return this->member; \
+  } \
+  SCHEMA_TEXTSETTER_##setter(sec, member, accessor)
+CNTLR_TEXT_SETTINGS(X)
+#undef X
 
-// WEB SERVER
-byte CONTROLLER_DATA::get_websrvr_enable(void) {
-  return this->websrvr_enable;
-}
 
-void CONTROLLER_DATA::set_websrvr_enable(byte newstate) {
-  this->StartDelayedUpdate(this->websrvr_enable, newstate);
+// ----------------------------------------------------------------------
+// Get a setting by its cntlr_config.jsn key, adds "key":value to doc
+// The switch on the key hash is resolved at compile time
+// ----------------------------------------------------------------------
+bool CONTROLLER_DATA::get_setting(const char *key, JsonDocument &doc) {
+  switch (cntlr_keyhash(key)) {
+#define X(sec, type, member, accessor, k, def, lo, hi, setter) \
+  case cntlr_keyhash(k): \
+    if (strcmp(key, k) != 0) { \
+      return false; \
+    } \
+    doc[k] = this->member; \
+    return true;
+    CNTLR_VALUE_SETTINGS(X)
+#undef X
+#define X(sec, member, accessor, k, def, len, setter) \
+  case cntlr_keyhash(k): \
+    if (strcmp(key, k) != 0) { \
+      return false; \
+    } \
+    doc[k] = this->member; \
+    return true;
+    CNTLR_TEXT_SETTINGS(X)
+#undef X
+    default:
+      return false;
+  }
 }
 
-unsigned long CONTROLLER_DATA::get_websrvr_port(void) {
-  return this->websrvr_port;
-}
 
-void CONTROLLER_DATA::set_websrvr_port(unsigned long newport) {
-  this->StartDelayedUpdate(this->websrvr_port, newport);
+// ----------------------------------------------------------------------
+// Set a setting by its cntlr_config.jsn key from text
+// Values are limited to the range in the schema, then set with set_
+// ----------------------------------------------------------------------
+bool CONTROLLER_DATA::set_setting(const char *key, const char *value) {
+  char *end;
+  double newval;
+
+  switch (cntlr_keyhash(key)) {
+#define X(sec, type, member, accessor, k, def, lo, hi, setter) \
+  case cntlr_keyhash(k): \
+    if (strcmp(key, k) != 0) { \
+      return false; \
+    } \
+    newval = strtod(value, &end); \
+    if (end == value) { \
+      return false; \
+    } \
+    this->set_##accessor((type)schema_range(newval, lo, hi)); \
+    return true;
+    CNTLR_VALUE_SETTINGS(X)
+#undef X
+#define X(sec, member, accessor, k, def, len, setter) \
+  case cntlr_keyhash(k): \
+    if (strcmp(key, k) != 0) { \
+      return false; \
+    } \
+    this->set_##accessor(value); \
+    return true;
+    CNTLR_TEXT_SETTINGS(X)
+#undef X
+    default:
+      return false;
+  }
 }
 
-// WEB PAGE COLORS
-String CONTROLLER_DATA::get_wp_backcolor(void) {
-  return this->backcolor;
+// ----------------------------------------------------------------------
+// Number from a JSON value, numbers, numeric text and true/false
+// ----------------------------------------------------------------------
+static bool setting_number(JsonVariantConst value, double &num) {
+  if (value.is<bool>()) {
+    num = (value.as<bool>() == true) ? 1 : 0;
+    return true;
+  }
+  if (value.is<double>()) {
+    num = value.as<double>();
+    return true;
+  }
+  const char *text = value.as<const char *>();
+  if (text == nullptr) {
+    return false;
+  }
+  char *end;
+  num = strtod(text, &end);
+  return (end != text) && (*end == 0);
 }
 
-void CONTROLLER_DATA::set_wp_backcolor(String newcolor) {
-  this->StartDelayedUpdate(this->backcolor, newcolor);
-}
 
-String CONTROLLER_DATA::get_wp_textcolor(void) {
-  return this->textcolor;
+// ----------------------------------------------------------------------
+// Check a setting by its cntlr_config.jsn key without changing it
+// Unlike set_setting, a value outside the schema range is rejected
+// ----------------------------------------------------------------------
+bool CONTROLLER_DATA::check_setting(const char *key, JsonVariantConst value) {
+  double num;
+
+  switch (cntlr_keyhash(key)) {
+#define X(sec, type, member, accessor, k, def, lo, hi, setter) \
+  case cntlr_keyhash(k): \
+    return (strcmp(key, k) == 0) && setting_number(value, num) && (num >= (lo)) && (num <= (hi));
+    CNTLR_VALUE_SETTINGS(X)
+#undef X
+#define X(sec, member, accessor, k, def, len, setter) \
+  case cntlr_keyhash(k): \
+    return (strcmp(key, k) == 0) && value.is<const char *>() && (strlen(value.as<const char *>()) < (len));
+    CNTLR_TEXT_SETTINGS(X)
+#undef X
+    default:
+      return false;
+  }
 }
 
-void CONTROLLER_DATA::set_wp_textcolor(String newcolor) {
-  this->StartDelayedUpdate(this->textcolor, newcolor);
-}
 
-String CONTROLLER_DATA::get_wp_headercolor(void) {
-  return this->headercolor;
+// ----------------------------------------------------------------------
+// Check the settings of cntlr_config.jsn that are not in the schema,
+// "preset":[10 positions] and "stall_st":tmc2209stallguard
+// ----------------------------------------------------------------------
+static bool check_presets(JsonVariantConst value) {
+  JsonArrayConst presets = value.as<JsonArrayConst>();
+  if (presets.isNull() || (presets.size() > 10)) {
+    return false;
+  }
+  for (size_t i = 0; i < presets.size(); i++) {
+    double num;
+    if ((setting_number(presets[i], num) == false) || (num < 0) || (num > FOCUSERUPPERLIMIT)) {
+      return false;
+    }
+  }
+  return true;
 }
 
-void CONTROLLER_DATA::set_wp_headercolor(String newcolor) {
-  this->StartDelayedUpdate(this->headercolor, newcolor);
+static bool check_stallstate(JsonVariantConst value) {
+  double num;
+  return setting_number(value, num) && (num >= Use_Stallguard) && (num <= Use_None);
 }
 
-String CONTROLLER_DATA::get_wp_titlecolor(void) {
-  return this->titlecolor;
-}
 
-void CONTROLLER_DATA::set_wp_titlecolor(String newcolor) {
-  this->StartDelayedUpdate(this->titlecolor, newcolor);
-}
+// ----------------------------------------------------------------------
+// Apply many settings as one transaction, { "key":value, ... }
+// Every setting is checked first, if one fails nothing is changed and its
+// key is returned. Then all are set and the changed sections are written
+// by one save, or by the delayed save if the focuser is moving.
+// Takes what get_cntlr_json() returns, including preset and stall_st
+// ----------------------------------------------------------------------
+bool CONTROLLER_DATA::ApplySettings(JsonObjectConst settings, String &badkey) {
+  for (JsonPairConst kv : settings) {
+    const char *key = kv.key().c_str();
+    bool ok;
+    if (strcmp(key, "preset") == 0) {
+      ok = check_presets(kv.value());
+    } else if (strcmp(key, "stall_st") == 0) {
+      ok = check_stallstate(kv.value());
+    } else {
+      ok = check_setting(key, kv.value());
+    }
+    if (ok == false) {
+      badkey = key;
+      return false;
+    }
+  }
 
-String CONTROLLER_DATA::get_wp_subtitlecolor(void) {
-  return this->subtitlecolor;
-}
+  for (JsonPairConst kv : settings) {
+    const char *key = kv.key().c_str();
+    double num = 0;
+    if (strcmp(key, "preset") == 0) {
+      JsonArrayConst presets = kv.value().as<JsonArrayConst>();
+      for (size_t i = 0; i < presets.size(); i++) {
+        setting_number(presets[i], num);
+        set_focuserpreset(i, (long)num);
+      }
+      continue;
+    }
+    if (strcmp(key, "stall_st") == 0) {
+      setting_number(kv.value(), num);
+      set_stallguard_state((tmc2209stallguard)(int)num);
+      continue;
+    }
+    char buff[24];
+    const char *text = kv.value().as<const char *>();
+    if (text == nullptr) {
+      setting_number(kv.value(), num);
+      snprintf(buff, sizeof(buff), "%.10g", num);
+      text = buff;
+    }
+    set_setting(key, text);
+  }
 
-void CONTROLLER_DATA::set_wp_subtitlecolor(String newcolor) {
-  this->StartDelayedUpdate(this->subtitlecolor, newcolor);
+  if (isMoving == true) {
+    CNTLRDATA_println("CD-Save delayed: isMoving");
+    return true;
+  }
+  portENTER_CRITICAL(&cntlrMux);
+  save_cntlr_flag = -1;
+  portEXIT_CRITICAL(&cntlrMux);
+  return SavePersitantConfiguration();
 }
 
 
@@ -1462,59 +1090,60 @@ void CONTROLLER_DATA::set_wp_subtitlecolor(String newcolor) {
 // Delayed Write routines which update the focuser setting with the
 // new value, then sets a flag for when the data should be written to file
 // ----------------------------------------------------------------------
-void CONTROLLER_DATA::StartDelayedUpdate(int &org_data, int new_data) {
+void CONTROLLER_DATA::StartDelayedUpdate(Cntlr_Sections section, int &org_data, int new_data) {
   if (org_data != new_data) {
     org_data = new_data;
-    this->set_cntlr_flags();
+    this->set_cntlr_flags(section);
   }
 }
 
-void CONTROLLER_DATA::StartDelayedUpdate(tmc2209stallguard &org_data, tmc2209stallguard new_data) {
+void CONTROLLER_DATA::StartDelayedUpdate(Cntlr_Sections section, tmc2209stallguard &org_data, tmc2209stallguard new_data) {
   if (org_data != new_data) {
     org_data = new_data;
-    this->set_cntlr_flags();
+    this->set_cntlr_flags(section);
   }
 }
 
-void CONTROLLER_DATA::StartDelayedUpdate(unsigned int &org_data, unsigned int new_data) {
+void CONTROLLER_DATA::StartDelayedUpdate(Cntlr_Sections section, unsigned int &org_data, unsigned int new_data) {
   if (org_data != new_data) {
     org_data = new_data;
-    this->set_cntlr_flags();
+    this->set_cntlr_flags(section);
   }
 }
 
-void CONTROLLER_DATA::StartDelayedUpdate(long &org_data, long new_data) {
+void CONTROLLER_DATA::StartDelayedUpdate(Cntlr_Sections section, long &org_data, long new_data) {
   if (org_data != new_data) {
     org_data = new_data;
-    this->set_cntlr_flags();
+    this->set_cntlr_flags(section);
   }
 }
 
-void CONTROLLER_DATA::StartDelayedUpdate(unsigned long &org_data, unsigned long new_data) {
+void CONTROLLER_DATA::StartDelayedUpdate(Cntlr_Sections section, unsigned long &org_data, unsigned long new_data) {
   if (org_data != new_data) {
     org_data = new_data;
-    this->set_cntlr_flags();
+    this->set_cntlr_flags(section);
   }
 }
 
-void CONTROLLER_DATA::StartDelayedUpdate(float &org_data, float new_data) {
+void CONTROLLER_DATA::StartDelayedUpdate(Cntlr_Sections section, float &org_data, float new_data) {
   if (org_data != new_data) {
     org_data = new_data;
-    this->set_cntlr_flags();
+    this->set_cntlr_flags(section);
   }
 }
 
-void CONTROLLER_DATA::StartDelayedUpdate(byte &org_data, byte new_data) {
+void CONTROLLER_DATA::StartDelayedUpdate(Cntlr_Sections section, byte &org_data, byte new_data) {
   if (org_data != new_data) {
     org_data = new_data;
-    this->set_cntlr_flags();
+    this->set_cntlr_flags(section);
   }
 }
 
-void CONTROLLER_DATA::StartDelayedUpdate(String &org_data, String new_data) {
-  if (org_data != new_data) {
-    org_data = new_data;
-    this->set_cntlr_flags();
+// org_data is a fixed buffer of size bytes, new_data is truncated to fit
+void CONTROLLER_DATA::StartDelayedUpdate(Cntlr_Sections section, char *org_data, size_t size, const char *new_data) {
+  if (strncmp(org_data, new_data, size - 1) != 0) {
+    strlcpy(org_data, new_data, size);
+    this->set_cntlr_flags(section);
   }
 }
 
@@ -1533,24 +1162,19 @@ bool CONTROLLER_DATA::LoadBrdConfigStart(String brdfile) {
     CNTLRDATA_print(T_OPENERROR);
     return false;
   } else {
-    // read file and deserialize
-    String fdata;
-    fdata.reserve(BOARDDATASIZE);
-    fdata = bfile.readString();
-    bfile.close();
-
     // Allocate a temporary JsonDocument
-    DynamicJsonDocument doc_brd(BOARDDATASIZE);
+    StaticJsonDocument<BOARDDATASIZE> doc_brd;
 
-    // Deserialize the JSON document
-    DeserializationError jerror = deserializeJson(doc_brd, fdata);
+    // Deserialize the JSON document straight from the file
+    DeserializationError jerror = deserializeJson(doc_brd, bfile);
+    bfile.close();
     if (jerror) {
       CNTLRDATA_println(T_DESERIALISEERROR);
       return false;
     } else {
       // save the brd_data just read from board config file (brdfile) into board_config.jsn
       // Set the board values from doc_brd
-      this->board = doc_brd["board"].as<const char *>();
+      strlcpy(this->board, doc_brd["board"] | "", sizeof(this->board));
       this->maxstepmode = doc_brd["maxstepmode"];
       this->stepmode = doc_brd["stepmode"];
       this->enablepin = doc_brd["enpin"];
@@ -1564,30 +1188,7 @@ bool CONTROLLER_DATA::LoadBrdConfigStart(String brdfile) {
       this->pb2pin = doc_brd["pb2pin"];
       this->irpin = doc_brd["irpin"];
       this->boardnumber = doc_brd["brdnum"];
-      // brdstepsperrev comes from STEPSPERREVOLUTION and will be different so must override the default setting in the board files
-      switch (myboardnumber) {
-        case PRO2ESP32ULN2003:
-        case PRO2ESP32L298N:
-        case PRO2ESP32L293DMINI:
-        case PRO2ESP32L9110S:
-          this->stepsperrev = mystepsperrev;
-          // override STEPSPERREVOLUTION from controller_config.h FIXEDSTEPMODE
-          break;
-        default:
-          this->stepsperrev = doc_brd["stepsrev"];
-          break;
-      }
-      // myfixedstepmode comes from FIXEDSTEPMODE and will be different so must override the default setting in the board files
-      switch (myboardnumber) {
-        case PRO2ESP32R3WEMOS:
-        case PRO2ESP32ST6128:
-          this->fixedstepmode = myfixedstepmode;
-          // override fixedstepmode from controller_config.h FIXEDSTEPMODE
-          break;
-        default:
-          this->fixedstepmode = doc_brd["fixedsmode"];
-          break;
-      }
+      SetBoardOverrides(doc_brd["stepsrev"], doc_brd["fixedsmode"]);
       for (int i = 0; i < 4; i++) {
         this->boardpins[i] = doc_brd["brdpins"][i];
       }
@@ -1598,6 +1199,83 @@ bool CONTROLLER_DATA::LoadBrdConfigStart(String brdfile) {
   return false;
 }
 
+// ----------------------------------------------------------------------
+// Board definitions from board_table.h, const so they stay in flash
+// ----------------------------------------------------------------------
+#define X(num, nm, msm, sm, en, st, dr, tp, hp, il, ol, p1, p2, ir, spr, fsm, b0, b1, b2, b3, msd) \
+  static const Board_Def board_##num = { num, nm, msm, sm, en, st, dr, tp, hp, il, ol, p1, p2, ir, spr, fsm, { b0, b1, b2, b3 }, msd };
+BOARD_TABLE(X)
+#undef X
+
+// the switch on the board number compiles to a jump table
+static const Board_Def *find_board(int brdnum) {
+  switch (brdnum) {
+#define X(num, ...) \
+  case num: \
+    return &board_##num;
+    BOARD_TABLE(X)
+#undef X
+    default:
+      return nullptr;
+  }
+}
+
+bool CONTROLLER_DATA::LoadBoardTable(int brdnum) {
+  const Board_Def *brd = find_board(brdnum);
+  if (brd == nullptr) {
+    return false;
+  }
+  strlcpy(this->board, brd->name, sizeof(this->board));
+  this->maxstepmode = brd->maxstepmode;
+  this->stepmode = brd->stepmode;
+  this->enablepin = brd->enpin;
+  this->steppin = brd->steppin;
+  this->dirpin = brd->dirpin;
+  this->temppin = brd->temppin;
+  this->hpswpin = brd->hpswpin;
+  this->inledpin = brd->inledpin;
+  this->outledpin = brd->outledpin;
+  this->pb1pin = brd->pb1pin;
+  this->pb2pin = brd->pb2pin;
+  this->irpin = brd->irpin;
+  this->boardnumber = brd->brdnum;
+  SetBoardOverrides(brd->stepsrev, brd->fixedsmode);
+  for (int i = 0; i < 4; i++) {
+    this->boardpins[i] = brd->brdpins[i];
+  }
+  this->msdelay = brd->msdelay;
+  return true;
+}
+
+// ----------------------------------------------------------------------
+// Steps per revolution and fixed step mode of the board definition, or
+// the values from controller_config.h for boards where they are set there
+// ----------------------------------------------------------------------
+void CONTROLLER_DATA::SetBoardOverrides(int stepsrev, int fixedsmode) {
+  // brdstepsperrev comes from STEPSPERREVOLUTION and will be different so must override the default setting in the board files
+  switch (myboardnumber) {
+    case PRO2ESP32ULN2003:
+    case PRO2ESP32L298N:
+    case PRO2ESP32L293DMINI:
+    case PRO2ESP32L9110S:
+      this->stepsperrev = mystepsperrev;
+      break;
+    default:
+      this->stepsperrev = stepsrev;
+      break;
+  }
+  // myfixedstepmode comes from FIXEDSTEPMODE and will be different so must override the default setting in the board files
+  switch (myboardnumber) {
+    case PRO2ESP32R3WEMOS:
+    case PRO2ESP32ST6128:
+      this->fixedstepmode = myfixedstepmode;
+      break;
+    default:
+      this->fixedstepmode = fixedsmode;
+      break;
+  }
+}
+
 // legacy orphaned code
 // kept here in case I change my mind about something
 bool CONTROLLER_DATA::CreateBoardConfigfromjson(String jsonstr) {
@@ -1606,7 +1284,7 @@ bool CONTROLLER_DATA::CreateBoardConfigfromjson(String jsonstr) {
   CNTLRDATA_print("CD-CreateBoardConfigfromjson() ");
   CNTLRDATA_println(jsonstr);
   // Allocate a temporary Json Document
-  DynamicJsonDocument doc_brd(BOARDDATASIZE);
+  StaticJsonDocument<BOARDDATASIZE> doc_brd;
 
   // Deserialize the JSON document
   DeserializationError jerror = deserializeJson(doc_brd, jsonstr);
@@ -1620,7 +1298,7 @@ bool CONTROLLER_DATA::CreateBoardConfigfromjson(String jsonstr) {
       "dirpin":32,"temppin":13,"hpswpin":4,"inledpin":18,"outledpin":19,"pb1pin":34,"pb2pin":35,"irpin":15,
       "brdnum":60,"stepsrev":-1,"fixedsmode":-1,"brdpins":[27,26,25,-1],"msdelay":4000 }
     */
-    this->board = doc_brd["board"].as<const char *>();
+    strlcpy(this->board, doc_brd["board"] | "", sizeof(this->board));
     this->maxstepmode = doc_brd["maxstepmode"];
     this->stepmode = doc_brd["stepmode"];
     this->enablepin = doc_brd["enpin"];
@@ -1634,30 +1312,7 @@ bool CONTROLLER_DATA::CreateBoardConfigfromjson(String jsonstr) {
     this->pb2pin = doc_brd["pb2pin"];
     this->irpin = doc_brd["irpin"];
     this->boardnumber = doc_brd["brdnum"];
-    // brdstepsperrev comes from STEPSPERREVOLUTION and will be different so must override the default setting in the board files
-    switch (myboardnumber) {
-      case PRO2ESP32ULN2003:
-      case PRO2ESP32L298N:
-      case PRO2ESP32L293DMINI:
-      case PRO2ESP32L9110S:
-        this->stepsperrev = mystepsperrev;
-        // override STEPSPERREVOLUTION from controller_config.h FIXEDSTEPMODE
-        break;
-      default:
-        this->stepsperrev = doc_brd["stepsrev"];
-        break;
-    }
-    // myfixedstepmode comes from FIXEDSTEPMODE and will be different so must override the default setting in the board files
-    switch (myboardnumber) {
-      case PRO2ESP32R3WEMOS:
-      case PRO2ESP32ST6128:
-        this->fixedstepmode = myfixedstepmode;
-        // override fixedstepmode from controller_config.h FIXEDSTEPMODE
-        break;
-      default:
-        this->fixedstepmode = doc_brd["fixedsmode"];
-        break;
-    }
+    SetBoardOverrides(doc_brd["stepsrev"], doc_brd["fixedsmode"]);
     for (int i = 0; i < 4; i++) {
       this->boardpins[i] = doc_brd["brdpins"][i];
     }
@@ -1668,7 +1323,7 @@ bool CONTROLLER_DATA::CreateBoardConfigfromjson(String jsonstr) {
 }
 
 // get
-String CONTROLLER_DATA::get_brdname() {
+const char *CONTROLLER_DATA::get_brdname() {
   return this->board;
 }
 
@@ -1741,8 +1396,8 @@ unsigned long CONTROLLER_DATA::get_brdmsdelay() {
 }
 
 // set
-void CONTROLLER_DATA::set_brdname(String newstr) {
-  this->StartBoardDelayedUpdate(this->board, newstr);
+void CONTROLLER_DATA::set_brdname(const char *newstr) {
+  this->StartBoardDelayedUpdate(this->board, sizeof(this->board), newstr);
 }
 
 void CONTROLLER_DATA::set_brdmaxstepmode(int newval) {
@@ -1834,14 +1489,24 @@ void CONTROLLER_DATA::StartBoardDelayedUpdate(byte &org_data, byte new_data) {
   }
 }
 
-void CONTROLLER_DATA::StartBoardDelayedUpdate(String &org_data, String new_data) {
-  if (org_data != new_data) {
-    org_data = new_data;
+void CONTROLLER_DATA::StartBoardDelayedUpdate(char *org_data, size_t size, const char *new_data) {
+  if (strncmp(org_data, new_data, size - 1) != 0) {
+    strlcpy(org_data, new_data, size);
     this->set_board_flags();
   }
 }
 
 void CONTROLLER_DATA::set_cntlr_flags(void) {
+  this->_dirty_sections = SECTIONS_ALL;
+  portENTER_CRITICAL(&cntlrMux);
+  save_cntlr_flag = 0;
+  portEXIT_CRITICAL(&cntlrMux);
+}
+
+// mark a section as changed, then start the delayed save. Changes made
+// within the save window are written by a single save
+void CONTROLLER_DATA::set_cntlr_flags(Cntlr_Sections section) {
+  this->_dirty_sections |= (1 << section);
   portENTER_CRITICAL(&cntlrMux);
   save_cntlr_flag = 0;
   portEXIT_CRITICAL(&cntlrMux);
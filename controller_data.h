@@ -5,10 +5,20 @@
 // controller_data.h
 // ----------------------------------------------------------------------
 #include <Arduino.h>
+#include <ArduinoJson.h>
+#include "FS.h"
 #include "controller_defines.h"
 #include "boarddefs.h"
 #include "controller_config.h"
+#include "controller_schema.h"
 
+// sizes of the fixed text buffers held in ControllerData, including terminator
+#define DEVICENAMELEN 32
+#define PAGEOPTIONLEN 9  // 8 display pages
+#define DUCKDNSLEN 64
+#define OTALEN 32
+#define COLORLEN 8       // rrggbb
+#define BRDNAMELEN 32
 
 // ----------------------------------------------------------------------
 // Not supported by myFP2ESP32
@@ -38,202 +48,54 @@ public:
 
   void set_var_flags(void);
   void set_cntlr_flags(void);
+  void set_cntlr_flags(Cntlr_Sections);
   void set_board_flags(void);
 
   void SetFocuserDefaults(void);
 
   bool CreateBoardConfigfromjson(String);  // create a board config from a json string - used by Management Server
 
+  // current settings as cntlr_config.jsn and board_config.jsn would hold
+  // them, made from memory, valid until the next call
+  const String &get_cntlr_json(void);
+  const String &get_board_json(void);
+
   long get_fposition(void);
-  long get_maxstep(void);
   long get_focuserpreset(byte);
   byte get_focuserdirection(void);
   void set_fposition(long);
-  void set_maxstep(long);
   void set_focuserpreset(byte, long);
   void set_focuserdirection(byte);
 
-  // SERVERS AND SERVICES
-  byte get_ascomsrvr_enable(void);
-  byte get_debugsrvr_enable(void);
-  byte get_duckdns_enable(void);
-  byte get_mngsrvr_enable(void);
-  byte get_tcpipsrvr_enable(void);
-  byte get_websrvr_enable(void);
-
-  void set_ascomsrvr_enable(byte);
-  void set_debugsrvr_enable(byte);
-  void set_duckdns_enable(byte);
-  void set_mngsrvr_enable(byte);
-  void set_tcpipsrvr_enable(byte);
-  void set_websrvr_enable(byte);
-
-  // Debug Server Output to Serial | Port
-  byte get_debugsrvr_out(void);
-  void set_debugsrvr_out(byte);
-
-  // Server ports
-  unsigned long get_ascomsrvr_port(void);
-  unsigned long get_debugsrvr_port();
-  unsigned long get_mngsrvr_port(void);
-  unsigned long get_tcpipsrvr_port(void);
-  unsigned long get_websrvr_port(void);
-
-  void set_ascomsrvr_port(unsigned long);
-  void set_debugsrvr_port(unsigned long);
-  void set_mngsrvr_port(unsigned long);
-  void set_tcpipsrvr_port(unsigned long);
-  void set_websrvr_port(unsigned long);
-
-  // DUCKDNS
-  String get_duckdns_domain(void);
-  String get_duckdns_token(void);
-  unsigned int get_duckdns_refreshtime(void);
-
-  void set_duckdns_domain(String);
-  void set_duckdns_token(String);
-  void set_duckdns_refreshtime(unsigned int);
-
-  // OTA
-  String get_ota_name(void);
-  String get_ota_password(void);
-  String get_ota_id(void);
-
-  void set_ota_name(String);
-  void set_ota_password(String);
-  void set_ota_id(String);
-
-  // TEMPERATURE PROBE
-  byte get_tempprobe_enable(void);
-  byte get_tempcomp_enable(void);
-  byte get_tempmode(void);  // C or F
-  int get_tempcoefficient(void);
-  byte get_tempresolution(void);
-  byte get_tcdirection(void);
-  byte get_tcavailable(void);
-
-  void set_tempprobe_enable(byte);
-  void set_tempcomp_enable(byte);
-  void set_tempmode(byte);
-  void set_tempcoefficient(int);
-  void set_tempresolution(byte);
-  void set_tcdirection(byte);
-  void set_tcavailable(byte);
-
-  // DISPLAY
-  byte get_display_enable(void);  // enable/disable, start stop, optional
-  int get_display_pagetime(void);
-  String get_display_pageoption(void);
-  byte get_display_updateonmove(void);  // also serves as DelayedDisplayUpdate (myFP2)
-
-  void set_display_enable(byte);
-  void set_display_pagetime(int);
-  void set_display_pageoption(String);
-  void set_display_updateonmove(byte);
-
-  // HPSW
-  byte get_hpswitch_enable(void);  // requires init
-  void set_hpswitch_enable(byte);
-  byte get_hpswmsg_enable(void);
-  void set_hpswmsg_enable(byte);
+  // SETTINGS IN controller_schema.h
+  // type get_accessor(void) and void set_accessor(type) for each setting
+#define X(section, type, member, accessor, key, def, lo, hi, setter) \
+  type get_##accessor(void); \
+  void set_##accessor(type);
+  CNTLR_VALUE_SETTINGS(X)
+#undef X
+#define X(section, member, accessor, key, def, len, setter) \
+  const char *get_##accessor(void); \
+  void set_##accessor(const char *);
+  CNTLR_TEXT_SETTINGS(X)
+#undef X
+
+  // access a setting by its cntlr_config.jsn key
+  bool get_setting(const char *, JsonDocument &);  // add "key":value to the document
+  bool set_setting(const char *, const char *);    // range check then set from text
+  bool check_setting(const char *, JsonVariantConst);  // true if the key is known and the value is in range
+  bool ApplySettings(JsonObjectConst, String &);       // check all, set all, save once. false returns the bad key
 
   // TMC 2225-2209 DRIVER CHIPS
   tmc2209stallguard get_stallguard_state(void);
-  byte get_stallguard_value(void);
-  int get_tmc2225current(void);
-  int get_tmc2209current(void);
-
   void set_stallguard_state(tmc2209stallguard);
-  void set_stallguard_value(byte);
-  void set_tmc2225current(int);
-  void set_tmc2209current(int);
-
-  // LEDS
-  byte get_inoutled_enable(void);  // requires init
-  byte get_inoutled_mode(void);
-  void set_inoutled_enable(byte);
-  void set_inoutled_mode(byte);
-
-  // JOYSTICKS
-  byte get_joystick1_enable(void);
-  byte get_joystick2_enable(void);
-  void set_joystick1_enable(byte);
-  void set_joystick2_enable(byte);
-
-  // PUSHBUTTONS
-  byte get_pushbutton_enable(void);  // requires init and load
-  int get_pushbutton_steps(void);
-  void set_pushbutton_enable(byte);
-  void set_pushbutton_steps(int);
-
-  // BACKLASH
-  byte get_backlash_in_enable(void);
-  byte get_backlash_out_enable(void);
-  byte get_backlashsteps_in(void);
-  byte get_backlashsteps_out(void);
-  void set_backlash_in_enable(byte);
-  void set_backlash_out_enable(byte);
-  void set_backlashsteps_in(byte);
-  void set_backlashsteps_out(byte);
-
-  // COIL POWER
-  byte get_coilpower_enable(void);  // enabled = ON, disabled = OFF
-  void set_coilpower_enable(byte);
-
-  // DELAY AFTER MOVE
-  byte get_delayaftermove_enable(void);
-  byte get_delayaftermove_time(void);
-  void set_delayaftermove_enable(byte);
-  void set_delayaftermove_time(byte);
-
-  // DEVICE NAME
-  String get_devicename(void);
-  void set_devicename(String);
-
-  // FILELIST FORMAT
-  byte get_filelistformat(void);
-  void set_filelistformat(byte);
-
-  // MOTORSPEED
-  byte get_motorspeed(void);
-  void set_motorspeed(byte);
-
-  // PARK
-  byte get_park_enable(void);
-  int get_parktime(void);
-  void set_park_enable(byte);
-  void set_parktime(int);
-
-  // REVERSE
-  byte get_reverse_enable(void);
-  void set_reverse_enable(byte);
-
-  // STEPSIZE
-  byte get_stepsize_enable(void);
-  float get_stepsize(void);
-  void set_stepsize_enable(byte);
-  void set_stepsize(float);
-
-  // WEB PAGE COLORS
-  String get_wp_titlecolor(void);
-  String get_wp_subtitlecolor(void);
-  String get_wp_headercolor(void);
-  String get_wp_textcolor(void);
-  String get_wp_backcolor(void);
-
-  void set_wp_titlecolor(String);
-  void set_wp_subtitlecolor(String);
-  void set_wp_headercolor(String);
-  void set_wp_textcolor(String);
-  void set_wp_backcolor(String);
-
 
   // display is a special case, it can be enabled, but the write to the display can be true or false
   // so it has both an enable state and a status. We only need to have enable here, status is a runtime
   // flag
 
   // BOARD CONFIGURATIONS
-  String get_brdname(void);
+  const char *get_brdname(void);
   int get_brdmaxstepmode(void);
   int get_brdstepmode(void);
   int get_brdenablepin(void);
@@ -255,7 +117,7 @@ public:
   int get_stepsperrev(void);
 
   // set boardconfig
-  void set_brdname(String);
+  void set_brdname(const char *);
   void set_brdmaxstepmode(int);
   void set_brdstepmode(int);
   void set_brdenablepin(int);
@@ -281,21 +143,34 @@ private:
   void LoadDefaultVariableData(void);
   void LoadBoardConfiguration(void);
   void SetDefaultBoardData(void);
-
-  void StartDelayedUpdate(unsigned long &, unsigned long);
-  void StartDelayedUpdate(long &, long);
-  void StartDelayedUpdate(float &, float);
-  void StartDelayedUpdate(byte &, byte);
-  void StartDelayedUpdate(int &, int);
-  void StartDelayedUpdate(tmc2209stallguard &, tmc2209stallguard);
-  void StartDelayedUpdate(unsigned int &, unsigned int);
-  void StartDelayedUpdate(String &, String);
+  bool LoadBoardTable(int);           // set the board from board_table.h, false if not in the table
+  void SetBoardOverrides(int, int);   // stepsrev and fixedsmode, unless set by controller_config.h
+
+  void StartDelayedUpdate(Cntlr_Sections, unsigned long &, unsigned long);
+  void StartDelayedUpdate(Cntlr_Sections, long &, long);
+  void StartDelayedUpdate(Cntlr_Sections, float &, float);
+  void StartDelayedUpdate(Cntlr_Sections, byte &, byte);
+  void StartDelayedUpdate(Cntlr_Sections, int &, int);
+  void StartDelayedUpdate(Cntlr_Sections, tmc2209stallguard &, tmc2209stallguard);
+  void StartDelayedUpdate(Cntlr_Sections, unsigned int &, unsigned int);
+  void StartDelayedUpdate(Cntlr_Sections, char *, size_t, const char *);
 
   void StartBoardDelayedUpdate(unsigned long &, unsigned long);
   void StartBoardDelayedUpdate(float &, float);
   void StartBoardDelayedUpdate(byte &, byte);
   void StartBoardDelayedUpdate(int &, int);
-  void StartBoardDelayedUpdate(String &, String);
+  void StartBoardDelayedUpdate(char *, size_t, const char *);
+
+  void pad_pageoption(char *);
+
+  void SerializeSection(Cntlr_Sections, String &);
+  void UpdateSections(void);           // serialize the sections changed since the last update
+  void BoardDocument(JsonDocument &);  // board data as saved in board_config.jsn
+  bool SaveJsonFile(const String &, JsonDocument &);  // write file.tmp, verify, then swap with file
+  File OpenTmpFile(const String &);
+  bool CommitTmpFile(const String &, size_t);
+  bool LoadJsonFile(const String &, JsonDocument &);  // load file, fallback to last good copy file.bak
+  void RemoveConfigFile(const String &);
 
   void ListDir(const char *, uint8_t);
 
@@ -303,89 +178,30 @@ private:
   const String file_cntlr_var = "/cntlr_var.jsn";        // variable JSON setup data, position and direction
   const String file_board_config = "/board_config.jsn";  // board JSON configuration
 
+  // section level saves of cntlr_config.jsn
+  byte _dirty_sections;                 // bit per Cntlr_Sections, set when a member of the section changes
+  bool _cntlr_unsaved;                  // a cached section has changed since the last write
+  String _section_json[Section_Count];  // last serialized JSON fragment of each section
+  String _cntlr_json;                   // get_cntlr_json(), the sections joined
+  bool _cntlr_jsonvalid;                // false when a section has changed
+  String _board_json;                   // get_board_json() buffer
+
   long fposition;          // last focuser position
-  long maxstep;            // max steps
   long focuserpreset[10];  // focuser presets can be used with software or ir-remote controller
   byte focuserdirection;   // keeps track of last focuser move direction
 
-  // Loaded at boot time, if enabled is 1 then an attempt will be made to "start" and "run"
-
-  byte ascomsrvr_enable;
-  byte debugsrvr_enable;
-  byte display_enable;
-  byte duckdns_enable;
-  byte mngsrvr_enable;
-  byte tcpipsrvr_enable;
-  byte tempprobe_enable;
-  byte websrvr_enable;
-
-  unsigned long ascomsrvr_port;
-  unsigned long debugsrvr_port;
-  unsigned long mngsrvr_port;
-  unsigned long tcpipsrvr_port;
-  unsigned long websrvr_port;
-
-  // debug server
-  byte debugsrvr_out;
-
-  byte backlash_in_enable;   // if 1, backlash is enabled for IN movements (lower or -ve moves)
-  byte backlash_out_enable;  // if 1, backlash is enabled for OUT movements (higher or +ve moves)
-  byte coilpower_enable;     // if 1, coil power is enabled. If 0 then coil power is off
-  byte delayaftermove_enable;
-  byte hpswmsg_enable;  // if 1, home position switch msg's show on display if enabled
-  byte hpswitch_enable;
-  byte inoutled_enable;  // if 1, in out leds are enabled [only if board supports them]
-  byte park_enable;
-  byte pushbutton_enable;
-  byte joystick1_enable;
-  byte joystick2_enable;
-  byte reverse_enable;  // if 1, motor direction is reversed
-
-  byte stallguard_value;  // value for STALL_GUARD, tmc2209, in boardefs.h
   tmc2209stallguard stallguard_state;
 
-  byte stepsize_enable;  // if 1, controller returns step size
-  byte tempcomp_enable;  // indicates if temperature compensation is enabled
-
-  // Settings values
-  String duckdns_domain;
-  String duckdns_token;
-  String ota_name;
-  String ota_password;
-  String ota_id;
-
-  byte backlashsteps_in;     // number of backlash steps to apply for IN moves
-  byte backlashsteps_out;    // number of backlash steps to apply for OUT moves
-  byte delayaftermove_time;  // number of milliseconds to wait after a move
-  String devicename;
-  int display_pagetime;              // length of time in seconds that a display page is shown for, 2-10
-  String display_pageoption;         // which display pages to show/hide
-  byte display_updateonmove;         // update position on display when moving
-  unsigned int duckdns_refreshtime;  // default 60s
-
-  byte inoutled_mode;  // 0=blink every stepper pulse, 1=stay on whilst motor moving
-  byte motorspeed;     // speed of motor, slow, medium or fast
-  int park_time;       // time in seconds that elapses after the end of a move, used to put the display to sleep
-  int pushbutton_steps;
-  float stepsize;       // the step size in microns, ie 7.2 - value * 10, so real stepsize = stepsize / 10 (maxval = 25.6)
-  byte tempmode;        // temperature display mode, Celcius=1, Fahrenheit=0
-  int tempcoefficient;  // steps per degree temperature coefficient value
-  byte tempresolution;  // 9 - 12
-  byte tcdirection;     // direction in which to apply temperature compensation
-  byte tcavailable;     // temperature compensation available
-
-  int tmc2209current;
-  int tmc2225current;
-  byte filelistformat;
-
-  String titlecolor;
-  String subtitlecolor;
-  String headercolor;
-  String textcolor;
-  String backcolor;
+  // settings in controller_schema.h
+#define X(section, type, member, accessor, key, def, lo, hi, setter) type member;
+  CNTLR_VALUE_SETTINGS(X)
+#undef X
+#define X(section, member, accessor, key, def, len, setter) char member[len];
+  CNTLR_TEXT_SETTINGS(X)
+#undef X
 
   // dataset board configuration
-  String board;
+  char board[BRDNAMELEN];
   int maxstepmode;
   int stepmode;
   int enablepin;
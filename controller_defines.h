@@ -80,6 +80,14 @@ enum tmc2209stallguard { Use_Stallguard,
                          Use_Physical_Switch,
                          Use_None };
 
+// sections of cntlr_config.jsn, only changed sections are serialized on save
+enum Cntlr_Sections { Section_Network,
+                      Section_Display,
+                      Section_Motion,
+                      Section_Temperature,
+                      Section_WebColors,
+                      Section_Count };
+
 // controller modes
 #define ACCESSPOINT 1
 #define STATION 2
@@ -143,6 +151,7 @@ enum tmc2209stallguard { Use_Stallguard,
 #define ASCOMDISCOVERYPORT 32227  // UDP
 #define DEBUGSERVERPORT 9090
 #define MNGSERVERPORT 6060    // Management interface - should not be changed
+#define OTASERVERPORTOFFSET 1  // ElegantOTA runs on the management port + 1
 #define TCPIPSERVERPORT 2020  // TCPIP Server port for myFP2ESP32
 #define WEBSERVERPORT 80      // Web server port
 
@@ -199,6 +208,7 @@ enum tmc2209stallguard { Use_Stallguard,
 // defines for ASCOMSERVER, WEBSERVER
 #define NORMALWEBPAGE 200
 //#define FILEUPLOADSUCCESS 300
+#define NOTMODIFIEDWEBPAGE 304
 #define BADREQUESTWEBPAGE 400
 #define NOTFOUNDWEBPAGE 404
 #define INTERNALSERVERERROR 500
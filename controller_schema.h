@@ -0,0 +1,120 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 CONTROLLER CONFIGURATION SCHEMA
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// Copyright Holger M, 2019-2021. All Rights Reserved.
+// controller_schema.h
+// ----------------------------------------------------------------------
+
+#ifndef _controller_schema_h
+#define _controller_schema_h
+
+#include <Arduino.h>
+
+
+// ----------------------------------------------------------------------
+// SCHEMA OF cntlr_config.jsn
+// Each setting is described once. ControllerData expands these tables to
+// generate the members, the get_ and set_ accessors, the default values,
+// the JSON load and save code, and the lookup of a setting by its key.
+//
+// Settings with a value
+// X(section, type, member, accessor, "key", default, min, max, setter)
+// Settings with text
+// X(section, member, accessor, "key", default, length, setter)
+//
+// setter AUTO generates set_accessor(), CUSTOM means it is written in
+// controller_data.cpp because it does more than store the value.
+// min and max are applied by set_accessor(), so the tcp/ip, ASCOM and web
+// servers, loading from file and setting by key all use the same range.
+//
+// Not in the schema: focuser presets (array), stall guard state (enum),
+// position and direction (cntlr_var.jsn) and the board configuration
+// ----------------------------------------------------------------------
+
+#define CNTLR_VALUE_SETTINGS(X) \
+  /* SERVERS - SERVICES */ \
+  X(Section_Network, byte, ascomsrvr_enable, ascomsrvr_enable, "ascom_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Network, unsigned long, ascomsrvr_port, ascomsrvr_port, "ascom_port", ASCOMSERVERPORT, 1, 65535, AUTO) \
+  X(Section_Network, byte, debugsrvr_enable, debugsrvr_enable, "dbg_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Network, unsigned long, debugsrvr_port, debugsrvr_port, "dbg_port", DEBUGSERVERPORT, 1, 65535, AUTO) \
+  X(Section_Network, byte, debugsrvr_out, debugsrvr_out, "dbg_out", DEBUGSERVEROUTPUTPORT, 0, 1, AUTO) \
+  X(Section_Network, byte, duckdns_enable, duckdns_enable, "ddns_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Network, unsigned int, duckdns_refreshtime, duckdns_refreshtime, "ddns_r", DUCKDNS_REFRESHRATE, 60, 3600, AUTO) \
+  X(Section_Network, byte, mngsrvr_enable, mngsrvr_enable, "mngt_en", V_ENABLED, 0, 1, AUTO) \
+  X(Section_Network, unsigned long, mngsrvr_port, mngsrvr_port, "mngt_port", MNGSERVERPORT, 1, 65535, AUTO) \
+  X(Section_Network, byte, tcpipsrvr_enable, tcpipsrvr_enable, "tcp_en", V_ENABLED, 0, 1, AUTO) \
+  X(Section_Network, unsigned long, tcpipsrvr_port, tcpipsrvr_port, "tcp_port", TCPIPSERVERPORT, 1, 65535, AUTO) \
+  X(Section_Network, byte, websrvr_enable, websrvr_enable, "ws_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Network, unsigned long, websrvr_port, websrvr_port, "ws_port", WEBSERVERPORT, 1, 65535, AUTO) \
+  /* DISPLAY, page time in seconds, update position when moving */ \
+  X(Section_Display, byte, display_enable, display_enable, "d_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Display, int, display_pagetime, display_pagetime, "d_pgtime", V_DISPLAYPAGETIMEMIN, V_DISPLAYPAGETIMEMIN, V_DISPLAYPAGETIMEMAX, CUSTOM) \
+  X(Section_Display, byte, display_updateonmove, display_updateonmove, "d_updmove", V_ENABLED, 0, 1, AUTO) \
+  /* MOTION */ \
+  X(Section_Motion, long, maxstep, maxstep, "maxstep", DEFAULTMAXSTEPS, FOCUSERLOWERLIMIT, FOCUSERUPPERLIMIT, AUTO) \
+  X(Section_Motion, byte, hpswitch_enable, hpswitch_enable, "hpsw_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, byte, hpswmsg_enable, hpswmsg_enable, "hpswmsg_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, byte, stallguard_value, stallguard_value, "stall_val", STALL_VALUE, 0, 255, AUTO) \
+  X(Section_Motion, int, tmc2209current, tmc2209current, "tmc2209mA", TMC2209CURRENT, 0, 2000, AUTO) \
+  X(Section_Motion, int, tmc2225current, tmc2225current, "tmc2225mA", TMC2225CURRENT, 0, 2000, AUTO) \
+  /* in out leds, mode 0=blink every stepper pulse, 1=stay on whilst motor moving */ \
+  X(Section_Motion, byte, inoutled_enable, inoutled_enable, "led_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, byte, inoutled_mode, inoutled_mode, "led_mode", LEDPULSE, LEDPULSE, LEDMOVE, AUTO) \
+  X(Section_Motion, byte, joystick1_enable, joystick1_enable, "joy1_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, byte, joystick2_enable, joystick2_enable, "joy2_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, byte, pushbutton_enable, pushbutton_enable, "pb_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, int, pushbutton_steps, pushbutton_steps, "pb_steps", PUSHBUTTON_STEPS, 1, FOCUSERUPPERLIMIT, AUTO) \
+  /* backlash, IN is lower or -ve moves, OUT is higher or +ve moves */ \
+  X(Section_Motion, byte, backlash_in_enable, backlash_in_enable, "blin_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, byte, backlashsteps_in, backlashsteps_in, "blin_steps", DEFAULT_FALSE, 0, 255, AUTO) \
+  X(Section_Motion, byte, backlash_out_enable, backlash_out_enable, "blout_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, byte, backlashsteps_out, backlashsteps_out, "blout_steps", DEFAULT_FALSE, 0, 255, AUTO) \
+  X(Section_Motion, byte, coilpower_enable, coilpower_enable, "cp_en", V_NOTENABLED, 0, 1, AUTO) \
+  /* delay after move in milliseconds */ \
+  X(Section_Motion, byte, delayaftermove_enable, delayaftermove_enable, "dam_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, byte, delayaftermove_time, delayaftermove_time, "dam_time", 25, 0, 250, AUTO) \
+  X(Section_Motion, byte, motorspeed, motorspeed, "mspeed", FAST, SLOW, FAST, AUTO) \
+  /* park time in seconds after the end of a move, used to put the display to sleep */ \
+  X(Section_Motion, byte, park_enable, park_enable, "park_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, int, park_time, parktime, "park_time", DEFAULTPARKTIME, 30, 300, AUTO) \
+  X(Section_Motion, byte, reverse_enable, reverse_enable, "rdir_en", V_NOTENABLED, 0, 1, AUTO) \
+  /* step size in microns, reported to ASCOM when enabled */ \
+  X(Section_Motion, byte, stepsize_enable, stepsize_enable, "ss_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Motion, float, stepsize, stepsize, "ss_val", DEFAULTSTEPSIZE, MINIMUMSTEPSIZE, MAXIMUMSTEPSIZE, AUTO) \
+  /* TEMPERATURE, mode Celsius=1 Fahrenheit=0, coefficient in steps per degree */ \
+  X(Section_Temperature, byte, tempprobe_enable, tempprobe_enable, "t_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Temperature, int, tempcoefficient, tempcoefficient, "t_coe", DEFAULT_FALSE, 0, 256, AUTO) \
+  X(Section_Temperature, byte, tempcomp_enable, tempcomp_enable, "t_comp_en", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Temperature, byte, tempmode, tempmode, "t_mod", V_CELSIUS, V_FAHRENHEIT, V_CELSIUS, AUTO) \
+  X(Section_Temperature, byte, tempresolution, tempresolution, "t_res", DEFAULTTEMPRESOLUTION, 9, 12, AUTO) \
+  X(Section_Temperature, byte, tcavailable, tcavailable, "t_tcavail", V_NOTENABLED, 0, 1, AUTO) \
+  X(Section_Temperature, byte, tcdirection, tcdirection, "t_tcdir", TC_DIRECTION_IN, TC_DIRECTION_IN, TC_DIRECTION_OUT, AUTO) \
+  /* WEB PAGES */ \
+  X(Section_WebColors, byte, filelistformat, filelistformat, "filelist", LISTLONG, LISTSHORT, LISTLONG, AUTO)
+
+#define CNTLR_TEXT_SETTINGS(X) \
+  X(Section_Network, devicename, devicename, "devname", project_name, DEVICENAMELEN, AUTO) \
+  X(Section_Network, duckdns_domain, duckdns_domain, "ddns_d", duckdnsdomain, DUCKDNSLEN, AUTO) \
+  X(Section_Network, duckdns_token, duckdns_token, "ddns_t", duckdnstoken, DUCKDNSLEN, AUTO) \
+  X(Section_Network, ota_id, ota_id, "ota_id", OTAID, OTALEN, AUTO) \
+  X(Section_Network, ota_name, ota_name, "ota_name", OTAName, OTALEN, AUTO) \
+  X(Section_Network, ota_password, ota_password, "ota_pwd", OTAPassword, OTALEN, AUTO) \
+  /* which display pages to show, always 8 pages */ \
+  X(Section_Display, display_pageoption, display_pageoption, "d_pgopt", "11111111", PAGEOPTIONLEN, CUSTOM) \
+  X(Section_WebColors, titlecolor, wp_titlecolor, "ticol", DEFAULTTITLECOLOR, COLORLEN, AUTO) \
+  X(Section_WebColors, subtitlecolor, wp_subtitlecolor, "scol", DEFAULTSUBTITLECOLOR, COLORLEN, AUTO) \
+  X(Section_WebColors, headercolor, wp_headercolor, "hcol", DEFAULTHEADERCOLOR, COLORLEN, AUTO) \
+  X(Section_WebColors, textcolor, wp_textcolor, "tcol", DEFAULTTEXTCOLLOR, COLORLEN, AUTO) \
+  X(Section_WebColors, backcolor, wp_backcolor, "bcol", DEFAULTBACKCOLOR, COLORLEN, AUTO)
+
+
+// ----------------------------------------------------------------------
+// KEY HASH
+// FNV-1a hash of a setting key. Evaluated at compile time for the case
+// labels of the key lookup, so two keys with the same hash fail to compile
+// ----------------------------------------------------------------------
+constexpr uint32_t cntlr_keyhash(const char *key, uint32_t hash = 2166136261UL) {
+  return (*key == 0) ? hash : cntlr_keyhash(key + 1, (hash ^ (uint8_t)*key) * 16777619UL);
+}
+
+#endif  // _controller_schema_h
@@ -36,6 +36,9 @@ extern DRIVER_BOARD *driverboard;
 #include "temp_probe.h"
 extern TEMP_PROBE *tempprobe;
 
+#include "focuser_state.h"
+extern FOCUSER_STATE *focuserstate;
+
 #include "tcpip_server.h"
 extern TCPIP_SERVER *tcpipsrvr;
 
@@ -57,8 +60,6 @@ extern TCPIP_SERVER *tcpipsrvr;
 // EXTERNS
 // ----------------------------------------------------------------------
 extern char mySSID[];
-extern long ftargetPosition;
-extern float temp;
 extern bool filesystemloaded;
 extern char ipStr[16];  // correction Eric Harant
 extern const char *program_version;
@@ -246,6 +247,7 @@ void GRAPHIC_DISPLAY::draw_main_update() {
   char buffer[80];
 
   if (this->_state) {
+    Focuser_Status fs = focuserstate->get();
     _display->clear();
     _display->setTextAlignment(TEXT_ALIGN_CENTER);
     _display->setFont(ArialMT_Plain_24);
@@ -271,19 +273,19 @@ void GRAPHIC_DISPLAY::draw_main_update() {
     } else {
       // tcpip client is connected
       char dir = (ControllerData->get_focuserdirection() == moving_in) ? '<' : '>';
-      snprintf(buffer, sizeof(buffer), "%ld:%i %c", driverboard->getposition(), (int)(driverboard->getposition() % ControllerData->get_brdstepmode()), dir);
+      snprintf(buffer, sizeof(buffer), "%ld:%i %c", fs.position, (int)(fs.position % ControllerData->get_brdstepmode()), dir);
       _display->drawString(64, 28, buffer);
       _display->setFont(ArialMT_Plain_10);
       snprintf(buffer, sizeof(buffer), "µSteps: %i MaxPos: %ld", ControllerData->get_brdstepmode(), ControllerData->get_maxstep());
       _display->drawString(64, 0, buffer);
-      snprintf(buffer, sizeof(buffer), "TargetPos:  %ld", ftargetPosition);
+      snprintf(buffer, sizeof(buffer), "TargetPos:  %ld", fs.target);
       _display->drawString(64, 12, buffer);
     }
 
     _display->setTextAlignment(TEXT_ALIGN_LEFT);
 
     if (tempprobe->get_state() == true) {
-      snprintf(buffer, sizeof(buffer), "TEMP: %.2f C", temp);
+      snprintf(buffer, sizeof(buffer), "TEMP: %.2f C", fs.temp);
       _display->drawString(54, 54, buffer);
     } else {
       snprintf(buffer, sizeof(buffer), "TEMP: %.2f C", 20.0);
@@ -292,7 +294,7 @@ void GRAPHIC_DISPLAY::draw_main_update() {
     if (tcpipsrvr->get_clients() == true) {
        
        // MN tesing
-       snprintf(buffer, sizeof(buffer), "TEMP: %.2f C", temp); 
+       snprintf(buffer, sizeof(buffer), "TEMP: %.2f C", fs.temp); 
        _display->drawString(54, 54, buffer);
        
       if (BLo_onDisplay == true){
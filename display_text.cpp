@@ -26,6 +26,9 @@ extern DRIVER_BOARD* driverboard;
 #include "temp_probe.h"
 extern TEMP_PROBE* tempprobe;
 
+#include "focuser_state.h"
+extern FOCUSER_STATE* focuserstate;
+
 
 // ----------------------------------------------------------------------
 // INCLUDES
@@ -41,9 +44,6 @@ extern TEMP_PROBE* tempprobe;
 extern char mySSID[];
 // controllermode, ACCESSPOINTMODE=1, STATIONMODE=2
 extern int myfp2esp32mode;
-extern bool isMoving;
-extern long ftargetPosition;
-extern float temp;
 extern char ipStr[16];  // correction Eric Harant
 extern byte ota_status;
 extern byte ascomsrvr_status;
@@ -255,7 +255,7 @@ void TEXT_DISPLAY::update_position(long position) {
     _display->println();
 
     _display->print(DT_TARGETPOSITION);
-    _display->print(ftargetPosition);
+    _display->print(focuserstate->get_target());
     _display->clearToEOL();
     _display->println();
   }
@@ -273,8 +273,8 @@ void TEXT_DISPLAY::draw_main_update() {
     // clrscr OLED
     _display->clear();
     int page = 0;
-    String mypage = ControllerData->get_display_pageoption();
-    for (int i = 0; i < mypage.length(); i++) {
+    const char *mypage = ControllerData->get_display_pageoption();
+    for (int i = 0; mypage[i] != 0; i++) {
       page *= 2;
       if (mypage[i] == '1') {
         page++;
@@ -351,23 +351,24 @@ void TEXT_DISPLAY::printpagenumber(byte pagenum) {
 void TEXT_DISPLAY::page1() {
   if (this->_state) {
     char tempString[20];
+    Focuser_Status fs = focuserstate->get();
 
     // Position
     _display->home();
     _display->print(DT_POSITION);
-    _display->print(driverboard->getposition());
+    _display->print(fs.position);
     _display->clearToEOL();
 
     // Target
     _display->println();
     _display->print(DT_TARGETPOSITION);
-    _display->print(ftargetPosition);
+    _display->print(fs.target);
     _display->clearToEOL();
     _display->println();
 
     // ismoving
     _display->print(DT_ISMOVING);
-    if (isMoving == true) {
+    if (fs.ismoving == true) {
       _display->print(T_YES);
     } else {
       _display->print(T_NO);
@@ -377,7 +378,7 @@ void TEXT_DISPLAY::page1() {
 
     // Temperature
     _display->print(DT_TEMPERATURE);
-    _display->print(String(temp, 2));
+    _display->print(String(fs.temp, 2));
     if (ControllerData->get_tempmode() == V_CELSIUS) {
       _display->print(" c");
     } else {
@@ -63,16 +63,8 @@ bool DUCK_DNS::start(void) {
     // Set DDNS Service Nameto "duckdns"
     EasyDDNS.service("duckdns");
 
-    String domain = ControllerData->get_duckdns_domain();
-    int domainlen = domain.length() + 1;
-    String token = ControllerData->get_duckdns_token();
-    int tokenlen = token.length() + 1;
-    char ddd[domainlen];
-    char ddt[tokenlen];
-    domain.toCharArray(ddd, domainlen);
-    token.toCharArray(ddt, tokenlen);
     // Enter ddns Domain & Token | Example - "esp.duckdns.org","1234567"
-    EasyDDNS.client(ddd, ddt);
+    EasyDDNS.client(ControllerData->get_duckdns_domain(), ControllerData->get_duckdns_token());
     EasyDDNS.update(ControllerData->get_duckdns_refreshtime());
 
     this->_loaded = true;
@@ -0,0 +1,243 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 WEB PAGE FILE CACHE
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// file_cache.cpp
+// ----------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------
+// INCLUDES
+// ----------------------------------------------------------------------
+#include <Arduino.h>
+#include "controller_config.h"
+#include "SPIFFS.h"
+
+#include "file_cache.h"
+
+
+// ----------------------------------------------------------------------
+// crc32
+// ----------------------------------------------------------------------
+static uint32_t cache_crc(uint32_t crc, const uint8_t *buf, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= buf[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return crc;
+}
+
+
+// ----------------------------------------------------------------------
+// CLASS
+// ----------------------------------------------------------------------
+FILE_CACHE::FILE_CACHE(void) {
+  _budget = psramFound() ? FILECACHEPSRAM : FILECACHESIZE;
+  for (int i = 0; i < FILECACHEENTRIES; i++) {
+    _entries[i].data = NULL;
+    _entries[i].inuse = false;
+    _entries[i].users = 0;
+    _entries[i].stale = false;
+  }
+}
+
+uint32_t FILE_CACHE::generation(void) {
+  return _generation;
+}
+
+// ----------------------------------------------------------------------
+// Drop all files, called after a file is uploaded or deleted
+// ----------------------------------------------------------------------
+void FILE_CACHE::changed(void) {
+  for (int i = 0; i < FILECACHEENTRIES; i++) {
+    drop(_entries[i]);
+    // a held entry stays in use until its last release()
+    _entries[i].inuse = _entries[i].stale;
+    _entries[i].path = String();
+  }
+  _generation++;
+}
+
+// ----------------------------------------------------------------------
+// Find the file, read it from SPIFFS if the cache does not know it
+// ----------------------------------------------------------------------
+bool FILE_CACHE::find(const String &path, Cache_File &file) {
+  int idx = -1;
+  // settings files are written while running, never keep them
+  if (path.endsWith(".jsn") == false) {
+    idx = lookup(path);
+    if (idx == -1) {
+      idx = new_entry();
+      if (idx != -1) {
+        _entries[idx].path = path;
+        _entries[idx].inuse = true;
+        load(_entries[idx], true);
+      }
+    }
+  }
+  if (idx == -1) {
+    // not kept, or every entry is held by a reply
+    Cache_Entry e;
+    e.path = path;
+    load(e, false);
+    file.data = NULL;
+    file.size = e.size;
+    file.stamp = e.stamp;
+    return e.found;
+  }
+  Cache_Entry &e = _entries[idx];
+  e.lastused = ++_tick;
+
+  file.data = e.data;
+  file.size = e.size;
+  file.stamp = e.stamp;
+  return e.found;
+}
+
+int FILE_CACHE::lookup(const String &path) {
+  for (int i = 0; i < FILECACHEENTRIES; i++) {
+    if (_entries[i].inuse && (_entries[i].stale == false) && _entries[i].path.equals(path)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// ----------------------------------------------------------------------
+// A free entry, else the least recently used one that is not held, -1
+// if all are held
+// ----------------------------------------------------------------------
+int FILE_CACHE::new_entry(void) {
+  int oldest = -1;
+  for (int i = 0; i < FILECACHEENTRIES; i++) {
+    if (_entries[i].inuse == false) {
+      return i;
+    }
+    if ((_entries[i].users == 0) && ((oldest == -1) || (_entries[i].lastused < _entries[oldest].lastused))) {
+      oldest = i;
+    }
+  }
+  if (oldest == -1) {
+    return -1;
+  }
+  drop(_entries[oldest]);
+  _entries[oldest].inuse = false;
+  return oldest;
+}
+
+// ----------------------------------------------------------------------
+// Free the file data of an entry, or mark it stale while it is held
+// ----------------------------------------------------------------------
+void FILE_CACHE::drop(Cache_Entry &e) {
+  if (e.users > 0) {
+    e.stale = true;
+    return;
+  }
+  if (e.data != NULL) {
+    free(e.data);
+    e.data = NULL;
+    _used -= e.size;
+  }
+}
+
+// ----------------------------------------------------------------------
+// A reply sends the data of a file, it is not freed until release()
+// ----------------------------------------------------------------------
+void FILE_CACHE::hold(const uint8_t *data) {
+  if (data == NULL) {
+    return;
+  }
+  for (int i = 0; i < FILECACHEENTRIES; i++) {
+    if (_entries[i].inuse && (_entries[i].data == data)) {
+      _entries[i].users++;
+      return;
+    }
+  }
+}
+
+void FILE_CACHE::release(const uint8_t *data) {
+  for (int i = 0; i < FILECACHEENTRIES; i++) {
+    Cache_Entry &e = _entries[i];
+    if ((e.users > 0) && (e.data == data)) {
+      e.users--;
+      if ((e.users == 0) && e.stale) {
+        // dropped while it was sent
+        e.stale = false;
+        drop(e);
+        e.inuse = false;
+      }
+      return;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+// Drop least recently used files until size bytes are free
+// ----------------------------------------------------------------------
+bool FILE_CACHE::make_room(size_t size) {
+  while ((_used + size) > _budget) {
+    int oldest = -1;
+    for (int i = 0; i < FILECACHEENTRIES; i++) {
+      if ((_entries[i].data != NULL) && (_entries[i].users == 0)) {
+        if ((oldest == -1) || (_entries[i].lastused < _entries[oldest].lastused)) {
+          oldest = i;
+        }
+      }
+    }
+    if (oldest == -1) {
+      return false;
+    }
+    drop(_entries[oldest]);
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------
+// Read the file into the entry, or only its size and stamp if it is too
+// big or not to be kept
+// ----------------------------------------------------------------------
+void FILE_CACHE::load(Cache_Entry &e, bool keep) {
+  e.data = NULL;
+  e.size = 0;
+  e.stamp = 0;
+  e.found = SPIFFS.exists(e.path);
+  if (e.found == false) {
+    return;
+  }
+  File file = SPIFFS.open(e.path, "r");
+  if (!file) {
+    e.found = false;
+    return;
+  }
+  e.size = file.size();
+  e.stamp = (uint32_t)file.getLastWrite();
+
+  if (keep && (e.size <= (_budget / 4)) && make_room(e.size)) {
+    uint8_t *buf = (uint8_t *)(psramFound() ? ps_malloc(e.size + 1) : malloc(e.size + 1));
+    if (buf != NULL) {
+      if (file.read(buf, e.size) == e.size) {
+        e.data = buf;
+        _used += e.size;
+      } else {
+        free(buf);
+      }
+    }
+  }
+
+  if (e.stamp == 0) {
+    if (e.data != NULL) {
+      e.stamp = ~cache_crc(0xFFFFFFFF, e.data, e.size);
+    } else {
+      uint8_t buf[128];
+      uint32_t crc = 0xFFFFFFFF;
+      int n;
+      file.seek(0);
+      while ((n = file.read(buf, sizeof(buf))) > 0) {
+        crc = cache_crc(crc, buf, n);
+      }
+      e.stamp = ~crc;
+    }
+  }
+  file.close();
+}
@@ -0,0 +1,77 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 WEB PAGE FILE CACHE
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// file_cache.h
+// ----------------------------------------------------------------------
+
+#if !defined(_file_cache_h)
+#define _file_cache_h
+
+#include <Arduino.h>
+#include "controller_config.h"
+
+#define FILECACHEENTRIES 24  // files known to the cache, including files that do not exist
+
+
+// ----------------------------------------------------------------------
+// A file found by FILE_CACHE::find()
+// data is NULL when the file is too big to keep, read it from SPIFFS
+// ----------------------------------------------------------------------
+struct Cache_File {
+  const uint8_t *data;
+  size_t size;
+  uint32_t stamp;  // time of last write, or crc32 when SPIFFS has no time
+};
+
+
+// ----------------------------------------------------------------------
+// A file known to the cache
+// ----------------------------------------------------------------------
+struct Cache_Entry {
+  String path;
+  uint8_t *data;
+  size_t size;
+  uint32_t stamp;
+  unsigned long lastused;
+  bool found;
+  bool inuse;
+  uint8_t users;  // replies still sending data, see hold()
+  bool stale;     // dropped while held, data is freed by the last release()
+};
+
+
+// ----------------------------------------------------------------------
+// FILE_CACHE Class
+// Keeps SPIFFS files in RAM up to a byte budget, the least recently used
+// file is dropped first. Files that do not exist are remembered too, so
+// a repeat request does not touch SPIFFS. The Management Server calls
+// changed() after a file is uploaded or deleted. Settings files (.jsn)
+// are read from SPIFFS each time.
+// A reply sent from the data after find() returns holds it, the data is
+// then not freed until it is released, even if the file is dropped
+// ----------------------------------------------------------------------
+class FILE_CACHE {
+public:
+  FILE_CACHE(void);
+  bool find(const String &, Cache_File &);  // false if the file does not exist, data is valid until the next find()
+  void changed(void);                       // drop all files
+  uint32_t generation(void);                // changes with each changed()
+  void hold(const uint8_t *);               // keep the data of find() until release()
+  void release(const uint8_t *);
+
+private:
+  int lookup(const String &);
+  int new_entry(void);
+  void load(Cache_Entry &, bool);
+  void drop(Cache_Entry &);
+  bool make_room(size_t);
+
+  Cache_Entry _entries[FILECACHEENTRIES];
+  size_t _budget;
+  size_t _used = 0;
+  unsigned long _tick = 0;
+  uint32_t _generation = 1;
+};
+
+
+#endif  // #if !defined(_file_cache_h)
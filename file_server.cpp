@@ -0,0 +1,124 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 STATIC FILE SERVING
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// file_server.cpp
+// ----------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------
+// INCLUDES
+// ----------------------------------------------------------------------
+#include <Arduino.h>
+#include "controller_config.h"
+#include "SPIFFS.h"
+#include "http_server.h"
+
+#include "file_cache.h"
+extern FILE_CACHE *filecache;
+
+#include "file_server.h"
+
+// the cached data of a reply is sent, the cache may free it now
+static void file_release(const uint8_t *data) {
+  filecache->release(data);
+}
+
+
+// ----------------------------------------------------------------------
+// Request headers needed by send_file()
+// ----------------------------------------------------------------------
+void file_headers(HTTP_SERVER *server) {
+  static const char *keys[] = { "If-None-Match", "Accept-Encoding" };
+  server->collectHeaders(keys, 2);
+}
+
+// ----------------------------------------------------------------------
+// convert the file extension to the MIME type
+// ----------------------------------------------------------------------
+String get_contenttype(const String &filename) {
+  String retval = PLAINTEXTPAGETYPE;
+  if (filename.endsWith(".html") || filename.endsWith(".htm")) {
+    retval = TEXTPAGETYPE;
+  } else if (filename.endsWith(".css")) {
+    retval = "text/css";
+  } else if (filename.endsWith(".js")) {
+    retval = "application/javascript";
+  } else if (filename.endsWith(".json") || filename.endsWith(".jsn")) {
+    retval = JSONPAGETYPE;
+  } else if (filename.endsWith(".ico")) {
+    retval = "image/x-icon";
+  } else if (filename.endsWith(".png")) {
+    retval = "image/png";
+  } else if (filename.endsWith(".jpg")) {
+    retval = "image/jpeg";
+  } else if (filename.endsWith(".svg")) {
+    retval = "image/svg+xml";
+  }
+  return retval;
+}
+
+// ----------------------------------------------------------------------
+// send the file to the client, or 304 if the client has it
+// ----------------------------------------------------------------------
+bool send_file(HTTP_SERVER *server, String path) {
+  if (path.endsWith("/")) {
+    // if a folder is requested, send the index file
+    path += "index.html";
+  }
+  String contenttype = get_contenttype(path);
+  // only the static files of the pages, never the settings (.jsn) or any other file
+  if (contenttype.equals(PLAINTEXTPAGETYPE) || contenttype.equals(JSONPAGETYPE)) {
+    return false;
+  }
+
+  // the cache knows if file.gz and file exist, no SPIFFS access after the first request
+  Cache_File cf;
+  bool gzip = false;
+  String sendpath = path;
+  if (server->header("Accept-Encoding").indexOf("gzip") != -1) {
+    String gzpath = path + ".gz";
+    if (filecache->find(gzpath, cf)) {
+      sendpath = gzpath;
+      gzip = true;
+    }
+  }
+  if ((gzip == false) && (filecache->find(path, cf) == false)) {
+    return false;
+  }
+
+  // strong ETag, the gzip and plain files are different entities
+  char etag[24];
+  snprintf(etag, sizeof(etag), "\"%lx-%lx%s\"", (unsigned long)cf.size, (unsigned long)cf.stamp, gzip ? "g" : "");
+
+  server->sendHeader("ETag", etag);
+  server->sendHeader("Vary", "Accept-Encoding");
+  if (contenttype.equals(TEXTPAGETYPE)) {
+    server->sendHeader("Cache-Control", "no-cache");
+  } else {
+    server->sendHeader("Cache-Control", "max-age=" + String(FILEMAXAGE));
+  }
+
+  if (server->header("If-None-Match").equals(etag)) {
+    debug_server_print("-not modified ");
+    debug_server_println(sendpath);
+    server->send(NOTMODIFIEDWEBPAGE);
+    return true;
+  }
+
+  debug_server_print("-send file ");
+  debug_server_println(sendpath);
+  if (gzip) {
+    server->sendHeader("Content-Encoding", "gzip");
+  }
+  if (cf.data != NULL) {
+    filecache->hold(cf.data);
+    server->send_P(NORMALWEBPAGE, contenttype.c_str(), (const char *)cf.data, cf.size, file_release);
+  } else {
+    // too big for the cache, sent from SPIFFS as the client takes it
+    File file = SPIFFS.open(sendpath, "r");
+    if (file) {
+      server->streamFile(file, contenttype);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,35 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 STATIC FILE SERVING
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// file_server.h
+// ----------------------------------------------------------------------
+
+#if !defined(_file_server_h)
+#define _file_server_h
+
+#include <Arduino.h>
+#include "http_server.h"
+
+#define FILEMAXAGE 86400  // seconds a browser may keep css, js and images before checking again
+
+
+// ----------------------------------------------------------------------
+// Send a SPIFFS file, shared by the Web, Management and ASCOM servers
+// - file.gz is sent instead of file, gzip encoded, if it exists and the
+//   browser accepts gzip
+// - files come from the file cache, file_cache.h
+// - each file has an ETag of its size and time of last write, or its
+//   crc when SPIFFS has no time. A browser that sends the same ETag in
+//   If-None-Match gets a 304 and no file
+// - html files must be checked each time, other files can be kept for
+//   FILEMAXAGE
+// - only html, css, js, ico, png, jpg and svg files are sent, the settings
+//   files (.jsn) and any other file are not found
+// file_headers() must be called before the server begin()
+// ----------------------------------------------------------------------
+void file_headers(HTTP_SERVER *);        // ask the server to keep If-None-Match and Accept-Encoding
+bool send_file(HTTP_SERVER *, String);   // false if the file does not exist or is not a page file
+String get_contenttype(const String &);  // MIME type from the file extension
+
+
+#endif  // #if !defined(_file_server_h)
@@ -0,0 +1,87 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 FOCUSER STATE SNAPSHOT
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// focuser_state.cpp
+// ----------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------
+// INCLUDES
+// ----------------------------------------------------------------------
+#include <Arduino.h>
+#include "focuser_state.h"
+
+
+// ----------------------------------------------------------------------
+// CLASS
+// ----------------------------------------------------------------------
+FOCUSER_STATE::FOCUSER_STATE(void) {
+  for (int i = 0; i < 2; i++) {
+    _status[i].version = 0;
+    _status[i].position = 0;
+    _status[i].target = 0;
+    _status[i].temp = 20.0;
+    _status[i].ismoving = false;
+  }
+}
+
+// ----------------------------------------------------------------------
+// Publish a new snapshot, called by the main loop only
+// ----------------------------------------------------------------------
+bool FOCUSER_STATE::publish(long position, long target, bool ismoving, float temp) {
+  const Focuser_Status &cur = _status[_front];
+  if ((cur.position == position) && (cur.target == target) && (cur.ismoving == ismoving) && (cur.temp == temp)) {
+    return false;
+  }
+
+  uint8_t back = _front ^ 1;
+  _seq[back]++;  // odd, back buffer is being written
+  __sync_synchronize();
+  _status[back].version = ++_version;
+  _status[back].position = position;
+  _status[back].target = target;
+  _status[back].ismoving = ismoving;
+  _status[back].temp = temp;
+  __sync_synchronize();
+  _seq[back]++;  // even, back buffer is complete
+  __sync_synchronize();
+  _front = back;
+  return true;
+}
+
+// ----------------------------------------------------------------------
+// Take a consistent copy, safe to call from any task
+// ----------------------------------------------------------------------
+Focuser_Status FOCUSER_STATE::get(void) {
+  Focuser_Status copy;
+  uint32_t seq;
+  uint8_t idx;
+  do {
+    idx = _front;
+    seq = _seq[idx];
+    __sync_synchronize();
+    copy = _status[idx];
+    __sync_synchronize();
+  } while ((seq & 1) || (seq != _seq[idx]));
+  return copy;
+}
+
+long FOCUSER_STATE::get_position(void) {
+  return get().position;
+}
+
+long FOCUSER_STATE::get_target(void) {
+  return get().target;
+}
+
+bool FOCUSER_STATE::get_ismoving(void) {
+  return get().ismoving;
+}
+
+float FOCUSER_STATE::get_temp(void) {
+  return get().temp;
+}
+
+uint32_t FOCUSER_STATE::get_version(void) {
+  return get().version;
+}
@@ -0,0 +1,55 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 FOCUSER STATE SNAPSHOT
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// focuser_state.h
+// ----------------------------------------------------------------------
+
+#if !defined(_focuser_state_h)
+#define _focuser_state_h
+
+#include <Arduino.h>
+
+
+// ----------------------------------------------------------------------
+// SNAPSHOT
+// The state reported by the servers and the display. The main loop
+// publishes a new snapshot when position, target, moving or temperature
+// change. Readers take one copy so every value in a reply agrees.
+// ----------------------------------------------------------------------
+struct Focuser_Status {
+  uint32_t version;  // incremented on each publish
+  long position;
+  long target;
+  float temp;
+  bool ismoving;
+};
+
+
+// ----------------------------------------------------------------------
+// FOCUSER_STATE Class
+// Double buffer, the writer fills the back buffer then flips the index.
+// Each buffer has a sequence count, odd whilst it is being written, so a
+// reader on the other core retries instead of taking a torn copy.
+// Only the main loop calls publish()
+// ----------------------------------------------------------------------
+class FOCUSER_STATE {
+public:
+  FOCUSER_STATE(void);
+  bool publish(long, long, bool, float);  // position, target, ismoving, temp; false if nothing changed
+  Focuser_Status get(void);               // copy of the current snapshot
+
+  long get_position(void);
+  long get_target(void);
+  bool get_ismoving(void);
+  float get_temp(void);
+  uint32_t get_version(void);
+
+private:
+  Focuser_Status _status[2];
+  volatile uint32_t _seq[2] = { 0, 0 };
+  volatile uint8_t _front = 0;
+  uint32_t _version = 0;
+};
+
+
+#endif  // #if !defined(_focuser_state_h)
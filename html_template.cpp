@@ -0,0 +1,290 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HTML PAGE TEMPLATES
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// html_template.cpp
+// ----------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------
+// INCLUDES
+// ----------------------------------------------------------------------
+#include <Arduino.h>
+#include "SPIFFS.h"
+
+#include "controller_schema.h"  // cntlr_keyhash()
+#include "file_cache.h"
+extern FILE_CACHE *filecache;
+
+#include "html_template.h"
+
+
+// ----------------------------------------------------------------------
+// Read a page from the file cache, or from SPIFFS when the page is too
+// big for the cache
+// ----------------------------------------------------------------------
+class TPL_READER {
+public:
+  bool open(const char *path) {
+    _pos = 0;
+    if (filecache->find(path, _cf) == false) {
+      return false;
+    }
+    if (_cf.data == NULL) {
+      _file = SPIFFS.open(path, "r");
+      return (bool)_file;
+    }
+    return true;
+  }
+  size_t size(void) {
+    return _cf.size;
+  }
+  int read(uint8_t *buf, size_t n) {
+    if (_cf.data == NULL) {
+      return _file.read(buf, n);
+    }
+    n = (n > (_cf.size - _pos)) ? (_cf.size - _pos) : n;
+    memcpy(buf, &_cf.data[_pos], n);
+    _pos += n;
+    return n;
+  }
+  void seek(size_t pos) {
+    if (_cf.data == NULL) {
+      _file.seek(pos);
+    } else {
+      _pos = pos;
+    }
+  }
+  void close(void) {
+    if (_cf.data == NULL) {
+      _file.close();
+    }
+  }
+
+private:
+  Cache_File _cf;
+  size_t _pos;
+  File _file;
+};
+
+
+// ----------------------------------------------------------------------
+// CLASS
+// ----------------------------------------------------------------------
+HTML_TEMPLATE::HTML_TEMPLATE(const char *path) {
+  _path = path;
+}
+
+HTML_TEMPLATE::~HTML_TEMPLATE() {
+  delete[] _fields;
+  delete[] _values;
+}
+
+// ----------------------------------------------------------------------
+// Start a request, scan the file if it has not been scanned
+// ----------------------------------------------------------------------
+bool HTML_TEMPLATE::load(void) {
+  // scan again after a file is uploaded or deleted
+  if (_scanned != filecache->generation()) {
+    _found = scan();
+    _scanned = filecache->generation();
+  }
+  clear();
+  return _found;
+}
+
+// ----------------------------------------------------------------------
+// Find the %FIELD%s of the file. The file is read twice, once to count
+// the fields and once to record them
+// ----------------------------------------------------------------------
+bool HTML_TEMPLATE::scan(void) {
+  delete[] _fields;
+  delete[] _values;
+  _fields = NULL;
+  _values = NULL;
+  _count = 0;
+  _size = 0;
+
+  for (int pass = 0; pass < 2; pass++) {
+    TPL_READER file;
+    if (!file.open(_path)) {
+      return false;
+    }
+    _size = file.size();
+
+    uint8_t buf[64];
+    uint16_t pos = 0;
+    uint16_t start = 0;
+    int namelen = -1;  // -1 not in a field
+    uint32_t hash = 0;
+    uint16_t count = 0;
+    int n;
+    while ((n = file.read(buf, sizeof(buf))) > 0) {
+      for (int i = 0; i < n; i++, pos++) {
+        char c = (char)buf[i];
+        if (c == '%') {
+          if (namelen > 0) {
+            // end of %FIELD%
+            if (pass == 1) {
+              _fields[count].hash = (hash ^ (uint8_t)c) * 16777619UL;
+              _fields[count].offset = start;
+              _fields[count].len = namelen + 2;
+              _fields[count].isset = false;
+            }
+            count++;
+            namelen = -1;
+          } else {
+            // may be the start of a field
+            start = pos;
+            namelen = 0;
+            hash = (2166136261UL ^ (uint8_t)c) * 16777619UL;
+          }
+        } else if ((namelen >= 0) && (isalnum(c) || (c == '_')) && (namelen < TPLNAMELEN)) {
+          namelen++;
+          hash = (hash ^ (uint8_t)c) * 16777619UL;
+        } else {
+          namelen = -1;
+        }
+      }
+    }
+    file.close();
+
+    if (pass == 0) {
+      _count = count;
+      if (_count > 0) {
+        _fields = new Tpl_Field[_count];
+        _values = new String[_count];
+      }
+    }
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------
+// Value of every %FIELD% with this name, unless it already has one
+// ----------------------------------------------------------------------
+void HTML_TEMPLATE::replace(const char *name, const String &value) {
+  uint32_t hash = cntlr_keyhash(name);
+  for (int i = 0; i < _count; i++) {
+    if ((_fields[i].hash == hash) && (_fields[i].isset == false)) {
+      _values[i] = value;
+      _fields[i].isset = true;
+    }
+  }
+}
+
+void HTML_TEMPLATE::replace(const char *name, const char *value) {
+  uint32_t hash = cntlr_keyhash(name);
+  for (int i = 0; i < _count; i++) {
+    if ((_fields[i].hash == hash) && (_fields[i].isset == false)) {
+      _values[i] = value;
+      _fields[i].isset = true;
+    }
+  }
+}
+
+void HTML_TEMPLATE::set_text(const char *text) {
+  _text = text;
+}
+
+// ----------------------------------------------------------------------
+// Clear the values of the last request
+// ----------------------------------------------------------------------
+void HTML_TEMPLATE::clear(void) {
+  for (int i = 0; i < _count; i++) {
+    if (_fields[i].isset) {
+      _values[i] = String();
+      _fields[i].isset = false;
+    }
+  }
+  _text = NULL;
+}
+
+size_t HTML_TEMPLATE::length(void) {
+  if (_text != NULL) {
+    return strlen(_text);
+  }
+  if (_found == false) {
+    return 0;
+  }
+  size_t len = _size;
+  for (int i = 0; i < _count; i++) {
+    if (_fields[i].isset) {
+      len = len - _fields[i].len + _values[i].length();
+    }
+  }
+  return len;
+}
+
+// ----------------------------------------------------------------------
+// Send the page, file text up to each field, then the value of the field
+// ----------------------------------------------------------------------
+size_t HTML_TEMPLATE::render(Print &out) {
+  size_t sent = 0;
+
+  if (_text != NULL) {
+    sent = out.print(_text);
+    clear();
+    return sent;
+  }
+  if (_found == false) {
+    return 0;
+  }
+  TPL_READER file;
+  if (!file.open(_path)) {
+    clear();
+    return 0;
+  }
+
+  uint8_t buf[TPLCHUNKSIZE];
+  size_t used = 0;
+  uint16_t pos = 0;  // position in file
+
+  for (int i = 0; i <= _count; i++) {
+    // file text up to the next field that has a value, or to the end
+    uint16_t end = (i < _count) ? _fields[i].offset : _size;
+    if ((i < _count) && (_fields[i].isset == false)) {
+      continue;
+    }
+    while (pos < end) {
+      size_t n = end - pos;
+      n = (n > (TPLCHUNKSIZE - used)) ? (TPLCHUNKSIZE - used) : n;
+      int got = file.read(&buf[used], n);
+      if (got <= 0) {
+        pos = end;
+        break;
+      }
+      used += got;
+      pos += got;
+      if (used == TPLCHUNKSIZE) {
+        sent += out.write(buf, used);
+        used = 0;
+      }
+    }
+    if (i == _count) {
+      break;
+    }
+
+    // the value, then skip the field in the file
+    const char *val = _values[i].c_str();
+    size_t vlen = _values[i].length();
+    while (vlen > 0) {
+      size_t n = (vlen > (TPLCHUNKSIZE - used)) ? (TPLCHUNKSIZE - used) : vlen;
+      memcpy(&buf[used], val, n);
+      used += n;
+      val += n;
+      vlen -= n;
+      if (used == TPLCHUNKSIZE) {
+        sent += out.write(buf, used);
+        used = 0;
+      }
+    }
+    pos += _fields[i].len;
+    file.seek(pos);
+  }
+  if (used > 0) {
+    sent += out.write(buf, used);
+  }
+  file.close();
+  clear();
+  return sent;
+}
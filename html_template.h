@@ -0,0 +1,64 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HTML PAGE TEMPLATES
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// html_template.h
+// ----------------------------------------------------------------------
+
+#if !defined(_html_template_h)
+#define _html_template_h
+
+#include <Arduino.h>
+
+#define TPLNAMELEN 16    // longest %FIELD% name, without the %
+#define TPLCHUNKSIZE 512 // render buffer, bytes sent per write
+
+
+// ----------------------------------------------------------------------
+// A %FIELD% in the page file
+// ----------------------------------------------------------------------
+struct Tpl_Field {
+  uint32_t hash;    // cntlr_keyhash of %FIELD%
+  uint16_t offset;  // position in the file
+  uint8_t len;      // length of %FIELD%
+  bool isset;       // a value has been given for this request
+};
+
+
+// ----------------------------------------------------------------------
+// HTML_TEMPLATE Class
+// The page file is scanned once for its %FIELD%s, and again only after a
+// file is uploaded or deleted. Pages are read through the file cache. A request gives the values with replace(),
+// then render() streams the file to the client through a small buffer,
+// putting each value in place of its field. The page is never held in a
+// String. The first value given for a field is kept, as String::replace()
+// did, and a field with no value is sent as it is in the file
+// ----------------------------------------------------------------------
+class HTML_TEMPLATE {
+public:
+  HTML_TEMPLATE(const char *);  // SPIFFS file of the page
+  ~HTML_TEMPLATE();
+  bool load(void);              // start a request, false if the file does not exist
+
+  void replace(const char *, const String &);
+  void replace(const char *, const char *);
+  void set_text(const char *);  // send this text instead of the page, eg file not found
+
+  size_t length(void);          // bytes render() will send
+  size_t render(Print &);       // send the page, then clear the values
+
+private:
+  bool scan(void);
+  void clear(void);
+
+  const char *_path;
+  const char *_text = NULL;
+  bool _found = false;
+  uint32_t _scanned = 0;     // file cache generation when the file was scanned, 0 never
+  uint16_t _size = 0;        // file size
+  uint16_t _count = 0;       // number of fields
+  Tpl_Field *_fields = NULL;
+  String *_values = NULL;
+};
+
+
+#endif  // #if !defined(_html_template_h)
@@ -0,0 +1,1505 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HTTP SERVER
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// http_server.cpp
+// ----------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------
+// INCLUDES
+// ----------------------------------------------------------------------
+#include <Arduino.h>
+#include "controller_config.h"
+#include "FS.h"
+#include <WiFiServer.h>
+#include <WiFiClient.h>
+#include <WebServer.h>
+#include "lwip/sockets.h"
+#include "mbedtls/base64.h"
+
+#include "http_server.h"
+
+
+// ----------------------------------------------------------------------
+// helpers
+// ----------------------------------------------------------------------
+static const char *status_text(int code) {
+  switch (code) {
+    case 100: return "Continue";
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+  }
+  return "";
+}
+
+static HTTPMethod parse_method(const char *m) {
+  if (strcmp(m, "GET") == 0) {
+    return HTTP_GET;
+  } else if (strcmp(m, "POST") == 0) {
+    return HTTP_POST;
+  } else if (strcmp(m, "HEAD") == 0) {
+    return HTTP_HEAD;
+  } else if (strcmp(m, "PUT") == 0) {
+    return HTTP_PUT;
+  } else if (strcmp(m, "PATCH") == 0) {
+    return HTTP_PATCH;
+  } else if (strcmp(m, "DELETE") == 0) {
+    return HTTP_DELETE;
+  } else if (strcmp(m, "OPTIONS") == 0) {
+    return HTTP_OPTIONS;
+  }
+  return HTTP_ANY;  // not known
+}
+
+static int hex_value(char c) {
+  if ((c >= '0') && (c <= '9')) {
+    return c - '0';
+  } else if ((c >= 'a') && (c <= 'f')) {
+    return c - 'a' + 10;
+  } else if ((c >= 'A') && (c <= 'F')) {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// form and query values, + is a space
+static String url_decode(const char *s, size_t len) {
+  String result;
+  result.reserve(len);
+  for (size_t i = 0; i < len; i++) {
+    if (s[i] == '+') {
+      result += ' ';
+    } else if ((s[i] == '%') && ((i + 2) < len) && (hex_value(s[i + 1]) != -1) && (hex_value(s[i + 2]) != -1)) {
+      result += (char)((hex_value(s[i + 1]) << 4) | hex_value(s[i + 2]));
+      i += 2;
+    } else {
+      result += s[i];
+    }
+  }
+  return result;
+}
+
+static int find_bytes(const uint8_t *buf, size_t len, const char *str, size_t slen) {
+  if (len < slen) {
+    return -1;
+  }
+  for (size_t i = 0; i <= (len - slen); i++) {
+    if ((buf[i] == (uint8_t)str[0]) && (memcmp(buf + i, str, slen) == 0)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// value of name="value" in a Content-Disposition header
+static bool header_param(const String &line, const char *name, String &value) {
+  String key = String(name) + "=\"";
+  int start = line.indexOf(key);
+  if (start == -1) {
+    return false;
+  }
+  start += key.length();
+  int end = line.indexOf('"', start);
+  if (end == -1) {
+    return false;
+  }
+  value = line.substring(start, end);
+  return true;
+}
+
+
+// ----------------------------------------------------------------------
+// ENGINE
+// ----------------------------------------------------------------------
+HTTP_ENGINE::HTTP_ENGINE(void)
+  : _content(this) {
+  _headerkeys[0] = "Authorization";
+  for (int i = 0; i < HTTPCONNECTIONS; i++) {
+    Http_Conn &c = _conns[i];
+    c.state = Conn_Free;
+    c.site = NULL;
+    c.head = NULL;
+    c.args = NULL;
+    c.argcount = 0;
+    c.handler = NULL;
+    c.upload = NULL;
+    c.part = NULL;
+    c.out = NULL;
+    c.outsize = 0;
+    c.outlen = 0;
+    c.outpos = 0;
+    c.data = NULL;
+    c.datalen = 0;
+    c.datapos = 0;
+    c.datadone = NULL;
+    c.sendfile = false;
+    c.chunked = false;
+    c.broken = false;
+  }
+  for (int i = 0; i < HTTPLISTENERS; i++) {
+    _listeners[i].server = NULL;
+    _listeners[i].users = 0;
+  }
+  for (int i = 0; i < HTTPSITES; i++) {
+    _sites[i] = NULL;
+  }
+}
+
+HTTP_ENGINE::~HTTP_ENGINE() {
+  for (int i = 0; i < HTTPSITES; i++) {
+    if (_sites[i] != NULL) {
+      remove_site(_sites[i]);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+// A server starts, listen on its port if no other server does
+// ----------------------------------------------------------------------
+bool HTTP_ENGINE::add_site(HTTP_SERVER *site) {
+  int slot = -1;
+  for (int i = 0; i < HTTPSITES; i++) {
+    if (_sites[i] == site) {
+      return true;
+    }
+    if ((_sites[i] == NULL) && (slot == -1)) {
+      slot = i;
+    }
+  }
+  if (slot == -1) {
+    return false;
+  }
+
+  int unused = -1;
+  for (int i = 0; i < HTTPLISTENERS; i++) {
+    if ((_listeners[i].users > 0) && (_listeners[i].port == site->_port)) {
+      _listeners[i].users++;
+      _sites[slot] = site;
+      return true;
+    }
+    if ((_listeners[i].users == 0) && (unused == -1)) {
+      unused = i;
+    }
+  }
+  if (unused == -1) {
+    return false;
+  }
+  Http_Listener &l = _listeners[unused];
+  l.server = new WiFiServer(site->_port, HTTPCONNECTIONS);
+  l.server->begin();
+  l.server->setNoDelay(true);
+  l.port = site->_port;
+  l.users = 1;
+  _sites[slot] = site;
+  return true;
+}
+
+// ----------------------------------------------------------------------
+// A server stops, close its connections, and its port if no other
+// server uses it
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::remove_site(HTTP_SERVER *site) {
+  int slot = -1;
+  for (int i = 0; i < HTTPSITES; i++) {
+    if (_sites[i] == site) {
+      slot = i;
+    }
+  }
+  if (slot == -1) {
+    return;
+  }
+  _sites[slot] = NULL;
+
+  bool portused = false;
+  for (int i = 0; i < HTTPLISTENERS; i++) {
+    Http_Listener &l = _listeners[i];
+    if ((l.users > 0) && (l.port == site->_port)) {
+      l.users--;
+      if (l.users == 0) {
+        l.server->stop();
+        delete l.server;
+        l.server = NULL;
+      } else {
+        portused = true;
+      }
+    }
+  }
+  for (int i = 0; i < HTTPCONNECTIONS; i++) {
+    Http_Conn &c = _conns[i];
+    if ((c.state != Conn_Free) && ((c.site == site) || ((c.port == site->_port) && (portused == false)))) {
+      release(c);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+// Request headers kept for header(), Authorization is always kept.
+// The keys of all servers on the engine are kept
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::collectHeaders(const char *keys[], size_t count) {
+  for (size_t k = 0; k < count; k++) {
+    bool found = false;
+    for (int i = 0; i < _headercount; i++) {
+      if (_headerkeys[i].equalsIgnoreCase(keys[k])) {
+        found = true;
+      }
+    }
+    if ((found == false) && (_headercount <= HTTPMAXHEADERS)) {
+      _headerkeys[_headercount++] = keys[k];
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+// The route for the request. Servers on the same port are searched in
+// the order they started, the first one gets requests with no route
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::find_route(Http_Conn &c) {
+  c.site = NULL;
+  c.handler = NULL;
+  for (int i = 0; i < HTTPSITES; i++) {
+    HTTP_SERVER *site = _sites[i];
+    if ((site == NULL) || (site->_port != c.port)) {
+      continue;
+    }
+    if (c.site == NULL) {
+      c.site = site;
+    }
+    Http_Handler *h = site->find_handler(c.uri, c.method);
+    if (h != NULL) {
+      c.site = site;
+      c.handler = h;
+      return;
+    }
+  }
+}
+
+
+// ----------------------------------------------------------------------
+// Called from loop(), does what each connection is ready for and
+// returns, never waits for a client
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::handleClient(void) {
+  accept_clients();
+
+  unsigned long now = millis();
+  for (int i = 0; i < HTTPCONNECTIONS; i++) {
+    Http_Conn &c = _conns[i];
+    switch (c.state) {
+      case Conn_Free:
+        break;
+      case Conn_Head:
+      case Conn_Body:
+      case Conn_Upload:
+        if ((now - c.time) > HTTPTIMEOUT) {
+          debug_server_println("-http request timeout");
+          send_error(c, 408);
+          break;
+        }
+        if (c.state == Conn_Head) {
+          read_head(c);
+        } else if (c.state == Conn_Body) {
+          read_body(c);
+        } else {
+          read_upload(c);
+        }
+        break;
+      case Conn_Send:
+        if ((now - c.time) > HTTPSENDTIMEOUT) {
+          debug_server_println("-http send timeout");
+          release(c);
+          break;
+        }
+        send_queued(c);
+        break;
+      case Conn_Drain:
+        drain(c);
+        break;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+// Accept new connections while there are free slots, from each port in
+// turn. When all are busy, new connections wait in the listen queue
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::accept_clients(void) {
+  for (int i = 0; i < HTTPCONNECTIONS; i++) {
+    Http_Conn &c = _conns[i];
+    if (c.state != Conn_Free) {
+      continue;
+    }
+    WiFiClient client;
+    int port = 0;
+    for (int n = 0; n < HTTPLISTENERS; n++) {
+      Http_Listener &l = _listeners[_nextlistener];
+      _nextlistener = (_nextlistener + 1) % HTTPLISTENERS;
+      if (l.users > 0) {
+        client = l.server->available();
+        if (client) {
+          port = l.port;
+          break;
+        }
+      }
+    }
+    if (!client) {
+      return;
+    }
+    c.head = (char *)malloc(HTTPHEADLEN + 1);
+    if (c.head == NULL) {
+      return;  // closes the client
+    }
+    c.client = client;
+    c.port = port;
+    c.headlen = 0;
+    c.state = Conn_Head;
+    c.time = millis();
+    c.responded = false;
+    c.chunked = false;
+    c.drain = false;
+    c.broken = false;
+  }
+}
+
+
+// ----------------------------------------------------------------------
+// Receive the request line and headers
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::read_head(Http_Conn &c) {
+  int avail = c.client.available();
+  if (avail <= 0) {
+    if (!c.client.connected()) {
+      release(c);
+    }
+    return;
+  }
+  // read only up to the end of the headers is not possible without
+  // peeking, so the start of the body may be read here
+  size_t room = HTTPHEADLEN - c.headlen;
+  if (room == 0) {
+    send_error(c, 431);
+    return;
+  }
+  int n = c.client.read((uint8_t *)c.head + c.headlen, ((size_t)avail < room) ? avail : room);
+  if (n <= 0) {
+    return;
+  }
+  c.headlen += n;
+  c.head[c.headlen] = 0;
+
+  int end = find_bytes((const uint8_t *)c.head, c.headlen, "\r\n\r\n", 4);
+  if (end == -1) {
+    if (c.headlen == HTTPHEADLEN) {
+      send_error(c, 431);
+    }
+    return;
+  }
+  int result = parse_head(c);
+  if (result != 0) {
+    send_error(c, result);
+  }
+}
+
+// ----------------------------------------------------------------------
+// Parse the request line and headers, start the body or run the handler
+// Returns 0, or the error status to send
+// ----------------------------------------------------------------------
+int HTTP_ENGINE::parse_head(Http_Conn &c) {
+  char *end = strstr(c.head, "\r\n\r\n");
+  size_t extra = c.headlen - ((end - c.head) + 4);  // body bytes already read
+  const uint8_t *extrabytes = (const uint8_t *)end + 4;
+  *end = 0;
+
+  // request line, METHOD uri HTTP/1.1
+  char *line = c.head;
+  char *next = strstr(line, "\r\n");
+  if (next != NULL) {
+    *next = 0;
+    next += 2;
+  }
+  char *sp1 = strchr(line, ' ');
+  char *sp2 = (sp1 != NULL) ? strchr(sp1 + 1, ' ') : NULL;
+  if ((sp1 == NULL) || (sp2 == NULL)) {
+    return 400;
+  }
+  *sp1 = 0;
+  *sp2 = 0;
+  c.method = parse_method(line);
+  char *query = strchr(sp1 + 1, '?');
+  if (query != NULL) {
+    *query++ = 0;
+  }
+  c.uri = sp1 + 1;
+
+  // headers
+  String contenttype;
+  bool expect = false;
+  c.bodylen = 0;
+  while ((next != NULL) && (*next != 0)) {
+    line = next;
+    next = strstr(line, "\r\n");
+    if (next != NULL) {
+      *next = 0;
+      next += 2;
+    }
+    char *colon = strchr(line, ':');
+    if (colon == NULL) {
+      continue;
+    }
+    *colon = 0;
+    String name = line;
+    String value = colon + 1;
+    value.trim();
+    if (name.equalsIgnoreCase("Content-Length")) {
+      c.bodylen = value.toInt();
+    } else if (name.equalsIgnoreCase("Content-Type")) {
+      contenttype = value;
+    } else if (name.equalsIgnoreCase("Expect")) {
+      expect = value.equalsIgnoreCase("100-continue");
+    }
+    for (int i = 0; i < _headercount; i++) {
+      if (name.equalsIgnoreCase(_headerkeys[i])) {
+        c.headers[i] = value;
+      }
+    }
+  }
+  if (query != NULL) {
+    parse_args(c, String(query));
+  }
+  find_route(c);
+
+  // body
+  if (c.bodylen == 0) {
+    dispatch(c);
+    return 0;
+  }
+  if (extra > c.bodylen) {
+    extra = c.bodylen;
+  }
+  if (contenttype.startsWith("multipart/form-data")) {
+    int b = contenttype.indexOf("boundary=");
+    if (b == -1) {
+      return 400;
+    }
+    String boundary = contenttype.substring(b + 9);
+    boundary.replace("\"", "");
+    if ((boundary.length() == 0) || (boundary.length() > 72)) {
+      return 400;
+    }
+    c.boundary = "\r\n--" + boundary;
+    c.part = (uint8_t *)malloc(HTTPPARTLEN);
+    if (c.part == NULL) {
+      return 500;
+    }
+    memcpy(c.part, extrabytes, extra);
+    c.partlen = extra;
+    c.partstate = Part_Wait;
+    c.isfile = false;
+    c.state = Conn_Upload;
+  } else {
+    if (c.bodylen > HTTPBODYLEN) {
+      return 413;
+    }
+    c.body.reserve(c.bodylen);
+    c.body.concat((const char *)extrabytes, extra);
+    c.urlencoded = contenttype.startsWith("application/x-www-form-urlencoded");
+    c.state = Conn_Body;
+  }
+  c.bodylen -= extra;
+  free(c.head);
+  c.head = NULL;
+  if (expect) {
+    c.client.write((const uint8_t *)"HTTP/1.1 100 Continue\r\n\r\n", 25);
+  }
+  c.time = millis();
+  // a short body may be complete already
+  if (c.state == Conn_Upload) {
+    read_upload(c);
+  } else {
+    read_body(c);
+  }
+  return 0;
+}
+
+// ----------------------------------------------------------------------
+// Receive a form or json body, form fields are added to the args, other
+// bodies are the arg "plain", as WebServer
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::read_body(Http_Conn &c) {
+  if (c.bodylen > 0) {
+    int avail = c.client.available();
+    if (avail <= 0) {
+      if (!c.client.connected()) {
+        release(c);
+      }
+      return;
+    }
+    char buf[256];
+    size_t want = ((size_t)avail < sizeof(buf)) ? avail : sizeof(buf);
+    if (want > c.bodylen) {
+      want = c.bodylen;
+    }
+    int n = c.client.read((uint8_t *)buf, want);
+    if (n <= 0) {
+      return;
+    }
+    c.body.concat(buf, n);
+    c.bodylen -= n;
+    c.time = millis();
+    if (c.bodylen > 0) {
+      return;
+    }
+  }
+
+  if (c.urlencoded) {
+    parse_args(c, c.body);
+  } else {
+    add_arg(c, "plain", c.body);
+  }
+  c.body = String();
+  dispatch(c);
+}
+
+// ----------------------------------------------------------------------
+// Receive a multipart body, a few buffers each call so other connections
+// get a turn
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::read_upload(Http_Conn &c) {
+  if (c.partstate == Part_Wait) {
+    // upload handlers keep one file open, one upload at a time
+    for (int i = 0; i < HTTPCONNECTIONS; i++) {
+      if ((_conns[i].state == Conn_Upload) && (_conns[i].partstate != Part_Wait)) {
+        c.time = millis();
+        return;
+      }
+    }
+    c.partstate = Part_Start;
+  }
+  for (int pass = 0; (pass < 4) && (c.bodylen > 0); pass++) {
+    int avail = c.client.available();
+    if (avail <= 0) {
+      if (!c.client.connected()) {
+        release(c);
+        return;
+      }
+      break;
+    }
+    size_t want = HTTPPARTLEN - c.partlen;
+    if ((size_t)avail < want) {
+      want = avail;
+    }
+    if (want > c.bodylen) {
+      want = c.bodylen;
+    }
+    int n = c.client.read(c.part + c.partlen, want);
+    if (n <= 0) {
+      break;
+    }
+    c.partlen += n;
+    c.bodylen -= n;
+    c.time = millis();
+    if (parse_parts(c) == false) {
+      send_error(c, 400);
+      return;
+    }
+  }
+  if (parse_parts(c) == false) {
+    send_error(c, 400);
+    return;
+  }
+  if (c.bodylen == 0) {
+    if (c.partstate != Part_End) {
+      send_error(c, 400);
+      return;
+    }
+    dispatch(c);
+  }
+}
+
+// ----------------------------------------------------------------------
+// Take what can be decided from the part buffer. Data that may be the
+// start of a boundary stays in the buffer until more arrives
+// ----------------------------------------------------------------------
+bool HTTP_ENGINE::parse_parts(Http_Conn &c) {
+  const char *delim = c.boundary.c_str();
+  size_t dlen = c.boundary.length();
+  int pos;
+  size_t used;
+
+  while (true) {
+    switch (c.partstate) {
+      case Part_Start:
+        // the first boundary has no leading CRLF
+        pos = find_bytes(c.part, c.partlen, delim + 2, dlen - 2);
+        if (pos == -1) {
+          if (c.partlen == HTTPPARTLEN) {
+            return false;
+          }
+          return true;
+        }
+        used = pos + dlen - 2;
+        c.partstate = Part_Next;
+        break;
+      case Part_Next:
+        if (c.partlen < 2) {
+          return true;
+        }
+        if ((c.part[0] == '-') && (c.part[1] == '-')) {
+          c.partstate = Part_End;
+          c.partlen = 0;
+          return true;
+        }
+        if ((c.part[0] != '\r') || (c.part[1] != '\n')) {
+          return false;
+        }
+        used = 2;
+        c.partstate = Part_Headers;
+        break;
+      case Part_Headers:
+        pos = find_bytes(c.part, c.partlen, "\r\n\r\n", 4);
+        if (pos == -1) {
+          return (c.partlen < HTTPPARTLEN);
+        }
+        c.part[pos] = 0;
+        if (part_start(c, (const char *)c.part) == false) {
+          return false;
+        }
+        used = pos + 4;
+        c.partstate = Part_Data;
+        break;
+      case Part_Data:
+        pos = find_bytes(c.part, c.partlen, delim, dlen);
+        if (pos == -1) {
+          if (c.partlen < dlen) {
+            return true;
+          }
+          used = c.partlen - (dlen - 1);
+          part_data(c, c.part, used);
+        } else {
+          part_data(c, c.part, pos);
+          part_end(c);
+          used = pos + dlen;
+          c.partstate = Part_Next;
+        }
+        break;
+      case Part_End:
+      default:
+        c.partlen = 0;  // ignore anything after the last boundary
+        return true;
+    }
+    if (used == 0) {
+      return true;
+    }
+    memmove(c.part, c.part + used, c.partlen - used);
+    c.partlen -= used;
+  }
+}
+
+// ----------------------------------------------------------------------
+// Headers of a part, a file part starts an upload
+// ----------------------------------------------------------------------
+bool HTTP_ENGINE::part_start(Http_Conn &c, const char *headers) {
+  String disposition;
+  String type = "text/plain";
+  String text = headers;
+  int start = 0;
+  while (start < (int)text.length()) {
+    int end = text.indexOf("\r\n", start);
+    if (end == -1) {
+      end = text.length();
+    }
+    String line = text.substring(start, end);
+    int colon = line.indexOf(':');
+    if (colon != -1) {
+      String name = line.substring(0, colon);
+      String value = line.substring(colon + 1);
+      value.trim();
+      if (name.equalsIgnoreCase("Content-Disposition")) {
+        disposition = value;
+      } else if (name.equalsIgnoreCase("Content-Type")) {
+        type = value;
+      }
+    }
+    start = end + 2;
+  }
+
+  if (header_param(disposition, "name", c.fieldname) == false) {
+    return false;
+  }
+  String filename;
+  c.isfile = header_param(disposition, "filename", filename);
+  c.fieldvalue = String();
+  if (c.isfile) {
+    if (c.upload == NULL) {
+      c.upload = new HTTPUpload;
+    }
+    c.upload->filename = filename;
+    c.upload->name = c.fieldname;
+    c.upload->type = type;
+    c.upload->totalSize = 0;
+    c.upload->currentSize = 0;
+    upload_event(c, UPLOAD_FILE_START);
+  }
+  return true;
+}
+
+void HTTP_ENGINE::part_data(Http_Conn &c, const uint8_t *data, size_t len) {
+  if (c.isfile == false) {
+    if ((c.fieldvalue.length() + len) <= HTTPBODYLEN) {
+      c.fieldvalue.concat((const char *)data, len);
+    }
+    return;
+  }
+  HTTPUpload &u = *c.upload;
+  while (len > 0) {
+    size_t n = HTTP_UPLOAD_BUFLEN - u.currentSize;
+    if (n > len) {
+      n = len;
+    }
+    memcpy(u.buf + u.currentSize, data, n);
+    u.currentSize += n;
+    data += n;
+    len -= n;
+    if (u.currentSize == HTTP_UPLOAD_BUFLEN) {
+      upload_event(c, UPLOAD_FILE_WRITE);
+      u.totalSize += u.currentSize;
+      u.currentSize = 0;
+    }
+  }
+}
+
+void HTTP_ENGINE::part_end(Http_Conn &c) {
+  if (c.isfile == false) {
+    add_arg(c, c.fieldname, c.fieldvalue);
+    c.fieldvalue = String();
+    return;
+  }
+  HTTPUpload &u = *c.upload;
+  if (u.currentSize > 0) {
+    upload_event(c, UPLOAD_FILE_WRITE);
+    u.totalSize += u.currentSize;
+    u.currentSize = 0;
+  }
+  upload_event(c, UPLOAD_FILE_END);
+  c.isfile = false;
+}
+
+// ----------------------------------------------------------------------
+// Call the upload handler of the uri
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::upload_event(Http_Conn &c, HTTPUploadStatus status) {
+  c.upload->status = status;
+  if ((c.handler != NULL) && c.handler->ufn) {
+    _current = &c;
+    c.handler->ufn();
+    _current = NULL;
+  }
+}
+
+
+// ----------------------------------------------------------------------
+// Request args
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::add_arg(Http_Conn &c, const String &name, const String &value) {
+  if (c.args == NULL) {
+    c.args = new Http_Arg[HTTPMAXARGS];
+  }
+  if (c.argcount < HTTPMAXARGS) {
+    c.args[c.argcount].name = name;
+    c.args[c.argcount].value = value;
+    c.argcount++;
+  }
+}
+
+// name=value&name=value
+void HTTP_ENGINE::parse_args(Http_Conn &c, const String &data) {
+  const char *s = data.c_str();
+  size_t len = data.length();
+  size_t start = 0;
+  while (start < len) {
+    const char *amp = strchr(s + start, '&');
+    size_t end = (amp != NULL) ? (size_t)(amp - s) : len;
+    if (end > start) {
+      const char *eq = (const char *)memchr(s + start, '=', end - start);
+      if (eq != NULL) {
+        size_t e = eq - s;
+        add_arg(c, url_decode(s + start, e - start), url_decode(s + e + 1, end - e - 1));
+      } else {
+        add_arg(c, url_decode(s + start, end - start), String());
+      }
+    }
+    start = end + 1;
+  }
+}
+
+
+// ----------------------------------------------------------------------
+// The request is complete, run its handler and start sending the reply
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::dispatch(Http_Conn &c) {
+  _current = &c;
+  _replyheaders = String();
+  _contentlength = CONTENT_LENGTH_NOT_SET;
+  if (c.handler != NULL) {
+    c.handler->fn();
+  } else if ((c.site != NULL) && c.site->_notfound) {
+    c.site->_notfound();
+  } else {
+    send(NOTFOUNDWEBPAGE, PLAINTEXTPAGETYPE, "Not found: " + c.uri);
+  }
+  if (c.chunked) {
+    // the handler did not send the last chunk
+    queue(c, (const uint8_t *)"0\r\n\r\n", 5);
+    c.chunked = false;
+  }
+  _current = NULL;
+  _replyheaders = String();
+
+  free_request(c);
+  c.state = Conn_Send;
+  c.time = millis();
+  send_queued(c);
+}
+
+String HTTP_ENGINE::uri(void) {
+  return (_current != NULL) ? _current->uri : String();
+}
+
+HTTPMethod HTTP_ENGINE::method(void) {
+  return (_current != NULL) ? _current->method : HTTP_ANY;
+}
+
+String HTTP_ENGINE::arg(const String &name) {
+  if (_current != NULL) {
+    for (int i = 0; i < _current->argcount; i++) {
+      if (_current->args[i].name.equals(name)) {
+        return _current->args[i].value;
+      }
+    }
+  }
+  return String();
+}
+
+String HTTP_ENGINE::arg(int i) {
+  if ((_current != NULL) && (i >= 0) && (i < _current->argcount)) {
+    return _current->args[i].value;
+  }
+  return String();
+}
+
+String HTTP_ENGINE::argName(int i) {
+  if ((_current != NULL) && (i >= 0) && (i < _current->argcount)) {
+    return _current->args[i].name;
+  }
+  return String();
+}
+
+int HTTP_ENGINE::args(void) {
+  return (_current != NULL) ? _current->argcount : 0;
+}
+
+bool HTTP_ENGINE::hasArg(const String &name) {
+  if (_current != NULL) {
+    for (int i = 0; i < _current->argcount; i++) {
+      if (_current->args[i].name.equals(name)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+String HTTP_ENGINE::header(const String &name) {
+  if (_current != NULL) {
+    for (int i = 0; i < _headercount; i++) {
+      if (name.equalsIgnoreCase(_headerkeys[i])) {
+        return _current->headers[i];
+      }
+    }
+  }
+  return String();
+}
+
+HTTPUpload &HTTP_ENGINE::upload(void) {
+  static HTTPUpload none;
+  if ((_current != NULL) && (_current->upload != NULL)) {
+    return *_current->upload;
+  }
+  return none;
+}
+
+// ----------------------------------------------------------------------
+// Basic authentication
+// ----------------------------------------------------------------------
+bool HTTP_ENGINE::authenticate(const char *username, const char *password) {
+  if (_current == NULL) {
+    return false;
+  }
+  String auth = _current->headers[0];
+  if (!auth.startsWith("Basic ")) {
+    return false;
+  }
+  String userpass = String(username) + ":" + password;
+  unsigned char encoded[128];
+  size_t len = 0;
+  if (mbedtls_base64_encode(encoded, sizeof(encoded), &len, (const unsigned char *)userpass.c_str(), userpass.length()) != 0) {
+    return false;
+  }
+  encoded[len] = 0;
+  return auth.substring(6).equals((const char *)encoded);
+}
+
+void HTTP_ENGINE::requestAuthentication(void) {
+  sendHeader("WWW-Authenticate", "Basic realm=\"Login Required\"");
+  send(401, TEXTPAGETYPE, "<html><body>401 Unauthorized</body></html>");
+}
+
+// ----------------------------------------------------------------------
+// The client of the request, for handlers that write the reply
+// themselves instead of queueing one. Anything queued is given to the
+// socket first, without waiting
+// ----------------------------------------------------------------------
+WiFiClient &HTTP_ENGINE::client(void) {
+  static WiFiClient none;
+  if (_current == NULL) {
+    return none;
+  }
+  push(*_current);
+  return _current->client;
+}
+
+
+// ----------------------------------------------------------------------
+// Reply, only the first send() of a request is used
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::setContentLength(size_t len) {
+  _contentlength = len;
+}
+
+void HTTP_ENGINE::sendHeader(const String &name, const String &value, bool first) {
+  String line = name + ": " + value + "\r\n";
+  if (first) {
+    _replyheaders = line + _replyheaders;
+  } else {
+    _replyheaders += line;
+  }
+}
+
+void HTTP_ENGINE::send(int code, const char *contenttype, const String &content) {
+  if ((_current == NULL) || _current->responded) {
+    return;
+  }
+  queue_head(code, (contenttype != NULL) ? contenttype : "", content.length());
+  if (content.length() > 0) {
+    sendContent(content.c_str(), content.length());
+  }
+}
+
+// the data is sent from where it is, done is called when it is no longer needed
+void HTTP_ENGINE::send_P(int code, const char *contenttype, const char *content, size_t len, Http_Release done) {
+  if ((_current == NULL) || _current->responded) {
+    if (done != NULL) {
+      done((const uint8_t *)content);
+    }
+    return;
+  }
+  queue_head(code, contenttype, len);
+  if (_current->chunked || (len == 0)) {
+    // setContentLength(CONTENT_LENGTH_UNKNOWN), a chunk is copied
+    sendContent(content, len);
+    if (done != NULL) {
+      done((const uint8_t *)content);
+    }
+    return;
+  }
+  _current->data = (const uint8_t *)content;
+  _current->datalen = len;
+  _current->datapos = 0;
+  _current->datadone = done;
+}
+
+size_t HTTP_ENGINE::streamFile(File &file, const String &contenttype, int code) {
+  if ((_current == NULL) || _current->responded) {
+    return 0;
+  }
+  size_t size = file.size();
+  _current->file = file;
+  _current->sendfile = true;
+  queue_head(code, contenttype, size);
+  return size;
+}
+
+Print &HTTP_ENGINE::content(void) {
+  return _content;
+}
+
+// ----------------------------------------------------------------------
+// Body after send(), as a chunk when the length is unknown. An empty
+// chunk ends the reply
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::sendContent(const char *content, size_t len) {
+  if ((_current == NULL) || (_current->responded == false)) {
+    return;
+  }
+  Http_Conn &c = *_current;
+  if ((c.data != NULL) || c.sendfile) {
+    // the body is the send_P() data or the file
+    return;
+  }
+  if (c.chunked == false) {
+    queue(c, (const uint8_t *)content, len);
+    return;
+  }
+  char size[12];
+  int n = snprintf(size, sizeof(size), "%x\r\n", (unsigned int)len);
+  queue(c, (const uint8_t *)size, n);
+  queue(c, (const uint8_t *)content, len);
+  queue(c, (const uint8_t *)"\r\n", 2);
+  if (len == 0) {
+    c.chunked = false;
+  }
+}
+
+size_t HTTP_CONTENT::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HTTP_CONTENT::write(const uint8_t *data, size_t len) {
+  if ((_engine->_current == NULL) || (len == 0)) {
+    return 0;
+  }
+  _engine->sendContent((const char *)data, len);
+  return len;
+}
+
+void HTTP_ENGINE::queue_head(int code, const String &contenttype, size_t len) {
+  if (_contentlength != CONTENT_LENGTH_NOT_SET) {
+    len = _contentlength;
+  }
+  String head;
+  head.reserve(128 + _replyheaders.length());
+  head = "HTTP/1.1 " + String(code) + " " + status_text(code) + "\r\n";
+  if (contenttype.length() > 0) {
+    head += "Content-Type: " + contenttype + "\r\n";
+  }
+  if (len != CONTENT_LENGTH_UNKNOWN) {
+    head += "Content-Length: " + String((unsigned long)len) + "\r\n";
+  } else if (_current->sendfile == false) {
+    head += "Transfer-Encoding: chunked\r\n";
+    _current->chunked = true;
+  }
+  head += _replyheaders;
+  head += "Connection: close\r\n\r\n";
+  _current->responded = true;
+  queue(*_current, (const uint8_t *)head.c_str(), head.length());
+}
+
+// room for len more bytes in the reply queue, bytes already sent are
+// dropped first. The queue grows in steps of HTTPSENDCHUNK
+bool HTTP_ENGINE::reserve(Http_Conn &c, size_t len) {
+  if (c.outpos > 0) {
+    memmove(c.out, c.out + c.outpos, c.outlen - c.outpos);
+    c.outlen -= c.outpos;
+    c.outpos = 0;
+  }
+  if ((c.outlen + len) <= c.outsize) {
+    return true;
+  }
+  size_t size = ((c.outlen + len + HTTPSENDCHUNK - 1) / HTTPSENDCHUNK) * HTTPSENDCHUNK;
+  uint8_t *buf = (uint8_t *)realloc(c.out, size);
+  if (buf == NULL) {
+    debug_server_println("-http no memory for reply");
+    return false;
+  }
+  c.out = buf;
+  c.outsize = size;
+  return true;
+}
+
+// ----------------------------------------------------------------------
+// Add to the reply. Every HTTPSENDCHUNK bytes the queue is given to the
+// socket, what it does not take stays queued for send_queued()
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::queue(Http_Conn &c, const uint8_t *data, size_t len) {
+  while ((len > 0) && (c.broken == false)) {
+    size_t n = len;
+    size_t queued = c.outlen - c.outpos;
+    if ((queued < HTTPSENDCHUNK) && ((queued + n) > HTTPSENDCHUNK)) {
+      n = HTTPSENDCHUNK - queued;
+    }
+    if (reserve(c, n) == false) {
+      c.broken = true;
+      return;
+    }
+    memcpy(c.out + c.outlen, data, n);
+    c.outlen += n;
+    data += n;
+    len -= n;
+    if ((c.outlen - c.outpos) >= HTTPSENDCHUNK) {
+      push(c);
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+// Give the queue to the socket, as much as it takes without waiting. A
+// socket error marks the connection broken, send_queued() releases it
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::push(Http_Conn &c) {
+  while ((c.outpos < c.outlen) && (c.broken == false)) {
+    int n = lwip_send(c.client.fd(), c.out + c.outpos, c.outlen - c.outpos, MSG_DONTWAIT);
+    if (n > 0) {
+      c.outpos += n;
+      c.time = millis();
+    } else if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+      return;  // socket full
+    } else {
+      c.broken = true;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+// The send_P() data is no longer needed
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::end_data(Http_Conn &c) {
+  if ((c.data != NULL) && (c.datadone != NULL)) {
+    c.datadone(c.data);
+  }
+  c.data = NULL;
+  c.datalen = 0;
+  c.datapos = 0;
+  c.datadone = NULL;
+}
+
+// ----------------------------------------------------------------------
+// Send as much of the reply as the socket takes without waiting, the
+// queue, then the send_P() data or the file. The connection is closed
+// when all is sent
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::send_queued(Http_Conn &c) {
+  while (true) {
+    push(c);
+    if (c.broken) {
+      release(c);
+      return;
+    }
+    if (c.outpos < c.outlen) {
+      return;  // socket full, try again next loop
+    }
+
+    if (c.data != NULL) {
+      if (c.datapos == c.datalen) {
+        end_data(c);
+        continue;
+      }
+      int n = lwip_send(c.client.fd(), c.data + c.datapos, c.datalen - c.datapos, MSG_DONTWAIT);
+      if (n > 0) {
+        c.datapos += n;
+        c.time = millis();
+        continue;
+      }
+      if ((n < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+        return;
+      }
+      release(c);
+      return;
+    }
+
+    if (c.sendfile) {
+      // next part of the file, through the queue
+      if (reserve(c, HTTPSENDCHUNK) == false) {
+        release(c);
+        return;
+      }
+      int n = c.file.read(c.out, HTTPSENDCHUNK);
+      if (n <= 0) {
+        c.sendfile = false;
+        continue;
+      }
+      c.outlen = n;
+      continue;
+    }
+
+    if (c.drain) {
+      lwip_shutdown(c.client.fd(), SHUT_WR);
+      c.state = Conn_Drain;
+      c.time = millis();
+      return;
+    }
+    release(c);
+    return;
+  }
+}
+
+// ----------------------------------------------------------------------
+// Error reply without a handler, upload in progress is aborted
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::send_error(Http_Conn &c, int code) {
+  debug_server_print("-http error ");
+  debug_server_println(code);
+  if ((c.state == Conn_Upload) && c.isfile) {
+    upload_event(c, UPLOAD_FILE_ABORTED);
+    c.isfile = false;
+  }
+  free_request(c);
+  _current = &c;
+  _replyheaders = String();
+  _contentlength = CONTENT_LENGTH_NOT_SET;
+  c.responded = false;
+  c.drain = true;
+  send(code, PLAINTEXTPAGETYPE, status_text(code));
+  _current = NULL;
+  c.state = Conn_Send;
+  c.time = millis();
+  send_queued(c);
+}
+
+// ----------------------------------------------------------------------
+// After an error reply, read and drop the rest of the request until the
+// client closes. Closing with unread data would reset the connection and
+// the client might not see the reply
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::drain(Http_Conn &c) {
+  uint8_t buf[128];
+  while (c.client.available() > 0) {
+    if (c.client.read(buf, sizeof(buf)) <= 0) {
+      break;
+    }
+  }
+  if (!c.client.connected() || ((millis() - c.time) > HTTPDRAINTIME)) {
+    release(c);
+  }
+}
+
+// ----------------------------------------------------------------------
+// Free what is only needed while receiving the request
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::free_request(Http_Conn &c) {
+  free(c.head);
+  c.head = NULL;
+  free(c.part);
+  c.part = NULL;
+  delete c.upload;
+  c.upload = NULL;
+  delete[] c.args;
+  c.args = NULL;
+  c.argcount = 0;
+  c.handler = NULL;
+  c.uri = String();
+  c.body = String();
+  c.boundary = String();
+  c.fieldname = String();
+  c.fieldvalue = String();
+  for (int i = 0; i <= HTTPMAXHEADERS; i++) {
+    c.headers[i] = String();
+  }
+}
+
+// ----------------------------------------------------------------------
+// Close the connection. A copy of the client made by a handler, eg
+// STATUS_EVENTS, keeps the socket open
+// ----------------------------------------------------------------------
+void HTTP_ENGINE::release(Http_Conn &c) {
+  if ((c.state == Conn_Upload) && c.isfile) {
+    upload_event(c, UPLOAD_FILE_ABORTED);
+    c.isfile = false;
+  }
+  free_request(c);
+  free(c.out);
+  c.out = NULL;
+  c.outsize = 0;
+  c.outlen = 0;
+  c.outpos = 0;
+  c.broken = false;
+  end_data(c);
+  if (c.sendfile) {
+    c.file.close();
+    c.sendfile = false;
+  }
+  c.file = File();
+  c.client = WiFiClient();
+  c.site = NULL;
+  c.state = Conn_Free;
+}
+
+
+// ----------------------------------------------------------------------
+// SERVER
+// ----------------------------------------------------------------------
+HTTP_SERVER::HTTP_SERVER(int port, HTTP_ENGINE *engine) {
+  _port = port;
+  _ownengine = (engine == NULL);
+  _engine = _ownengine ? new HTTP_ENGINE() : engine;
+}
+
+HTTP_SERVER::~HTTP_SERVER() {
+  stop();
+  if (_ownengine) {
+    delete _engine;
+  }
+  while (_handlers != NULL) {
+    Http_Handler *next = _handlers->next;
+    delete _handlers;
+    _handlers = next;
+  }
+}
+
+void HTTP_SERVER::begin(void) {
+  _running = _engine->add_site(this);
+  if (_running == false) {
+    debug_server_println("-http no room for server");
+  }
+}
+
+void HTTP_SERVER::stop(void) {
+  if (_running) {
+    _engine->remove_site(this);
+    _running = false;
+  }
+}
+
+void HTTP_SERVER::handleClient(void) {
+  if (_ownengine) {
+    _engine->handleClient();
+  }
+}
+
+void HTTP_SERVER::on(const String &uri, THandlerFunction fn) {
+  on(uri, HTTP_ANY, fn, NULL);
+}
+
+void HTTP_SERVER::on(const String &uri, HTTPMethod method, THandlerFunction fn) {
+  on(uri, method, fn, NULL);
+}
+
+void HTTP_SERVER::on(const String &uri, HTTPMethod method, THandlerFunction fn, THandlerFunction ufn) {
+  Http_Handler *h = new Http_Handler;
+  h->uri = uri;
+  h->method = method;
+  h->fn = fn;
+  h->ufn = ufn;
+  h->next = NULL;
+  // first added is found first, as WebServer
+  if (_lasthandler == NULL) {
+    _handlers = h;
+  } else {
+    _lasthandler->next = h;
+  }
+  _lasthandler = h;
+}
+
+void HTTP_SERVER::onNotFound(THandlerFunction fn) {
+  _notfound = fn;
+}
+
+Http_Handler *HTTP_SERVER::find_handler(const String &uri, HTTPMethod method) {
+  for (Http_Handler *h = _handlers; h != NULL; h = h->next) {
+    if (((h->method == HTTP_ANY) || (h->method == method)) && h->uri.equals(uri)) {
+      return h;
+    }
+  }
+  return NULL;
+}
+
+void HTTP_SERVER::collectHeaders(const char *keys[], size_t count) {
+  _engine->collectHeaders(keys, count);
+}
+
+String HTTP_SERVER::uri(void) {
+  return _engine->uri();
+}
+
+HTTPMethod HTTP_SERVER::method(void) {
+  return _engine->method();
+}
+
+String HTTP_SERVER::arg(const String &name) {
+  return _engine->arg(name);
+}
+
+String HTTP_SERVER::arg(int i) {
+  return _engine->arg(i);
+}
+
+String HTTP_SERVER::argName(int i) {
+  return _engine->argName(i);
+}
+
+int HTTP_SERVER::args(void) {
+  return _engine->args();
+}
+
+bool HTTP_SERVER::hasArg(const String &name) {
+  return _engine->hasArg(name);
+}
+
+String HTTP_SERVER::header(const String &name) {
+  return _engine->header(name);
+}
+
+bool HTTP_SERVER::authenticate(const char *username, const char *password) {
+  return _engine->authenticate(username, password);
+}
+
+void HTTP_SERVER::requestAuthentication(void) {
+  _engine->requestAuthentication();
+}
+
+HTTPUpload &HTTP_SERVER::upload(void) {
+  return _engine->upload();
+}
+
+WiFiClient &HTTP_SERVER::client(void) {
+  return _engine->client();
+}
+
+void HTTP_SERVER::setContentLength(size_t len) {
+  _engine->setContentLength(len);
+}
+
+void HTTP_SERVER::sendHeader(const String &name, const String &value, bool first) {
+  _engine->sendHeader(name, value, first);
+}
+
+void HTTP_SERVER::send(int code, const char *contenttype, const String &content) {
+  _engine->send(code, contenttype, content);
+}
+
+void HTTP_SERVER::send(int code, const String &contenttype, const String &content) {
+  _engine->send(code, contenttype.c_str(), content);
+}
+
+void HTTP_SERVER::send_P(int code, const char *contenttype, const char *content, size_t len, Http_Release done) {
+  _engine->send_P(code, contenttype, content, len, done);
+}
+
+size_t HTTP_SERVER::streamFile(File &file, const String &contenttype, int code) {
+  return _engine->streamFile(file, contenttype, code);
+}
+
+void HTTP_SERVER::sendContent(const String &content) {
+  _engine->sendContent(content.c_str(), content.length());
+}
+
+void HTTP_SERVER::sendContent(const char *content, size_t len) {
+  _engine->sendContent(content, len);
+}
+
+Print &HTTP_SERVER::content(void) {
+  return _engine->content();
+}
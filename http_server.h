@@ -0,0 +1,305 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HTTP SERVER
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// http_server.h
+// ----------------------------------------------------------------------
+
+#if !defined(_http_server_h)
+#define _http_server_h
+
+#include <Arduino.h>
+#include <functional>
+#include "FS.h"
+#include <WiFiServer.h>
+#include <WiFiClient.h>
+#include <WebServer.h>  // HTTPMethod, HTTPUpload
+
+#define HTTPCONNECTIONS 4      // connections in progress at once, for each engine
+#define HTTPSITES 3            // servers sharing one engine
+#define HTTPLISTENERS 3        // ports of one engine
+#define HTTPHEADLEN 1024       // request line and headers
+#define HTTPBODYLEN 4096       // largest form or json body, uploads are not limited
+#define HTTPMAXARGS 40
+#define HTTPMAXHEADERS 4       // headers kept with collectHeaders(), plus Authorization
+#define HTTPPARTLEN 1536       // multipart upload buffer
+#define HTTPSENDCHUNK 1024     // reply bytes queued before they are given to the socket, file bytes read per write
+#define HTTPTIMEOUT 5000       // ms to receive a whole request
+#define HTTPSENDTIMEOUT 10000  // ms with no progress sending a response
+#define HTTPDRAINTIME 1000     // ms to read the rest of a request after an error reply
+
+
+// ----------------------------------------------------------------------
+// CONNECTION
+// ----------------------------------------------------------------------
+enum Http_Conn_States {
+  Conn_Free,
+  Conn_Head,    // receiving request line and headers
+  Conn_Body,    // receiving a form or json body
+  Conn_Upload,  // receiving a multipart upload, passed to the upload handler as it arrives
+  Conn_Send,    // response queued, sending as the socket accepts it
+  Conn_Drain    // error sent before the whole request was read, read the rest so the reply is not lost to a reset
+};
+
+enum Http_Part_States {
+  Part_Wait,     // another upload is in progress, the body is left unread
+  Part_Start,    // looking for the first boundary
+  Part_Headers,  // headers of a part
+  Part_Data,     // data of a part, up to the next boundary
+  Part_Next,     // after a boundary, "--" is the end
+  Part_End
+};
+
+struct Http_Arg {
+  String name;
+  String value;
+};
+
+struct Http_Handler {
+  String uri;
+  HTTPMethod method;
+  std::function<void(void)> fn;
+  std::function<void(void)> ufn;  // upload, called for each part of a file as it arrives
+  Http_Handler *next;
+};
+
+class HTTP_SERVER;
+
+// called when the data of send_P() has been sent, or the reply dropped
+typedef void (*Http_Release)(const uint8_t *);
+
+struct Http_Conn {
+  WiFiClient client;
+  int port;           // listener the client connected to
+  HTTP_SERVER *site;  // server whose routes handle the request
+  Http_Conn_States state;
+  unsigned long time;  // accept time, then time of last progress while sending
+
+  // request
+  char *head;
+  size_t headlen;
+  HTTPMethod method;
+  String uri;
+  String query;
+  String headers[HTTPMAXHEADERS + 1];
+  String body;
+  size_t bodylen;  // bytes of the body still to receive
+  Http_Arg *args;
+  int argcount;
+  Http_Handler *handler;
+  bool urlencoded;  // form fields in the body
+
+  // multipart upload
+  HTTPUpload *upload;
+  uint8_t *part;
+  size_t partlen;
+  String boundary;
+  String fieldname;   // part that is not a file, added to the args
+  String fieldvalue;
+  Http_Part_States partstate;
+  bool isfile;
+
+  // response, headers and body waiting to be sent
+  bool responded;
+  bool chunked;  // Transfer-Encoding: chunked, until sendContent("")
+  bool drain;    // request not read to the end
+  bool broken;   // the socket failed, the reply is dropped
+  uint8_t *out;
+  size_t outsize;
+  size_t outlen;
+  size_t outpos;
+  const uint8_t *data;  // send_P(), sent from where it is after out
+  size_t datalen;
+  size_t datapos;
+  Http_Release datadone;
+  File file;  // streamFile(), sent after out
+  bool sendfile;
+};
+
+
+// ----------------------------------------------------------------------
+// A port the engine listens on, shared by the servers that use it
+// ----------------------------------------------------------------------
+struct Http_Listener {
+  WiFiServer *server;
+  int port;
+  int users;
+};
+
+
+// ----------------------------------------------------------------------
+// Reply body written with print(), eg HTML_TEMPLATE::render()
+// ----------------------------------------------------------------------
+class HTTP_ENGINE;
+
+class HTTP_CONTENT : public Print {
+public:
+  HTTP_CONTENT(HTTP_ENGINE *engine)
+    : _engine(engine) {}
+  size_t write(uint8_t);
+  size_t write(const uint8_t *, size_t);
+
+private:
+  HTTP_ENGINE *_engine;
+};
+
+
+// ----------------------------------------------------------------------
+// HTTP_ENGINE Class
+// Listens, reads requests and sends replies for one or more HTTP_SERVERs.
+// WebServer reads and answers one connection at a time and waits inside
+// handleClient() for slow clients. HTTP_ENGINE keeps HTTPCONNECTIONS
+// connections, each loop() it reads what has arrived on each one and
+// calls the handler when a request is complete. send() and content()
+// queue the reply. Each time HTTPSENDCHUNK bytes are queued they are
+// given to the socket, the queue only grows by what the socket cannot
+// take yet. send_P() and streamFile() are not copied, they are sent from
+// the data or the file as the socket accepts them. Nothing waits for the
+// client, the rest of a reply is sent by later loops.
+// A handler that writes to client() itself does so instead of queueing a
+// reply.
+// A reply of unknown length is sent chunked, setContentLength(
+// CONTENT_LENGTH_UNKNOWN), send(code, type, "") then sendContent() or
+// content().
+// A request that takes longer than HTTPTIMEOUT, or a reply that makes no
+// progress for HTTPSENDTIMEOUT, is closed.
+// One multipart upload at a time, a second waits until the first ends.
+// Responses are Connection: close. Basic authentication only
+// ----------------------------------------------------------------------
+class HTTP_ENGINE {
+public:
+  HTTP_ENGINE(void);
+  ~HTTP_ENGINE();
+  void handleClient(void);
+  bool add_site(HTTP_SERVER *);
+  void remove_site(HTTP_SERVER *);
+  void collectHeaders(const char *[], size_t);
+
+  // request being handled
+  String uri(void);
+  HTTPMethod method(void);
+  String arg(const String &);
+  String arg(int);
+  String argName(int);
+  int args(void);
+  bool hasArg(const String &);
+  String header(const String &);
+  bool authenticate(const char *, const char *);
+  void requestAuthentication(void);
+  HTTPUpload &upload(void);
+  WiFiClient &client(void);
+
+  // reply
+  void setContentLength(size_t);
+  void sendHeader(const String &, const String &, bool = false);
+  void send(int, const char * = NULL, const String & = String());
+  void send_P(int, const char *, const char *, size_t, Http_Release = NULL);
+  size_t streamFile(File &, const String &, int = 200);
+  Print &content(void);
+  void sendContent(const char *, size_t);
+
+private:
+  friend class HTTP_CONTENT;
+
+  void accept_clients(void);
+  void read_head(Http_Conn &);
+  int parse_head(Http_Conn &);
+  void find_route(Http_Conn &);
+  void read_body(Http_Conn &);
+  void read_upload(Http_Conn &);
+  bool parse_parts(Http_Conn &);
+  bool part_start(Http_Conn &, const char *);
+  void part_data(Http_Conn &, const uint8_t *, size_t);
+  void part_end(Http_Conn &);
+  void upload_event(Http_Conn &, HTTPUploadStatus);
+  void add_arg(Http_Conn &, const String &, const String &);
+  void parse_args(Http_Conn &, const String &);
+  void dispatch(Http_Conn &);
+  bool reserve(Http_Conn &, size_t);
+  void queue(Http_Conn &, const uint8_t *, size_t);
+  void queue_head(int, const String &, size_t);
+  void send_queued(Http_Conn &);
+  void push(Http_Conn &);
+  void end_data(Http_Conn &);
+  void send_error(Http_Conn &, int);
+  void drain(Http_Conn &);
+  void free_request(Http_Conn &);
+  void release(Http_Conn &);
+
+  Http_Conn _conns[HTTPCONNECTIONS];
+  Http_Listener _listeners[HTTPLISTENERS];
+  HTTP_SERVER *_sites[HTTPSITES];
+  int _nextlistener = 0;       // accept from each port in turn
+  Http_Conn *_current = NULL;  // connection whose handler is running
+  String _headerkeys[HTTPMAXHEADERS + 1];
+  int _headercount = 1;
+  String _replyheaders;  // sendHeader() for the reply being made
+  size_t _contentlength;
+  HTTP_CONTENT _content;
+};
+
+
+// ----------------------------------------------------------------------
+// HTTP_SERVER Class
+// Replaces the Arduino WebServer for the Web, Management and ASCOM servers,
+// with the same handler functions and request/reply calls. Each server
+// has its routes and port. It runs on its own HTTP_ENGINE, or on a shared
+// one given to the constructor, see ENABLE_SHAREDHTTP. Servers on a shared
+// engine with the same port are told apart by their routes, the first
+// server started gets requests that match no route
+// ----------------------------------------------------------------------
+class HTTP_SERVER {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  HTTP_SERVER(int, HTTP_ENGINE * = NULL);  // port, shared engine or NULL
+  ~HTTP_SERVER();
+  void begin(void);
+  void stop(void);
+  void handleClient(void);  // does nothing on a shared engine, it is polled once for all servers
+
+  void on(const String &, THandlerFunction);
+  void on(const String &, HTTPMethod, THandlerFunction);
+  void on(const String &, HTTPMethod, THandlerFunction, THandlerFunction);
+  void onNotFound(THandlerFunction);
+  void collectHeaders(const char *[], size_t);
+
+  // request being handled, from the engine
+  String uri(void);
+  HTTPMethod method(void);
+  String arg(const String &);
+  String arg(int);
+  String argName(int);
+  int args(void);
+  bool hasArg(const String &);
+  String header(const String &);
+  bool authenticate(const char *, const char *);
+  void requestAuthentication(void);
+  HTTPUpload &upload(void);
+  WiFiClient &client(void);
+
+  // reply, to the engine
+  void setContentLength(size_t);
+  void sendHeader(const String &, const String &, bool = false);
+  void send(int, const char * = NULL, const String & = String());
+  void send(int, const String &, const String &);
+  void send_P(int, const char *, const char *, size_t, Http_Release = NULL);  // not copied, keep data until release
+  size_t streamFile(File &, const String &, int = 200);  // the file is sent later, do not close it
+  Print &content(void);                                   // body after send(code, type, "")
+  void sendContent(const String &);                       // a chunk after setContentLength(CONTENT_LENGTH_UNKNOWN)
+  void sendContent(const char *, size_t);                 // and send(code, type, ""), "" is the last chunk
+
+private:
+  friend class HTTP_ENGINE;
+  Http_Handler *find_handler(const String &, HTTPMethod);
+
+  HTTP_ENGINE *_engine;
+  bool _ownengine;
+  bool _running = false;
+  int _port;
+  Http_Handler *_handlers = NULL;
+  Http_Handler *_lasthandler = NULL;
+  THandlerFunction _notfound = NULL;
+};
+
+
+#endif  // #if !defined(_http_server_h)
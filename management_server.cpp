@@ -16,7 +16,12 @@
 // Benoit Blanchon https://github.com/bblanchon/ArduinoJson
 #include <ArduinoJson.h>
 #include "SPIFFS.h"
-#include <WebServer.h>
+#include "http_server.h"
+extern HTTP_ENGINE *httpengine;
+#include "html_template.h"
+#include "file_server.h"
+#include "file_cache.h"
+extern FILE_CACHE *filecache;
 
 
 // ---------------------------------------------------------------------
@@ -57,7 +62,11 @@ extern TCPIP_SERVER *tcpipsrvr;
 // Temperature probe
 #include "temp_probe.h"
 extern TEMP_PROBE *tempprobe;
-extern float temp;
+
+// Focuser state snapshot
+#include "focuser_state.h"
+extern FOCUSER_STATE *focuserstate;
+extern void publish_focuser_state(void);
 
 // Web Server
 #include "web_server.h"
@@ -136,6 +145,8 @@ extern portMUX_TYPE halt_alertMux;
 // ----------------------------------------------------------------------
 // Page refresh time following a Management service reboot page time (s) between next page refresh
 #define MAXSIZECUSTOMBRD 300
+// POST /config body, about the size of cntlr_config.jsn
+#define CONFIGPOSTSIZE 3072
 // temporary page when reboot occurs
 #define RebootStr "<html><meta http-equiv=refresh content=15; url=/\"><head><title>Management Server></title></head><body><p>Please wait, controller rebooting.</p></body></html>"
 // reboot button, each admin page
@@ -615,6 +626,11 @@ void ms_handleset() {
   mngsrvr->handleset();
 }
 
+// many settings in one request: JSON
+void ms_postconfig() {
+  mngsrvr->postconfig();
+}
+
 // Driver Board management
 void msget_brdedit() {
   brdedit_type = GeT;
@@ -647,6 +663,14 @@ void ms_gettargetposition() {
   mngsrvr->gettargetposition();
 }
 
+void ms_getevents() {
+  mngsrvr->getevents();
+}
+
+void ms_getstatus() {
+  mngsrvr->getstatus();
+}
+
 //void ms_reboot()
 //{
 //  mngsrvr->reboot();
@@ -679,7 +703,7 @@ bool MANAGEMENT_SERVER::start(unsigned long port) {
 
   // check if server already created, if not, create one
   if (this->_loaded == false) {
-    mserver = new WebServer(this->_port);
+    mserver = new HTTP_SERVER(this->_port, httpengine);
   }
 
   // admin pages
@@ -708,6 +732,8 @@ bool MANAGEMENT_SERVER::start(unsigned long port) {
   mserver->on("/po", ms_getposition);
   mserver->on("/im", ms_getismoving);
   mserver->on("/ta", ms_gettargetposition);
+  mserver->on("/events", HTTP_GET, ms_getevents);
+  mserver->on("/status", HTTP_GET, ms_getstatus);
 
   // file handling pages
   mserver->on("/delete", HTTP_GET, ms_deletefile);
@@ -727,6 +753,8 @@ bool MANAGEMENT_SERVER::start(unsigned long port) {
   mserver->on("/get", ms_handleget);
   // generic set function
   mserver->on("/set", ms_handleset);
+  // set many settings, one save
+  mserver->on("/config", HTTP_POST, ms_postconfig);
   // driver board management
   mserver->on("/brdedit", HTTP_GET, msget_brdedit);
   mserver->on("/brdedit", HTTP_POST, mspost_brdedit);
@@ -745,15 +773,15 @@ bool MANAGEMENT_SERVER::start(unsigned long port) {
 
   // start elegant ota
 #if defined(ENABLE_ELEGANTOTA)
-  char buff[32];
   debug_server_print(T_OTA);
   debug_server_println(T_START);
-  ControllerData->get_ota_id().toCharArray(buff, ControllerData->get_ota_id().length() + 1);
-  ElegantOTA.setID(buff); // removed since no ".setID(buf)" defined -> MN
-  ElegantOTA.begin(mserver, OTAName, OTAPassword);
+  ElegantOTA.setID(ControllerData->get_ota_id()); // removed since no ".setID(buf)" defined -> MN
+  _otaserver = new WebServer(this->_port + OTASERVERPORTOFFSET);
+  ElegantOTA.begin(_otaserver, OTAName, OTAPassword);
+  _otaserver->begin();
   ota_status = V_RUNNING;
-  // Elegant OTA cannot be stopped
 #endif
+  file_headers(mserver);
   mserver->begin();
   this->_loaded = true;
   this->_state = V_RUNNING;
@@ -768,11 +796,14 @@ void MANAGEMENT_SERVER::stop(void) {
   debug_server_print(T_MANAGEMENTSERVER);
   debug_server_println(T_STOP);
   if (this->_loaded == true) {
+    _events.stop();
     mserver->stop();
     delete mserver;
     this->_loaded = false;
     this->_state = V_STOPPED;
 #if defined(ENABLE_ELEGANTOTA)
+    _otaserver->stop();
+    delete _otaserver;
     ota_status = V_STOPPED;
 #endif
   }
@@ -789,6 +820,10 @@ void MANAGEMENT_SERVER::loop(bool parked) {
   }
   _parkstate = parked;
   mserver->handleClient();
+  _events.loop(parked);
+#if defined(ENABLE_ELEGANTOTA)
+  _otaserver->handleClient();
+#endif
 }
 
 // ----------------------------------------------------------------------
@@ -799,23 +834,8 @@ bool MANAGEMENT_SERVER::handlefileread(String path) {
   debug_server_print(T_MS);
   debug_server_print(T_READFILE);
   debug_server_println(path);
-  if (path.endsWith("/")) {
-    // if a folder is requested, send the index file
-    path += "index.html";
-  }
-  // get the MIME type
-  String contentType = get_contenttype(path);
-  // if the file exists
-  if (SPIFFS.exists(path)) {
-    File file = SPIFFS.open(path, "r");
-    // send it to the client
-    mserver->streamFile(file, contentType);
-    file.close();
-    return true;
-  } else {
-    // resource does not exist
-    return false;
-  }
+  // send the file, gzip and ETag in file_server.cpp
+  return send_file(mserver, path);
 }
 
 // ----------------------------------------------------------------------
@@ -825,8 +845,7 @@ void MANAGEMENT_SERVER::file_sys_error(void) {
   // spiffs not started
   debug_server_print(T_MS);
   debug_server_println(T_ERRORFILESYSTEM);
-  send_myheader();
-  send_mycontent(H_FSNOTLOADEDSTR);
+  mserver->send(NORMALWEBPAGE, TEXTPAGETYPE, H_FSNOTLOADEDSTR);
 }
 
 // ----------------------------------------------------------------------
@@ -849,6 +868,14 @@ bool MANAGEMENT_SERVER::check_access(void) {
   }
 }
 
+// ----------------------------------------------------------------------
+// Reply header for a page, the page follows with render(mserver->content())
+// ----------------------------------------------------------------------
+void MANAGEMENT_SERVER::send_myheader(size_t len) {
+  mserver->setContentLength(len);
+  mserver->send(NORMALWEBPAGE, TEXTPAGETYPE, "");
+}
+
 // ----------------------------------------------------------------------
 // Send a redirect pg to client
 // ----------------------------------------------------------------------
@@ -865,26 +892,6 @@ void MANAGEMENT_SERVER::send_json(String str) {
   mserver->send(NORMALWEBPAGE, JSONPAGETYPE, str);
 }
 
-// ----------------------------------------------------------------------
-// convert the file extension to the MIME type
-// ----------------------------------------------------------------------
-String MANAGEMENT_SERVER::get_contenttype(String filename) {
-  String retval = "text/plain";
-  if (filename.endsWith(".html")) {
-    retval = "text/html";
-  } else if (filename.endsWith(".css")) {
-    retval = "text/css";
-  } else if (filename.endsWith(".js")) {
-    retval = "application/javascript";
-  } else if (filename.endsWith(".json")) {
-    retval = "text/json";
-  } else if (filename.endsWith(".ico")) {
-    retval = "image/x-icon";
-  }
-  //retval = "application/octet-stream";
-  return retval;
-}
-
 // ----------------------------------------------------------------------
 // check if digit is hex
 // ----------------------------------------------------------------------
@@ -905,11 +912,9 @@ bool MANAGEMENT_SERVER::is_hexdigit(char c) {
 // Handler for /admin1
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin1(void) {
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/admin1.html");
   String msg;
 
-  AdminPg.reserve(6100);  // 306-05   5840
-
   debug_server_println(T_ADMIN1);
 
   if (!check_access()) {
@@ -1153,11 +1158,7 @@ void MANAGEMENT_SERVER::getadmin1(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin1.html")) {
-    File file = SPIFFS.open("/admin1.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -1276,27 +1277,22 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_ADMIN1);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 // ----------------------------------------------------------------------
 // Handler for /admin2
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin2(void) {
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/admin2.html");
   String msg;
 
-  AdminPg.reserve(4300);  // 306-03    4121
-
   debug_server_println(T_ADMIN2);
 
   if (!check_access()) {
@@ -1313,7 +1309,7 @@ void MANAGEMENT_SERVER::getadmin2(void) {
     if (msg != "") {
       String dom = mserver->arg("ddomain");
       if (dom != "") {
-        ControllerData->set_duckdns_domain(dom);
+        ControllerData->set_duckdns_domain(dom.c_str());
       }
       goto Get_Handler;
     }
@@ -1323,7 +1319,7 @@ void MANAGEMENT_SERVER::getadmin2(void) {
     if (msg != "") {
       String dtok = mserver->arg("dtoken");
       if (dtok != "") {
-        ControllerData->set_duckdns_token(dtok);
+        ControllerData->set_duckdns_token(dtok.c_str());
       }
       goto Get_Handler;
     }
@@ -1345,7 +1341,7 @@ void MANAGEMENT_SERVER::getadmin2(void) {
     if (msg != "") {
       String dom = mserver->arg("otaname");
       if (dom != "") {
-        ControllerData->set_ota_name(dom);
+        ControllerData->set_ota_name(dom.c_str());
       }
       goto Get_Handler;
     }
@@ -1355,7 +1351,7 @@ void MANAGEMENT_SERVER::getadmin2(void) {
     if (msg != "") {
       String dom = mserver->arg("otapwd");
       if (dom != "") {
-        ControllerData->set_ota_password(dom);
+        ControllerData->set_ota_password(dom.c_str());
       }
       goto Get_Handler;
     }
@@ -1365,7 +1361,7 @@ void MANAGEMENT_SERVER::getadmin2(void) {
     if (msg != "") {
       String dom = mserver->arg("otaida");
       if (dom != "") {
-        ControllerData->set_ota_id(dom);
+        ControllerData->set_ota_id(dom.c_str());
       }
       goto Get_Handler;
     }
@@ -1373,10 +1369,7 @@ void MANAGEMENT_SERVER::getadmin2(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin2.html")) {
-    File file = SPIFFS.open("/admin2.html", "r");
-    AdminPg = file.readString();
-    file.close();
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -1445,15 +1438,12 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
   debug_server_print(T_ADMIN2);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 
@@ -1462,9 +1452,7 @@ Get_Handler:
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin3(void) {
   // get admin pg 3 and send to client
-  String AdminPg;
-
-  AdminPg.reserve(6900);  // 306-02 6672
+  static HTML_TEMPLATE AdminPg("/admin3.html");
 
   debug_server_println(T_ADMIN3);
 
@@ -1610,14 +1598,11 @@ void MANAGEMENT_SERVER::getadmin3(void) {
     msg = mserver->arg("setpat");
     if (msg != "") {
       String ti = mserver->arg("pat");
-      int pt = ti.toInt();
-      // range check 30s to 300s (5m)
-      pt = (pt < 30) ? 30 : pt;
-      pt = (pt > 300) ? 300 : pt;
-      ControllerData->set_parktime(pt);
+      // range checked by the setter, 30s to 300s (5m)
+      ControllerData->set_parktime(ti.toInt());
       // update park_maxcount
       portENTER_CRITICAL(&parkMux);
-      park_maxcount = pt * 10;
+      park_maxcount = ControllerData->get_parktime() * 10;
       portEXIT_CRITICAL(&parkMux);
       goto Get_Handler;
     }
@@ -1667,14 +1652,10 @@ void MANAGEMENT_SERVER::getadmin3(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin3.html")) {
+  if (AdminPg.load()) {
     String msg;
     String tmp;
 
-    File file = SPIFFS.open("/admin3.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -1685,7 +1666,7 @@ Get_Handler:
 
     // position
     msg = H_POS_VALUE;
-    msg.replace("%posval%", String(driverboard->getposition()));
+    msg.replace("%posval%", String(focuserstate->get_position()));
     AdminPg.replace("%POS%", msg);
     AdminPg.replace("%BPOS%", H_POS_SETBTN);
     AdminPg.replace("%MOV%", H_POS_GOTOBTN);
@@ -1922,16 +1903,13 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_ADMIN3);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 
@@ -1939,11 +1917,9 @@ Get_Handler:
 // Handler for /admin4
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin4(void) {
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/admin4.html");
   String msg;
 
-  AdminPg.reserve(3600);  // 306-01    3334
-
   debug_server_println(T_ADMIN4);
 
   if (!check_access()) {
@@ -1999,11 +1975,7 @@ void MANAGEMENT_SERVER::getadmin4(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin4.html")) {
-    File file = SPIFFS.open("/admin4.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -2045,16 +2017,13 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_ADMIN4);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 
@@ -2062,11 +2031,9 @@ Get_Handler:
 // Handler for /admin5
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin5(void) {
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/admin5.html");
   String msg;
 
-  AdminPg.reserve(4600);  // 306-02    4402
-
   debug_server_println(T_ADMIN5);
 
   if (!check_access()) {
@@ -2185,11 +2152,7 @@ void MANAGEMENT_SERVER::getadmin5(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin5.html")) {
-    File file = SPIFFS.open("/admin5.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -2286,16 +2249,13 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_ADMIN5);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 
@@ -2304,11 +2264,9 @@ Get_Handler:
 // Leds,PB,Joysticks
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin6(void) {
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/admin6.html");
   String msg;
 
-  AdminPg.reserve(4500);  // 306-01    4253
-
   debug_server_println(T_ADMIN6);
 
   if (!check_access()) {
@@ -2413,11 +2371,7 @@ void MANAGEMENT_SERVER::getadmin6(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin6.html")) {
-    File file = SPIFFS.open("/admin6.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -2493,16 +2447,13 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_ADMIN6);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 
@@ -2511,11 +2462,9 @@ Get_Handler:
 // DISPLAY
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin7(void) {
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/admin7.html");
   String msg;
 
-  AdminPg.reserve(4400);  // 306-01  4180
-
   debug_server_println(T_ADMIN7);
 
   if (!check_access()) {
@@ -2592,7 +2541,7 @@ void MANAGEMENT_SERVER::getadmin7(void) {
     String pageoption = ControllerData->get_display_pageoption();
     if (pageoption == "") {
       pageoption = "00000001";
-      ControllerData->set_display_pageoption(pageoption);
+      ControllerData->set_display_pageoption(pageoption.c_str());
     }
     // make sure there are 8 digits, pad leading 0's if necessary
     while (pageoption.length() < 8) {
@@ -2658,18 +2607,14 @@ void MANAGEMENT_SERVER::getadmin7(void) {
       } else {
         pageoption[0] = '0';
       }
-      ControllerData->set_display_pageoption(pageoption);
+      ControllerData->set_display_pageoption(pageoption.c_str());
       goto Get_Handler;
     }
   }  // end of post handler
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin7.html")) {
-    File file = SPIFFS.open("/admin7.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -2721,7 +2666,7 @@ Get_Handler:
     AdminPg.replace("%PDO%", H_DISPLAYPOFORM);
 
     // need to get display options and then set each checkbox
-    String pageoption = ControllerData->get_display_pageoption();
+    const char *pageoption = ControllerData->get_display_pageoption();
     // now build the page option html code
     // start with page1, which is right most bit
     // if 0, then unchecked, else if 1 then checked
@@ -2778,16 +2723,13 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_ADMIN7);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 
@@ -2797,11 +2739,9 @@ Get_Handler:
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin8(void) {
   // get admin pg 8 and send to client
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/admin8.html");
   String msg;
 
-  AdminPg.reserve(4000);  // 306-01    3705
-
   debug_server_println(T_ADMIN8);
 
   if (!check_access()) {
@@ -2889,11 +2829,7 @@ void MANAGEMENT_SERVER::getadmin8(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin8.html")) {
-    File file = SPIFFS.open("/admin8.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -2976,16 +2912,13 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_ADMIN8);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 
@@ -2995,11 +2928,9 @@ Get_Handler:
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getadmin9(void) {
   // get admin pg 9 and send to client
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/admin9.html");
   String msg;
 
-  AdminPg.reserve(4800);  // 306-05    TODO
-
   debug_server_println(T_ADMIN9);
 
   if (!check_access()) {
@@ -3016,8 +2947,8 @@ void MANAGEMENT_SERVER::getadmin9(void) {
     if (msg != "") {
       String dom = mserver->arg("dname");
       if (dom != "") {
-        ControllerData->set_devicename(dom);
-        dom.toCharArray(devicename, dom.length() + 1);
+        ControllerData->set_devicename(dom.c_str());
+        strlcpy(devicename, ControllerData->get_devicename(), sizeof(devicename));
       }
       goto Get_Handler;
     }
@@ -3051,8 +2982,8 @@ void MANAGEMENT_SERVER::getadmin9(void) {
           }
         }
         if (flag) {
-          ControllerData->set_wp_titlecolor(str);
-          str.toCharArray(titlecolor, str.length() + 1);
+          ControllerData->set_wp_titlecolor(str.c_str());
+          strlcpy(titlecolor, ControllerData->get_wp_titlecolor(), sizeof(titlecolor));
         }
       }
       goto Get_Handler;
@@ -3073,8 +3004,8 @@ void MANAGEMENT_SERVER::getadmin9(void) {
           }
         }
         if (flag) {
-          ControllerData->set_wp_subtitlecolor(str);
-          str.toCharArray(subtitlecolor, str.length() + 1);
+          ControllerData->set_wp_subtitlecolor(str.c_str());
+          strlcpy(subtitlecolor, ControllerData->get_wp_subtitlecolor(), sizeof(subtitlecolor));
         }
       }
       goto Get_Handler;
@@ -3095,8 +3026,8 @@ void MANAGEMENT_SERVER::getadmin9(void) {
           }
         }
         if (flag) {
-          ControllerData->set_wp_headercolor(str);
-          str.toCharArray(headercolor, str.length() + 1);
+          ControllerData->set_wp_headercolor(str.c_str());
+          strlcpy(headercolor, ControllerData->get_wp_headercolor(), sizeof(headercolor));
         }
       }
       goto Get_Handler;
@@ -3117,8 +3048,8 @@ void MANAGEMENT_SERVER::getadmin9(void) {
           }
         }
         if (flag) {
-          ControllerData->set_wp_textcolor(str);
-          str.toCharArray(textcolor, str.length() + 1);
+          ControllerData->set_wp_textcolor(str.c_str());
+          strlcpy(textcolor, ControllerData->get_wp_textcolor(), sizeof(textcolor));
         }
       }
       goto Get_Handler;
@@ -3139,8 +3070,8 @@ void MANAGEMENT_SERVER::getadmin9(void) {
           }
         }
         if (flag) {
-          ControllerData->set_wp_backcolor(str);
-          str.toCharArray(backcolor, str.length() + 1);
+          ControllerData->set_wp_backcolor(str.c_str());
+          strlcpy(backcolor, ControllerData->get_wp_backcolor(), sizeof(backcolor));
         }
       }
       goto Get_Handler;
@@ -3149,11 +3080,7 @@ void MANAGEMENT_SERVER::getadmin9(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/admin9.html")) {
-    File file = SPIFFS.open("/admin9.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -3240,27 +3167,22 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_ADMIN9);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 // ----------------------------------------------------------------------
 // handler for /move
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getmove(void) {
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/adminmove.html");
   String msg;
 
-  AdminPg.reserve(5200);  // 306-05 4996
-
   debug_server_println(T_MOVE);
 
   if (!check_access()) {
@@ -3328,11 +3250,7 @@ void MANAGEMENT_SERVER::getmove(void) {
   // end of move_post
 
 Get_Handler:
-  if (SPIFFS.exists("/adminmove.html")) {
-    File file = SPIFFS.open("/adminmove.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -3341,14 +3259,14 @@ Get_Handler:
     AdminPg.replace("%TXC%", textcolor);
     AdminPg.replace("%BKC%", backcolor);
 
-    String pos = String(driverboard->getposition());
-
-    //AdminPg.replace("%CPO%", String(driverboard->getposition()));
+    // publish any move started by the post, then build the page from one snapshot
+    publish_focuser_state();
+    Focuser_Status fs = focuserstate->get();
+    String pos = String(fs.position);
     AdminPg.replace("%CPO%", pos);
-    pos = String(ControllerData->get_maxstep());
-    AdminPg.replace("%MAX%", pos);
-    AdminPg.replace("%TPO%", String(ftargetPosition));
-    if (isMoving == true) {
+    AdminPg.replace("%MAX%", String(ControllerData->get_maxstep()));
+    AdminPg.replace("%TPO%", String(fs.target));
+    if (fs.ismoving == true) {
       AdminPg.replace("%MOV%", "True");
     } else {
       AdminPg.replace("%MOV%", "False");
@@ -3380,38 +3298,29 @@ Get_Handler:
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_MOVE);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 // ----------------------------------------------------------------------
 // handler for /adminlinks
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getlinks(void) {
-  String AdminPg;
+  static HTML_TEMPLATE AdminPg("/adminlinks.html");
   String msg;
 
-  AdminPg.reserve(3900);  // 306-05 3610
-
   debug_server_println(T_LINKS);
 
   if (!check_access()) {
     return;
   }
 
-  if (SPIFFS.exists("/adminlinks.html")) {
-    File file = SPIFFS.open("/adminlinks.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -3427,16 +3336,13 @@ void MANAGEMENT_SERVER::getlinks(void) {
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_LINKS);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 // ----------------------------------------------------------------------
@@ -3461,8 +3367,7 @@ void MANAGEMENT_SERVER::checkreboot(void) {
 // handles delete file request
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::post_deletefile() {
-  String AdminPg;
-  AdminPg.reserve(2700);  // 303  2460
+  static HTML_TEMPLATE AdminPg("/deleteok.html");
 
   debug_server_print(T_DELETEOK);
 
@@ -3480,13 +3385,7 @@ void MANAGEMENT_SERVER::post_deletefile() {
     }
 
     // load the deleteok.html file
-    if (SPIFFS.exists("/deleteok.html")) {
-      // open file for read
-      File file = SPIFFS.open("/deleteok.html", "r");
-      // read contents into string
-      AdminPg = file.readString();
-      file.close();
-
+    if (AdminPg.load()) {
       AdminPg.replace("%PGT%", devicename);
       // Web page colors
       AdminPg.replace("%TIC%", titlecolor);
@@ -3507,6 +3406,7 @@ void MANAGEMENT_SERVER::post_deletefile() {
 
       if (SPIFFS.exists(df)) {
         if (SPIFFS.remove(df)) {
+          filecache->changed();
           AdminPg.replace("%STA%", "deleted.");
         } else {
           debug_server_print(T_ERROR);
@@ -3519,20 +3419,17 @@ void MANAGEMENT_SERVER::post_deletefile() {
       }
     } else {
       debug_server_println(T_NOTFOUND);
-      AdminPg = "<html><head><title>Management Server</title></head><body><p>deleteok.html not found</p><p><form action=\"/\"method=\"GET\"><input type=\"submit\" value=\"HOMEPAGE\"></form></p></body></html>";
+      AdminPg.set_text("<html><head><title>Management Server</title></head><body><p>deleteok.html not found</p><p><form action=\"/\"method=\"GET\"><input type=\"submit\" value=\"HOMEPAGE\"></form></p></body></html>");
     }
   } else {
     // null argument has been passed
-    AdminPg = "<html><head><title>Management Server</title></head><body><p>Null argument found</p><p><form action=\"/\" method=\"GET\"><input type=\"submit\" value=\"HOMEPAGE\"></form></p></body></html>";
+    AdminPg.set_text("<html><head><title>Management Server</title></head><body><p>Null argument found</p><p><form action=\"/\" method=\"GET\"><input type=\"submit\" value=\"HOMEPAGE\"></form></p></body></html>");
   }
 
   debug_server_print(T_DELETEOK);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 // ----------------------------------------------------------------------
@@ -3540,8 +3437,7 @@ void MANAGEMENT_SERVER::post_deletefile() {
 // displays delete html page
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::get_deletefile() {
-  String AdminPg;
-  AdminPg.reserve(2700);  // 306-01 2446
+  static HTML_TEMPLATE AdminPg("/delete.html");
 
   debug_server_println(T_DELETE);
 
@@ -3549,11 +3445,7 @@ void MANAGEMENT_SERVER::get_deletefile() {
     return;
   }
 
-  if (SPIFFS.exists("/delete.html")) {
-    File file = SPIFFS.open("/delete.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -3571,89 +3463,106 @@ void MANAGEMENT_SERVER::get_deletefile() {
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_DELETE);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
+}
+
+// ----------------------------------------------------------------------
+// The file lists are collected in buf and sent a chunk of about
+// HTTPSENDCHUNK bytes at a time, not a chunk per file
+// ----------------------------------------------------------------------
+static void list_add(HTTP_SERVER *server, char *buf, size_t &len, const char *text, size_t n) {
+  n = (n > HTTPSENDCHUNK) ? HTTPSENDCHUNK : n;
+  if ((len + n) > HTTPSENDCHUNK) {
+    server->sendContent(buf, len);
+    len = 0;
+  }
+  memcpy(buf + len, text, n);
+  len += n;
+}
+
+// the rest of buf, then the last chunk
+static void list_end(HTTP_SERVER *server, char *buf, size_t len) {
+  if (len > 0) {
+    server->sendContent(buf, len);
+  }
+  server->sendContent("");
 }
 
 // ----------------------------------------------------------------------
 // lists all files in file system
 // shorten format of filenames only, eg admin1.html, admin2.html, .... cntlr_config.jsn
+// sent chunked as the directory is read, memory does not grow with the
+// number of files
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::get_filelist_short(void) {
-  String path = "/";
-
   debug_server_println("get_filelist_short");
 
   if (!check_access()) {
     return;
   }
 
-  // format looks like [] array of {"type":"file","name":"admin2.html"}
   // example code taken from FSBrowser
-  File root = SPIFFS.open(path);
-  path = String();
-
-  String output = "";
+  mserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  mserver->send(NORMALWEBPAGE, String(JSONTEXTPAGETYPE), "");
+  char buf[HTTPSENDCHUNK];
+  size_t len = 0;
+  File root = SPIFFS.open("/");
   if (root.isDirectory()) {
     File file = root.openNextFile();
-
+    bool first = true;
     while (file) {
-      output += String(file.name());
-      file = root.openNextFile();
-      if (file) {
-        output += ", ";
+      if (first == false) {
+        list_add(mserver, buf, len, ", ", 2);
       }
+      list_add(mserver, buf, len, file.name(), strlen(file.name()));
+      first = false;
+      file = root.openNextFile();
     }
-    file.close();
   }
-  mserver->send(NORMALWEBPAGE, String(JSONTEXTPAGETYPE), output);
+  list_end(mserver, buf, len);
 }
 
 // ----------------------------------------------------------------------
 // void get_filelist_long(void);
 // lists all files in file system, long format
 // {[{"type":"file","name":"admin1.html"}, ... ,{"type":"file","name":"cntlr_config.jsn"}]}
+// sent chunked as the directory is read
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::get_filelist_long(void) {
-  // format looks like [] array of {"type":"file","name":"admin2.html"}
-  // example code taken from FSBrowser
-  String path = "/";
-
   debug_server_println("get_filelist_long");
 
   if (!check_access()) {
     return;
   }
 
-  File root = SPIFFS.open(path);
-  path = String();
-
-  String output = "{[";
+  // format looks like [] array of {"type":"file","name":"admin2.html"}
+  // example code taken from FSBrowser
+  mserver->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  mserver->send(NORMALWEBPAGE, String(JSONTEXTPAGETYPE), "");
+  char buf[HTTPSENDCHUNK];
+  size_t len = 0;
+  list_add(mserver, buf, len, "{[", 2);
+  File root = SPIFFS.open("/");
   if (root.isDirectory()) {
     File file = root.openNextFile();
+    bool first = true;
     while (file) {
-      output += "{\"type\":\"";
-      output += (file.isDirectory()) ? "dir" : "file";
-      output += "\",\"name\":\"";
-      output += String(file.name());
-      output += "\"}";
+      char entry[64 + 32];  // SPIFFS names are at most 32 bytes
+      int n = snprintf(entry, sizeof(entry), "%s{\"type\":\"%s\",\"name\":\"%s\"}",
+                       first ? "" : ",", file.isDirectory() ? "dir" : "file", file.name());
+      list_add(mserver, buf, len, entry, (n < (int)sizeof(entry)) ? n : sizeof(entry) - 1);
+      first = false;
       file = root.openNextFile();
-      if (file) {
-        output += ',';
-      }
     }
-    file.close();
   }
-  output += "]}";
-  mserver->send(NORMALWEBPAGE, String(JSONTEXTPAGETYPE), output);
+  list_add(mserver, buf, len, "]}", 2);
+  list_end(mserver, buf, len);
 }
 
 // ----------------------------------------------------------------------
@@ -3661,8 +3570,7 @@ void MANAGEMENT_SERVER::get_filelist_long(void) {
 // displays not found html page
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::get_notfound(void) {
-  String AdminPg;
-  AdminPg.reserve(5800);  // in case the file exists
+  static HTML_TEMPLATE AdminPg("/adminnotfound.html");
 
   debug_server_println("get_notfound");
   if (!check_access()) {
@@ -3674,39 +3582,14 @@ void MANAGEMENT_SERVER::get_notfound(void) {
   debug_server_print("-uri !found ");
   debug_server_println(p);
 
-  // get the MIME type
-  String contenttype = get_contenttype(p);
-  if (SPIFFS.exists(p)) {
-    debug_server_print("-File ");
-    debug_server_print(p);
-    debug_server_println(" found");
-
-    File file = SPIFFS.open(p, "r");
-    AdminPg = file.readString();
-    file.close();
-    debug_server_print("-send file ");
-    debug_server_print(p);
-    debug_server_println(" to client now");
-    if (AdminPg[0] == '{') {
-      // a json file
-      send_json(AdminPg);
-      return;
-    }
-    // for non jsn types like .ico
-    mserver->send(NORMALWEBPAGE, contenttype, AdminPg);
+  if (handlefileread(p)) {
     return;
   } else {
 
     debug_server_println(T_ADMINNOTFOUND);
 
     // file definately does not exist, so use notfound html file
-    if (SPIFFS.exists("/adminnotfound.html")) {
-      // open file for read
-      File file = SPIFFS.open("/adminnotfound.html", "r");
-      // read contents into string
-      AdminPg = file.readString();
-      file.close();
-
+    if (AdminPg.load()) {
       AdminPg.replace("%PGT%", devicename);
       // Web page colors
       AdminPg.replace("%TIC%", titlecolor);
@@ -3724,16 +3607,13 @@ void MANAGEMENT_SERVER::get_notfound(void) {
       AdminPg.replace("%SUT%", systemuptime);
     } else {
       debug_server_println(T_NOTFOUND);
-      AdminPg = H_FILENOTFOUNDSTR;
+      AdminPg.set_text(H_FILENOTFOUNDSTR);
     }
 
     debug_server_print(T_ADMINNOTFOUND);
     debug_server_println(AdminPg.length());
-    mserver->client().println("HTTP/1.1 200 OK");
-    mserver->client().println("Content-type:text/html");
-    mserver->client().println();
-    mserver->client().print(AdminPg);
-    mserver->client().println();
+    send_myheader(AdminPg.length());
+    AdminPg.render(mserver->content());
   }
 }
 
@@ -3767,16 +3647,9 @@ void MANAGEMENT_SERVER::saveconfig(void) {
 
   // save the focuser settings immediately
   if (ControllerData->SaveNow(driverboard->getposition(), driverboard->getdirection()) == true) {
-    String AdminPg;
-    AdminPg.reserve(3000);  // 300 		2047
-
-    if (SPIFFS.exists("/configsaved.html")) {
-      // open file for read
-      File file = SPIFFS.open("/configsaved.html", "r");
-      // read contents into string
-      AdminPg = file.readString();
-      file.close();
+    static HTML_TEMPLATE AdminPg("/configsaved.html");
 
+    if (AdminPg.load()) {
       // Web page colors
       AdminPg.replace("%PGT%", devicename);
       // Web page colors
@@ -3795,28 +3668,18 @@ void MANAGEMENT_SERVER::saveconfig(void) {
       AdminPg.replace("%SUT%", systemuptime);
     } else {
       debug_server_println(T_NOTFOUND);
-      AdminPg = H_FILENOTFOUNDSTR;
+      AdminPg.set_text(H_FILENOTFOUNDSTR);
     }
 
     debug_server_print(T_CONFIGSAVED);
     debug_server_println(AdminPg.length());
-    mserver->client().println("HTTP/1.1 200 OK");
-    mserver->client().println("Content-type:text/html");
-    mserver->client().println();
-    mserver->client().print(AdminPg);
-    mserver->client().println();
+    send_myheader(AdminPg.length());
+    AdminPg.render(mserver->content());
     return;
   } else {
-    String AdminPg;
-    AdminPg.reserve(3000);  // 300 		2049
-
-    if (SPIFFS.exists("/confignotsaved.html")) {
-      // open file for read
-      File file = SPIFFS.open("/confignotsaved.html", "r");
-      // read contents into string
-      AdminPg = file.readString();
-      file.close();
+    static HTML_TEMPLATE AdminPg("/confignotsaved.html");
 
+    if (AdminPg.load()) {
       AdminPg.replace("%PGT%", devicename);
       // Web page colors
       AdminPg.replace("%TIC%", titlecolor);
@@ -3834,16 +3697,13 @@ void MANAGEMENT_SERVER::saveconfig(void) {
       AdminPg.replace("%SUT%", systemuptime);
     } else {
       debug_server_println(T_NOTFOUND);
-      AdminPg = H_FILENOTFOUNDSTR;
+      AdminPg.set_text(H_FILENOTFOUNDSTR);
     }
 
     debug_server_print(T_CONFIGNOTSAVED);
     debug_server_println(AdminPg.length());
-    mserver->client().println("HTTP/1.1 200 OK");
-    mserver->client().println("Content-type:text/html");
-    mserver->client().println();
-    mserver->client().print(AdminPg);
-    mserver->client().println();
+    send_myheader(AdminPg.length());
+    AdminPg.render(mserver->content());
   }
 }
 
@@ -3852,8 +3712,7 @@ void MANAGEMENT_SERVER::saveconfig(void) {
 // displays upload html page
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::upload_file(void) {
-  String AdminPg;
-  AdminPg.reserve(2500);  // 306-01 2307
+  static HTML_TEMPLATE AdminPg("/upload.html");
 
   debug_server_println(T_UPLOAD);
 
@@ -3861,11 +3720,7 @@ void MANAGEMENT_SERVER::upload_file(void) {
     return;
   }
 
-  if (SPIFFS.exists("/upload.html")) {
-    File file = SPIFFS.open("/upload.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -3883,16 +3738,13 @@ void MANAGEMENT_SERVER::upload_file(void) {
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_UPLOAD);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 
@@ -3935,6 +3787,7 @@ void MANAGEMENT_SERVER::post_uploadfile(void) {
     if (_fsUploadFile) {
       // If the file was successfully created
       _fsUploadFile.close();
+      filecache->changed();
       debug_server_print("-size ");
       debug_server_println(upload.totalSize);
       send_redirect("/success");
@@ -3950,8 +3803,7 @@ void MANAGEMENT_SERVER::post_uploadfile(void) {
 // if requested operation was successful, display success html page
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::success(void) {
-  String AdminPg;
-  AdminPg.reserve(2500);  // 306-01 		2228
+  static HTML_TEMPLATE AdminPg("/success.html");
 
   debug_server_println(T_SUCCESS);
 
@@ -3959,11 +3811,7 @@ void MANAGEMENT_SERVER::success(void) {
     return;
   }
 
-  if (SPIFFS.exists("/success.html")) {
-    File file = SPIFFS.open("/success.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -3981,15 +3829,12 @@ void MANAGEMENT_SERVER::success(void) {
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
   debug_server_print(T_SUCCESS);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 // ----------------------------------------------------------------------
@@ -3997,8 +3842,7 @@ void MANAGEMENT_SERVER::success(void) {
 // requested operation failed, display fail html page
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::fail(void) {
-  String AdminPg;
-  AdminPg.reserve(2500);  // 306-01 2211
+  static HTML_TEMPLATE AdminPg("/fail.html");
 
   if (!check_access()) {
     return;
@@ -4006,11 +3850,7 @@ void MANAGEMENT_SERVER::fail(void) {
 
   debug_server_println(T_FAIL);
 
-  if (SPIFFS.exists("/fail.html")) {
-    File file = SPIFFS.open("/fail.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -4031,16 +3871,13 @@ void MANAGEMENT_SERVER::fail(void) {
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_println(T_FAIL);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
 // ----------------------------------------------------------------------
@@ -4054,14 +3891,9 @@ void MANAGEMENT_SERVER::handlecmds(void) {
 
   debug_server_println(T_CMDS);
 
-  String AdminPg;
-  AdminPg.reserve(7000);  // 306-01 6742
-
-  if (SPIFFS.exists("/cmds.html")) {
-    File file = SPIFFS.open("/cmds.html", "r");
-    AdminPg = file.readString();
-    file.close();
+  static HTML_TEMPLATE AdminPg("/cmds.html");
 
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -4079,21 +3911,29 @@ void MANAGEMENT_SERVER::handlecmds(void) {
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
 
   debug_server_print(T_CMDS);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
 
+// ----------------------------------------------------------------------
+// A get or set key in the switch on its hash. Hashes are worked out at
+// compile time, the name is compared in case another key has the same hash
+// ----------------------------------------------------------------------
+#define MS_KEY(k) \
+  case cntlr_keyhash(k): \
+    if (strcmp(key, k) != 0) { \
+      break; \
+    }
+
 // ----------------------------------------------------------------------
 // void handleget(void);
 // generic get handler for client requests
+// get?position&ismoving returns the fields of each key in one reply
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::handleget(void) {
 
@@ -4103,775 +3943,845 @@ void MANAGEMENT_SERVER::handleget(void) {
     return;
   }
 
-  // return json string of state, on or off or value
+  StaticJsonDocument<1024> doc;
   String jsonstr;
 
-  debug_server_print("-get ");
-  debug_server_println(mserver->argName(0));
-
-  // get?ascom=
-  if (mserver->argName(0) == "ascomserver") {
-    // ascom alpaca server
-    jsonstr = "{\"ascomserver\":";
-    if (ControllerData->get_ascomsrvr_enable()) {
-      jsonstr = jsonstr + "\"enabled\", ";
-    } else {
-      jsonstr = jsonstr + "\"notenabled\", ";
+  for (int i = 0; i < mserver->args(); i++) {
+    String name = mserver->argName(i);
+    debug_server_print("-get ");
+    debug_server_println(name);
+
+    // the settings are the whole reply, current values made from memory,
+    // a value just set is not in the file until the delayed save
+    if ((name == "boardconfig") || (name == "cntlrconfig")) {
+      const String &json = (name == "boardconfig") ? ControllerData->get_board_json() : ControllerData->get_cntlr_json();
+      mserver->sendHeader("Access-Control-Allow-Origin", "*");
+      // copied, the json is made again by the next change
+      mserver->send(NORMALWEBPAGE, JSONPAGETYPE, json);
+      return;
     }
-    jsonstr = jsonstr + "\"ascomstatus\":";
-    if (ascomsrvr_status == V_RUNNING) {
-      jsonstr = jsonstr + "\"running\", ";
-    } else {
-      jsonstr = jsonstr + "\"stopped\", ";
+
+    if (get_value(name.c_str(), doc) == false) {
+      debug_server_print("-err arg ");
+      debug_server_println(name);
+      doc["error"] = "unknown-command";
     }
-    jsonstr = jsonstr + "\"ascomport\":" + String(ControllerData->get_ascomsrvr_port()) + " }";
-    send_json(jsonstr);
-    return;
   }
 
-  // get?boardconfig=
-  else if (mserver->argName(0) == "boardconfig") {
-    // Problem: this is the file. If var was just set then after 30s it
-    // is written to file. We are not reading from cache
-    File bfile = SPIFFS.open("/board_config.jsn", "r");
-    if (!bfile) {
-      jsonstr = "{ \"err\":\"unable to read file\" }";
-    } else {
-      jsonstr = bfile.readString();
-      bfile.close();
-    }
-    send_json(jsonstr);
-    return;
+  if (doc.isNull()) {
+    doc["error"] = "unknown-command";
   }
-  // get?coilpower=
-  else if (mserver->argName(0) == "coilpower") {
-    if (ControllerData->get_coilpower_enable() == true) {
-      jsonstr = "{ \"coilpower\":\"enabled\" }";
-    } else {
-      jsonstr = "{ \"coilpower\":\"notenabled\" }";
-    }
-    send_json(jsonstr);
-    return;
+  serializeJson(doc, jsonstr);
+  send_json(jsonstr);
+}
+
+// ----------------------------------------------------------------------
+// Add the fields of a get key to doc, false if the key is not known
+// ----------------------------------------------------------------------
+bool MANAGEMENT_SERVER::get_value(const char *key, JsonDocument &doc) {
+  switch (cntlr_keyhash(key)) {
+    // get?ascomserver=
+    MS_KEY("ascomserver") {
+      doc["ascomserver"] = ControllerData->get_ascomsrvr_enable() ? "enabled" : "notenabled";
+      doc["ascomstatus"] = (ascomsrvr_status == V_RUNNING) ? "running" : "stopped";
+      doc["ascomport"] = ControllerData->get_ascomsrvr_port();
+      return true;
+    }
+    // get?coilpower=
+    MS_KEY("coilpower") {
+      doc["coilpower"] = ControllerData->get_coilpower_enable() ? "enabled" : "notenabled";
+      return true;
+    }
+    // get?display=
+    MS_KEY("display") {
+      doc["display"] = ControllerData->get_display_enable() ? "enabled" : "notenabled";
+      doc["displaystatus"] = (display_status == V_RUNNING) ? "running" : "stopped";
+      return true;
+    }
+    // get?fixedstepmode=
+    MS_KEY("fixedstepmode") {
+      doc["fixedstepmode"] = ControllerData->get_brdfixedstepmode();
+      return true;
+    }
+    // get?hpsw=
+    MS_KEY("hpsw") {
+      doc["hpsw"] = ControllerData->get_hpswitch_enable() ? "enabled" : "notenabled";
+      return true;
+    }
+    // get?ismoving=
+    MS_KEY("ismoving") {
+      doc["ismoving"] = focuserstate->get_ismoving() ? 1 : 0;
+      return true;
+    }
+    // get?leds=
+    MS_KEY("leds") {
+      doc["leds"] = ControllerData->get_inoutled_enable() ? "enabled" : "notenabled";
+      doc["ledmode"] = (ControllerData->get_inoutled_mode() == LEDPULSE) ? "pulse" : "move";
+      return true;
+    }
+    // get?motorspeed=
+    MS_KEY("motorspeed") {
+      doc["motorspeed"] = ControllerData->get_motorspeed();
+      doc["motorspeeddelay"] = ControllerData->get_brdmsdelay();
+      return true;
+    }
+    // get?park=
+    MS_KEY("park") {
+      doc["park"] = ControllerData->get_park_enable() ? "enabled" : "notenabled";
+      doc["parktime"] = ControllerData->get_parktime();
+      return true;
+    }
+    // get?position=
+    MS_KEY("position") {
+      Focuser_Status fs = focuserstate->get();
+      doc["position"] = fs.position;
+      doc["maxsteps"] = ControllerData->get_maxstep();
+      doc["ismoving"] = fs.ismoving ? 1 : 0;
+      return true;
+    }
+    // get?reverse=
+    MS_KEY("reverse") {
+      doc["reverse"] = ControllerData->get_reverse_enable() ? "enabled" : "notenabled";
+      return true;
+    }
+    // get?rssi=
+    MS_KEY("rssi") {
+      doc["rssi"] = getrssi();
+      return true;
+    }
+    // get?stepmode=
+    MS_KEY("stepmode") {
+      doc["stepmode"] = ControllerData->get_brdstepmode();
+      return true;
+    }
+    // get?stallguard=
+    MS_KEY("stallguard") {
+      tmc2209stallguard sg = ControllerData->get_stallguard_state();
+      if (sg == Use_Stallguard) {
+        doc["stallguardstate"] = "Use_Stallguard";
+      } else if (sg == Use_Physical_Switch) {
+        doc["stallguardstate"] = "Use_Physical_Switch";
+      } else if (sg == Use_None) {
+        doc["stallguardstate"] = "Use_None";
+      } else {
+        // error
+        doc["sg_state"] = "error";
+      }
+      doc["sg_value"] = driverboard->getstallguardvalue();
+      return true;
+    }
+    // get?temp=
+    MS_KEY("temp") {
+      doc["tprobe"] = ControllerData->get_tempprobe_enable() ? "enabled" : "notenabled";
+      doc["tprobestatus"] = (tempprobe->get_state() == V_RUNNING) ? "running" : "stopped";
+      doc["temperature"] = serialized(String(focuserstate->get_temp(), 2));
+      return true;
+    }
+    // get?tcpipserver=
+    MS_KEY("tcpipserver") {
+      doc["tcpipserver"] = ControllerData->get_tcpipsrvr_enable() ? "enabled" : "notenabled";
+      doc["tcpipstatus"] = (tcpipsrvr_status == V_RUNNING) ? "running" : "stopped";
+      doc["tcpipport"] = ControllerData->get_tcpipsrvr_port();
+      return true;
+    }
+    // get?tmc2209current=
+    MS_KEY("tmc2209current") {
+      doc["tmc2209current"] = ControllerData->get_tmc2209current();
+      return true;
+    }
+    // get?tmc2225current=
+    MS_KEY("tmc2225current") {
+      doc["tmc2225current"] = ControllerData->get_tmc2225current();
+      return true;
+    }
+    // get?webserver=
+    MS_KEY("webserver") {
+      doc["webserver"] = ControllerData->get_websrvr_enable() ? "enabled" : "notenabled";
+      doc["webstatus"] = (websrvr_status == V_RUNNING) ? "running" : "stopped";
+      doc["webport"] = ControllerData->get_websrvr_port();
+      return true;
+    }
+    default:
+      break;
   }
-  // get?cntlrconfig=
-  else if (mserver->argName(0) == "cntlrconfig") {
-    // Problem: this is the file. If var was just set then after 30s it
-    // is written to file. We are not reading from cache
-    File bfile = SPIFFS.open("/cntlr_config.jsn", "r");
-    if (!bfile) {
-      jsonstr = "{ \"err\":\"unable to read file\" }";
-    } else {
-      jsonstr = bfile.readString();
-      bfile.close();
-    }
-    send_json(jsonstr);
+  // any other setting by its cntlr_config.jsn key, get?maxstep=
+  return ControllerData->get_setting(key, doc);
+}
+
+// ----------------------------------------------------------------------
+// void handleset(void);
+// generic set handler for client commands
+// set?park=enable&parktime=60 sets each key in the order given, the
+// reply has the fields of each key that was set
+// ----------------------------------------------------------------------
+void MANAGEMENT_SERVER::handleset(void) {
+
+  debug_server_println("MS-set()");
+
+  if (!check_access()) {
     return;
   }
-  // get?display=
-  else if (mserver->argName(0) == "display") {
-    if (ControllerData->get_display_enable() == true) {
-      jsonstr = "{ \"display\":\"enabled\", ";
-    } else {
-      jsonstr = "{ \"display\":\"notenabled\", ";
-    }
-    if (display_status == V_RUNNING) {
-      jsonstr = jsonstr + "\"displaystatus\":\"running\" }";
-    } else {
-      jsonstr = jsonstr + "\"displaystatus\":\"stopped\" }";
+
+  StaticJsonDocument<1024> doc;
+  String jsonstr;
+
+  for (int i = 0; i < mserver->args(); i++) {
+    String name = mserver->argName(i);
+    String va = mserver->arg(i);
+    if (va != "") {
+      set_value(name.c_str(), va, doc);
     }
-    send_json(jsonstr);
-    return;
   }
-  // get?fixedstepmode=
-  else if (mserver->argName(0) == "fixedstepmode") {
-    jsonstr = "{ \"fixedstepmode\":" + String(ControllerData->get_brdfixedstepmode()) + " }";
-    send_json(jsonstr);
-    return;
+
+  if (doc.isNull()) {
+    doc["error"] = "not set";
   }
-  // get?hpsw=
-  else if (mserver->argName(0) == "hpsw") {
-    if (ControllerData->get_hpswitch_enable() == true) {
-      jsonstr = "{ \"hpsw\":\"enabled\", ";
-    } else {
-      jsonstr = "{ \"hpsw\":\"notenabled\", ";
+  serializeJson(doc, jsonstr);
+  send_json(jsonstr);
+}
+
+// ----------------------------------------------------------------------
+// Set a key to va and add the result to doc
+// ----------------------------------------------------------------------
+void MANAGEMENT_SERVER::set_value(const char *key, const String &va, JsonDocument &doc) {
+  switch (cntlr_keyhash(key)) {
+    // ascom alpaca server
+    MS_KEY("ascomserver") {
+      if (va == "enable") {
+        ControllerData->set_ascomsrvr_enable(V_ENABLED);
+        doc["ascomserver"] = "enabled";
+      } else if (va == "disable") {
+        if (ascomsrvr_status == V_RUNNING) {
+          ascomsrvr->stop();
+        }
+        ascomsrvr_status = V_STOPPED;
+        ControllerData->set_ascomsrvr_enable(V_NOTENABLED);
+        doc["ascomserver"] = "notenabled";
+      } else if (va == "start") {
+        if (ascomsrvr->start() == true) {
+          ascomsrvr_status = V_RUNNING;
+          doc["ascomstatus"] = "running";
+        } else {
+          doc["ascomstatus"] = "stopped";
+        }
+      } else if (va == "stop") {
+        ascomsrvr->stop();
+        ascomsrvr_status = V_STOPPED;
+        doc["ascomstatus"] = "stopped";
+      }
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
-  // get?ismoving=
-  else if (mserver->argName(0) == "ismoving") {
-    jsonstr = "{ \"ismoving\":" + String(isMoving) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?leds=
-  else if (mserver->argName(0) == "leds") {
-    if (ControllerData->get_inoutled_enable() == true) {
-      jsonstr = "{ \"leds\":\"enabled\", ";
-    } else {
-      jsonstr = "{ \"leds\":\"notenabled\", ";
+
+    MS_KEY("ascomport") {
+      if (ascomsrvr_status == V_STOPPED) {
+        unsigned long tmp = va.toInt();
+        ControllerData->set_ascomsrvr_port(tmp);
+        doc["ascomport"] = tmp;
+      } else {
+        doc["ascomport"] = "error-not-set";
+      }
+      return;
     }
-    if (ControllerData->get_inoutled_mode() == LEDPULSE) {
-      jsonstr = jsonstr + "\"ledmode\":\"pulse\" }";
-    } else {
-      jsonstr = jsonstr + "\"ledmode\":\"move\" }";
+
+    // coilpower
+    MS_KEY("coilpower") {
+      if (va == "enable") {
+        ControllerData->set_coilpower_enable(V_ENABLED);
+        driverboard->enablemotor();
+        doc["coilpower"] = "enabled";
+      } else if (va == "disable") {
+        ControllerData->set_coilpower_enable(V_NOTENABLED);
+        driverboard->releasemotor();
+        doc["coilpower"] = "notenabled";
+      }
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
-  // get?motorspeed=
-  else if (mserver->argName(0) == "motorspeed") {
-    jsonstr = "{ \"motorspeed\":" + String(ControllerData->get_motorspeed()) + ", ";
-    jsonstr = jsonstr + "\"motorspeeddelay\":" + String(ControllerData->get_brdmsdelay()) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?park=
-  else if (mserver->argName(0) == "park") {
-    if (ControllerData->get_park_enable() == true) {
-      jsonstr = "{ \"park\":\"enabled\", \"parktime\":" + String(ControllerData->get_parktime()) + " }";
-    } else {
-      jsonstr = "{ \"park\":\"notenabled\", \"parktime\":" + String(ControllerData->get_parktime()) + " }";
+
+    // display enable/disable
+    MS_KEY("display") {
+      if (va == "enable") {
+        ControllerData->set_display_enable(V_ENABLED);
+        doc["display"] = "enabled";
+      } else if (va == "disable") {
+        // stop the display if running
+        if (display_status == V_RUNNING) {
+          display_stop();
+        }
+        ControllerData->set_display_enable(V_NOTENABLED);
+        doc["display"] = "notenabled";
+      }
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
-  // get?position=
-  else if (mserver->argName(0) == "position") {
-    jsonstr = "{ \"position\":" + String(ControllerData->get_fposition())
-              + ", \"maxsteps\":" + String(ControllerData->get_maxstep())
-              + ", \"ismoving\":" + String(isMoving) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?reverse=
-  else if (mserver->argName(0) == "reverse") {
-    if (ControllerData->get_reverse_enable() == true) {
-      jsonstr = "{ \"reverse\":\"enabled\" }";
-    } else {
-      jsonstr = "{ \"reverse\":\"notenabled\" }";
+
+    // display status V_RUNNING, V_STOPPED, start, stop
+    MS_KEY("displaystatus") {
+      if (va == "start") {
+        if ((ControllerData->get_display_enable() == V_ENABLED) && (display_start() == true)) {
+          doc["displaystatus"] = "running";
+        } else {
+          doc["displaystatus"] = "stopped";
+        }
+      } else if (va == "stop") {
+        // stop the display
+        display_stop();
+        doc["display"] = "stopped";
+      }
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
-  // get?rssi=
-  else if (mserver->argName(0) == "rssi") {
-    long ri = getrssi();
-    jsonstr = "{ \"rssi\":" + String(ri) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?stepmode=
-  else if (mserver->argName(0) == "stepmode") {
-    jsonstr = "{ \"stepmode\":" + String(ControllerData->get_brdstepmode()) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?stallguard=
-  else if (mserver->argName(0) == "stallguard") {
-    byte sgval = STALL_VALUE;
-    sgval = driverboard->getstallguardvalue();
-    tmc2209stallguard sg = ControllerData->get_stallguard_state();
-    if (sg == Use_Stallguard) {
-      jsonstr = "{ \"stallguardstate\":\"Use_Stallguard\", ";
-    } else if (sg == Use_Physical_Switch) {
-      jsonstr = "{ \"stallguardstate\":\"Use_Physical_Switch\", ";
-    } else if (sg == Use_None) {
-      jsonstr = "{ \"stallguardstate\":\"Use_None\", ";
-    } else {
-      // error
-      jsonstr = "{ \"sg_state\":\"error\", ";
+
+    // fixedstepmode for uln2003, l298n, l293d-mini etc
+    MS_KEY("fixedstepmode") {
+      int tmp = va.toInt();
+      ControllerData->set_brdfixedstepmode(tmp);
+      doc["fixedstepmode"] = tmp;
+      return;
     }
-    jsonstr = jsonstr + "\"sg_value\":" + String(sgval) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?temp=
-  else if (mserver->argName(0) == "temp") {
-    if (ControllerData->get_tempprobe_enable() == true) {
-      jsonstr = "{ \"tprobe\":\"enabled\", ";
-    } else {
-      jsonstr = "{ \"tprobe\":\"notenabled\", ";
+
+    // halt
+    MS_KEY("halt") {
+      if (va == "yes") {
+        portENTER_CRITICAL(&halt_alertMux);
+        halt_alert = true;
+        portEXIT_CRITICAL(&halt_alertMux);
+      }
+      doc["halt"] = driverboard->getposition();
+      return;
     }
-    if (tempprobe->get_state() == V_RUNNING) {
-      jsonstr = jsonstr + "\"tprobestatus\":\"running\", ";
-    } else {
-      jsonstr = jsonstr + "\"tprobestatus\":\"stopped\", ";
+
+    // home position switch enable
+    MS_KEY("hpsw") {
+      if (va == "enable") {
+        ControllerData->set_hpswitch_enable(V_ENABLED);
+        doc["hpsw"] = (driverboard->init_hpsw() == true) ? "enabled" : "notenabled";
+      } else if (va == "disable") {
+        ControllerData->set_hpswitch_enable(V_NOTENABLED);
+        doc["hpsw"] = "off";
+      }
+      return;
     }
-    jsonstr = jsonstr + "\"temperature\":" + String(temp, 2) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?tcpipserver=
-  else if (mserver->argName(0) == "tcpipserver") {
-    jsonstr = "{ \"tcpipserver\":";
-    if (ControllerData->get_tcpipsrvr_enable() == true) {
-      jsonstr = jsonstr + "\"enabled\", ";
-    } else {
-      jsonstr = jsonstr + "\"notenabled\", ";
+
+    // leds in out enable
+    MS_KEY("leds") {
+      // the state after set_leds(), unchanged if it could not be set
+      if (va == "enable") {
+        doc["leds"] = (driverboard->set_leds(true) == true) ? "enabled" : "notenabled";
+      } else if (va == "disable") {
+        doc["leds"] = (driverboard->set_leds(false) == true) ? "notenabled" : "enabled";
+      }
+      return;
     }
-    jsonstr = jsonstr + "\"tcpipstatus\":";
-    if (tcpipsrvr_status == V_RUNNING) {
-      jsonstr = jsonstr + "\"running\", \"tcpipport\":" + String(ControllerData->get_tcpipsrvr_port()) + " }";
-    } else {
-      jsonstr = jsonstr + "\"stopped\", \"tcpipport\":" + String(ControllerData->get_tcpipsrvr_port()) + " }";
+
+    // leds mode, pulse or move
+    MS_KEY("ledmode") {
+      if (va == "pulse") {
+        ControllerData->set_inoutled_mode(LEDPULSE);
+        doc["ledmode"] = "pulse";
+      } else if (va == "move") {
+        ControllerData->set_inoutled_mode(LEDMOVE);
+        doc["ledmode"] = "move";
+      }
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
-  // get?tmc2209current=
-  else if (mserver->argName(0) == "tmc2209current") {
-    jsonstr = "{\"tmc2209current\":" + String(ControllerData->get_tmc2209current()) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?tmc2225current=
-  else if (mserver->argName(0) == "tmc2225current") {
-    jsonstr = "{\"tmc2225current\":" + String(ControllerData->get_tmc2225current()) + " }";
-    send_json(jsonstr);
-    return;
-  }
-  // get?webserver=
-  else if (mserver->argName(0) == "webserver") {
-    jsonstr = "{ \"webserver\":";
-    if (ControllerData->get_websrvr_enable() == true) {
-      jsonstr = jsonstr + "\"enabled\", ";
-    } else {
-      jsonstr = jsonstr + "\"notenabled\", ";
+
+    // motorspeed
+    MS_KEY("motorspeed") {
+      int tmp = va.toInt();
+      if (tmp < SLOW) {
+        tmp = SLOW;
+      }
+      if (tmp > FAST) {
+        tmp = FAST;
+      }
+      ControllerData->set_motorspeed(tmp);
+      doc["motorspeed"] = tmp;
+      return;
     }
-    jsonstr = jsonstr + "\"webstatus\":";
-    if (websrvr_status == V_RUNNING) {
-      jsonstr = jsonstr + "\"running\", \"webport\":" + String(ControllerData->get_websrvr_port()) + " }";
-    } else {
-      jsonstr = jsonstr + "\"stopped\", \"webport\":" + String(ControllerData->get_websrvr_port()) + " }";
+
+    // motorspeeddelay value
+    MS_KEY("motorspeeddelay") {
+      unsigned long tmp = va.toInt();
+      ControllerData->set_brdmsdelay(tmp);
+      doc["motorspeeddelay"] = tmp;
+      return;
     }
-    send_json(jsonstr);
-    return;
-  } else {
-    debug_server_print("-err arg ");
-    debug_server_println(mserver->argName(0));
-    jsonstr = "{ \"error\":\"unknown-command\" }";
-    send_json(jsonstr);
-    return;
-  }
-}
 
-// ----------------------------------------------------------------------
-// void handleset(void);
-// generic set handler for client commands
-// ----------------------------------------------------------------------
-void MANAGEMENT_SERVER::handleset(void) {
+    // move - moves focuser position
+    MS_KEY("move") {
+      long tmp = va.toInt();
+      tmp = (tmp < 0) ? 0 : tmp;
+      tmp = (tmp > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : tmp;
+      ftargetPosition = tmp;
+      doc["move"] = ftargetPosition;
+      return;
+    }
 
-  debug_server_println("MS-set()");
+    // park enabled state
+    MS_KEY("park") {
+      if (va == "enable") {
+        ControllerData->set_park_enable(V_ENABLED);
+        doc["park"] = "enabled";
+      } else if (va == "disable") {
+        ControllerData->set_park_enable(V_NOTENABLED);
+        doc["park"] = "notenabled";
+      }
+      return;
+    }
 
-  if (!check_access()) {
-    return;
-  }
+    // Park time
+    MS_KEY("parktime") {
+      // range checked by the setter, 30s to 300s (5m)
+      ControllerData->set_parktime(va.toInt());
+      // update park_maxcount
+      portENTER_CRITICAL(&parkMux);
+      park_maxcount = ControllerData->get_parktime() * 10;  // convert to timeslices
+      portEXIT_CRITICAL(&parkMux);
+      doc["parktime"] = ControllerData->get_parktime();
+      return;
+    }
 
-  // get parameter after ?
-  String jsonstr;
-  String va;
-  String drvbrd = ControllerData->get_brdname();
+    // position - does not move focuser
+    MS_KEY("position") {
+      long tmp = va.toInt();
+      tmp = (tmp < 0) ? 0 : tmp;
+      tmp = (tmp > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : tmp;
+      ftargetPosition = tmp;
+      ControllerData->set_fposition(ftargetPosition);  // current position in SPIFFS
+      driverboard->setposition(ftargetPosition);       // current position in driver board
+      doc["position"] = ftargetPosition;
+      return;
+    }
 
-  // ascom alpaca server
-  va = mserver->arg("ascomserver");
-  if (va != "") {
-    if (va == "enable") {
-      ControllerData->set_ascomsrvr_enable(V_ENABLED);
-      jsonstr = "{ \"ascomserver\":\"enabled\" }";
-    } else if (va == "disable") {
-      if (ascomsrvr_status == V_RUNNING) {
-        ascomsrvr->stop();
+    // reverse direction
+    MS_KEY("reverse") {
+      if (va == "enable") {
+        ControllerData->set_reverse_enable(V_ENABLED);
+        doc["reverse"] = "enabled";
+      } else if (va == "disable") {
+        ControllerData->set_reverse_enable(V_NOTENABLED);
+        doc["reverse"] = "notenabled";
       }
-      ascomsrvr_status = V_STOPPED;
-      ControllerData->set_ascomsrvr_enable(V_NOTENABLED);
-      jsonstr = "{ \"ascomserver\":\"notenabled\" }";
-    } else if (va == "start") {
-      if (ascomsrvr->start() == true) {
-        ascomsrvr_status = V_RUNNING;
-        jsonstr = "{ \"ascomstatus\":\"running\" }";
+      return;
+    }
+
+    MS_KEY("stallguardstate") {
+      //Use_Stallguard, Use_Physical_Switch, Use_None
+      if (va == "stallguard") {
+        tmc2209stallguard thisstate = Use_Stallguard;
+        // save stallguard source
+        ControllerData->set_stallguard_state(thisstate);
+        // set stallguard value
+        driverboard->setstallguardvalue(ControllerData->get_stallguard_value());
+        // enable hpsw
+        ControllerData->set_hpswitch_enable(V_ENABLED);
+        // reset hpsw
+        driverboard->init_hpsw();
+        debug_server_println(T_STALLGUARD);
+        doc["state"] = "Use_Stallguard";
+      } else if (va == "switch") {
+        tmc2209stallguard thisstate = Use_Physical_Switch;
+        // save stallguard source
+        ControllerData->set_stallguard_state(thisstate);
+        // enable hpsw
+        ControllerData->set_hpswitch_enable(V_ENABLED);
+        // disable stallguard for tmc2209
+        driverboard->setstallguardvalue(0);
+        // reset hpsw
+        driverboard->init_hpsw();
+        debug_server_println(T_PHYSICALSWITCH);
+        doc["state"] = "Use_Physical_Switch";
+      } else if (va == "none") {
+        tmc2209stallguard thisstate = Use_None;
+        // save state
+        ControllerData->set_stallguard_state(thisstate);
+        // disable hpsw
+        ControllerData->set_hpswitch_enable(V_NOTENABLED);
+        // disable stallguard for tmc2209
+        driverboard->setstallguardvalue(0);
+        // reset hpsw
+        driverboard->init_hpsw();
+        debug_server_println(T_NONE);
+        doc["state"] = "Use_None";
       } else {
-        jsonstr = "{ \"ascomstatus\":\"stopped\" }";
+        // error
+        doc["state"] = "not implemented yet";
       }
-    } else if (va == "stop") {
-      ascomsrvr->stop();
-      ascomsrvr_status = V_STOPPED;
-      jsonstr = "{ \"ascomstatus\":\"stopped\" }";
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
 
-  va = mserver->arg("ascomport");
-  if (va != "") {
-    if (ascomsrvr_status == V_STOPPED) {
-      unsigned long tmp = va.toInt();
-      ControllerData->set_ascomsrvr_port(tmp);
-      jsonstr = "{ \"ascomport\":" + String(tmp) + " }";
-    } else {
-      jsonstr = "{ \"ascomport\": \"error-not-set\" }";
+    // stall guard value
+    MS_KEY("stallguardvalue") {
+      int tmp = va.toInt();
+      // write value to 2209 registers and update ControllerData
+      driverboard->setstallguardvalue((byte)tmp);
+      doc["sg_value"] = ControllerData->get_stallguard_value();
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
 
-  // coilpower
-  va = mserver->arg("coilpower");
-  if (va != "") {
-    if (va == "enable") {
-      ControllerData->set_coilpower_enable(V_ENABLED);
-      driverboard->enablemotor();
-      jsonstr = "{ \"coilpower\":\"enabled\" }";
-    } else if (va == "disable") {
-      ControllerData->set_coilpower_enable(V_NOTENABLED);
-      driverboard->releasemotor();
-      jsonstr = "{ \"coilpower\":\"notenabled\" }";
-    }
-    send_json(jsonstr);
-    return;
-  }
+    // stepmode
+    MS_KEY("stepmode") {
+      int tmp = va.toInt();
+      // write to pins and update mySetupData
+      driverboard->setstepmode(tmp);
+      // read actual stepmode set by driverboard
+      doc["stepmode"] = ControllerData->get_brdstepmode();
+      return;
+    }
 
-  // display enable/disable
-  va = mserver->arg("display");
-  if (va != "") {
-    if (va == "enable") {
-      ControllerData->set_display_enable(V_ENABLED);
-      jsonstr = "{ \"display\":\"enabled\" }";
-    } else if (va == "disable") {
-      // stop the display if running
-      if (display_status == V_RUNNING) {
-        display_stop();
+    // tcpip server
+    MS_KEY("tcpipserver") {
+      if (va == "enable") {
+        ControllerData->set_tcpipsrvr_enable(V_ENABLED);
+        doc["tcpipserver"] = "enabled";
+      } else if (va == "disable") {
+        if (tcpipsrvr_status == V_RUNNING) {
+          tcpipsrvr->stop();
+        }
+        tcpipsrvr_status = V_STOPPED;
+        ControllerData->set_tcpipsrvr_enable(V_NOTENABLED);
+        doc["tcpipserver"] = "notenabled";
+      } else if (va == "start") {
+        if (tcpipsrvr->start(ControllerData->get_tcpipsrvr_port()) == true) {
+          tcpipsrvr_status = V_RUNNING;
+          doc["tcpipstatus"] = "running";
+        } else {
+          doc["tcpipstatus"] = "stopped";
+        }
+      } else if (va == "stop") {
+        tcpipsrvr->stop();
+        tcpipsrvr_status = V_STOPPED;
+        doc["tcpipstatus"] = "stopped";
       }
-      ControllerData->set_display_enable(V_NOTENABLED);
-      jsonstr = "{ \"display\":\"notenabled\" }";
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
 
-  // display status V_RUNNING, V_STOPPED, start, stop
-  va = mserver->arg("displaystatus");
-  if (va != "") {
-    if (va == "start") {
-      if (ControllerData->get_display_enable() == V_ENABLED) {
-        if (display_start() == true) {
-          jsonstr = "{ \"displaystatus\":\"running\" }";
+    MS_KEY("tcpipport") {
+      if (tcpipsrvr_status == V_STOPPED) {
+        unsigned long tmp = va.toInt();
+        ControllerData->set_tcpipsrvr_port(tmp);
+        doc["tcpipport"] = tmp;
+      } else {
+        // cannot change port when srvr is running
+        doc["tcpipport"] = "error-not-set";
+      }
+      return;
+    }
+
+    // temperature probe enable/disable
+    MS_KEY("tempprobe") {
+      if (va == "enable") {
+        // start probe, if not already running
+        if ((tempprobe->get_loaded() == V_RUNNING) || (tempprobe->start() == true)) {
+          doc["tempprobe"] = "enabled";
         } else {
-          jsonstr = "{ \"displaystatus\":\"stopped\" }";
+          // did not start
+          doc["tempprobe"] = "notenabled";
         }
-      } else {
-        jsonstr = "{ \"displaystatus\":\"stopped\" }";
+      } else if (va == "disable") {
+        // is loaded so stop probe, there is no destructor call
+        if (tempprobe->get_loaded() == V_RUNNING) {
+          tempprobe->stop();
+        }
+        doc["tempprobe"] = "notenabled";
       }
-    } else if (va == "stop") {
-      // stop the display
-      display_stop();
-      jsonstr = "{ \"display\":\"stopped\" }";
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
 
-  // fixedstepmode for uln2003, l298n, l293d-mini etc
-  va = mserver->arg("fixedstepmode");
-  if (va != "") {
-    int tmp = va.toInt();
-    ControllerData->set_brdfixedstepmode(tmp);
-    jsonstr = "{ \"fixedstepmode\":" + String(tmp) + " }";
-  }
+    // tmc2209current
+    MS_KEY("tmc2209current") {
+      int tmp = va.toInt();
+      // write current value to tmc22xx, call ControllerData->set_tmc2209current(temp);
+      driverboard->settmc2209current(tmp);
+      doc["tmc2209current"] = tmp;
+      return;
+    }
 
-  // halt
-  va = mserver->arg("halt");
-  if (va != "") {
-    if (va == "yes") {
-      portENTER_CRITICAL(&halt_alertMux);
-      halt_alert = true;
-      portEXIT_CRITICAL(&halt_alertMux);
+    // tmc2225current
+    MS_KEY("tmc2225current") {
+      int tmp = va.toInt();
+      // write current value to tmc22xx, call ControllerData->set_tmc2225current(temp);
+      driverboard->settmc2225current(tmp);
+      doc["tmc2225current"] = tmp;
+      return;
     }
-    jsonstr = "{ \"halt\":" + String(driverboard->getposition()) + " }";
-    send_json(jsonstr);
-    return;
-  }
 
-  // home position switch enable
-  va = mserver->arg("hpsw");
-  if (va != "") {
-    if (va == "enable") {
-      ControllerData->set_hpswitch_enable(V_ENABLED);
-      if (driverboard->init_hpsw() == true) {
-        jsonstr = "{ \"hpsw\":\"enabled\" }";
-      } else {
-        jsonstr = "{ \"hpsw\":\"notenabled\" }";
+    // web server
+    MS_KEY("webserver") {
+      if (va == "enable") {
+        ControllerData->set_websrvr_enable(V_ENABLED);
+        doc["webserver"] = "enabled";
+      } else if (va == "disable") {
+        if (websrvr_status == V_RUNNING) {
+          websrvr->stop();
+        }
+        websrvr_status = V_STOPPED;
+        ControllerData->set_websrvr_enable(V_NOTENABLED);
+        doc["webserver"] = "notenabled";
+      } else if (va == "start") {
+        if (websrvr_status == V_STOPPED) {
+          // attempt to start the web server
+          websrvr->start(ControllerData->get_websrvr_port());
+        }
+        // did webserver start? then websrvr_status would be V_RUNNING
+        doc["webstatus"] = (websrvr_status == V_RUNNING) ? "running" : "stopped";
+      } else if (va == "stop") {
+        // is it on?
+        if (websrvr_status == V_RUNNING) {
+          websrvr->stop();
+        }
+        doc["webstatus"] = "stopped";
       }
-    } else if (va == "disable") {
-      ControllerData->set_hpswitch_enable(V_NOTENABLED);
-      jsonstr = "{ \"hpsw\":\"off\" }";
+      return;
     }
-    send_json(jsonstr);
-    return;
-  }
 
-  // leds in out enable
-  va = mserver->arg("leds");
-  if (va != "") {
-    if (va == "enable") {
-      if (driverboard->set_leds(true) == true) {
-        jsonstr = "{ \"leds\":\"enabled\" }";
-      } else {
-        // error could not be set
-        jsonstr = "{ \"leds\":\"notenabled\" }";
-      }
-    } else if (va == "disable") {
-      if (driverboard->set_leds(false) == true) {
-        jsonstr = "{ \"leds\":\"notenabled\" }";
+    // web server
+    MS_KEY("webport") {
+      if (websrvr_status == V_STOPPED) {
+        unsigned long tmp = va.toInt();
+        ControllerData->set_websrvr_port(tmp);
+        doc["webport"] = tmp;
       } else {
-        // error could not be set
-        jsonstr = "{ \"leds\":\"enabled\" }";  // TODO enabled is wrong response
+        // cannot change port when srvr is running
+        doc["webport"] = "error-not-set";
       }
+      return;
     }
-    send_json(jsonstr);
+
+    default:
+      break;
+  }
+  // any other setting by its cntlr_config.jsn key, set?maxstep=
+  // servers, display and temp probe are changed with their own keys above,
+  // which check their state
+  if (setting_restarts(key)) {
+    doc[String(key)] = "error-not-set";
     return;
   }
+  if (ControllerData->set_setting(key, va.c_str()) == true) {
+    setting_changed(key);
+    ControllerData->get_setting(key, doc);
+  }
+}
 
-  // leds mode, pulse or move
-  va = mserver->arg("ledmode");
-  if (va != "") {
-    if (va == "pulse") {
-      ControllerData->set_inoutled_mode(LEDPULSE);
-      jsonstr = "{ \"ledmode\":\"pulse\" }";
-    } else if (va == "move") {
-      ControllerData->set_inoutled_mode(LEDMOVE);
-      jsonstr = "{ \"ledmode\":\"move\" }";
-    }
-    send_json(jsonstr);
-    return;
+// ----------------------------------------------------------------------
+// true for a cntlr_config.jsn key that starts, stops or moves a server,
+// the display or the temp probe
+// ----------------------------------------------------------------------
+bool MANAGEMENT_SERVER::setting_restarts(const char *key) {
+  switch (cntlr_keyhash(key)) {
+    MS_KEY("ascom_en") return true;
+    MS_KEY("ascom_port") return true;
+    MS_KEY("mngt_en") return true;
+    MS_KEY("mngt_port") return true;
+    MS_KEY("tcp_en") return true;
+    MS_KEY("tcp_port") return true;
+    MS_KEY("ws_en") return true;
+    MS_KEY("ws_port") return true;
+    MS_KEY("d_en") return true;
+    MS_KEY("t_en") return true;
+    MS_KEY("t_res") return true;
+    default:
+      break;
   }
+  return false;
+}
 
-  // motorspeed
-  va = mserver->arg("motorspeed");
-  if (va != "") {
-    int tmp = va.toInt();
-    if (tmp < SLOW) {
-      tmp = SLOW;
+// ----------------------------------------------------------------------
+// A cntlr_config.jsn setting was set by key, do what the named set? key
+// for it does after setting the value
+// ----------------------------------------------------------------------
+void MANAGEMENT_SERVER::setting_changed(const char *key) {
+  switch (cntlr_keyhash(key)) {
+    MS_KEY("cp_en") {
+      if (ControllerData->get_coilpower_enable() == V_ENABLED) {
+        driverboard->enablemotor();
+      } else {
+        driverboard->releasemotor();
+      }
+      return;
     }
-    if (tmp > FAST) {
-      tmp = FAST;
+    MS_KEY("hpsw_en") {
+      if (ControllerData->get_hpswitch_enable() == V_ENABLED) {
+        driverboard->init_hpsw();
+      }
+      return;
     }
-    ControllerData->set_motorspeed(tmp);
-    jsonstr = "{ \"motorspeed\":\"" + String(tmp) + " }";
-    send_json(jsonstr);
-    return;
+    MS_KEY("led_en") {
+      driverboard->set_leds(ControllerData->get_inoutled_enable() == V_ENABLED);
+      return;
+    }
+    MS_KEY("park_time") {
+      portENTER_CRITICAL(&parkMux);
+      park_maxcount = ControllerData->get_parktime() * 10;  // convert to timeslices
+      portEXIT_CRITICAL(&parkMux);
+      return;
+    }
+    MS_KEY("stall_val") {
+      driverboard->setstallguardvalue(ControllerData->get_stallguard_value());
+      return;
+    }
+    // POST /config only, as set?stallguardstate=
+    MS_KEY("stall_st") {
+      if (ControllerData->get_stallguard_state() == Use_Stallguard) {
+        driverboard->setstallguardvalue(ControllerData->get_stallguard_value());
+      } else {
+        driverboard->setstallguardvalue(0);
+      }
+      driverboard->init_hpsw();
+      return;
+    }
+    MS_KEY("tmc2209mA") {
+      driverboard->settmc2209current(ControllerData->get_tmc2209current());
+      return;
+    }
+    MS_KEY("tmc2225mA") {
+      driverboard->settmc2225current(ControllerData->get_tmc2225current());
+      return;
+    }
+    default:
+      break;
   }
+}
 
-  // motorspeeddelay value
-  va = mserver->arg("motorspeeddelay");
-  if (va != "") {
-    unsigned long tmp = va.toInt();
-    ControllerData->set_brdmsdelay(tmp);
-    jsonstr = "{ \"motorspeeddelay\":\"" + String(tmp) + " }";
-    send_json(jsonstr);
-    return;
-  }
+#undef MS_KEY
 
-  // move - moves focuser position
-  va = mserver->arg("move");
-  if (va != "") {
-    long tmp = va.toInt();
-    tmp = (tmp < 0) ? 0 : tmp;
-    tmp = (tmp > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : tmp;
-    ftargetPosition = tmp;
-    jsonstr = "{ \"move\":" + String(ftargetPosition) + " }";
-    send_json(jsonstr);
-    return;
+// ----------------------------------------------------------------------
+// port of a server after a /config request, the new port or the current
+// ----------------------------------------------------------------------
+static unsigned long config_port(JsonObjectConst settings, const char *key, unsigned long current) {
+  JsonVariantConst v = settings[key];
+  if (v.isNull()) {
+    return current;
   }
+  const char *text = v.as<const char *>();
+  return (text != nullptr) ? strtoul(text, NULL, 10) : v.as<unsigned long>();
+}
 
-  // park enabled state
-  va = mserver->arg("park");
-  if (va != "") {
-    if (va == "enable") {
-      ControllerData->set_park_enable(V_ENABLED);
-      jsonstr = "{ \"park\":\"enabled\" }";
-    } else if (va == "disable") {
-      ControllerData->set_park_enable(V_NOTENABLED);
-      jsonstr = "{ \"park\":\"notenabled\" }";
-    }
-    send_json(jsonstr);
-    return;
-  }
+// ----------------------------------------------------------------------
+// void postconfig(void);
+// POST /config, body { "key":value, ... } using the cntlr_config.jsn keys,
+// or the whole get?cntlrconfig reply. All settings are checked, then
+// applied and saved once. Each setting then does what set? does for it.
+// Servers, display and temp probe affected by the change are started,
+// stopped or restarted once
+// ----------------------------------------------------------------------
+void MANAGEMENT_SERVER::postconfig(void) {
+  debug_server_println("MS-config()");
 
-  // Park time
-  va = mserver->arg("parktime");
-  if (va != "") {
-    int pt = va.toInt();
-    // range check 0 - 300 (5m)
-    pt = (pt < 0) ? 0 : pt;
-    pt = (pt > 600) ? 600 : pt;
-    ControllerData->set_parktime(pt);
-    // update park_maxcount
-    portENTER_CRITICAL(&parkMux);
-    park_maxcount = pt * 10;  // convert to timeslices
-    portEXIT_CRITICAL(&parkMux);
-    jsonstr = "{ \"parktime\":" + String(pt) + " }";
-    send_json(jsonstr);
+  if (!check_access()) {
     return;
   }
 
-  // position - does not move focuser
-  va = mserver->arg("position");
-  if (va != "") {
-    long tmp = va.toInt();
-    tmp = (tmp < 0) ? 0 : tmp;
-    tmp = (tmp > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : tmp;
-    ftargetPosition = tmp;
-    ControllerData->set_fposition(ftargetPosition);  // current position in SPIFFS
-    driverboard->setposition(ftargetPosition);       // current position in driver board
-    jsonstr = "{ \"position\":" + String(ftargetPosition) + " }";
-    send_json(jsonstr);
+  DynamicJsonDocument doc(CONFIGPOSTSIZE);
+  DeserializationError error = deserializeJson(doc, mserver->arg("plain"));
+  if ((error) || (doc.is<JsonObject>() == false)) {
+    mserver->send(BADREQUESTWEBPAGE, JSONPAGETYPE, "{ \"config\":\"error\", \"key\":\"\" }");
     return;
   }
-
-  // reverse direction
-  va = mserver->arg("reverse");
-  if (va != "") {
-    if (va == "enable") {
-      ControllerData->set_reverse_enable(V_ENABLED);
-      jsonstr = "{ \"reverse\":\"enabled\" }";
-    } else if (va == "disable") {
-      ControllerData->set_reverse_enable(V_NOTENABLED);
-      jsonstr = "{ \"reverse\":\"notenabled\" }";
-    }
-    send_json(jsonstr);
-    return;
+  JsonObjectConst settings = doc.as<JsonObjectConst>();
+
+  // server ports must stay different from each other
+  unsigned long ports[5];
+  int nports = 4;
+  ports[0] = config_port(settings, "ascom_port", ControllerData->get_ascomsrvr_port());
+  ports[1] = config_port(settings, "mngt_port", ControllerData->get_mngsrvr_port());
+  ports[2] = config_port(settings, "tcp_port", ControllerData->get_tcpipsrvr_port());
+  ports[3] = config_port(settings, "ws_port", ControllerData->get_websrvr_port());
+#if defined(ENABLE_ELEGANTOTA)
+  // ElegantOTA runs on the management port + OTASERVERPORTOFFSET
+  ports[nports++] = ports[1] + OTASERVERPORTOFFSET;
+#endif
+  for (int i = 0; i < nports; i++) {
+    for (int j = i + 1; j < nports; j++) {
+      if (ports[i] == ports[j]) {
+        mserver->send(BADREQUESTWEBPAGE, JSONPAGETYPE, "{ \"config\":\"error\", \"key\":\"port\" }");
+        return;
+      }
+    }
   }
 
-  va = mserver->arg("stallguardstate");
-  if (va != "") {
-    jsonstr = "{ \"state\": \"not implemented yet\" }";
-    //Use_Stallguard, Use_Physical_Switch, Use_None
-    if (va == "stallguard") {
-      tmc2209stallguard thisstate = Use_Stallguard;
-      // save stallguard source
-      ControllerData->set_stallguard_state(thisstate);
-      // set stallguard value
-      driverboard->setstallguardvalue(ControllerData->get_stallguard_value());
-      // enable hpsw
-      ControllerData->set_hpswitch_enable(V_ENABLED);
-      // reset hpsw
-      driverboard->init_hpsw();
-      debug_server_println(T_STALLGUARD);
-      jsonstr = "{ \"state\": \"Use_Stallguard\" }";
-    } else if (va == "switch") {
-      tmc2209stallguard thisstate = Use_Physical_Switch;
-      // save stallguard source
-      ControllerData->set_stallguard_state(thisstate);
-      // enable hpsw
-      ControllerData->set_hpswitch_enable(V_ENABLED);
-      // disable stallguard for tmc2209
-      driverboard->setstallguardvalue(0);
-      // reset hpsw
-      driverboard->init_hpsw();
-      debug_server_println(T_PHYSICALSWITCH);
-      jsonstr = "{ \"state\": \"Use_Physical_Switch\" }";
-    } else if (va == "none") {
-      tmc2209stallguard thisstate = Use_None;
-      // save state
-      ControllerData->set_stallguard_state(thisstate);
-      // disable hpsw
-      ControllerData->set_hpswitch_enable(V_NOTENABLED);
-      // disable stallguard for tmc2209
-      driverboard->setstallguardvalue(0);
-      // reset hpsw
-      driverboard->init_hpsw();
-      debug_server_println(T_NONE);
-      jsonstr = "{ \"state\": \"Use_None\" }";
-    } else {
-      // error
-    }
-    send_json(jsonstr);
+  // state before the change, to find what must be restarted
+  unsigned long ascomport = ControllerData->get_ascomsrvr_port();
+  unsigned long tcpport = ControllerData->get_tcpipsrvr_port();
+  unsigned long webport = ControllerData->get_websrvr_port();
+  byte tres = ControllerData->get_tempresolution();
+  byte ascomen = ControllerData->get_ascomsrvr_enable();
+  byte tcpen = ControllerData->get_tcpipsrvr_enable();
+  byte weben = ControllerData->get_websrvr_enable();
+  byte den = ControllerData->get_display_enable();
+  byte ten = ControllerData->get_tempprobe_enable();
+
+  String badkey;
+  if (ControllerData->ApplySettings(settings, badkey) == false) {
+    String jsonstr = "{ \"config\":\"error\", \"key\":\"" + badkey + "\" }";
+    mserver->send(BADREQUESTWEBPAGE, JSONPAGETYPE, jsonstr);
     return;
   }
 
-  // stall guard value
-  va = mserver->arg("stallguardvalue");
-  if (va != "") {
-    int tmp = va.toInt();
-    // write value to 2209 registers and update ControllerData
-    driverboard->setstallguardvalue((byte)tmp);
-    tmp = ControllerData->get_stallguard_value();
-    jsonstr = "{ \"sg_value\":" + String(tmp) + " }";
-    send_json(jsonstr);
-    return;
+  // park time, coil power, driver board
+  for (JsonPairConst kv : settings) {
+    setting_changed(kv.key().c_str());
   }
 
-  // stepmode
-  va = mserver->arg("stepmode");
-  if (va != "") {
-    int tmp = va.toInt();
-    // write to pins and update mySetupData
-    driverboard->setstepmode(tmp);
-    // read actual stepmode set by driverboard
-    tmp = ControllerData->get_brdstepmode();
-    jsonstr = "{ \"stepmode\":" + String(tmp) + " }";
-    send_json(jsonstr);
-    return;
+  // ascom alpaca server
+  if (ascomsrvr_status == V_RUNNING) {
+    if (ControllerData->get_ascomsrvr_enable() == V_NOTENABLED) {
+      ascomsrvr->stop();
+      ascomsrvr_status = V_STOPPED;
+    } else if (ControllerData->get_ascomsrvr_port() != ascomport) {
+      ascomsrvr->stop();
+      ascomsrvr_status = ascomsrvr->start();
+    }
+  } else if ((ascomen == V_NOTENABLED) && (ControllerData->get_ascomsrvr_enable() == V_ENABLED)) {
+    ascomsrvr_status = ascomsrvr->start();
   }
 
   // tcpip server
-  va = mserver->arg("tcpipserver");
-  if (va != "") {
-    if (va == "enable") {
-      ControllerData->set_tcpipsrvr_enable(V_ENABLED);
-      jsonstr = "{ \"tcpipserver\":\"enabled\" }";
-    } else if (va == "disable") {
-      if (tcpipsrvr_status == V_RUNNING) {
-        tcpipsrvr->stop();
-      }
-      tcpipsrvr_status = V_STOPPED;
-      ControllerData->set_tcpipsrvr_enable(V_NOTENABLED);
-      jsonstr = "{ \"tcpipserver\":\"notenabled\" }";
-    } else if (va == "start") {
-      if (tcpipsrvr->start(ControllerData->get_tcpipsrvr_port()) == true) {
-        tcpipsrvr_status = V_RUNNING;
-        jsonstr = "{ \"tcpipstatus\":\"running\" }";
-      } else {
-        jsonstr = "{ \"tcpipstatus\":\"stopped\" }";
-      }
-    } else if (va == "stop") {
+  if (tcpipsrvr_status == V_RUNNING) {
+    if (ControllerData->get_tcpipsrvr_enable() == V_NOTENABLED) {
       tcpipsrvr->stop();
       tcpipsrvr_status = V_STOPPED;
-      jsonstr = "{ \"tcpipstatus\":\"stopped\" }";
-    }
-    send_json(jsonstr);
-    return;
-  }
-
-  va = mserver->arg("tcpipport");
-  if (va != "") {
-    if (tcpipsrvr_status == V_STOPPED) {
-      unsigned long tmp = va.toInt();
-      ControllerData->set_tcpipsrvr_port(tmp);
-      jsonstr = "{ \"tcpipport\":" + String(tmp) + " }";
-    } else {
-      // cannot change port when srvr is running
-      jsonstr = "{ \"tcpipport\":\"error-not-set\" }";
-    }
-  }
-
-  // temperature probe enable/disable
-  va = mserver->arg("tempprobe");
-  if (va != "") {
-    if (va == "enable") {
-      // start probe
-      if (tempprobe->get_loaded() != V_RUNNING) {
-        if (tempprobe->start() == true) {
-          // probe was started
-          jsonstr = "{ \"tempprobe\":\"enabled\" }";
-        } else {
-          // did not start
-          jsonstr = "{ \"tempprobe\":\"notenabled\" }";
-        }
-      } else {
-        jsonstr = "{ \"tempprobe\":\"enabled\" }";
-      }
-    } else if (va == "disable") {
-      // is it already off ?
-      if (tempprobe->get_loaded() != V_RUNNING) {
-        jsonstr = "{ \"tempprobe\":\"notenabled\" }";
-      } else {
-        // is loaded so stop probe
-        tempprobe->stop();
-        // there is no destructor call
-        jsonstr = "{ \"tempprobe\":\"notenabled\" }";
-      }
+    } else if (ControllerData->get_tcpipsrvr_port() != tcpport) {
+      tcpipsrvr->stop();
+      tcpipsrvr_status = tcpipsrvr->start(ControllerData->get_tcpipsrvr_port());
     }
-    send_json(jsonstr);
-    return;
-  }
-
-  // tmc2209current
-  va = mserver->arg("tmc2209current");
-  if (va != "") {
-    int tmp = va.toInt();
-    // write current value to tmc22xx, call ControllerData->set_tmc2209current(temp);
-    driverboard->settmc2209current(tmp);
-    jsonstr = "{ \"tmc2209current\":" + String(tmp) + " }";
-    send_json(jsonstr);
-    return;
-  }
-
-  // tmc2225current
-  va = mserver->arg("tmc2225current");
-  if (va != "") {
-    int tmp = va.toInt();
-    // write current value to tmc22xx, call ControllerData->set_tmc2225current(temp);
-    driverboard->settmc2225current(tmp);
-    jsonstr = "{ \"tmc2225current\":" + String(tmp) + " }";
-    send_json(jsonstr);
-    return;
+  } else if ((tcpen == V_NOTENABLED) && (ControllerData->get_tcpipsrvr_enable() == V_ENABLED)) {
+    tcpipsrvr_status = tcpipsrvr->start(ControllerData->get_tcpipsrvr_port());
   }
 
   // web server
-  va = mserver->arg("webserver");
-  if (va != "") {
-    if (va == "enable") {
-      ControllerData->set_websrvr_enable(V_ENABLED);
-      jsonstr = "{ \"webserver\":\"enabled\" }";
-    } else if (va == "disable") {
-      if (websrvr_status == V_RUNNING) {
-        websrvr->stop();
-      }
+  if (websrvr_status == V_RUNNING) {
+    if (ControllerData->get_websrvr_enable() == V_NOTENABLED) {
+      websrvr->stop();
       websrvr_status = V_STOPPED;
-      ControllerData->set_websrvr_enable(V_NOTENABLED);
-      jsonstr = "{ \"webserver\":\"notenabled\" }";
-    } else if (va == "start") {
-      if (websrvr_status == V_STOPPED) {
-        // attempt to start the web server
-        websrvr->start(ControllerData->get_websrvr_port());
-        // did webserver start? then websrvr_status would be V_RUNNING
-        if (websrvr_status == V_RUNNING) {
-          jsonstr = "{ \"webstatus\":\"running\" }";
-        } else {
-          // did not start
-          jsonstr = "{ \"webstatus\":\"stopped\" }";
-        }
-      } else {
-        // already on
-        jsonstr = "{ \"webstatus\":\"running\" }";
-      }
-    } else if (va == "stop") {
-      // is it on?
-      if (websrvr_status == V_RUNNING) {
-        websrvr->stop();
-        jsonstr = "{ \"webstatus\":\"stopped\" }";
-      } else {
-        // already off
-        jsonstr = "{ \"webstatus\":\"stopped\" }";
-      }
+    } else if (ControllerData->get_websrvr_port() != webport) {
+      websrvr->stop();
+      websrvr_status = websrvr->start(ControllerData->get_websrvr_port());
     }
-    send_json(jsonstr);
-    return;
+  } else if ((weben == V_NOTENABLED) && (ControllerData->get_websrvr_enable() == V_ENABLED)) {
+    websrvr_status = websrvr->start(ControllerData->get_websrvr_port());
   }
 
-  // web server
-  va = mserver->arg("webport");
-  if (va != "") {
-    if (websrvr_status == V_STOPPED) {
-      unsigned long tmp = va.toInt();
-      ControllerData->set_websrvr_port(tmp);
-      jsonstr = "{ \"webport\":" + String(tmp) + " }";
-    } else {
-      // cannot change port when srvr is running
+  // display
+  if ((display_status == V_RUNNING) && (ControllerData->get_display_enable() == V_NOTENABLED)) {
+    display_clear();
+    display_stop();
+  } else if ((den == V_NOTENABLED) && (ControllerData->get_display_enable() == V_ENABLED)) {
+    display_start();
+  }
 
-      jsonstr = "{ \"webport\":\"error-not-set\" }";
+  // temperature probe
+  if (tempprobe->get_state() == V_RUNNING) {
+    if (ControllerData->get_tempprobe_enable() == V_NOTENABLED) {
+      tempprobe->stop();
+    } else if (ControllerData->get_tempresolution() != tres) {
+      tempprobe->set_resolution(ControllerData->get_tempresolution());
     }
-    send_json(jsonstr);
-    return;
+  } else if ((ten == V_NOTENABLED) && (ControllerData->get_tempprobe_enable() == V_ENABLED)) {
+    tempprobe->start();
   }
 
-  if (jsonstr != "") {
-    send_json(jsonstr);
-  } else {
-    send_json("{ \"error\":\"not set\" }");
-  }
+  // the management server port is used after a reboot
+  send_json("{ \"config\":\"ok\", \"settings\":" + String(settings.size()) + " }");
 }
 
 // XHTML
@@ -4881,7 +4791,7 @@ void MANAGEMENT_SERVER::handleset(void) {
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getposition() {
   // Send position value only to client ajax request
-  mserver->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(driverboard->getposition()));
+  mserver->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(focuserstate->get_position()));
 }
 
 // ----------------------------------------------------------------------
@@ -4890,7 +4800,7 @@ void MANAGEMENT_SERVER::getposition() {
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::getismoving() {
   // Send isMoving value only to client ajax request
-  if (isMoving == true) {
+  if (focuserstate->get_ismoving() == true) {
     mserver->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, "True");
   } else {
     mserver->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, "False");
@@ -4903,7 +4813,21 @@ void MANAGEMENT_SERVER::getismoving() {
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::gettargetposition() {
   //Send targetPosition value only to client ajax request
-  mserver->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(ftargetPosition));
+  mserver->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(focuserstate->get_target()));
+}
+
+// ----------------------------------------------------------------------
+// subscribe to status events
+// ----------------------------------------------------------------------
+void MANAGEMENT_SERVER::getevents() {
+  _events.subscribe(mserver);
+}
+
+// ----------------------------------------------------------------------
+// get all status fields in one reply
+// ----------------------------------------------------------------------
+void MANAGEMENT_SERVER::getstatus() {
+  send_status(mserver, _parkstate);
 }
 
 
@@ -4936,8 +4860,7 @@ void MANAGEMENT_SERVER::rssi(void) {
 //		   (exisitng file deleted)
 // ----------------------------------------------------------------------
 void MANAGEMENT_SERVER::brdedit() {
-  String AdminPg;
-  AdminPg.reserve(4200);  // 306-01 		3989
+  static HTML_TEMPLATE AdminPg("/brdedit.html");
 
   debug_server_println("MS-brdedit ");
 
@@ -5027,10 +4950,14 @@ void MANAGEMENT_SERVER::brdedit() {
         debug_server_println(T_SAVED);
 
         // NEXT we have to update board_config.jsn file with the new board config
-        // since the brdfile has been saved we could just use ControllerData->LoadDefaultBoardData() to load
-        // the new board - this uses myboardnumber which we have already set
+        // load the brdfile just saved, LoadDefaultBoardData() would take a built in
+        // board from board_table.h rather than the edited file
         debug_server_println("-create new board file");
-        ControllerData->LoadDefaultBoardData();
+        if (ControllerData->LoadBrdConfigStart(brdfile) == true) {
+          ControllerData->SaveBoardConfiguration();
+        } else {
+          ControllerData->LoadDefaultBoardData();
+        }
 
         // Setup up the all ok in the universe page, and send to user
         send_redirect("/success");
@@ -5044,11 +4971,7 @@ void MANAGEMENT_SERVER::brdedit() {
   }
 
   // get handler
-  if (SPIFFS.exists("/brdedit.html")) {
-    File file = SPIFFS.open("/brdedit.html", "r");
-    AdminPg = file.readString();
-    file.close();
-
+  if (AdminPg.load()) {
     AdminPg.replace("%PGT%", devicename);
     // Web page colors
     AdminPg.replace("%TIC%", titlecolor);
@@ -5059,7 +4982,7 @@ void MANAGEMENT_SERVER::brdedit() {
 
     // put all the board settings into a table, so that the form will submit all elements to board save
     AdminPg.replace("%STA%", "<table><tr><td><form action=\"/brdedit\" method=\"post\"><input type=\"hidden\" name=\"wrbrd\" value=\"true\"></td><td> </td></tr>");
-    AdminPg.replace("%BRD%", "<tr><td>Board Name </td><td><input type=\"text\" name=\"brd\" value=\"" + ControllerData->get_brdname() + "\"></td></tr>");
+    AdminPg.replace("%BRD%", "<tr><td>Board Name </td><td><input type=\"text\" name=\"brd\" value=\"" + String(ControllerData->get_brdname()) + "\"></td></tr>");
     AdminPg.replace("%MAX%", "<tr><td>MaxStepMode </td><td><input type=\"text\" name=\"max\" value=\"" + String(ControllerData->get_brdmaxstepmode()) + "\"></td></tr>");
     AdminPg.replace("%STM%", "<tr><td>Step Mode </td><td><input type=\"text\" name=\"stm\" value=\"" + String(ControllerData->get_brdstepmode()) + "\"></td></tr>");
     AdminPg.replace("%ENP%", "<tr><td>Enable pin </td><td><input type=\"text\" name=\"enp\" value=\"" + String(ControllerData->get_brdenablepin()) + "\"></td></tr>");
@@ -5100,13 +5023,10 @@ void MANAGEMENT_SERVER::brdedit() {
     AdminPg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    AdminPg = H_FILENOTFOUNDSTR;
+    AdminPg.set_text(H_FILENOTFOUNDSTR);
   }
   debug_server_print(T_BOARDEDIT);
   debug_server_println(AdminPg.length());
-  mserver->client().println("HTTP/1.1 200 OK");
-  mserver->client().println("Content-type:text/html");
-  mserver->client().println();
-  mserver->client().print(AdminPg);
-  mserver->client().println();
+  send_myheader(AdminPg.length());
+  AdminPg.render(mserver->content());
 }
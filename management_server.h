@@ -11,7 +11,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>  // Benoit Blanchon https://github.com/bblanchon/ArduinoJson
 #include "SPIFFS.h"
-#include <WebServer.h>
+#include "http_server.h"
+#include "status_events.h"
 
 
 // ----------------------------------------------------------------------
@@ -48,6 +49,8 @@ public:
   void getposition(void);
   void getismoving(void);
   void gettargetposition(void);
+  void getevents(void);
+  void getstatus(void);
 
   // file management
   void get_filelist_long(void);
@@ -64,6 +67,7 @@ public:
   void handlecmds(void);
   void handleget(void);
   void handleset(void);
+  void postconfig(void);
 
   // board management
   void brdedit(void);
@@ -76,14 +80,20 @@ private:
   void checkreboot(void);
   void focuser_moving(void);
   void file_sys_error(void);
-  void send_myheader(void);
-  void send_mycontent(String);
+  void send_myheader(size_t);
   void send_json(String);
-  String get_contenttype(String);
+  bool get_value(const char *, JsonDocument &);
+  void set_value(const char *, const String &, JsonDocument &);
+  bool setting_restarts(const char *);
+  void setting_changed(const char *);
   bool is_hexdigit(char);
 
   File _fsUploadFile;
-  WebServer *mserver;
+  HTTP_SERVER *mserver;
+#if defined(ENABLE_ELEGANTOTA)
+  WebServer *_otaserver;  // ElegantOTA needs an Arduino WebServer
+#endif
+  STATUS_EVENTS _events;
   unsigned int _port = MNGSERVERPORT;
   bool _loaded = false;
   bool _parkstate = true;
@@ -0,0 +1,264 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 STATUS EVENTS
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// status_events.cpp
+// ----------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------
+// INCLUDES
+// ----------------------------------------------------------------------
+#include <Arduino.h>
+#include "controller_config.h"
+#include "http_server.h"
+#include <WiFiClient.h>
+#include "lwip/sockets.h"
+
+#include "controller_data.h"
+extern CONTROLLER_DATA *ControllerData;
+
+#include "focuser_state.h"
+extern FOCUSER_STATE *focuserstate;
+
+#include "status_events.h"
+
+
+// ----------------------------------------------------------------------
+// /status reply, built in a stack buffer
+// ----------------------------------------------------------------------
+void send_status(HTTP_SERVER *server, bool parked) {
+  Focuser_Status fs = focuserstate->get();
+  bool coil = ControllerData->get_coilpower_enable();
+  unsigned long seq = (fs.version << 2) | (parked ? 2 : 0) | (coil ? 1 : 0);
+
+  char etag[16];
+  snprintf(etag, sizeof(etag), "\"%lu\"", seq);
+  server->sendHeader("ETag", etag);
+  server->sendHeader("Cache-Control", "no-cache");
+  server->sendHeader("Access-Control-Allow-Origin", "*");
+  if (server->header("If-None-Match").equals(etag) || (server->hasArg("seq") && (server->arg("seq").toInt() == (long)seq))) {
+    server->send(NOTMODIFIEDWEBPAGE);
+    return;
+  }
+
+  char buf[STATUSLEN];
+  int len = snprintf(buf, sizeof(buf), "{\"seq\":%lu,\"position\":%ld,\"target\":%ld,\"moving\":%d,\"temp\":%.2f,\"park\":%d,\"coilpower\":%d}",
+                     seq, fs.position, fs.target, fs.ismoving ? 1 : 0, fs.temp, parked ? 1 : 0, coil ? 1 : 0);
+  // buf is gone before the reply is sent, copied
+  server->setContentLength(len);
+  server->send(NORMALWEBPAGE, JSONPAGETYPE, "");
+  server->sendContent(buf, len);
+}
+
+
+// ----------------------------------------------------------------------
+// CLASS
+// ----------------------------------------------------------------------
+STATUS_EVENTS::STATUS_EVENTS(void) {
+  for (int i = 0; i < EVENTCLIENTS; i++) {
+    _inuse[i] = false;
+    _pendlen[i] = 0;
+  }
+  _sent.version = 0;
+}
+
+// ----------------------------------------------------------------------
+// Handler for /events, keep the connection and send the whole status
+// ----------------------------------------------------------------------
+void STATUS_EVENTS::subscribe(HTTP_SERVER *server) {
+  int slot = -1;
+  for (int i = 0; i < EVENTCLIENTS; i++) {
+    if (_inuse[i] == false) {
+      slot = i;
+      break;
+    }
+  }
+  if (slot == -1) {
+    debug_server_println("-events full");
+    server->send(503, PLAINTEXTPAGETYPE, "busy");
+    return;
+  }
+
+  // the copy keeps the socket open after the server has finished the request
+  _clients[slot] = server->client();
+  _inuse[slot] = true;
+  _pendlen[slot] = 0;
+  _count++;
+
+  static const char head[] = "HTTP/1.1 200 OK\r\n"
+                             "Content-Type: text/event-stream\r\n"
+                             "Cache-Control: no-cache\r\n"
+                             "Connection: keep-alive\r\n"
+                             "Access-Control-Allow-Origin: *\r\n\r\n"
+                             "retry: 3000\n\n";
+  send_client(slot, head, sizeof(head) - 1);
+
+  Focuser_Status fs = focuserstate->get();
+  bool coil = ControllerData->get_coilpower_enable();
+  String msg = make_json(fs, _parked, coil, true);
+  send_client(slot, msg.c_str(), msg.length());
+  if (_count == 1) {
+    // first browser, later updates are changes from now
+    _sent = fs;
+    _sentpark = _parked;
+    _sentcoil = coil;
+  }
+  debug_server_print("-events subscribe ");
+  debug_server_println(slot);
+}
+
+// ----------------------------------------------------------------------
+// "data: {...}\n\n" with the fields that differ from the last status
+// sent, or all fields
+// ----------------------------------------------------------------------
+String STATUS_EVENTS::make_json(const Focuser_Status &fs, bool park, bool coil, bool all) {
+  String msg;
+  msg.reserve(100);
+  msg = "data: {";
+  if (all || (fs.position != _sent.position)) {
+    msg += "\"position\":" + String(fs.position) + ",";
+  }
+  if (all || (fs.target != _sent.target)) {
+    msg += "\"target\":" + String(fs.target) + ",";
+  }
+  if (all || (fs.ismoving != _sent.ismoving)) {
+    msg += "\"moving\":" + String(fs.ismoving ? 1 : 0) + ",";
+  }
+  if (all || (fs.temp != _sent.temp)) {
+    msg += "\"temp\":" + String(fs.temp, 2) + ",";
+  }
+  if (all || (park != _sentpark)) {
+    msg += "\"park\":" + String(park ? 1 : 0) + ",";
+  }
+  if (all || (coil != _sentcoil)) {
+    msg += "\"coilpower\":" + String(coil ? 1 : 0) + ",";
+  }
+  if (msg.endsWith(",")) {
+    msg.remove(msg.length() - 1);
+  }
+  msg += "}\n\n";
+  return msg;
+}
+
+void STATUS_EVENTS::send_all(const String &msg) {
+  for (int i = 0; i < EVENTCLIENTS; i++) {
+    if (_inuse[i]) {
+      send_client(i, msg.c_str(), msg.length());
+    }
+  }
+}
+
+// ----------------------------------------------------------------------
+// Send without waiting, what the socket does not take is kept in the
+// pending buffer of the browser, behind anything already there
+// ----------------------------------------------------------------------
+void STATUS_EVENTS::send_client(int i, const char *data, size_t len) {
+  send_pending(i);
+  if ((_inuse[i] == false) || (len == 0)) {
+    return;
+  }
+  if (_pendlen[i] == 0) {
+    int n = lwip_send(_clients[i].fd(), data, len, MSG_DONTWAIT);
+    if (n > 0) {
+      data += n;
+      len -= n;
+    } else if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK))) {
+      drop(i);
+      return;
+    }
+  }
+  if (len == 0) {
+    return;
+  }
+  if ((_pendlen[i] + len) > EVENTPENDING) {
+    // too far behind
+    debug_server_print("-events slow ");
+    drop(i);
+    return;
+  }
+  memcpy(&_pending[i][_pendlen[i]], data, len);
+  _pendlen[i] += len;
+}
+
+void STATUS_EVENTS::send_pending(int i) {
+  if ((_inuse[i] == false) || (_pendlen[i] == 0)) {
+    return;
+  }
+  int n = lwip_send(_clients[i].fd(), _pending[i], _pendlen[i], MSG_DONTWAIT);
+  if (n > 0) {
+    memmove(_pending[i], &_pending[i][n], _pendlen[i] - n);
+    _pendlen[i] -= n;
+  } else if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK))) {
+    drop(i);
+  }
+}
+
+void STATUS_EVENTS::drop(int i) {
+  _clients[i].stop();
+  _clients[i] = WiFiClient();
+  _inuse[i] = false;
+  _pendlen[i] = 0;
+  _count--;
+  debug_server_print("-events close ");
+  debug_server_println(i);
+}
+
+// ----------------------------------------------------------------------
+// Called after the server handleClient(), send what has changed
+// ----------------------------------------------------------------------
+void STATUS_EVENTS::loop(bool parked) {
+  _parked = parked;
+  if (_count == 0) {
+    return;
+  }
+
+  // drop closed connections, send what is pending
+  for (int i = 0; i < EVENTCLIENTS; i++) {
+    if (_inuse[i] == false) {
+      continue;
+    }
+    if (!_clients[i].connected()) {
+      drop(i);
+    } else {
+      send_pending(i);
+    }
+  }
+  if (_count == 0) {
+    return;
+  }
+
+  unsigned long now = millis();
+  Focuser_Status fs = focuserstate->get();
+  bool coil = ControllerData->get_coilpower_enable();
+
+  if ((fs.version != _sent.version) || (parked != _sentpark) || (coil != _sentcoil)) {
+    // limit updates while moving, the end of a move is sent at once
+    if (fs.ismoving && ((now - _lastpush) < EVENTPUSHMIN)) {
+      return;
+    }
+    String msg = make_json(fs, parked, coil, false);
+    if (!msg.startsWith("data: {}")) {
+      send_all(msg);
+    }
+    _sent = fs;
+    _sentpark = parked;
+    _sentcoil = coil;
+    _lastpush = now;
+    _lastalive = now;
+  } else if ((now - _lastalive) > EVENTKEEPALIVE) {
+    send_all(":\n\n");
+    _lastalive = now;
+  }
+}
+
+// ----------------------------------------------------------------------
+// Close all subscriptions, the server is stopping
+// ----------------------------------------------------------------------
+void STATUS_EVENTS::stop(void) {
+  for (int i = 0; i < EVENTCLIENTS; i++) {
+    if (_inuse[i]) {
+      drop(i);
+    }
+  }
+  _count = 0;
+}
@@ -0,0 +1,74 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 STATUS EVENTS
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// status_events.h
+// ----------------------------------------------------------------------
+
+#if !defined(_status_events_h)
+#define _status_events_h
+
+#include <Arduino.h>
+#include "http_server.h"
+#include <WiFiClient.h>
+#include "focuser_state.h"
+
+#define EVENTCLIENTS 4         // browsers subscribed to one server at once
+#define EVENTPUSHMIN 250       // ms between updates while moving
+#define EVENTKEEPALIVE 15000   // ms, comment sent to an idle browser to find closed connections
+#define STATUSLEN 160          // /status reply
+#define EVENTPENDING 512       // bytes a browser can fall behind before it is dropped
+
+
+// ----------------------------------------------------------------------
+// Handler for /status, shared by the Web, Management and ASCOM servers.
+// One reply with every polled field, instead of /po /im /ta /tm /pa /cp
+// {"seq":n,"position":n,"target":n,"moving":0,"temp":20.50,"park":1,"coilpower":0}
+// seq changes when any field changes. It is also the ETag, a client that
+// sends it back as If-None-Match, or as /status?seq=n, gets a 304
+// ----------------------------------------------------------------------
+void send_status(HTTP_SERVER *, bool);  // server, park state
+
+
+// ----------------------------------------------------------------------
+// STATUS_EVENTS Class
+// Server-Sent Events on /events for the Web and Management servers.
+// A browser subscribes once with EventSource("/events") and gets the
+// whole status as JSON, then only the fields that change, eg
+// data: {"position":1200,"moving":1}
+// Fields: position, target, moving, temp, park, coilpower
+// While moving, updates are sent at most every EVENTPUSHMIN ms. The end of
+// a move is sent at once. The /po /im /ta ... handlers stay for old pages
+// Sends never wait for the socket. What a browser cannot take now waits
+// in its pending buffer, a browser that falls EVENTPENDING bytes behind
+// is dropped, it reconnects after retry ms
+// ----------------------------------------------------------------------
+class STATUS_EVENTS {
+public:
+  STATUS_EVENTS(void);
+  void subscribe(HTTP_SERVER *);  // handler for /events
+  void loop(bool);                // send changes, arg is park state
+  void stop(void);                // close all subscriptions
+
+private:
+  String make_json(const Focuser_Status &, bool, bool, bool);
+  void send_all(const String &);
+  void send_client(int, const char *, size_t);
+  void send_pending(int);
+  void drop(int);
+
+  WiFiClient _clients[EVENTCLIENTS];
+  bool _inuse[EVENTCLIENTS];
+  char _pending[EVENTCLIENTS][EVENTPENDING];  // not yet taken by the socket
+  uint16_t _pendlen[EVENTCLIENTS];
+  int _count = 0;
+
+  Focuser_Status _sent;         // last status sent to all browsers
+  bool _parked = true;          // park state from the last loop()
+  bool _sentpark = true;
+  bool _sentcoil = false;
+  unsigned long _lastpush = 0;
+  unsigned long _lastalive = 0;
+};
+
+
+#endif  // #if !defined(_status_events_h)
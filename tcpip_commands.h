@@ -0,0 +1,190 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 TCP/IP COMMAND TABLE
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// Copyright Holger M, 2019-2021. All Rights Reserved.
+// tcpip_commands.h
+// ----------------------------------------------------------------------
+
+#ifndef _tcpip_commands_h
+#define _tcpip_commands_h
+
+#include <Arduino.h>
+
+
+// ----------------------------------------------------------------------
+// COMMAND CLASSES
+// ----------------------------------------------------------------------
+enum Tcp_Cmd_Class { Cmd_Get,    // read only, reply from ControllerData or the focuser state snapshot
+                     Cmd_Set,    // change a setting, a server or halt
+                     Cmd_Idle }; // change position or target, ignored whilst moving
+
+
+// ----------------------------------------------------------------------
+// ARGUMENTS
+// The parameter is parsed once, before the handler is called
+// ----------------------------------------------------------------------
+enum Tcp_Arg_Types { Arg_None,   // no parameter
+                     Arg_Digit,  // first character, 0-9
+                     Arg_Long,   // signed integer
+                     Arg_Text }; // the handler parses the text
+
+struct Tcp_Args {
+  const char *text;  // parameter as received, terminated
+  long value;        // Arg_Digit or Arg_Long, else 0
+};
+
+
+// ----------------------------------------------------------------------
+// OPCODE
+// NN is 0-99, A0-C9 is 100-129, anything else is -1
+// ----------------------------------------------------------------------
+constexpr bool tcp_isdigit(char c) {
+  return (c >= '0') && (c <= '9');
+}
+
+constexpr int tcp_opcode(const char *op) {
+  return !tcp_isdigit(op[1])                  ? -1
+         : tcp_isdigit(op[0])                 ? ((op[0] - '0') * 10) + (op[1] - '0')
+         : ((op[0] >= 'A') && (op[0] <= 'C')) ? 100 + ((op[0] - 'A') * 10) + (op[1] - '0')
+                                              : -1;
+}
+
+
+// ----------------------------------------------------------------------
+// COMMAND TABLE
+// X(opcode, handler, class, argument)
+// A transport looks up the opcode of :NNparam# and calls cmd_handler.
+// Not listed, :53 :84 :96 :97 reserved, :B9 :C0 deprecated
+// ----------------------------------------------------------------------
+#define TCP_COMMANDS(X) \
+  X(00, getposition, Cmd_Get, Arg_None) \
+  X(01, getismoving, Cmd_Get, Arg_None) \
+  X(02, getstatus, Cmd_Get, Arg_None) \
+  X(03, getversion, Cmd_Get, Arg_None) \
+  X(04, getbrdversion, Cmd_Get, Arg_None) \
+  X(05, movetarget, Cmd_Idle, Arg_Long) \
+  X(06, gettemp, Cmd_Get, Arg_None) \
+  X(07, setmaxstep, Cmd_Set, Arg_Long) \
+  X(08, getmaxstep, Cmd_Get, Arg_None) \
+  X(09, getinoutledmode, Cmd_Get, Arg_None) \
+  X(10, getmaxincrement, Cmd_Get, Arg_None) \
+  X(11, getcoilpower, Cmd_Get, Arg_None) \
+  X(12, setcoilpower, Cmd_Set, Arg_Digit) \
+  X(13, getreverse, Cmd_Get, Arg_None) \
+  X(14, setreverse, Cmd_Idle, Arg_Digit) \
+  X(15, setmotorspeed, Cmd_Set, Arg_Long) \
+  X(16, setcelsius, Cmd_Set, Arg_None) \
+  X(17, setfahrenheit, Cmd_Set, Arg_None) \
+  X(18, setstepsizeenable, Cmd_Set, Arg_Digit) \
+  X(19, setstepsize, Cmd_Set, Arg_Text) \
+  X(20, settempresolution, Cmd_Set, Arg_Long) \
+  X(21, gettempresolution, Cmd_Get, Arg_None) \
+  X(22, settempcoefficient, Cmd_Set, Arg_Long) \
+  X(23, settempcomp, Cmd_Set, Arg_Digit) \
+  X(24, gettempcomp, Cmd_Get, Arg_None) \
+  X(25, gettcavailable, Cmd_Get, Arg_None) \
+  X(26, gettempcoefficient, Cmd_Get, Arg_None) \
+  X(27, halt, Cmd_Set, Arg_None) \
+  X(28, home, Cmd_Idle, Arg_None) \
+  X(29, getstepmode, Cmd_Get, Arg_None) \
+  X(30, setstepmode, Cmd_Set, Arg_Long) \
+  X(31, setposition, Cmd_Idle, Arg_Long) \
+  X(32, getstepsizeenable, Cmd_Get, Arg_None) \
+  X(33, getstepsize, Cmd_Get, Arg_None) \
+  X(34, getpagetime, Cmd_Get, Arg_None) \
+  X(35, setpagetime, Cmd_Set, Arg_Long) \
+  X(36, setdisplaystate, Cmd_Set, Arg_Digit) \
+  X(37, getdisplaystatus, Cmd_Get, Arg_None) \
+  X(38, gettempmode, Cmd_Get, Arg_None) \
+  X(39, gettarget, Cmd_Get, Arg_None) \
+  X(40, reboot, Cmd_Set, Arg_None) \
+  X(41, setinoutledmode, Cmd_Set, Arg_Digit) \
+  X(42, setdefaults, Cmd_Idle, Arg_None) \
+  X(43, getmotorspeed, Cmd_Get, Arg_None) \
+  X(44, getparkenable, Cmd_Get, Arg_None) \
+  X(45, setparkenable, Cmd_Set, Arg_Digit) \
+  X(46, getinoutledenable, Cmd_Get, Arg_None) \
+  X(47, setinoutledenable, Cmd_Set, Arg_Digit) \
+  X(48, savesettings, Cmd_Idle, Arg_None) \
+  X(49, getid, Cmd_Get, Arg_None) \
+  X(50, gethpswenable, Cmd_Get, Arg_None) \
+  X(51, getipaddress, Cmd_Get, Arg_None) \
+  X(52, getparked, Cmd_Get, Arg_None) \
+  X(54, getssid, Cmd_Get, Arg_None) \
+  X(55, getmsdelay, Cmd_Get, Arg_None) \
+  X(56, setmsdelay, Cmd_Set, Arg_Long) \
+  X(57, getpushbuttons, Cmd_Get, Arg_None) \
+  X(58, setpushbuttons, Cmd_Set, Arg_Digit) \
+  X(59, getparktime, Cmd_Get, Arg_None) \
+  X(60, setparktime, Cmd_Set, Arg_Long) \
+  X(61, setupdateonmove, Cmd_Set, Arg_Digit) \
+  X(62, getupdateonmove, Cmd_Get, Arg_None) \
+  X(63, gethpsw, Cmd_Get, Arg_None) \
+  X(64, movesteps, Cmd_Idle, Arg_Long) \
+  X(65, setjogging, Cmd_Set, Arg_Digit) \
+  X(66, getjogging, Cmd_Get, Arg_None) \
+  X(67, setjogdirection, Cmd_Set, Arg_Digit) \
+  X(68, getjogdirection, Cmd_Get, Arg_None) \
+  X(69, getpbsteps, Cmd_Get, Arg_None) \
+  X(70, setpbsteps, Cmd_Set, Arg_Long) \
+  X(71, setdelayaftermove, Cmd_Set, Arg_Long) \
+  X(72, getdelayaftermove, Cmd_Get, Arg_None) \
+  X(73, setbacklashinenable, Cmd_Set, Arg_Digit) \
+  X(74, getbacklashinenable, Cmd_Get, Arg_None) \
+  X(75, setbacklashoutenable, Cmd_Set, Arg_Digit) \
+  X(76, getbacklashoutenable, Cmd_Get, Arg_None) \
+  X(77, setbacklashin, Cmd_Set, Arg_Long) \
+  X(78, getbacklashin, Cmd_Get, Arg_None) \
+  X(79, setbacklashout, Cmd_Set, Arg_Long) \
+  X(80, getbacklashout, Cmd_Get, Arg_None) \
+  X(81, getstallguard, Cmd_Get, Arg_None) \
+  X(82, setstallguard, Cmd_Set, Arg_Long) \
+  X(83, gettempprobefound, Cmd_Get, Arg_None) \
+  X(85, getdelayaftermoveenable, Cmd_Get, Arg_None) \
+  X(86, setdelayaftermoveenable, Cmd_Set, Arg_Digit) \
+  X(87, gettcdirection, Cmd_Get, Arg_None) \
+  X(88, settcdirection, Cmd_Set, Arg_Digit) \
+  X(89, getstepperpower, Cmd_Get, Arg_None) \
+  X(90, setpreset, Cmd_Set, Arg_Text) \
+  X(91, getpreset, Cmd_Get, Arg_Long) \
+  X(92, setpageoption, Cmd_Set, Arg_Text) \
+  X(93, getpageoption, Cmd_Get, Arg_None) \
+  X(94, setdelayeddisplay, Cmd_Set, Arg_Digit) \
+  X(95, getdelayeddisplay, Cmd_Get, Arg_None) \
+  X(98, getrssi, Cmd_Get, Arg_None) \
+  X(99, sethpswenable, Cmd_Set, Arg_Digit) \
+  X(A0, getjoystick1, Cmd_Get, Arg_None) \
+  X(A1, setjoystick1, Cmd_Set, Arg_Digit) \
+  X(A2, getjoystick2, Cmd_Get, Arg_None) \
+  X(A3, setjoystick2, Cmd_Set, Arg_Digit) \
+  X(A4, gettempprobeenable, Cmd_Get, Arg_None) \
+  X(A5, settempprobeenable, Cmd_Set, Arg_Digit) \
+  X(A6, getascomenable, Cmd_Get, Arg_None) \
+  X(A7, setascomenable, Cmd_Set, Arg_Digit) \
+  X(A8, getascomstatus, Cmd_Get, Arg_None) \
+  X(A9, setascomstatus, Cmd_Set, Arg_Digit) \
+  X(B0, getwebenable, Cmd_Get, Arg_None) \
+  X(B1, setwebenable, Cmd_Set, Arg_Digit) \
+  X(B2, getwebstatus, Cmd_Get, Arg_None) \
+  X(B3, setwebstatus, Cmd_Set, Arg_Digit) \
+  X(B4, getmngenable, Cmd_Get, Arg_None) \
+  X(B5, setmngenable, Cmd_Set, Arg_Digit) \
+  X(B6, getmngstatus, Cmd_Get, Arg_None) \
+  X(B7, setmngstatus, Cmd_Set, Arg_Digit) \
+  X(B8, getcntlrconfig, Cmd_Get, Arg_None) \
+  X(C1, subscribe, Cmd_Set, Arg_Long) \
+  X(C2, getsubscribe, Cmd_Get, Arg_None) \
+  X(C3, getdeferred, Cmd_Get, Arg_None)
+
+
+// ----------------------------------------------------------------------
+// INDEX OF EACH COMMAND IN THE TABLE
+// ----------------------------------------------------------------------
+enum Tcp_Commands {
+#define X(op, name, cmdclass, argtype) Tcp_##name,
+  TCP_COMMANDS(X)
+#undef X
+  Tcp_Command_Count
+};
+
+#endif  // _tcpip_commands_h
@@ -0,0 +1,235 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 TCP/IP COMMAND PARSER
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// Copyright Holger M, 2019-2021. All Rights Reserved.
+// tcpip_parser.cpp
+// Receive ring buffer and parser of :NNparam# commands and binary frames,
+// and the builder of binary response frames
+// ----------------------------------------------------------------------
+
+
+// ----------------------------------------------------------------------
+// INCLUDES
+// ----------------------------------------------------------------------
+#include <Arduino.h>
+#include "tcpip_parser.h"
+
+#define TCPEOFSTR '#'  // 0x23   '#'  end of command
+
+
+// ----------------------------------------------------------------------
+// Empty the receive buffer of a new connection
+// ----------------------------------------------------------------------
+void tcp_rx_reset(Tcp_Rx &rx) {
+  rx.head = 0;
+  rx.tail = 0;
+  rx.state = Parse_Start;
+  rx.mode = Mode_Unknown;
+}
+
+// ----------------------------------------------------------------------
+// Copy bytes into the receive ring, returns how many fitted
+// ----------------------------------------------------------------------
+int tcp_rx_put(Tcp_Rx &rx, const char *data, int len) {
+  // one slot is kept empty to tell a full ring from an empty one
+  int space = (rx.tail - rx.head - 1) & (TCPRXBUFSIZE - 1);
+  int n = (len > space) ? space : len;
+  for (int i = 0; i < n; i++) {
+    rx.ring[rx.head] = data[i];
+    rx.head = (rx.head + 1) & (TCPRXBUFSIZE - 1);
+  }
+  return n;
+}
+
+// ----------------------------------------------------------------------
+// CRC16-CCITT of binary frames
+// ----------------------------------------------------------------------
+uint16_t tcp_crc16(uint16_t crc, uint8_t data) {
+  crc ^= (uint16_t)data << 8;
+  for (int i = 0; i < 8; i++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+  }
+  return crc;
+}
+
+// ----------------------------------------------------------------------
+// Parse the receive buffer of a client for the next :NNparam# command
+// Returns true when a command is in rx.cmd and rx.param. A partial
+// command stays in the parser state until the rest arrives. Bytes before
+// the ':' are ignored, and a command with a parameter that does not fit
+// in TCPPARAMLEN is dropped
+// ----------------------------------------------------------------------
+bool tcp_next_command(Tcp_Rx &rx) {
+
+  // the first byte of a connection selects text or binary frames
+  if ((rx.mode == Mode_Unknown) && (rx.tail != rx.head)) {
+    rx.mode = (rx.ring[rx.tail] == (char)TCPFRAMESOF) ? Mode_Binary : Mode_Text;
+  }
+  if (rx.mode == Mode_Binary) {
+    return tcp_next_frame(rx);
+  }
+
+  while (rx.tail != rx.head) {
+    char c = rx.ring[rx.tail];
+    rx.tail = (rx.tail + 1) & (TCPRXBUFSIZE - 1);
+
+    // a ':' always starts a new command
+    if (c == ':') {
+      rx.len = 0;
+      rx.state = Parse_Cmd;
+      continue;
+    }
+
+    switch (rx.state) {
+      case Parse_Cmd:
+        if (c == TCPEOFSTR) {
+          rx.state = Parse_Start;
+        } else {
+          rx.cmd[rx.len++] = c;
+          if (rx.len == 2) {
+            rx.cmd[2] = 0;
+            rx.len = 0;
+            rx.state = Parse_Param;
+          }
+        }
+        break;
+
+      case Parse_Param:
+        if (c == TCPEOFSTR) {
+          rx.param[rx.len] = 0;
+          rx.state = Parse_Start;
+          return true;
+        }
+        if (rx.len < (TCPPARAMLEN - 1)) {
+          rx.param[rx.len++] = c;
+        } else {
+          rx.state = Parse_Skip;
+        }
+        break;
+
+      case Parse_Skip:
+        if (c == TCPEOFSTR) {
+          rx.state = Parse_Start;
+        }
+        break;
+
+      default:
+        // Parse_Start, wait for ':'
+        break;
+    }
+  }
+  return false;
+}
+
+// ----------------------------------------------------------------------
+// Parse the receive buffer of a binary client for the next frame
+// Returns true when a frame is in rx.opcode, seq, plen and param, with
+// rx.bad set if the crc is wrong or the payload did not fit
+// ----------------------------------------------------------------------
+bool tcp_next_frame(Tcp_Rx &rx) {
+
+  while (rx.tail != rx.head) {
+    uint8_t c = (uint8_t)rx.ring[rx.tail];
+    rx.tail = (rx.tail + 1) & (TCPRXBUFSIZE - 1);
+
+    switch (rx.state) {
+      case Parse_Opcode:
+        rx.crc = tcp_crc16(0xFFFF, c);
+        rx.opcode = c;
+        rx.state = Parse_Seq;
+        break;
+
+      case Parse_Seq:
+        rx.crc = tcp_crc16(rx.crc, c);
+        rx.seq = c;
+        rx.state = Parse_Len;
+        break;
+
+      case Parse_Len:
+        rx.crc = tcp_crc16(rx.crc, c);
+        rx.plen = c;
+        rx.len = 0;
+        rx.bad = (c > (TCPPARAMLEN - 1));
+        rx.state = (c == 0) ? Parse_Crc : Parse_Payload;
+        break;
+
+      case Parse_Payload:
+        rx.crc = tcp_crc16(rx.crc, c);
+        if (rx.len < (TCPPARAMLEN - 1)) {
+          rx.param[rx.len] = c;
+        }
+        rx.len++;
+        if (rx.len == rx.plen) {
+          rx.state = Parse_Crc;
+        }
+        break;
+
+      case Parse_Crc:
+        rx.rxcrc = c;
+        rx.state = Parse_Crc2;
+        break;
+
+      case Parse_Crc2:
+        rx.rxcrc |= (uint16_t)c << 8;
+        rx.state = Parse_Start;
+        if (rx.rxcrc != rx.crc) {
+          rx.bad = true;
+        } else if (rx.bad == false) {
+          rx.param[rx.plen] = 0;
+        }
+        return true;
+
+      default:
+        // Parse_Start, wait for SOF
+        if (c == TCPFRAMESOF) {
+          rx.state = Parse_Opcode;
+        }
+        break;
+    }
+  }
+  return false;
+}
+
+
+// ----------------------------------------------------------------------
+// Add a reply to the payload of a binary response frame
+// ----------------------------------------------------------------------
+uint8_t tcp_add_payload(uint8_t *payload, uint8_t paylen, const char token, byte type, const void *data, size_t len) {
+  size_t room = TCPPAYLOADLEN - paylen;
+  size_t need = (type == Bin_Text) ? len + 3 : len + 2;
+  if (need > room) {
+    if ((type != Bin_Text) || (room < 3)) {
+      return paylen;
+    }
+    // truncate text to fit
+    len = room - 3;
+  }
+  payload[paylen++] = token;
+  payload[paylen++] = type;
+  if (type == Bin_Text) {
+    payload[paylen++] = (uint8_t)len;
+  }
+  memcpy(&payload[paylen], data, len);
+  return paylen + len;
+}
+
+// ----------------------------------------------------------------------
+// Build a binary frame, the crc covers opcode to payload
+// ----------------------------------------------------------------------
+size_t tcp_build_frame(uint8_t *frame, uint8_t opcode, uint8_t seq, const uint8_t *payload, uint8_t len) {
+  size_t n = 0;
+
+  frame[n++] = TCPFRAMESOF;
+  frame[n++] = opcode;
+  frame[n++] = seq;
+  frame[n++] = len;
+  memcpy(&frame[n], payload, len);
+  n += len;
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 1; i < n; i++) {
+    crc = tcp_crc16(crc, frame[i]);
+  }
+  frame[n++] = crc & 0xff;
+  frame[n++] = crc >> 8;
+  return n;
+}
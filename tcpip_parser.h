@@ -0,0 +1,106 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 TCP/IP COMMAND PARSER
+// Copyright Robert Brown 2014-2023. All Rights Reserved.
+// Copyright Holger M, 2019-2021. All Rights Reserved.
+// tcpip_parser.h
+// ----------------------------------------------------------------------
+
+#if !defined(_tcpip_parser_h)
+#define _tcpip_parser_h
+
+#include <Arduino.h>
+
+#define TCPRXBUFSIZE 64  // receive ring buffer of each client, power of 2
+#define TCPPARAMLEN 32   // longest parameter of a :NNparam# command, including terminator
+#define TCPPAYLOADLEN 96 // replies to one binary frame
+
+
+// ----------------------------------------------------------------------
+// BINARY FRAMES
+// A connection whose first byte is TCPFRAMESOF uses binary frames instead
+// of :NNparam#, for the rest of the connection
+//
+// request   SOF opcode seq len payload crc
+// response  SOF opcode seq len payload crc
+// SOF 0xB5, opcode 0-129 (tcp_opcode), seq chosen by the client and
+// returned in the response, len bytes of payload, crc is CRC16-CCITT
+// (0x1021, start 0xFFFF) of opcode to payload, little endian
+//
+// Request payload by argument type
+//   Arg_None none, Arg_Digit 1 byte, Arg_Long int32, Arg_Text the text
+// Response payload, one entry per reply of the command, none for a set
+//   token, Bin_Long int32 | Bin_Float float32 | Bin_Text len + text
+// Numbers are little endian. A failed request is answered with opcode
+// TCPFRAMEERROR and a one byte Tcp_Frame_Errors. Pushes of :C1 have seq 0
+// ----------------------------------------------------------------------
+#define TCPFRAMESOF 0xB5
+#define TCPFRAMEERROR 0xFF
+#define TCPFRAMEOVERHEAD 6  // SOF opcode seq len and crc
+
+enum Tcp_Frame_Errors { Frame_BadCrc = 1,   // crc or length wrong, frame dropped
+                        Frame_Unknown,      // opcode not in the command table
+                        Frame_BadArgs,      // payload does not match the argument type
+                        Frame_Busy,         // Cmd_Idle whilst moving
+                        Frame_NotSupported }; // command is text only
+
+enum Tcp_Bin_Types { Bin_Long, Bin_Float, Bin_Text };
+
+
+// ----------------------------------------------------------------------
+// RECEIVE BUFFER AND COMMAND PARSER STATE OF A CLIENT
+// ----------------------------------------------------------------------
+enum Tcp_Modes { Mode_Unknown,  // no byte received yet
+                 Mode_Text,     // :NNparam#
+                 Mode_Binary }; // frames
+
+enum Tcp_Parse_States { Parse_Start,    // wait for ':' or SOF
+                        Parse_Cmd,      // two command characters
+                        Parse_Param,    // parameter up to '#'
+                        Parse_Skip,     // parameter too long, drop up to '#'
+                        Parse_Opcode,   // binary frame fields
+                        Parse_Seq,
+                        Parse_Len,
+                        Parse_Payload,
+                        Parse_Crc,
+                        Parse_Crc2 };
+
+struct Tcp_Rx {
+  char ring[TCPRXBUFSIZE];
+  uint8_t head;             // next byte written to the ring
+  uint8_t tail;             // next byte parsed by tcp_next_command()
+  byte mode;                // Tcp_Modes
+  byte state;               // Tcp_Parse_States
+  uint8_t len;              // characters of cmd or param so far
+  char cmd[3];              // NN
+  char param[TCPPARAMLEN];  // parameter, terminated, or the binary payload
+  uint8_t opcode;           // binary frame
+  uint8_t seq;
+  uint8_t plen;             // payload length
+  uint16_t crc;             // crc of the frame so far
+  uint16_t rxcrc;           // crc sent by the client
+  bool bad;                 // payload did not fit in param
+};
+
+
+// ----------------------------------------------------------------------
+// PARSER
+// No socket or heap, so it also builds on the host, see tools/host
+// ----------------------------------------------------------------------
+void tcp_rx_reset(Tcp_Rx &);
+int tcp_rx_put(Tcp_Rx &, const char *, int);  // copy into the ring, returns the bytes that fit
+bool tcp_next_command(Tcp_Rx &);
+bool tcp_next_frame(Tcp_Rx &);
+uint16_t tcp_crc16(uint16_t, uint8_t);
+
+
+// ----------------------------------------------------------------------
+// RESPONSE FRAMES
+// tcp_add_payload() returns the new payload length, a reply that does
+// not fit in TCPPAYLOADLEN is dropped, text is truncated.
+// tcp_build_frame() needs len + TCPFRAMEOVERHEAD bytes, returns the size
+// ----------------------------------------------------------------------
+uint8_t tcp_add_payload(uint8_t *, uint8_t, const char, byte, const void *, size_t);
+size_t tcp_build_frame(uint8_t *, uint8_t, uint8_t, const uint8_t *, uint8_t);
+
+
+#endif  // #if !defined(_tcpip_parser_h)
@@ -16,7 +16,6 @@
 #include <Arduino.h>
 #include <WiFiServer.h>
 #include <WiFiClient.h>
-#include "SPIFFS.h"
 #include <SPI.h>
 
 #include "controller_defines.h"
@@ -38,6 +37,10 @@ extern DRIVER_BOARD *driverboard;
 #include "temp_probe.h"
 extern TEMP_PROBE *tempprobe;
 
+// focuser state snapshot
+#include "focuser_state.h"
+extern FOCUSER_STATE *focuserstate;
+
 // ASCOM server
 #include "ascom_server.h"
 extern ASCOM_SERVER *ascomsrvr;
@@ -68,6 +71,7 @@ extern bool display_on(void);
 extern bool display_off(void);
 extern void reboot_esp32(int);
 extern long getrssi(void);
+extern void publish_focuser_state(void);
 
 
 // ----------------------------------------------------------------------
@@ -83,17 +87,18 @@ extern byte display_status;
 extern long ftargetPosition;
 extern bool isMoving;
 extern bool filesystemloaded;
-extern float temp;
 
 
 // ----------------------------------------------------------------------
 // CLASS: TCPIP Server
 // ----------------------------------------------------------------------
 TCPIP_SERVER::TCPIP_SERVER() {
-  // clear lists for client connections
+  // clear lists for client connections, all slots are free, slot 0 is used first
   for (int lp = 0; lp < MAXCONNECTIONS; lp++) {
     _myclientsfreeslot[lp] = false;
+    _freeslots[lp] = (MAXCONNECTIONS - 1) - lp;
   }
+  _freecount = MAXCONNECTIONS;
   _totalclients = 0;
 }
 
@@ -176,71 +181,112 @@ void TCPIP_SERVER::loop(bool parkstate) {
     debug_server_print(T_TCPIPSERVER);
     debug_server_print("new client ");
     debug_server_println(T_FOUND);
-    // search for free slot, return first free slot found
-    int lp = 0;
-    for (lp = 0; lp < MAXCONNECTIONS; lp++) {
-      if (_myclientsfreeslot[lp] == false) {
-        break;
-      }
-    }
-
-    // check if there is a free slot
-    if (lp < MAXCONNECTIONS) {
-      debug_server_print(T_TCPIPSERVER);
-      debug_server_print("client ");
-      debug_server_println(T_CONNECTED);
-      // save new client to client list
-      _myclients[lp] = new WiFiClient(newclient);
-      // get IP of client
-      _myclientsIPAddressList[lp] = newclient.remoteIP();
-      // indicate slot is in use
-      _myclientsfreeslot[lp] = true;
-      _totalclients++;
-      // newClient will dispose at end of loop()
-      newclient.stop();
-
-      // TODO turn oled_state true to start display for this client ?
-
-    } else {
-      debug_server_print(T_TCPIPSERVER);
-      debug_server_print(T_ERROR);
-      debug_server_println("No connection");
-      newclient.stop();
-    }
+    int lp = open_slot();
+    debug_server_print(T_TCPIPSERVER);
+    debug_server_print("client ");
+    debug_server_println(T_CONNECTED);
+    // save new client to client list
+    _myclients[lp] = newclient;
+    // start with an empty receive buffer
+    tcp_rx_reset(_rx[lp]);
+    _tx[lp].len = 0;
+    _tx[lp].paylen = 0;
+    _sub[lp].interval = 0;
+    _lastactive[lp] = millis();
+    _deferred[lp] = 0;
+    // replies are already coalesced, do not wait to fill a segment
+    _myclients[lp].setNoDelay(true);
+    // get IP of client
+    _myclientsIPAddressList[lp] = newclient.remoteIP();
+    // indicate slot is in use
+    _myclientsfreeslot[lp] = true;
+    _totalclients++;
+    // newClient will dispose at end of loop()
+    newclient.stop();
+
+    // TODO turn oled_state true to start display for this client ?
   }
 
   // cycle through each tcp/ip client connection
   // faster to avoid for loop if there are no clients
   if (_totalclients > 0) {
-    // check all connected wifi client slots for data
-    for (int lp = 0; lp < MAXCONNECTIONS; lp++) {
+    // check all connected wifi client slots for data, starting with a
+    // different slot each loop so no client is always served last
+    for (int i = 0; i < MAXCONNECTIONS; i++) {
+      int lp = (_nextclient + i) % MAXCONNECTIONS;
       // if there is a client
       if (_myclientsfreeslot[lp] == true) {
         // if client is connected
-        if (_myclients[lp]->connected()) {
-          // if client has send request
-          while (_myclients[lp]->available()) {
-            // process request and send client number
-            process_command(lp);
+        if (_myclients[lp].connected()) {
+          // move what the client has sent into its receive buffer, without waiting
+          read_client(lp);
+          // process up to TCPCMDBUDGET complete commands
+          int budget = TCPCMDBUDGET;
+          while ((budget > 0) && tcp_next_command(_rx[lp])) {
+            budget--;
+            _lastactive[lp] = millis();
+            // the next command from this client sees any move it started
+            if (process_command(lp)) {
+              publish_focuser_state();
+            }
+          }
+          if ((budget == 0) && (_rx[lp].tail != _rx[lp].head)) {
+            // more in the receive buffer, it waits for the next loop
+            _deferred[lp]++;
+          }
+          // send the replies to all of them together, with any push
+          push_status(lp);
+          flush_client(lp);
+          // close a client that has gone quiet, unless it is waiting for pushes
+          if ((_sub[lp].interval == 0) && ((millis() - _lastactive[lp]) > TCPIDLETIME)) {
+            debug_server_print(T_TCPIPSERVER);
+            debug_server_println("client idle");
+            close_client(lp);
           }
         } else {
           // not connected, stop client
-          _myclients[lp]->stop();
-          // free client space
-          _myclientsfreeslot[lp] = false;
-          // release client
-          delete _myclients[lp];
-          _myclients[lp] = NULL;
-          _totalclients--;
-          if (_totalclients < 0) {
-            _totalclients = 0;
-          }
+          close_client(lp);
         }  // if (myclients[lp].connected())
       }    // if ( myclientsfreeslot[lp] == true )
-    }      // for ( int lp = 0; lp < MAXCONNECTIONS; lp++ )
+    }      // for ( int i = 0; i < MAXCONNECTIONS; i++ )
+    _nextclient = (_nextclient + 1) % MAXCONNECTIONS;
   }        // if ( totalclients > 0 )
 }
 
+// ----------------------------------------------------------------------
+// Take a free connection slot for a new client
+// When all slots are in use the least recently active client is closed
+// ----------------------------------------------------------------------
+int TCPIP_SERVER::open_slot(void) {
+  if (_freecount == 0) {
+    int oldest = 0;
+    for (int lp = 1; lp < MAXCONNECTIONS; lp++) {
+      if ((long)(_lastactive[lp] - _lastactive[oldest]) < 0) {
+        oldest = lp;
+      }
+    }
+    debug_server_print(T_TCPIPSERVER);
+    debug_server_print("all slots in use, close client ");
+    debug_server_println(oldest);
+    close_client(oldest);
+  }
+  return _freeslots[--_freecount];
+}
+
+// ----------------------------------------------------------------------
+// Close a client and return its slot to the free list
+// ----------------------------------------------------------------------
+void TCPIP_SERVER::close_client(int clientnum) {
+  _myclients[clientnum].stop();
+  // free client space
+  _myclientsfreeslot[clientnum] = false;
+  _freeslots[_freecount++] = clientnum;
+  _totalclients--;
+  if (_totalclients < 0) {
+    _totalclients = 0;
+  }
+}
+
 // ----------------------------------------------------------------------
 // Determine if there is at least 1 client connected
 // ----------------------------------------------------------------------
@@ -279,19 +325,75 @@ char *TCPIP_SERVER::ftoa(char *a, double f, int precision) {
 
 // ----------------------------------------------------------------------
 // Send reply to client
+// The reply is added to the reply buffer of the client, flush_client()
+// sends it at the end of the loop
 // ----------------------------------------------------------------------
 void TCPIP_SERVER::send_reply(const char *str, int clientnum) {
+  send_bytes((const uint8_t *)str, strlen(str), clientnum);
+}
+
+void TCPIP_SERVER::send_bytes(const uint8_t *data, size_t len, int clientnum) {
+  Tcp_Tx &tx = _tx[clientnum];
+
+  if ((tx.len + len) > TCPTXBUFSIZE) {
+    flush_client(clientnum);
+  }
+  if (len > TCPTXBUFSIZE) {
+    // too big to buffer, send now
+    if (_myclients[clientnum].connected()) {
+      _myclients[clientnum].write(data, len);
+    }
+    return;
+  }
+  memcpy(&tx.buf[tx.len], data, len);
+  tx.len += len;
+}
+
+// ----------------------------------------------------------------------
+// Add a reply to the payload of the binary response frame
+// ----------------------------------------------------------------------
+void TCPIP_SERVER::add_payload(int clientnum, const char token, byte type, const void *data, size_t len) {
+  Tcp_Tx &tx = _tx[clientnum];
+  tx.paylen = tcp_add_payload(tx.payload, tx.paylen, token, type, data, len);
+}
+
+// ----------------------------------------------------------------------
+// Send a binary response frame with the payload built by the handler
+// ----------------------------------------------------------------------
+void TCPIP_SERVER::send_frame(int clientnum, uint8_t opcode, uint8_t seq) {
+  Tcp_Tx &tx = _tx[clientnum];
+  uint8_t frame[TCPPAYLOADLEN + TCPFRAMEOVERHEAD];
+  size_t n = tcp_build_frame(frame, opcode, seq, tx.payload, tx.paylen);
+  tx.paylen = 0;
+  send_bytes(frame, n, clientnum);
+}
+
+void TCPIP_SERVER::send_frame_error(int clientnum, uint8_t seq, byte error) {
+  _tx[clientnum].payload[0] = error;
+  _tx[clientnum].paylen = 1;
+  send_frame(clientnum, TCPFRAMEERROR, seq);
+}
+
+// ----------------------------------------------------------------------
+// Send the buffered replies of a client
+// ----------------------------------------------------------------------
+void TCPIP_SERVER::flush_client(int clientnum) {
+  Tcp_Tx &tx = _tx[clientnum];
   // if client is still connected
-  if (_myclients[clientnum]->connected()) {
-    // send reply
-    _myclients[clientnum]->print(str);
+  if ((tx.len > 0) && (_myclients[clientnum].connected())) {
+    _myclients[clientnum].write((const uint8_t *)tx.buf, tx.len);
   }
+  tx.len = 0;
 }
 
 // ----------------------------------------------------------------------
 // Build a char array reply to a client
 // ----------------------------------------------------------------------
 void TCPIP_SERVER::build_reply(const char token, const char *str, int clientnum) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    add_payload(clientnum, token, Bin_Text, str, strlen(str));
+    return;
+  }
   char buff[32];
   snprintf(buff, sizeof(buff), "%c%s%c", token, str, _EOFSTR);
   send_reply(buff, clientnum);
@@ -301,6 +403,11 @@ void TCPIP_SERVER::build_reply(const char token, const char *str, int clientnum)
 // Build a unsigned char reply to a client
 // ----------------------------------------------------------------------
 void TCPIP_SERVER::build_reply(const char token, unsigned char data_val, int clientnum) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    int32_t val = data_val;
+    add_payload(clientnum, token, Bin_Long, &val, sizeof(val));
+    return;
+  }
   char buff[32];
   snprintf(buff, sizeof(buff), "%c%u%c", token, data_val, _EOFSTR);
   send_reply(buff, clientnum);
@@ -311,6 +418,10 @@ void TCPIP_SERVER::build_reply(const char token, unsigned char data_val, int cli
 // i = decimal places
 // ----------------------------------------------------------------------
 void TCPIP_SERVER::build_reply(const char token, float data_val, int i, int clientnum) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    add_payload(clientnum, token, Bin_Float, &data_val, sizeof(data_val));
+    return;
+  }
   char buff[32];
   char tmp[10];
   // Note Arduino snprintf does not support .2f
@@ -323,6 +434,11 @@ void TCPIP_SERVER::build_reply(const char token, float data_val, int i, int clie
 // Build a integer reply to a client
 // ----------------------------------------------------------------------
 void TCPIP_SERVER::build_reply(const char token, int data_val, int clientnum) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    int32_t val = data_val;
+    add_payload(clientnum, token, Bin_Long, &val, sizeof(val));
+    return;
+  }
   char buff[32];
   snprintf(buff, sizeof(buff), "%c%i%c", token, data_val, _EOFSTR);
   send_reply(buff, clientnum);
@@ -332,6 +448,10 @@ void TCPIP_SERVER::build_reply(const char token, int data_val, int clientnum) {
 // Build a string reply to a client
 // ----------------------------------------------------------------------
 void TCPIP_SERVER::build_reply(const char token, String str, int clientnum) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    add_payload(clientnum, token, Bin_Text, str.c_str(), str.length());
+    return;
+  }
   char buff[32];
   char tmp[30];
   str.toCharArray(tmp, str.length());
@@ -343,6 +463,11 @@ void TCPIP_SERVER::build_reply(const char token, String str, int clientnum) {
 // Build a long reply to a client
 // ----------------------------------------------------------------------
 void TCPIP_SERVER::build_reply(const char token, long data_val, int clientnum) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    int32_t val = data_val;
+    add_payload(clientnum, token, Bin_Long, &val, sizeof(val));
+    return;
+  }
   char buff[32];
   snprintf(buff, sizeof(buff), "%c%ld%c", token, data_val, _EOFSTR);
   send_reply(buff, clientnum);
@@ -352,774 +477,1062 @@ void TCPIP_SERVER::build_reply(const char token, long data_val, int clientnum) {
 // Build a unsigned long reply to a client
 // ----------------------------------------------------------------------
 void TCPIP_SERVER::build_reply(const char token, unsigned long data_val, int clientnum) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    int32_t val = (int32_t)data_val;
+    add_payload(clientnum, token, Bin_Long, &val, sizeof(val));
+    return;
+  }
   char buff[32];
   snprintf(buff, sizeof(buff), "%c%lu%c", token, data_val, _EOFSTR);
   send_reply(buff, clientnum);
 }
 
 // ----------------------------------------------------------------------
-// Process a client command request
+// Push changes in the focuser state to a subscribed client
+// A completed move is sent at once, with the final position, other
+// changes wait for the interval the client asked for
 // ----------------------------------------------------------------------
-void TCPIP_SERVER::process_command(int clientnum) {
-  // compatibility
-  static byte joggingstate = 0;
-  static byte joggingdirection = 0;
-  static byte delayeddisplayupdatestatus = 0;
-
-  String receiveString = "";
-  String WorkString = "";
-  int cmdvalue;
-  int paramval;
-  long tmppos;
-
-  String drvbrd = ControllerData->get_brdname();
-  receiveString = _myclients[clientnum]->readStringUntil(_EOFSTR);
-  receiveString = receiveString + '#' + "";
-
-  String cmdstr = receiveString.substring(1, 3);
-
-  if (cmdstr[0] == 'A') {
-    cmdvalue = 100 + (cmdstr[1] - '0');  // can only use digits A0-A9
-  } else if (cmdstr[0] == 'B') {
-    cmdvalue = 110 + (cmdstr[1] - '0');  // can only use digits B0-B9
-  } else if (cmdstr[0] == 'C') {
-    cmdvalue = 120 + (cmdstr[1] - '0');  // can only use digits C0-C9
+void TCPIP_SERVER::push_status(int clientnum) {
+  Tcp_Sub &sub = _sub[clientnum];
+  if (sub.interval == 0) {
+    return;
+  }
+
+  Focuser_Status fs = focuserstate->get();
+  if (sub.all) {
+    build_reply('P', fs.position, clientnum);
+    build_reply('I', fs.ismoving, clientnum);
+    build_reply('Z', fs.temp, 3, clientnum);
   } else {
-    cmdvalue = cmdstr.toInt();
+    if (fs.version == sub.sent.version) {
+      return;
+    }
+    bool movedone = (sub.sent.ismoving == true) && (fs.ismoving == false);
+    if ((movedone == false) && ((millis() - sub.lastpush) < sub.interval)) {
+      return;
+    }
+    if (fs.position != sub.sent.position) {
+      build_reply('P', fs.position, clientnum);
+    }
+    if (fs.ismoving != sub.sent.ismoving) {
+      build_reply('I', fs.ismoving, clientnum);
+    }
+    if (fs.temp != sub.sent.temp) {
+      build_reply('Z', fs.temp, 3, clientnum);
+    }
+    if (movedone) {
+      // move complete
+      build_reply('m', fs.position, clientnum);
+    }
+  }
+  if (_rx[clientnum].mode == Mode_Binary) {
+    send_frame(clientnum, tcp_opcode("C1"), 0);
+  }
+  sub.sent = fs;
+  sub.all = false;
+  sub.lastpush = millis();
+}
+
+// ----------------------------------------------------------------------
+// Read the bytes a client has sent into its receive ring buffer
+// Only reads what is available, so it never waits for the rest of a
+// command. When the ring is full the data waits in the socket
+// ----------------------------------------------------------------------
+void TCPIP_SERVER::read_client(int clientnum) {
+  Tcp_Rx &rx = _rx[clientnum];
+  // one slot is kept empty to tell a full ring from an empty one
+  int space = (rx.tail - rx.head - 1) & (TCPRXBUFSIZE - 1);
+  int avail = _myclients[clientnum].available();
+
+  while ((space > 0) && (avail > 0)) {
+    // free bytes up to the end of the ring
+    int run = TCPRXBUFSIZE - rx.head;
+    run = (run > space) ? space : run;
+    run = (run > avail) ? avail : run;
+    int n = _myclients[clientnum].read((uint8_t *)&rx.ring[rx.head], run);
+    if (n <= 0) {
+      break;
+    }
+    rx.head = (rx.head + n) & (TCPRXBUFSIZE - 1);
+    space -= n;
+    avail -= n;
+  }
+}
+
+// ----------------------------------------------------------------------
+// Command dispatch table, built from TCP_COMMANDS in tcpip_commands.h
+// ----------------------------------------------------------------------
+const Tcp_Command TCPIP_SERVER::_commands[Tcp_Command_Count] = {
+#define X(op, name, cmdclass, argtype) { #op, cmdclass, argtype, &TCPIP_SERVER::cmd_##name },
+  TCP_COMMANDS(X)
+#undef X
+};
+
+// ----------------------------------------------------------------------
+// Find the table entry of an opcode, NULL if not a command
+// ----------------------------------------------------------------------
+const Tcp_Command *TCPIP_SERVER::find_command(int opcode) {
+  switch (opcode) {
+#define X(op, name, cmdclass, argtype) \
+  case tcp_opcode(#op): return &_commands[Tcp_##name];
+    TCP_COMMANDS(X)
+#undef X
+    default:
+      return NULL;
+  }
+}
+
+// ----------------------------------------------------------------------
+// Process a client command request
+// Returns false for a Cmd_Get or unknown command, there is no state to publish
+// ----------------------------------------------------------------------
+bool TCPIP_SERVER::process_command(int clientnum) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    return process_frame(clientnum);
   }
 
+  // command and parameter of :NNparam# from tcp_next_command()
+  const char *cmdstr = _rx[clientnum].cmd;
+  const char *param = _rx[clientnum].param;
+
   debug_server_print(T_TCPIPSERVER);
-  debug_server_print(", recstr ");
-  debug_server_print(receiveString);
   debug_server_print(", cmdstr ");
-  debug_server_println(cmdstr);
-  switch (cmdvalue) {
-    case 0:  // get focuser position
-      build_reply('P', driverboard->getposition(), clientnum);
-      break;
-    case 1:  // ismoving
-      build_reply('I', isMoving, clientnum);
-      break;
-    case 2:  // get controller status
-      build_reply('E', "OK", clientnum);
-      break;
-    case 3:  // get firmware version
-      build_reply('F', program_version, clientnum);
-      break;
-    case 4:  // get get_brdname + version number
-      {
-        char buff[32];
-        char tempstr[20];
-        String brdname = ControllerData->get_brdname();
-        brdname.toCharArray(tempstr, brdname.length() + 1);
-        snprintf(buff, sizeof(buff), "%s%c%c%s", tempstr, '\r', '\n', program_version);
-        build_reply('F', buff, clientnum);
-      }
-      break;
-    case 5:  // Set new target position to xxxxxx (and focuser initiates immediate move to xxxxxx)
-      // only if not already moving
-      if (isMoving == 0) {
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        ftargetPosition = WorkString.toInt();
-        ftargetPosition = (ftargetPosition < 0) ? 0 : ftargetPosition;
-        ftargetPosition = (ftargetPosition > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : ftargetPosition;
-        isMoving = 1;
-      }
-      break;
-    case 6:  // get temperature
-      build_reply('Z', temp, 3, clientnum);
-      break;
-    case 7:  // Set maxsteps
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      tmppos = WorkString.toInt();
-      // check to make sure not above largest value for maxstep
-      tmppos = (tmppos > FOCUSERUPPERLIMIT) ? FOCUSERUPPERLIMIT : tmppos;
-      // check if below lowest set valueue for maxstep
-      tmppos = (tmppos < FOCUSERLOWERLIMIT) ? FOCUSERLOWERLIMIT : tmppos;
-      // check to make sure its not less than current focuser position
-      tmppos = (tmppos < driverboard->getposition()) ? driverboard->getposition() : tmppos;
-      ControllerData->set_maxstep(tmppos);
-      break;
-    case 8:  // get maxStep
-      build_reply('M', ControllerData->get_maxstep(), clientnum);
-      break;
-    case 9:  // myFP2ESP32 get _inoutledmode, pulse or move
-      build_reply('$', ControllerData->get_inoutled_mode(), clientnum);
-      break;
-    case 10:  // get maxIncrement
-      build_reply('Y', ControllerData->get_maxstep(), clientnum);
-      break;
-    case 11:  // get coil power enable
-      build_reply('O', ControllerData->get_coilpower_enable(), clientnum);
-      break;
-    case 12:  // set coil power enable
-      paramval = receiveString[3] - '0';
-      // if 1, enable coilpower, set coilpowerstate true, enable motor
-      // if 0, disable coilpower, set coilpowerstate false; release motor
-      (paramval == 1) ? driverboard->enablemotor() : driverboard->releasemotor();
-      (paramval == 1) ? ControllerData->set_coilpower_enable(V_ENABLED) : ControllerData->set_coilpower_enable(V_NOTENABLED);
-      break;
-    case 13:  // get reverse direction setting, 00 off, 01 on
-      build_reply('R', ControllerData->get_reverse_enable(), clientnum);
-      break;
-    case 14:  // set reverse direction
-      if (isMoving == 0) {
-        paramval = receiveString[3] - '0';
-        (paramval == 1) ? ControllerData->set_reverse_enable(V_ENABLED) : ControllerData->set_reverse_enable(V_NOTENABLED);
-      }
-      break;
-    case 15:  // set motor speed
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = WorkString.toInt() & 3;
-      ControllerData->set_motorspeed((byte)paramval);
-      break;
-    case 16:  // set temperature display setting to celsius (0)
-      ControllerData->set_tempmode(V_CELSIUS);
-      break;
-    case 17:  // set temperature display setting to fahrenheit (1)
-      ControllerData->set_tempmode(V_FAHRENHEIT);
-      break;
-    case 18:  // set Stepsize enable state
-      // :180#    None    Set stepsize to be OFF - default
-      // :181#    None    stepsize to be ON - reports what user specified as stepsize
-      //WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = receiveString[3] - '0';
-      ControllerData->set_stepsize_enable((byte)paramval);
-      break;
-    case 19:  // set the step size value - double type, eg 2.1
-      {
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        float tempstepsize = WorkString.toFloat();
-        tempstepsize = (tempstepsize < MINIMUMSTEPSIZE) ? MINIMUMSTEPSIZE : tempstepsize;
-        tempstepsize = (tempstepsize > MAXIMUMSTEPSIZE) ? MAXIMUMSTEPSIZE : tempstepsize;
-        ControllerData->set_stepsize(tempstepsize);
-      }
-      break;
-    case 20:  // set the temperature resolution setting for the DS18B20 temperature probe
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = WorkString.toInt();
-      paramval = (paramval < 9) ? 9 : paramval;
-      paramval = (paramval > 12) ? 12 : paramval;
-      ControllerData->set_tempresolution((byte)paramval);
-      tempprobe->set_resolution((byte)paramval);
-      break;
-    case 21:  // get temp probe resolution
-      build_reply('Q', ControllerData->get_tempresolution(), clientnum);
-      break;
-    case 22:  // set temperature coefficient steps value to xxx
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = WorkString.toInt();
-      ControllerData->set_tempcoefficient(paramval);
-      break;
-    case 23:  // set the temperature compensation ON (1) or OFF (0)
-      if (tempprobe->get_state() == V_RUNNING) {
-        paramval = receiveString[3] - '0';
-        ControllerData->set_tempcomp_enable((byte)paramval);
-      }
-      break;
-    case 24:  // get status of temperature compensation (enabled | disabled)
-      build_reply('1', ControllerData->get_tempcomp_enable(), clientnum);
-      break;
-    case 25:  // get temperature compensation available
-      build_reply('A', ControllerData->get_tcavailable(), clientnum);
-      break;
-    case 26:  // get temperature coefficient steps/degree
-      build_reply('B', ControllerData->get_tempcoefficient(), clientnum);
-      break;
-    case 27:  // stop a move - like a Halt
-      portENTER_CRITICAL(&halt_alertMux);
-      halt_alert = true;
-      portEXIT_CRITICAL(&halt_alertMux);
-      break;
-    case 28:  // home the motor to position 0
-      if (isMoving == 0) {
-        ftargetPosition = 0;
-        isMoving = 1;
-      }
-      break;
-    case 29:  // get stepmode
-      build_reply('S', ControllerData->get_brdstepmode(), clientnum);
-      break;
+  debug_server_print(cmdstr);
+  debug_server_print(", param ");
+  debug_server_println(param);
 
-    // ----------------------------------------------------------------------
-    // Basic rule for setting stepmode
-    // set DRIVER_BOARD->setstepmode(xx);                         // this sets the physical pins
-    // and this also saves ControllerData->set_brdstepmode(xx);   // this saves config setting
-    case 30:  // set step mode
-      {
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        paramval = WorkString.toInt();
-        int brdnum = ControllerData->get_brdnumber();
-        if (brdnum == PRO2ESP32ULN2003 || brdnum == PRO2ESP32L298N || brdnum == PRO2ESP32L293DMINI || brdnum == PRO2ESP32L9110S) {
-          paramval = (int)(paramval & 3);  // STEP1 - STEP2
-        } else if (brdnum == PRO2ESP32DRV8825 || brdnum == PRO2ESP32R3WEMOS) {
-          paramval = (paramval < STEP1) ? STEP1 : paramval;
-          paramval = (paramval > STEP32) ? STEP32 : paramval;
-        } else if (brdnum == PRO2ESP32TMC2225 || brdnum == PRO2ESP32TMC2209 || brdnum == PRO2ESP32TMC2209P) {
-          paramval = (paramval < STEP1) ? STEP1 : paramval;
-          paramval = (paramval > STEP256) ? STEP256 : paramval;
-        } else {
-          debug_server_print(T_TCPIPSERVER);
-          debug_server_print(T_ERROR);
-          debug_server_print(", invalid brd ");
-          debug_server_println(brdnum);
-        }
-      }
-      ControllerData->set_brdstepmode((int)paramval);
-      driverboard->setstepmode((int)paramval);
-      break;
-    case 31:  // set focuser position
-      if (isMoving == 0) {
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        {
-          long tpos = (long)WorkString.toInt();
-          tpos = (tpos < 0) ? 0 : tpos;
-          tpos = (tpos > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : tpos;
-          ftargetPosition = tpos;
-          driverboard->setposition(tpos);
-          ControllerData->set_fposition(tpos);
-        }
-      }
-      break;
-    case 32:  // get if stepsize is enabled
-      build_reply('U', ControllerData->get_stepsize_enable(), clientnum);
-      break;
-    case 33:  // get stepsize
-      build_reply('T', ControllerData->get_stepsize(), 2, clientnum);
-      break;
-    case 34:  // get the time that a display page is shown for
-      build_reply('X', ControllerData->get_display_pagetime(), clientnum);
-      break;
-    case 35:  // set the time a display page is displayed for in seconds, integer, 2-10
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = WorkString.toInt();
-      paramval = (paramval < V_DISPLAYPAGETIMEMIN) ? V_DISPLAYPAGETIMEMIN : paramval;
-      paramval = (paramval > V_DISPLAYPAGETIMEMAX) ? V_DISPLAYPAGETIMEMAX : paramval;
-      ControllerData->set_display_pagetime(paramval);
-      // update display_maxcount
-      portENTER_CRITICAL(&displaytimeMux);
-      // convert to timeslices
-      display_maxcount = paramval * 10;
-      portEXIT_CRITICAL(&displaytimeMux);
-      break;
-    case 36:  // set display writing state, 0 = write not allowed, 1 = write text allowed
-      // :360#    None    Blank the Display
-      // :361#    None    UnBlank the Display
-      //WorkString = receiveString.substring(3, receiveString.length() - 1);
-      //paramval = (byte) WorkString.toInt() & 0x01;
-      paramval = receiveString[3] - '0';
-      (paramval == 1) ? display_on() : display_off();
-      break;
-    case 37:  // get display status (1=Running or 0=Stopped)
-      build_reply('D', display_status, clientnum);
-      break;
-    case 38:  // get temperature mode 1=Celsius, 0=Fahrenheight
-      build_reply('b', ControllerData->get_tempmode(), clientnum);
-      break;
-    case 39:  // get the new motor position (target) XXXXXX
-      build_reply('N', ftargetPosition, clientnum);
-      break;
-    case 40:  // reboot controller with 2s delay
-      reboot_esp32(2000);
-      break;
-    case 41:  // myFP2ESP32 set in-out-led-mode (pulsed or move)
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = receiveString[3] - '0';
-      ControllerData->set_inoutled_mode((byte)paramval);
-      break;
-    case 42:  // reset focuser defaults
-      if (isMoving == 0) {
-        ControllerData->SetFocuserDefaults();
-        ftargetPosition = ControllerData->get_fposition();
-        driverboard->setposition(ftargetPosition);
-        ControllerData->set_fposition(ftargetPosition);
-      }
-      break;
-    case 43:  // get motorspeed
-      build_reply('C', ControllerData->get_motorspeed(), clientnum);
-      break;
-    case 44:  // myFP2ESP32 get park enable state
-      build_reply('$', ControllerData->get_park_enable(), clientnum);
-      break;
-    case 45:  // myFP2ESP32 set park enable state
-      paramval = receiveString[3] - '0';
-      ControllerData->set_park_enable((byte)paramval);
-      break;
-    case 46:  // myFP2ESP32 get in-out led enable state
-      build_reply('$', ControllerData->get_inoutled_enable(), clientnum);
-      break;
-    case 47:  // myFP2ESP32 set in-out led enable state
-      paramval = receiveString[3] - '0';
-      ControllerData->set_inoutled_enable((byte)paramval);
-      break;
-    case 48:  // save settings to file
-      // do not do this if focuser is moving
-      if (isMoving == 0) {
-        // need to save position setting
-        ControllerData->set_fposition(driverboard->getposition());
-        // save the focuser settings immediately
-        ControllerData->SaveNow(driverboard->getposition(), driverboard->getdirection());
-      }
-      break;
-    case 49:  // aXXXXX
-      build_reply('a', "b552efd", clientnum);
-      break;
-    case 50:  // get if Home Position Switch enabled, 0 = no, 1 = yes
-      build_reply('l', ControllerData->get_hpswitch_enable(), clientnum);
-      break;
-    case 51:  // myFP2ESP32 get Wifi Controller IP Address
-      build_reply('$', ipStr, clientnum);
-      break;
-    case 52:  // myFP2ESP32 get park state
-      if (_parked) {
-        build_reply('$', 1, clientnum);
-      } else {
-        build_reply('$', 0, clientnum);
-      }
-      break;
-    case 54:  // myFP2ESP32 ESP32 Controller SSID
-      build_reply('$', mySSID, clientnum);
-      break;
-    case 55:  // get motorspeed delay for current speed setting
-      build_reply('0', ControllerData->get_brdmsdelay(), clientnum);
-      break;
-    case 56:  // set motorspeed delay for current speed setting
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = WorkString.toInt();
-      paramval = (paramval < 1000) ? 1000 : paramval;
-      ControllerData->set_brdmsdelay(paramval);
-      break;
-    case 57:  // myFP2ESP32 get pushbutton enable state
-      build_reply('$', driverboard->get_pushbuttons_loaded(), clientnum);
-      break;
-    case 58:  // myFP2ESP32 set pushbutton enable state
-      paramval = receiveString[3] - '0';
-      driverboard->set_pushbuttons((byte)paramval);
-      break;
-    case 59:  // myFP2ESP32 get park time
-      build_reply('$', ControllerData->get_parktime(), clientnum);
-      break;
-    case 60:  // myFP2ESP32 set park time interval in seconds
-      {
-        // range check 30s to 300s (5m)
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        paramval = WorkString.toInt();
-        paramval = (paramval < 30) ? 30 : paramval;
-        paramval = (paramval > 300) ? 300 : paramval;
-        ControllerData->set_parktime(paramval);
-        // update park_maxcount
-        portENTER_CRITICAL(&parkMux);
-        // convert to timeslices
-        park_maxcount = paramval * 10;
-        portEXIT_CRITICAL(&parkMux);
-      }
-      break;
-    case 61:  // set update of position on oled when moving (0=disable, 1=enable)
-      paramval = receiveString[3] - '0';
-      ControllerData->set_display_updateonmove((byte)paramval);
-      break;
-    case 62:  // get update of position on oled when moving (00=disable, 01=enable)
-      build_reply('L', ControllerData->get_display_updateonmove(), clientnum);
-      break;
-    case 63:  // get status of home position switch
-      // if the hpsw is enabled
-      if (ControllerData->get_hpswitch_enable() == V_RUNNING) {
-        // get state of hpsw, return 1 if closed, 0 if open
-        // myFP2ESP32  (hpsw pin 1=open, 0=closed)
-        // if( driverboard->hpsw_alert() == true )
-        build_reply('H', driverboard->hpsw_alert(), clientnum);
-      } else {
-        build_reply('H', 0, clientnum);
-      }
-      break;
-    case 64:  // move a specified number of steps
-      if (isMoving == 0) {
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        long pos = WorkString.toInt() + driverboard->getposition();
-        pos = (pos < 0) ? 0 : pos;
-        ftargetPosition = (pos > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : pos;
-        isMoving = 0;
-      }
-      break;
-    case 65:  // set jogging state enable/disable
-      paramval = receiveString[3] - '0';
-      joggingstate = (byte)paramval;
-      break;
-    case 66:  // get jogging state enabled/disabled
-      build_reply('K', joggingstate, clientnum);
-      break;
-    case 67:  // set jogging direction, 0=IN, 1=OUT
-      paramval = receiveString[3] - '0';
-      joggingdirection = (byte)paramval;
-      break;
-    case 68:  // get jogging direction, 0=IN, 1=OUT
-      build_reply('V', joggingdirection, clientnum);
-      break;
-    case 69:  // get push button steps
-      build_reply('?', ControllerData->get_pushbutton_steps(), clientnum);
-      break;
-    case 70:  // set push buttons steps [1-max] where max = stepsize / 2
-      {
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        paramval = WorkString.toInt();
-        paramval = (paramval < 1) ? 1 : paramval;
-        // set maximum steps to be 1/2 the step size
-        int sz = (int)ControllerData->get_stepsize() / 2;
-        sz = (sz < 1) ? 1 : sz;
-        paramval = (paramval > sz) ? sz : paramval;
-        ControllerData->set_pushbutton_steps((byte)paramval);
-      }
-      break;
-    case 71:  // set delayaftermove time value in milliseconds [0-250]
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = WorkString.toInt();
-      paramval = (paramval < 0) ? 0 : paramval;
-      paramval = (paramval > 250) ? 250 : paramval;
-      ControllerData->set_delayaftermove_time((byte)paramval);
-      break;
-    case 72:  // get delayaftermove_state value in milliseconds
-      build_reply('3', ControllerData->get_delayaftermove_time(), clientnum);
-      break;
-    case 73:  // set disable/enable backlash IN (going to lower focuser position)
-      paramval = receiveString[3] - '0';
-      ControllerData->set_backlash_in_enable((byte)paramval);
-      break;
-    case 74:  // get backlash in enabled status
-      build_reply('4', ControllerData->get_backlash_in_enable(), clientnum);
-      break;
-    case 75:  // set disable/enable backlash OUT (going to lower focuser position)
-      paramval = receiveString[3] - '0';
-      ControllerData->set_backlash_out_enable((byte)paramval);
-      break;
-    case 76:  // get backlash OUT enabled status
-      build_reply('5', ControllerData->get_backlash_out_enable(), clientnum);
-      break;
-    case 77:  // set backlash in steps [0-255]
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = (byte)WorkString.toInt() & 0xff;
-      ControllerData->set_backlashsteps_in((byte)paramval);
-      break;
-    case 78:  // get backlash steps IN
-      build_reply('6', ControllerData->get_backlashsteps_in(), clientnum);
-      break;
-    case 79:  // set backlash OUT steps
-      WorkString = receiveString.substring(3, receiveString.length() - 1);
-      paramval = (byte)WorkString.toInt() & 0xff;
-      ControllerData->set_backlashsteps_out((byte)paramval);
-      break;
-    case 80:  // get backlash steps OUT
-      build_reply('7', ControllerData->get_backlashsteps_out(), clientnum);
-      break;
-    case 81:  // get STALL_VALUE (for TMC2209 stepper modules)
-      build_reply('8', ControllerData->get_stallguard_value(), clientnum);
-      break;
-    case 82:  // myFP2ESP32 set STALL_VALUE (for TMC2209 stepper modules)
-      WorkString = receiveString.substring(2, receiveString.length());
-      driverboard->setstallguardvalue((byte)WorkString.toInt());
-      break;
-    case 83:  // get if there is a temperature probe
-      if (tempprobe->get_found() == false) {
-        build_reply('c', 0, clientnum);
-      } else {
-        build_reply('c', 1, clientnum);
-      }
-      break;
+  const Tcp_Command *cmd = find_command(tcp_opcode(cmdstr));
+  if (cmd == NULL) {
+    debug_server_print(T_TCPIPSERVER);
+    debug_server_print(T_ERROR);
+    debug_server_print(", cmd ");
+    debug_server_println(cmdstr);
+    return false;
+  }
 
-    case 84:  // myFP2N reserved
-      break;
+  // position and target are only changed when the focuser is not moving
+  if ((cmd->cmdclass == Cmd_Idle) && (isMoving != 0)) {
+    return false;
+  }
 
-    case 85:  // myFP2ESP32 get delay after move enable state
-      build_reply('$', ControllerData->get_delayaftermove_enable(), clientnum);
+  Tcp_Args arg = { param, 0 };
+  switch (cmd->argtype) {
+    case Arg_Digit:
+      arg.value = param[0] - '0';
       break;
-    case 86:  // myFP2ESP32 set delay after move enable state
-      paramval = receiveString[3] - '0';
-      ControllerData->set_delayaftermove_enable((byte)paramval);
+    case Arg_Long:
+      arg.value = atol(param);
       break;
-    case 87:  // get tc direction
-      build_reply('k', ControllerData->get_tcdirection(), clientnum);
-      break;
-    case 88:  // set tc direction
-      paramval = receiveString[3] - '0';
-      ControllerData->set_tcdirection((byte)paramval);
-      break;
-    case 89:  // get stepper power (reads from A7) - only valid if hardware circuit is added (1=stepperpower ON)
-      build_reply('9', 1, clientnum);
-      break;
-    case 90:  // myFP2ESP32 set preset x [0-9] with position value yyyy [unsigned long]
-      {
-        byte preset = (byte)(receiveString[3] - '0');
-        preset = (preset > 9) ? 9 : preset;
-        WorkString = receiveString.substring(4, receiveString.length() - 1);
-        tmppos = WorkString.toInt();
-        tmppos = (tmppos < 0) ? 0 : tmppos;
-        tmppos = (tmppos > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : tmppos;
-        ControllerData->set_focuserpreset(preset, tmppos);
-        // update cached copy
-        _presets[preset] = tmppos;
-      }
-      break;
-    case 91:  // myFP2ESP32 get focuserpreset [0-9]
-      {
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        byte preset = (byte)WorkString.toInt();
-        build_reply('$', _presets[preset], clientnum);
-      }
-      break;
-    case 92:  // set display page display option (8 digits, index of 0-7)
-      {
-        WorkString = receiveString.substring(3, receiveString.length() - 1);
-        // If empty (no args) - fill with default display string
-        if (WorkString == "") {
-          WorkString = "11111111";
-        }
-
-        // if display option length less than 8, pad with leading 0's
-        if (WorkString.length() < 8) {
-          while (WorkString.length() < 8) {
-            WorkString = '0' + WorkString;
-          }
-        }
+  }
 
-        // do not allow display strings that exceed length of buffer (0-7, 8 digits)
-        if (WorkString.length() > 8) {
-          WorkString[8] = 0x00;
-        }
-        ControllerData->set_display_pageoption(WorkString);
-      }
+  (this->*(cmd->handler))(clientnum, arg);
+  return (cmd->cmdclass != Cmd_Get);
+}
+
+
+// ----------------------------------------------------------------------
+// Process a binary frame from tcp_next_frame()
+// Every request gets one response frame with the same seq
+// ----------------------------------------------------------------------
+bool TCPIP_SERVER::process_frame(int clientnum) {
+  Tcp_Rx &rx = _rx[clientnum];
+  Tcp_Tx &tx = _tx[clientnum];
+
+  if (rx.bad) {
+    send_frame_error(clientnum, rx.seq, Frame_BadCrc);
+    return false;
+  }
+
+  const Tcp_Command *cmd = find_command(rx.opcode);
+  if (cmd == NULL) {
+    send_frame_error(clientnum, rx.seq, Frame_Unknown);
+    return false;
+  }
+
+  Tcp_Args arg = { "", 0 };
+  bool argsok;
+  switch (cmd->argtype) {
+    case Arg_Digit:
+      argsok = (rx.plen == 1);
+      arg.value = (uint8_t)rx.param[0];
       break;
-    case 93:  // get display page option
+    case Arg_Long:
       {
-        // return as string of 01's
-        char buff[10];
-        memset(buff, 0, 10);
-        String answer = ControllerData->get_display_pageoption();
-        // should always be 8 digits (0-7) due to set command (:92)
-        // copy to buff
-        int i;
-        for (i = 0; i < answer.length(); i++) {
-          buff[i] = answer[i];
-        }
-        buff[i] = 0x00;
-        build_reply('l', buff, clientnum);
+        // little endian int32
+        int32_t val;
+        argsok = (rx.plen == sizeof(val));
+        memcpy(&val, rx.param, sizeof(val));
+        arg.value = val;
       }
       break;
-    case 94:  // - set DelayedDisplayUpdate (0=disabled, 1-enabled)
-      paramval = receiveString[3] - '0';
-      delayeddisplayupdatestatus = (byte)paramval;
+    case Arg_Text:
+      argsok = true;
+      arg.text = rx.param;
       break;
-    case 95:  // - get DelayedDisplayUpdate (0=disabled, 1-enabled)
-      build_reply('n', delayeddisplayupdatestatus, clientnum);
+    default:
+      argsok = (rx.plen == 0);
       break;
+  }
+  if (argsok == false) {
+    send_frame_error(clientnum, rx.seq, Frame_BadArgs);
+    return false;
+  }
 
-    case 96:  // not used
-      break;
+  // position and target are only changed when the focuser is not moving
+  if ((cmd->cmdclass == Cmd_Idle) && (isMoving != 0)) {
+    send_frame_error(clientnum, rx.seq, Frame_Busy);
+    return false;
+  }
 
-    case 97:  // not used
-      break;
+  tx.paylen = 0;
+  tx.replied = false;
+  (this->*(cmd->handler))(clientnum, arg);
+  if (tx.replied == false) {
+    send_frame(clientnum, rx.opcode, rx.seq);
+  }
+  return (cmd->cmdclass != Cmd_Get);
+}
 
-    case 98:  // myFP2ESP32 get network strength dbm
-      {
-        long rssi = getrssi();
-        build_reply('$', rssi, clientnum);
-      }
-      break;
-    case 99:  // myFP2ESP32 set home positon switch enable state, 0 or 1, disabled or enabled
-      {
-        paramval = receiveString[3] - '0';
-        debug_server_print(T_TCPIPSERVER);
-        debug_server_print(T_HPSW);
-        if (ControllerData->get_brdhpswpin() == -1) {
-          debug_server_println(T_NOTSUPPORTED);
-        } else {
-          if (paramval == 1) {
-            // enable
-            if (driverboard->init_hpsw() == true) {
-              debug_server_println(T_ENABLED);
-              ControllerData->set_hpswitch_enable((byte)paramval);
-            } else {
-              debug_server_println(T_ERROR);
-            }
-          } else {
-            // disable
-            ControllerData->set_hpswitch_enable((byte)paramval);
-            debug_server_println(T_DISABLED);
-          }
-        }
-      }
-      break;
 
-    // :A0-A9
-    case 100:  // myFP2ESP32 get joystick1 enable state
-      build_reply('$', driverboard->get_joystick1_loaded(), clientnum);
-      break;
-    case 101:  // myFP2ESP32 set joystick1 enable state (0=stopped, 1=started)
-      paramval = receiveString[3] - '0';
-      driverboard->set_joystick1((byte)paramval);
-      break;
-    case 102:  // myFP2ESP32 get joystick2 enable state
-      build_reply('$', driverboard->get_joystick2_loaded(), clientnum);
-      break;
-    case 103:  // myFP2ESP32 set joystick2 enable state (0=stopped, 1=started)
-      paramval = receiveString[3] - '0';
-      driverboard->set_joystick2((byte)paramval);
-      break;
-    case 104:  // myFP2ESP32 get temp probe enabled state
-      build_reply('$', ControllerData->get_tempprobe_enable(), clientnum);
-      break;
-    case 105:  // myFP2ESP32 set temp probe enabled state
-      paramval = receiveString[3] - '0';
-      ControllerData->set_tempprobe_enable((byte)paramval);
-      break;
-    case 106:  // myFP2ESP32 get ASCOM ALPACA Server enabled state
-      build_reply('$', ControllerData->get_ascomsrvr_enable(), clientnum);
-      break;
-    case 107:  // myFP2ESP32 set ASCOM ALPACA Server enabled state
-      paramval = receiveString[3] - '0';
-      if (paramval == 1) {
-        // enable the server
-        ControllerData->set_ascomsrvr_enable(V_ENABLED);
-      } else {
-        // stop and disable
-        ascomsrvr->stop();
-        ascomsrvr_status = V_STOPPED;
-        ControllerData->set_ascomsrvr_enable(V_NOTENABLED);
-      }
-      break;
-    case 108:  // myFP2ESP32 get ASCOM ALPACA Server Start/Stop status
-      build_reply('$', ascomsrvr_status, clientnum);
-      break;
-    case 109:  // myFP2ESP32 set ASCOM ALPACA Server Start/Stop - this will start or stop the ASCOM server
-      paramval = receiveString[3] - '0';
-      if (paramval == 1) {
-        // start if enabled
-        if (ControllerData->get_ascomsrvr_enable() == V_ENABLED) {
-          ascomsrvr_status = ascomsrvr->start();
-          if (ascomsrvr_status != V_RUNNING) {
-            debug_server_print(T_ALPACA);
-            debug_server_println(T_ERRSTART);
-          }
-        } else {
-          debug_server_print(T_ALPACA);
-          debug_server_println(T_NOTENABLED);
-        }
-      } else {
-        // stop
-        ascomsrvr->stop();
-        ascomsrvr_status = V_STOPPED;
-      }
-      break;
+// ----------------------------------------------------------------------
+// COMMAND HANDLERS
+// ----------------------------------------------------------------------
+// compatibility, not supported by myFP2ESP32
+static byte joggingstate = 0;
+static byte joggingdirection = 0;
+static byte delayeddisplayupdatestatus = 0;
+
+// :00 get focuser position
+void TCPIP_SERVER::cmd_getposition(int clientnum, const Tcp_Args &arg) {
+  build_reply('P', focuserstate->get_position(), clientnum);
+}
 
-    // :B0 to :B9
-    case 110:  // myFP2ESP32 get Web Server enabled state
-      build_reply('$', ControllerData->get_ascomsrvr_enable(), clientnum);
-      break;
-    case 111:  // myFP2ESP32 set Web Server enabled state
-      paramval = receiveString[3] - '0';
-      if (paramval == 1) {
-        // enable the server
-        ControllerData->set_websrvr_enable(V_ENABLED);
-      } else {
-        // stop and disable
-        websrvr->stop();
-        websrvr_status = V_STOPPED;
-        ControllerData->set_websrvr_enable(V_NOTENABLED);
-      }
-      break;
-    case 112:  // myFP2ESP32 get Web Server Start/Stop status
-      build_reply('$', ascomsrvr_status, clientnum);
-      break;
-    case 113:  // myFP2ESP32 set Web Server Start/Stop - this will start or stop the ASCOM server
-      paramval = receiveString[3] - '0';
-      if (paramval == 1) {
-        // start if enabled
-        if (ControllerData->get_websrvr_enable() == V_ENABLED) {
-          // enabled
-          websrvr_status = websrvr->start(ControllerData->get_websrvr_port());
-          if (websrvr_status != V_RUNNING) {
-            debug_server_print(T_ERRSTART);
-            debug_server_println(T_WEBSERVER);
-          }
-        }
+// :01 ismoving
+void TCPIP_SERVER::cmd_getismoving(int clientnum, const Tcp_Args &arg) {
+  build_reply('I', focuserstate->get_ismoving(), clientnum);
+}
+
+// :02 get controller status
+void TCPIP_SERVER::cmd_getstatus(int clientnum, const Tcp_Args &arg) {
+  build_reply('E', "OK", clientnum);
+}
+
+// :03 get firmware version
+void TCPIP_SERVER::cmd_getversion(int clientnum, const Tcp_Args &arg) {
+  build_reply('F', program_version, clientnum);
+}
+
+// :04 get get_brdname + version number
+void TCPIP_SERVER::cmd_getbrdversion(int clientnum, const Tcp_Args &arg) {
+  char buff[48];
+  snprintf(buff, sizeof(buff), "%s%c%c%s", ControllerData->get_brdname(), '\r', '\n', program_version);
+  build_reply('F', buff, clientnum);
+}
+
+// :05 Set new target position to xxxxxx (and focuser initiates immediate move to xxxxxx)
+void TCPIP_SERVER::cmd_movetarget(int clientnum, const Tcp_Args &arg) {
+  ftargetPosition = arg.value;
+  ftargetPosition = (ftargetPosition < 0) ? 0 : ftargetPosition;
+  ftargetPosition = (ftargetPosition > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : ftargetPosition;
+  isMoving = 1;
+}
+
+// :06 get temperature
+void TCPIP_SERVER::cmd_gettemp(int clientnum, const Tcp_Args &arg) {
+  build_reply('Z', focuserstate->get_temp(), 3, clientnum);
+}
+
+// :07 Set maxsteps
+void TCPIP_SERVER::cmd_setmaxstep(int clientnum, const Tcp_Args &arg) {
+  long tmppos = arg.value;
+  // check to make sure not above largest value for maxstep
+  tmppos = (tmppos > FOCUSERUPPERLIMIT) ? FOCUSERUPPERLIMIT : tmppos;
+  // check if below lowest set valueue for maxstep
+  tmppos = (tmppos < FOCUSERLOWERLIMIT) ? FOCUSERLOWERLIMIT : tmppos;
+  // check to make sure its not less than current focuser position
+  tmppos = (tmppos < driverboard->getposition()) ? driverboard->getposition() : tmppos;
+  ControllerData->set_maxstep(tmppos);
+}
+
+// :08 get maxStep
+void TCPIP_SERVER::cmd_getmaxstep(int clientnum, const Tcp_Args &arg) {
+  build_reply('M', ControllerData->get_maxstep(), clientnum);
+}
+
+// :09 myFP2ESP32 get _inoutledmode, pulse or move
+void TCPIP_SERVER::cmd_getinoutledmode(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_inoutled_mode(), clientnum);
+}
+
+// :10 get maxIncrement
+void TCPIP_SERVER::cmd_getmaxincrement(int clientnum, const Tcp_Args &arg) {
+  build_reply('Y', ControllerData->get_maxstep(), clientnum);
+}
+
+// :11 get coil power enable
+void TCPIP_SERVER::cmd_getcoilpower(int clientnum, const Tcp_Args &arg) {
+  build_reply('O', ControllerData->get_coilpower_enable(), clientnum);
+}
+
+// :12 set coil power enable
+void TCPIP_SERVER::cmd_setcoilpower(int clientnum, const Tcp_Args &arg) {
+  // if 1, enable coilpower, set coilpowerstate true, enable motor
+  // if 0, disable coilpower, set coilpowerstate false; release motor
+  (arg.value == 1) ? driverboard->enablemotor() : driverboard->releasemotor();
+  (arg.value == 1) ? ControllerData->set_coilpower_enable(V_ENABLED) : ControllerData->set_coilpower_enable(V_NOTENABLED);
+}
+
+// :13 get reverse direction setting, 00 off, 01 on
+void TCPIP_SERVER::cmd_getreverse(int clientnum, const Tcp_Args &arg) {
+  build_reply('R', ControllerData->get_reverse_enable(), clientnum);
+}
+
+// :14 set reverse direction
+void TCPIP_SERVER::cmd_setreverse(int clientnum, const Tcp_Args &arg) {
+  (arg.value == 1) ? ControllerData->set_reverse_enable(V_ENABLED) : ControllerData->set_reverse_enable(V_NOTENABLED);
+}
+
+// :15 set motor speed
+void TCPIP_SERVER::cmd_setmotorspeed(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_motorspeed((byte)(arg.value & 3));
+}
+
+// :16 set temperature display setting to celsius (0)
+void TCPIP_SERVER::cmd_setcelsius(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_tempmode(V_CELSIUS);
+}
+
+// :17 set temperature display setting to fahrenheit (1)
+void TCPIP_SERVER::cmd_setfahrenheit(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_tempmode(V_FAHRENHEIT);
+}
+
+// :18 set Stepsize enable state
+void TCPIP_SERVER::cmd_setstepsizeenable(int clientnum, const Tcp_Args &arg) {
+  // :180#    None    Set stepsize to be OFF - default
+  // :181#    None    stepsize to be ON - reports what user specified as stepsize
+  ControllerData->set_stepsize_enable((byte)arg.value);
+}
+
+// :19 set the step size value - double type, eg 2.1
+void TCPIP_SERVER::cmd_setstepsize(int clientnum, const Tcp_Args &arg) {
+  float tempstepsize = atof(arg.text);
+  tempstepsize = (tempstepsize < MINIMUMSTEPSIZE) ? MINIMUMSTEPSIZE : tempstepsize;
+  tempstepsize = (tempstepsize > MAXIMUMSTEPSIZE) ? MAXIMUMSTEPSIZE : tempstepsize;
+  ControllerData->set_stepsize(tempstepsize);
+}
+
+// :20 set the temperature resolution setting for the DS18B20 temperature probe
+void TCPIP_SERVER::cmd_settempresolution(int clientnum, const Tcp_Args &arg) {
+  long paramval = arg.value;
+  paramval = (paramval < 9) ? 9 : paramval;
+  paramval = (paramval > 12) ? 12 : paramval;
+  ControllerData->set_tempresolution((byte)paramval);
+  tempprobe->set_resolution((byte)paramval);
+}
+
+// :21 get temp probe resolution
+void TCPIP_SERVER::cmd_gettempresolution(int clientnum, const Tcp_Args &arg) {
+  build_reply('Q', ControllerData->get_tempresolution(), clientnum);
+}
+
+// :22 set temperature coefficient steps value to xxx
+void TCPIP_SERVER::cmd_settempcoefficient(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_tempcoefficient(arg.value);
+}
+
+// :23 set the temperature compensation ON (1) or OFF (0)
+void TCPIP_SERVER::cmd_settempcomp(int clientnum, const Tcp_Args &arg) {
+  if (tempprobe->get_state() == V_RUNNING) {
+    ControllerData->set_tempcomp_enable((byte)arg.value);
+  }
+}
+
+// :24 get status of temperature compensation (enabled | disabled)
+void TCPIP_SERVER::cmd_gettempcomp(int clientnum, const Tcp_Args &arg) {
+  build_reply('1', ControllerData->get_tempcomp_enable(), clientnum);
+}
+
+// :25 get temperature compensation available
+void TCPIP_SERVER::cmd_gettcavailable(int clientnum, const Tcp_Args &arg) {
+  build_reply('A', ControllerData->get_tcavailable(), clientnum);
+}
+
+// :26 get temperature coefficient steps/degree
+void TCPIP_SERVER::cmd_gettempcoefficient(int clientnum, const Tcp_Args &arg) {
+  build_reply('B', ControllerData->get_tempcoefficient(), clientnum);
+}
+
+// :27 stop a move - like a Halt
+void TCPIP_SERVER::cmd_halt(int clientnum, const Tcp_Args &arg) {
+  portENTER_CRITICAL(&halt_alertMux);
+  halt_alert = true;
+  portEXIT_CRITICAL(&halt_alertMux);
+}
+
+// :28 home the motor to position 0
+void TCPIP_SERVER::cmd_home(int clientnum, const Tcp_Args &arg) {
+  ftargetPosition = 0;
+  isMoving = 1;
+}
+
+// :29 get stepmode
+void TCPIP_SERVER::cmd_getstepmode(int clientnum, const Tcp_Args &arg) {
+  build_reply('S', ControllerData->get_brdstepmode(), clientnum);
+}
+
+// ----------------------------------------------------------------------
+// Basic rule for setting stepmode
+// set DRIVER_BOARD->setstepmode(xx);                         // this sets the physical pins
+// and this also saves ControllerData->set_brdstepmode(xx);   // this saves config setting
+// ----------------------------------------------------------------------
+// :30 set step mode
+void TCPIP_SERVER::cmd_setstepmode(int clientnum, const Tcp_Args &arg) {
+  long paramval = arg.value;
+  int brdnum = ControllerData->get_brdnumber();
+  if (brdnum == PRO2ESP32ULN2003 || brdnum == PRO2ESP32L298N || brdnum == PRO2ESP32L293DMINI || brdnum == PRO2ESP32L9110S) {
+    paramval = (int)(paramval & 3);  // STEP1 - STEP2
+  } else if (brdnum == PRO2ESP32DRV8825 || brdnum == PRO2ESP32R3WEMOS) {
+    paramval = (paramval < STEP1) ? STEP1 : paramval;
+    paramval = (paramval > STEP32) ? STEP32 : paramval;
+  } else if (brdnum == PRO2ESP32TMC2225 || brdnum == PRO2ESP32TMC2209 || brdnum == PRO2ESP32TMC2209P) {
+    paramval = (paramval < STEP1) ? STEP1 : paramval;
+    paramval = (paramval > STEP256) ? STEP256 : paramval;
+  } else {
+    debug_server_print(T_TCPIPSERVER);
+    debug_server_print(T_ERROR);
+    debug_server_print(", invalid brd ");
+    debug_server_println(brdnum);
+  }
+  ControllerData->set_brdstepmode((int)paramval);
+  driverboard->setstepmode((int)paramval);
+}
+
+// :31 set focuser position
+void TCPIP_SERVER::cmd_setposition(int clientnum, const Tcp_Args &arg) {
+  long tpos = arg.value;
+  tpos = (tpos < 0) ? 0 : tpos;
+  tpos = (tpos > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : tpos;
+  ftargetPosition = tpos;
+  driverboard->setposition(tpos);
+  ControllerData->set_fposition(tpos);
+}
+
+// :32 get if stepsize is enabled
+void TCPIP_SERVER::cmd_getstepsizeenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('U', ControllerData->get_stepsize_enable(), clientnum);
+}
+
+// :33 get stepsize
+void TCPIP_SERVER::cmd_getstepsize(int clientnum, const Tcp_Args &arg) {
+  build_reply('T', ControllerData->get_stepsize(), 2, clientnum);
+}
+
+// :34 get the time that a display page is shown for
+void TCPIP_SERVER::cmd_getpagetime(int clientnum, const Tcp_Args &arg) {
+  build_reply('X', ControllerData->get_display_pagetime(), clientnum);
+}
+
+// :35 set the time a display page is displayed for in seconds, integer, 2-10
+void TCPIP_SERVER::cmd_setpagetime(int clientnum, const Tcp_Args &arg) {
+  long paramval = arg.value;
+  paramval = (paramval < V_DISPLAYPAGETIMEMIN) ? V_DISPLAYPAGETIMEMIN : paramval;
+  paramval = (paramval > V_DISPLAYPAGETIMEMAX) ? V_DISPLAYPAGETIMEMAX : paramval;
+  ControllerData->set_display_pagetime(paramval);
+  // update display_maxcount
+  portENTER_CRITICAL(&displaytimeMux);
+  // convert to timeslices
+  display_maxcount = paramval * 10;
+  portEXIT_CRITICAL(&displaytimeMux);
+}
+
+// :36 set display writing state, 0 = write not allowed, 1 = write text allowed
+void TCPIP_SERVER::cmd_setdisplaystate(int clientnum, const Tcp_Args &arg) {
+  // :360#    None    Blank the Display
+  // :361#    None    UnBlank the Display
+  (arg.value == 1) ? display_on() : display_off();
+}
+
+// :37 get display status (1=Running or 0=Stopped)
+void TCPIP_SERVER::cmd_getdisplaystatus(int clientnum, const Tcp_Args &arg) {
+  build_reply('D', display_status, clientnum);
+}
+
+// :38 get temperature mode 1=Celsius, 0=Fahrenheight
+void TCPIP_SERVER::cmd_gettempmode(int clientnum, const Tcp_Args &arg) {
+  build_reply('b', ControllerData->get_tempmode(), clientnum);
+}
+
+// :39 get the new motor position (target) XXXXXX
+void TCPIP_SERVER::cmd_gettarget(int clientnum, const Tcp_Args &arg) {
+  build_reply('N', focuserstate->get_target(), clientnum);
+}
+
+// :40 reboot controller with 2s delay
+void TCPIP_SERVER::cmd_reboot(int clientnum, const Tcp_Args &arg) {
+  reboot_esp32(2000);
+}
+
+// :41 myFP2ESP32 set in-out-led-mode (pulsed or move)
+void TCPIP_SERVER::cmd_setinoutledmode(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_inoutled_mode((byte)arg.value);
+}
+
+// :42 reset focuser defaults
+void TCPIP_SERVER::cmd_setdefaults(int clientnum, const Tcp_Args &arg) {
+  ControllerData->SetFocuserDefaults();
+  ftargetPosition = ControllerData->get_fposition();
+  driverboard->setposition(ftargetPosition);
+  ControllerData->set_fposition(ftargetPosition);
+}
+
+// :43 get motorspeed
+void TCPIP_SERVER::cmd_getmotorspeed(int clientnum, const Tcp_Args &arg) {
+  build_reply('C', ControllerData->get_motorspeed(), clientnum);
+}
+
+// :44 myFP2ESP32 get park enable state
+void TCPIP_SERVER::cmd_getparkenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_park_enable(), clientnum);
+}
+
+// :45 myFP2ESP32 set park enable state
+void TCPIP_SERVER::cmd_setparkenable(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_park_enable((byte)arg.value);
+}
+
+// :46 myFP2ESP32 get in-out led enable state
+void TCPIP_SERVER::cmd_getinoutledenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_inoutled_enable(), clientnum);
+}
+
+// :47 myFP2ESP32 set in-out led enable state
+void TCPIP_SERVER::cmd_setinoutledenable(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_inoutled_enable((byte)arg.value);
+}
+
+// :48 save settings to file
+void TCPIP_SERVER::cmd_savesettings(int clientnum, const Tcp_Args &arg) {
+  // need to save position setting
+  ControllerData->set_fposition(driverboard->getposition());
+  // save the focuser settings immediately
+  ControllerData->SaveNow(driverboard->getposition(), driverboard->getdirection());
+}
+
+// :49 aXXXXX
+void TCPIP_SERVER::cmd_getid(int clientnum, const Tcp_Args &arg) {
+  build_reply('a', "b552efd", clientnum);
+}
+
+// :50 get if Home Position Switch enabled, 0 = no, 1 = yes
+void TCPIP_SERVER::cmd_gethpswenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('l', ControllerData->get_hpswitch_enable(), clientnum);
+}
+
+// :51 myFP2ESP32 get Wifi Controller IP Address
+void TCPIP_SERVER::cmd_getipaddress(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ipStr, clientnum);
+}
+
+// :52 myFP2ESP32 get park state
+void TCPIP_SERVER::cmd_getparked(int clientnum, const Tcp_Args &arg) {
+  if (_parked) {
+    build_reply('$', 1, clientnum);
+  } else {
+    build_reply('$', 0, clientnum);
+  }
+}
+
+// :54 myFP2ESP32 ESP32 Controller SSID
+void TCPIP_SERVER::cmd_getssid(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', mySSID, clientnum);
+}
+
+// :55 get motorspeed delay for current speed setting
+void TCPIP_SERVER::cmd_getmsdelay(int clientnum, const Tcp_Args &arg) {
+  build_reply('0', ControllerData->get_brdmsdelay(), clientnum);
+}
+
+// :56 set motorspeed delay for current speed setting
+void TCPIP_SERVER::cmd_setmsdelay(int clientnum, const Tcp_Args &arg) {
+  long paramval = arg.value;
+  paramval = (paramval < 1000) ? 1000 : paramval;
+  ControllerData->set_brdmsdelay(paramval);
+}
+
+// :57 myFP2ESP32 get pushbutton enable state
+void TCPIP_SERVER::cmd_getpushbuttons(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', driverboard->get_pushbuttons_loaded(), clientnum);
+}
+
+// :58 myFP2ESP32 set pushbutton enable state
+void TCPIP_SERVER::cmd_setpushbuttons(int clientnum, const Tcp_Args &arg) {
+  driverboard->set_pushbuttons((byte)arg.value);
+}
+
+// :59 myFP2ESP32 get park time
+void TCPIP_SERVER::cmd_getparktime(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_parktime(), clientnum);
+}
+
+// :60 myFP2ESP32 set park time interval in seconds
+void TCPIP_SERVER::cmd_setparktime(int clientnum, const Tcp_Args &arg) {
+  // range checked by the setter, 30s to 300s (5m)
+  ControllerData->set_parktime(arg.value);
+  // update park_maxcount
+  portENTER_CRITICAL(&parkMux);
+  // convert to timeslices
+  park_maxcount = ControllerData->get_parktime() * 10;
+  portEXIT_CRITICAL(&parkMux);
+}
+
+// :61 set update of position on oled when moving (0=disable, 1=enable)
+void TCPIP_SERVER::cmd_setupdateonmove(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_display_updateonmove((byte)arg.value);
+}
+
+// :62 get update of position on oled when moving (00=disable, 01=enable)
+void TCPIP_SERVER::cmd_getupdateonmove(int clientnum, const Tcp_Args &arg) {
+  build_reply('L', ControllerData->get_display_updateonmove(), clientnum);
+}
+
+// :63 get status of home position switch
+void TCPIP_SERVER::cmd_gethpsw(int clientnum, const Tcp_Args &arg) {
+  // if the hpsw is enabled
+  if (ControllerData->get_hpswitch_enable() == V_RUNNING) {
+    // get state of hpsw, return 1 if closed, 0 if open
+    // myFP2ESP32  (hpsw pin 1=open, 0=closed)
+    // if( driverboard->hpsw_alert() == true )
+    build_reply('H', driverboard->hpsw_alert(), clientnum);
+  } else {
+    build_reply('H', 0, clientnum);
+  }
+}
+
+// :64 move a specified number of steps
+void TCPIP_SERVER::cmd_movesteps(int clientnum, const Tcp_Args &arg) {
+  long pos = arg.value + driverboard->getposition();
+  pos = (pos < 0) ? 0 : pos;
+  ftargetPosition = (pos > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : pos;
+  isMoving = 0;
+}
+
+// :65 set jogging state enable/disable
+void TCPIP_SERVER::cmd_setjogging(int clientnum, const Tcp_Args &arg) {
+  joggingstate = (byte)arg.value;
+}
+
+// :66 get jogging state enabled/disabled
+void TCPIP_SERVER::cmd_getjogging(int clientnum, const Tcp_Args &arg) {
+  build_reply('K', joggingstate, clientnum);
+}
+
+// :67 set jogging direction, 0=IN, 1=OUT
+void TCPIP_SERVER::cmd_setjogdirection(int clientnum, const Tcp_Args &arg) {
+  joggingdirection = (byte)arg.value;
+}
+
+// :68 get jogging direction, 0=IN, 1=OUT
+void TCPIP_SERVER::cmd_getjogdirection(int clientnum, const Tcp_Args &arg) {
+  build_reply('V', joggingdirection, clientnum);
+}
+
+// :69 get push button steps
+void TCPIP_SERVER::cmd_getpbsteps(int clientnum, const Tcp_Args &arg) {
+  build_reply('?', ControllerData->get_pushbutton_steps(), clientnum);
+}
+
+// :70 set push buttons steps [1-max] where max = stepsize / 2
+void TCPIP_SERVER::cmd_setpbsteps(int clientnum, const Tcp_Args &arg) {
+  long paramval = arg.value;
+  paramval = (paramval < 1) ? 1 : paramval;
+  // set maximum steps to be 1/2 the step size
+  int sz = (int)ControllerData->get_stepsize() / 2;
+  sz = (sz < 1) ? 1 : sz;
+  paramval = (paramval > sz) ? sz : paramval;
+  ControllerData->set_pushbutton_steps((byte)paramval);
+}
+
+// :71 set delayaftermove time value in milliseconds [0-250]
+void TCPIP_SERVER::cmd_setdelayaftermove(int clientnum, const Tcp_Args &arg) {
+  long paramval = arg.value;
+  paramval = (paramval < 0) ? 0 : paramval;
+  paramval = (paramval > 250) ? 250 : paramval;
+  ControllerData->set_delayaftermove_time((byte)paramval);
+}
+
+// :72 get delayaftermove_state value in milliseconds
+void TCPIP_SERVER::cmd_getdelayaftermove(int clientnum, const Tcp_Args &arg) {
+  build_reply('3', ControllerData->get_delayaftermove_time(), clientnum);
+}
+
+// :73 set disable/enable backlash IN (going to lower focuser position)
+void TCPIP_SERVER::cmd_setbacklashinenable(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_backlash_in_enable((byte)arg.value);
+}
+
+// :74 get backlash in enabled status
+void TCPIP_SERVER::cmd_getbacklashinenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('4', ControllerData->get_backlash_in_enable(), clientnum);
+}
+
+// :75 set disable/enable backlash OUT (going to lower focuser position)
+void TCPIP_SERVER::cmd_setbacklashoutenable(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_backlash_out_enable((byte)arg.value);
+}
+
+// :76 get backlash OUT enabled status
+void TCPIP_SERVER::cmd_getbacklashoutenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('5', ControllerData->get_backlash_out_enable(), clientnum);
+}
+
+// :77 set backlash in steps [0-255]
+void TCPIP_SERVER::cmd_setbacklashin(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_backlashsteps_in((byte)(arg.value & 0xff));
+}
+
+// :78 get backlash steps IN
+void TCPIP_SERVER::cmd_getbacklashin(int clientnum, const Tcp_Args &arg) {
+  build_reply('6', ControllerData->get_backlashsteps_in(), clientnum);
+}
+
+// :79 set backlash OUT steps
+void TCPIP_SERVER::cmd_setbacklashout(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_backlashsteps_out((byte)(arg.value & 0xff));
+}
+
+// :80 get backlash steps OUT
+void TCPIP_SERVER::cmd_getbacklashout(int clientnum, const Tcp_Args &arg) {
+  build_reply('7', ControllerData->get_backlashsteps_out(), clientnum);
+}
+
+// :81 get STALL_VALUE (for TMC2209 stepper modules)
+void TCPIP_SERVER::cmd_getstallguard(int clientnum, const Tcp_Args &arg) {
+  build_reply('8', ControllerData->get_stallguard_value(), clientnum);
+}
+
+// :82 myFP2ESP32 set STALL_VALUE (for TMC2209 stepper modules)
+void TCPIP_SERVER::cmd_setstallguard(int clientnum, const Tcp_Args &arg) {
+  driverboard->setstallguardvalue((byte)arg.value);
+}
+
+// :83 get if there is a temperature probe
+void TCPIP_SERVER::cmd_gettempprobefound(int clientnum, const Tcp_Args &arg) {
+  if (tempprobe->get_found() == false) {
+    build_reply('c', 0, clientnum);
+  } else {
+    build_reply('c', 1, clientnum);
+  }
+}
+
+// :85 myFP2ESP32 get delay after move enable state
+void TCPIP_SERVER::cmd_getdelayaftermoveenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_delayaftermove_enable(), clientnum);
+}
+
+// :86 myFP2ESP32 set delay after move enable state
+void TCPIP_SERVER::cmd_setdelayaftermoveenable(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_delayaftermove_enable((byte)arg.value);
+}
+
+// :87 get tc direction
+void TCPIP_SERVER::cmd_gettcdirection(int clientnum, const Tcp_Args &arg) {
+  build_reply('k', ControllerData->get_tcdirection(), clientnum);
+}
+
+// :88 set tc direction
+void TCPIP_SERVER::cmd_settcdirection(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_tcdirection((byte)arg.value);
+}
+
+// :89 get stepper power (reads from A7) - only valid if hardware circuit is added (1=stepperpower ON)
+void TCPIP_SERVER::cmd_getstepperpower(int clientnum, const Tcp_Args &arg) {
+  build_reply('9', 1, clientnum);
+}
+
+// :90 myFP2ESP32 set preset x [0-9] with position value yyyy [unsigned long]
+void TCPIP_SERVER::cmd_setpreset(int clientnum, const Tcp_Args &arg) {
+  byte preset = (byte)(arg.text[0] - '0');
+  preset = (preset > 9) ? 9 : preset;
+  long tmppos = (arg.text[0] != 0) ? atol(arg.text + 1) : 0;
+  tmppos = (tmppos < 0) ? 0 : tmppos;
+  tmppos = (tmppos > ControllerData->get_maxstep()) ? ControllerData->get_maxstep() : tmppos;
+  ControllerData->set_focuserpreset(preset, tmppos);
+  // update cached copy
+  _presets[preset] = tmppos;
+}
+
+// :91 myFP2ESP32 get focuserpreset [0-9]
+void TCPIP_SERVER::cmd_getpreset(int clientnum, const Tcp_Args &arg) {
+  byte preset = (byte)arg.value;
+  preset = (preset > 9) ? 9 : preset;
+  build_reply('$', _presets[preset], clientnum);
+}
+
+// :92 set display page display option (8 digits, index of 0-7)
+void TCPIP_SERVER::cmd_setpageoption(int clientnum, const Tcp_Args &arg) {
+  char pgopt[PAGEOPTIONLEN];
+  size_t len = strlen(arg.text);
+  if (len == 0) {
+    // If empty (no args) - fill with default display string
+    strlcpy(pgopt, "11111111", sizeof(pgopt));
+  } else if (len < (PAGEOPTIONLEN - 1)) {
+    // if display option length less than 8, pad with leading 0's
+    size_t pad = (PAGEOPTIONLEN - 1) - len;
+    memset(pgopt, '0', pad);
+    strlcpy(pgopt + pad, arg.text, sizeof(pgopt) - pad);
+  } else {
+    // do not allow display strings that exceed length of buffer (0-7, 8 digits)
+    strlcpy(pgopt, arg.text, sizeof(pgopt));
+  }
+  ControllerData->set_display_pageoption(pgopt);
+}
+
+// :93 get display page option
+void TCPIP_SERVER::cmd_getpageoption(int clientnum, const Tcp_Args &arg) {
+  // return as string of 01's, always 8 digits (0-7) due to set command (:92)
+  build_reply('l', ControllerData->get_display_pageoption(), clientnum);
+}
+
+// :94 - set DelayedDisplayUpdate (0=disabled, 1-enabled)
+void TCPIP_SERVER::cmd_setdelayeddisplay(int clientnum, const Tcp_Args &arg) {
+  delayeddisplayupdatestatus = (byte)arg.value;
+}
+
+// :95 - get DelayedDisplayUpdate (0=disabled, 1-enabled)
+void TCPIP_SERVER::cmd_getdelayeddisplay(int clientnum, const Tcp_Args &arg) {
+  build_reply('n', delayeddisplayupdatestatus, clientnum);
+}
+
+// :98 myFP2ESP32 get network strength dbm
+void TCPIP_SERVER::cmd_getrssi(int clientnum, const Tcp_Args &arg) {
+  long rssi = getrssi();
+  build_reply('$', rssi, clientnum);
+}
+
+// :99 myFP2ESP32 set home positon switch enable state, 0 or 1, disabled or enabled
+void TCPIP_SERVER::cmd_sethpswenable(int clientnum, const Tcp_Args &arg) {
+  debug_server_print(T_TCPIPSERVER);
+  debug_server_print(T_HPSW);
+  if (ControllerData->get_brdhpswpin() == -1) {
+    debug_server_println(T_NOTSUPPORTED);
+  } else {
+    if (arg.value == 1) {
+      // enable
+      if (driverboard->init_hpsw() == true) {
+        debug_server_println(T_ENABLED);
+        ControllerData->set_hpswitch_enable((byte)arg.value);
       } else {
-        // stop
-        if (websrvr_status == V_RUNNING) {
-          websrvr->stop();
-          websrvr_status = V_STOPPED;
-        }
+        debug_server_println(T_ERROR);
       }
-      break;
+    } else {
+      // disable
+      ControllerData->set_hpswitch_enable((byte)arg.value);
+      debug_server_println(T_DISABLED);
+    }
+  }
+}
 
-    case 114:  // myFP2ESP32 get Management Server enabled state
-      build_reply('$', ControllerData->get_mngsrvr_enable(), clientnum);
-      break;
-    case 115:  // myFP2ESP32 set Management Server enabled state
-      paramval = receiveString[3] - '0';
-      if (paramval == 1) {
-        // enable the server
-        ControllerData->set_mngsrvr_enable(V_ENABLED);
-      } else {
-        // stop and disable
-        mngsrvr->stop();
-        mngsrvr_status = V_STOPPED;
-        ControllerData->set_mngsrvr_enable(V_NOTENABLED);
+// :A0 myFP2ESP32 get joystick1 enable state
+void TCPIP_SERVER::cmd_getjoystick1(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', driverboard->get_joystick1_loaded(), clientnum);
+}
+
+// :A1 myFP2ESP32 set joystick1 enable state (0=stopped, 1=started)
+void TCPIP_SERVER::cmd_setjoystick1(int clientnum, const Tcp_Args &arg) {
+  driverboard->set_joystick1((byte)arg.value);
+}
+
+// :A2 myFP2ESP32 get joystick2 enable state
+void TCPIP_SERVER::cmd_getjoystick2(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', driverboard->get_joystick2_loaded(), clientnum);
+}
+
+// :A3 myFP2ESP32 set joystick2 enable state (0=stopped, 1=started)
+void TCPIP_SERVER::cmd_setjoystick2(int clientnum, const Tcp_Args &arg) {
+  driverboard->set_joystick2((byte)arg.value);
+}
+
+// :A4 myFP2ESP32 get temp probe enabled state
+void TCPIP_SERVER::cmd_gettempprobeenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_tempprobe_enable(), clientnum);
+}
+
+// :A5 myFP2ESP32 set temp probe enabled state
+void TCPIP_SERVER::cmd_settempprobeenable(int clientnum, const Tcp_Args &arg) {
+  ControllerData->set_tempprobe_enable((byte)arg.value);
+}
+
+// :A6 myFP2ESP32 get ASCOM ALPACA Server enabled state
+void TCPIP_SERVER::cmd_getascomenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_ascomsrvr_enable(), clientnum);
+}
+
+// :A7 myFP2ESP32 set ASCOM ALPACA Server enabled state
+void TCPIP_SERVER::cmd_setascomenable(int clientnum, const Tcp_Args &arg) {
+  if (arg.value == 1) {
+    // enable the server
+    ControllerData->set_ascomsrvr_enable(V_ENABLED);
+  } else {
+    // stop and disable
+    ascomsrvr->stop();
+    ascomsrvr_status = V_STOPPED;
+    ControllerData->set_ascomsrvr_enable(V_NOTENABLED);
+  }
+}
+
+// :A8 myFP2ESP32 get ASCOM ALPACA Server Start/Stop status
+void TCPIP_SERVER::cmd_getascomstatus(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ascomsrvr_status, clientnum);
+}
+
+// :A9 myFP2ESP32 set ASCOM ALPACA Server Start/Stop - this will start or stop the ASCOM server
+void TCPIP_SERVER::cmd_setascomstatus(int clientnum, const Tcp_Args &arg) {
+  if (arg.value == 1) {
+    // start if enabled
+    if (ControllerData->get_ascomsrvr_enable() == V_ENABLED) {
+      ascomsrvr_status = ascomsrvr->start();
+      if (ascomsrvr_status != V_RUNNING) {
+        debug_server_print(T_ALPACA);
+        debug_server_println(T_ERRSTART);
       }
-      break;
-    case 116:  // myFP2ESP32 get Management Server Start/Stop status
-      build_reply('$', mngsrvr_status, clientnum);
-      break;
-    case 117:  // myFP2ESP32 set Management Server Start/Stop - this will start or stop the Management server
-      paramval = receiveString[3] - '0';
-      if (paramval == 1) {
-        // start if enabled
-        if (ControllerData->get_mngsrvr_enable() == V_ENABLED) {
-          // enabled
-          mngsrvr_status = mngsrvr->start(ControllerData->get_mngsrvr_port());
-          if (mngsrvr_status != V_RUNNING) {
-            debug_server_print(T_ERRSTART);
-            debug_server_println(T_MANAGEMENTSERVER);
-          }
-        }
-      } else {
-        // stop
-        mngsrvr->stop();
-        mngsrvr_status = V_STOPPED;
+    } else {
+      debug_server_print(T_ALPACA);
+      debug_server_println(T_NOTENABLED);
+    }
+  } else {
+    // stop
+    ascomsrvr->stop();
+    ascomsrvr_status = V_STOPPED;
+  }
+}
+
+// :B0 myFP2ESP32 get Web Server enabled state
+void TCPIP_SERVER::cmd_getwebenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_ascomsrvr_enable(), clientnum);
+}
+
+// :B1 myFP2ESP32 set Web Server enabled state
+void TCPIP_SERVER::cmd_setwebenable(int clientnum, const Tcp_Args &arg) {
+  if (arg.value == 1) {
+    // enable the server
+    ControllerData->set_websrvr_enable(V_ENABLED);
+  } else {
+    // stop and disable
+    websrvr->stop();
+    websrvr_status = V_STOPPED;
+    ControllerData->set_websrvr_enable(V_NOTENABLED);
+  }
+}
+
+// :B2 myFP2ESP32 get Web Server Start/Stop status
+void TCPIP_SERVER::cmd_getwebstatus(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ascomsrvr_status, clientnum);
+}
+
+// :B3 myFP2ESP32 set Web Server Start/Stop - this will start or stop the ASCOM server
+void TCPIP_SERVER::cmd_setwebstatus(int clientnum, const Tcp_Args &arg) {
+  if (arg.value == 1) {
+    // start if enabled
+    if (ControllerData->get_websrvr_enable() == V_ENABLED) {
+      // enabled
+      websrvr_status = websrvr->start(ControllerData->get_websrvr_port());
+      if (websrvr_status != V_RUNNING) {
+        debug_server_print(T_ERRSTART);
+        debug_server_println(T_WEBSERVER);
       }
-      break;
+    }
+  } else {
+    // stop
+    if (websrvr_status == V_RUNNING) {
+      websrvr->stop();
+      websrvr_status = V_STOPPED;
+    }
+  }
+}
 
-    case 118:  // myFP2ESP32 get cntlr_config.jsn
-      {
-        if (SPIFFS.exists("/cntlr_config.jsn") == false) {
-          send_reply("TCP-cntlr_config.jsn !found", clientnum);
-        } else {
-          // file exists so open it
-          File dfile = SPIFFS.open("/cntlr_config.jsn", "r");
-          if (!dfile) {
-            send_reply("TCP-118-cntlr_config.jsn !found", clientnum);
-          } else {
-            String cdata = dfile.readString();
-            dfile.close();
-            int len = cdata.length();
-            char cd[len + 2];
-            snprintf(cd, len + 2, "%c%s%c", '$', cdata, _EOFSTR);
-            send_reply(cd, clientnum);
-          }
-        }
+// :B4 myFP2ESP32 get Management Server enabled state
+void TCPIP_SERVER::cmd_getmngenable(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', ControllerData->get_mngsrvr_enable(), clientnum);
+}
+
+// :B5 myFP2ESP32 set Management Server enabled state
+void TCPIP_SERVER::cmd_setmngenable(int clientnum, const Tcp_Args &arg) {
+  if (arg.value == 1) {
+    // enable the server
+    ControllerData->set_mngsrvr_enable(V_ENABLED);
+  } else {
+    // stop and disable
+    mngsrvr->stop();
+    mngsrvr_status = V_STOPPED;
+    ControllerData->set_mngsrvr_enable(V_NOTENABLED);
+  }
+}
+
+// :B6 myFP2ESP32 get Management Server Start/Stop status
+void TCPIP_SERVER::cmd_getmngstatus(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', mngsrvr_status, clientnum);
+}
+
+// :B7 myFP2ESP32 set Management Server Start/Stop - this will start or stop the Management server
+void TCPIP_SERVER::cmd_setmngstatus(int clientnum, const Tcp_Args &arg) {
+  if (arg.value == 1) {
+    // start if enabled
+    if (ControllerData->get_mngsrvr_enable() == V_ENABLED) {
+      // enabled
+      mngsrvr_status = mngsrvr->start(ControllerData->get_mngsrvr_port());
+      if (mngsrvr_status != V_RUNNING) {
+        debug_server_print(T_ERRSTART);
+        debug_server_println(T_MANAGEMENTSERVER);
       }
-      send_reply("TCP-err 118", clientnum);
-      break;
+    }
+  } else {
+    // stop
+    mngsrvr->stop();
+    mngsrvr_status = V_STOPPED;
+  }
+}
 
-    case 119:  // myFP2ESP32 get coil power state :B9#
-      //deprecated
-      break;
-    case 120:  // myFP2ESP32 set coil power state :C0# (change only the coilpowestate) :C0x#
-      // deprecated
-      break;
+// :B8 myFP2ESP32 get cntlr_config.jsn, the current settings made from memory
+void TCPIP_SERVER::cmd_getcntlrconfig(int clientnum, const Tcp_Args &arg) {
+  if (_rx[clientnum].mode == Mode_Binary) {
+    // a response frame cannot hold the settings
+    send_frame_error(clientnum, _rx[clientnum].seq, Frame_NotSupported);
+    _tx[clientnum].replied = true;
+    return;
+  }
+  // send as $data# in one write, after any replies before it
+  // reply keeps its buffer, the settings are about the same size each time
+  static String reply;
+  const String &json = ControllerData->get_cntlr_json();
+  reply.reserve(json.length() + 2);
+  reply = "$";
+  reply += json;
+  reply += _EOFSTR;
+  send_bytes((const uint8_t *)reply.c_str(), reply.length(), clientnum);
+}
 
-    default:
-      debug_server_print(T_TCPIPSERVER);
-      debug_server_print(T_ERROR);
-      debug_server_print(", cmd ");
-      debug_server_println(receiveString);
-      break;
+// :C1 myFP2ESP32 subscribe to pushed position, moving and temperature, nnn = interval ms, 0 = unsubscribe
+void TCPIP_SERVER::cmd_subscribe(int clientnum, const Tcp_Args &arg) {
+  Tcp_Sub &sub = _sub[clientnum];
+  if (arg.value <= 0) {
+    sub.interval = 0;
+    return;
   }
+  long interval = arg.value;
+  interval = (interval < TCPPUSHMIN) ? TCPPUSHMIN : interval;
+  interval = (interval > TCPPUSHMAX) ? TCPPUSHMAX : interval;
+  sub.interval = (uint16_t)interval;
+  // send the whole state on the next push
+  sub.all = true;
+}
+
+// :C2 myFP2ESP32 get push interval ms, 0 = not subscribed
+void TCPIP_SERVER::cmd_getsubscribe(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', (int)_sub[clientnum].interval, clientnum);
+}
+
+// :C3 myFP2ESP32 get number of loops this client had commands wait for the next loop
+void TCPIP_SERVER::cmd_getdeferred(int clientnum, const Tcp_Args &arg) {
+  build_reply('$', _deferred[clientnum], clientnum);
 }
@@ -9,8 +9,59 @@
 #define _tcpip_server_h
 
 #include <WiFiServer.h>
+#include <WiFiClient.h>
+#include "controller_config.h"
+#include "tcpip_commands.h"
+#include "tcpip_parser.h"
+#include "focuser_state.h"
 
-#define MAXCONNECTIONS 4
+#define MAXCONNECTIONS TCPIPCLIENTS  // client slots, set in controller_config.h
+#define TCPIDLETIME 600000          // ms without a command before a client that is not subscribed is closed
+#define TCPCMDBUDGET 4              // commands of a client processed per loop, the rest wait for the next loop
+#define TCPTXBUFSIZE 256 // replies of a client, sent once per loop
+#define TCPPUSHMIN 100   // fastest push interval of a subscribed client, ms
+#define TCPPUSHMAX 60000 // slowest push interval, ms
+
+
+// ----------------------------------------------------------------------
+// REPLY BUFFER OF A CLIENT
+// The replies to all commands received in one loop are written with one
+// write(), so a poll of several commands is answered in one TCP segment
+// ----------------------------------------------------------------------
+struct Tcp_Tx {
+  char buf[TCPTXBUFSIZE];
+  uint16_t len;
+  uint8_t payload[TCPPAYLOADLEN];  // replies to the current binary frame
+  uint8_t paylen;
+  bool replied;                    // the handler has sent the response frame
+};
+
+
+// ----------------------------------------------------------------------
+// PUSH SUBSCRIPTION OF A CLIENT, :C1nnn#
+// A subscribed client is sent P, I and Z when they change, no more often
+// than every interval ms, and m when a move completes
+// ----------------------------------------------------------------------
+struct Tcp_Sub {
+  uint16_t interval;       // ms, 0 is not subscribed
+  unsigned long lastpush;  // millis() of the last push
+  bool all;                // send every value on the next push
+  Focuser_Status sent;     // values the client was last sent
+};
+
+
+// ----------------------------------------------------------------------
+// DISPATCH TABLE ENTRY, ONE PER TCP_COMMANDS IN tcpip_commands.h
+// ----------------------------------------------------------------------
+class TCPIP_SERVER;
+typedef void (TCPIP_SERVER::*Tcp_Handler)(int, const Tcp_Args &);
+
+struct Tcp_Command {
+  const char *opcode;   // NN
+  byte cmdclass;        // Tcp_Cmd_Class
+  byte argtype;         // Tcp_Arg_Types
+  Tcp_Handler handler;
+};
 
 
 // ----------------------------------------------------------------------
@@ -44,12 +95,38 @@ public:
   void cachepresets(void);
 
 private:
-   void process_command(int);
+  void read_client(int);
+  void flush_client(int);
+  void send_bytes(const uint8_t *, size_t, int);
+  bool process_frame(int);
+  void add_payload(int, const char, byte, const void *, size_t);
+  void send_frame(int, uint8_t, uint8_t);
+  void send_frame_error(int, uint8_t, byte);
+  void push_status(int);
+  int open_slot(void);
+  void close_client(int);
+  bool process_command(int);  // false if the command cannot change the focuser state
+
+  static const Tcp_Command *find_command(int);
+  static const Tcp_Command _commands[Tcp_Command_Count];
+
+  // command handlers, cmd_name(clientnum, args)
+#define X(op, name, cmdclass, argtype) void cmd_##name(int, const Tcp_Args &);
+  TCP_COMMANDS(X)
+#undef X
 
   WiFiServer *_myserver;
-  WiFiClient *_myclients[MAXCONNECTIONS] = { NULL };  // 4 connections allowed
+  WiFiClient _myclients[MAXCONNECTIONS];              // preallocated client of each connection slot
   IPAddress _myclientsIPAddressList[MAXCONNECTIONS];  // IP Address for each connection
-  bool _myclientsfreeslot[MAXCONNECTIONS];            // indicator for free connection slot
+  bool _myclientsfreeslot[MAXCONNECTIONS];            // true when the connection slot is in use
+  unsigned long _lastactive[MAXCONNECTIONS];          // millis() of the last command of each connection
+  int8_t _freeslots[MAXCONNECTIONS];                  // stack of free connection slots
+  unsigned long _deferred[MAXCONNECTIONS];            // loops a connection had commands left over after its budget
+  int _nextclient = 0;                                // connection served first, rotates each loop
+  int _freecount = 0;
+  Tcp_Rx _rx[MAXCONNECTIONS];                         // receive buffer and parser of each connection
+  Tcp_Tx _tx[MAXCONNECTIONS];                         // reply buffer of each connection
+  Tcp_Sub _sub[MAXCONNECTIONS];                       // push subscription of each connection
   int _totalclients = 0;
   bool _clientstatus = false;
   bool _loaded = false;
@@ -0,0 +1,298 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// alloc_test.cpp
+// Heap allocations of the hot paths, counted by replacing operator new as
+// tcp_bench does. The text getters of CONTROLLER_DATA, the page option and
+// web page colour reads, and the TCP :NN# dispatch of TCPIP_SERVER on a
+// loopback socket must not allocate
+// ----------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <new>
+#include <signal.h>
+#include <arpa/inet.h>
+#include "controller_config.h"
+#include "controller_data.h"
+#include "driver_board.h"
+#include "temp_probe.h"
+#include "focuser_state.h"
+#include "ascom_server.h"
+#include "management_server.h"
+#include "web_server.h"
+#include "tcpip_server.h"
+#include "defines/app_defines.h"
+#include "defines/duckdns_defines.h"
+
+static unsigned long allocs = 0;
+
+void *operator new(size_t n) {
+  allocs++;
+  void *p = malloc(n ? n : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+static int checks = 0;
+static int failed = 0;
+
+#define CHECK(c) \
+  do { \
+    checks++; \
+    if (!(c)) { \
+      failed++; \
+      printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); \
+    } \
+  } while (0)
+
+#define LOOPS 10000
+
+// a poll of an application, with the text replies, the page option read
+// and set, and a preset
+static const char workload[] = ":00#:01#:03#:04#:08#:13#:29#:34#:59#:93#:9201010101#:93#:9112#";
+#define WORKLOADCMDS 13
+#define WORKLOADREPLIES 12  // :92 does not reply
+#define ROUNDS 200
+
+
+// ----------------------------------------------------------------------
+// The globals of the main sketch, which is not built here
+// ----------------------------------------------------------------------
+CONTROLLER_DATA *ControllerData;
+DRIVER_BOARD *driverboard;
+FOCUSER_STATE *focuserstate;
+TEMP_PROBE *tempprobe;
+ASCOM_SERVER *ascomsrvr;
+MANAGEMENT_SERVER *mngsrvr;
+WEB_SERVER *websrvr;
+static TCPIP_SERVER *tcpipsrvr;
+
+byte ascomsrvr_status = V_STOPPED;
+byte mngsrvr_status = V_STOPPED;
+byte websrvr_status = V_STOPPED;
+byte display_status = V_STOPPED;
+volatile unsigned int display_maxcount;
+volatile unsigned int park_maxcount;
+volatile int save_var_flag;
+volatile int save_board_flag;
+volatile int save_cntlr_flag;
+volatile bool halt_alert;
+enum Display_Types displaytype;
+bool isMoving;
+bool filesystemloaded;
+long ftargetPosition;
+int myboardnumber = DRVBRD;
+int myfixedstepmode = FIXEDSTEPMODE;
+int mystepsperrev = STEPSPERREVOLUTION;
+char ipStr[16] = "127.0.0.1";
+char mySSID[64] = "host";
+char devicename[32] = "myFP2ESP32";
+portMUX_TYPE varMux = portMUX_INITIALIZER_UNLOCKED;
+portMUX_TYPE boardMux = portMUX_INITIALIZER_UNLOCKED;
+portMUX_TYPE cntlrMux = portMUX_INITIALIZER_UNLOCKED;
+portMUX_TYPE displaytimeMux = portMUX_INITIALIZER_UNLOCKED;
+portMUX_TYPE halt_alertMux = portMUX_INITIALIZER_UNLOCKED;
+portMUX_TYPE parkMux = portMUX_INITIALIZER_UNLOCKED;
+
+void debug_server_print(const char *) {}
+void debug_server_println(const char *) {}
+void debug_server_println(const int) {}
+bool display_on(void) {
+  return true;
+}
+bool display_off(void) {
+  return true;
+}
+long getrssi(void) {
+  return -50;
+}
+void publish_focuser_state(void) {}
+void reboot_esp32(int) {}
+
+// the servers and the hardware, none is loaded
+bool ASCOM_SERVER::start(void) {
+  return false;
+}
+void ASCOM_SERVER::stop(void) {}
+bool MANAGEMENT_SERVER::start(unsigned long) {
+  return false;
+}
+void MANAGEMENT_SERVER::stop(void) {}
+bool WEB_SERVER::start(unsigned long) {
+  return false;
+}
+void WEB_SERVER::stop(void) {}
+
+void DRIVER_BOARD::enablemotor(void) {}
+void DRIVER_BOARD::releasemotor(void) {}
+bool DRIVER_BOARD::get_joystick1_loaded(void) {
+  return false;
+}
+bool DRIVER_BOARD::get_joystick2_loaded(void) {
+  return false;
+}
+bool DRIVER_BOARD::get_pushbuttons_loaded(void) {
+  return false;
+}
+bool DRIVER_BOARD::getdirection(void) {
+  return false;
+}
+long DRIVER_BOARD::getposition(void) {
+  return 5000;
+}
+bool DRIVER_BOARD::hpsw_alert(void) {
+  return false;
+}
+bool DRIVER_BOARD::init_hpsw(void) {
+  return false;
+}
+bool DRIVER_BOARD::set_joystick1(bool) {
+  return false;
+}
+bool DRIVER_BOARD::set_joystick2(bool) {
+  return false;
+}
+bool DRIVER_BOARD::set_pushbuttons(bool) {
+  return false;
+}
+void DRIVER_BOARD::setposition(long) {}
+void DRIVER_BOARD::setstallguardvalue(byte) {}
+void DRIVER_BOARD::setstepmode(int) {}
+
+bool TEMP_PROBE::get_found(void) {
+  return false;
+}
+bool TEMP_PROBE::get_state(void) {
+  return false;
+}
+void TEMP_PROBE::set_resolution(byte) {}
+
+
+// ----------------------------------------------------------------------
+// Text getters, as the display and the web pages read them
+// ----------------------------------------------------------------------
+static void test_getters(void) {
+  size_t len = 0;
+  unsigned long before = allocs;
+  for (int i = 0; i < LOOPS; i++) {
+#define X(section, member, accessor, key, def, size, setter) len += strlen(ControllerData->get_##accessor());
+    CNTLR_TEXT_SETTINGS(X)
+#undef X
+    len += strlen(ControllerData->get_brdname());
+  }
+  CHECK(len > 0);
+  printf("text getters      %lu allocations per call\n", (allocs - before) / LOOPS);
+  CHECK(allocs == before);
+
+  // each page of the display, as the display tests its page
+  int pages = 0;
+  before = allocs;
+  for (int i = 0; i < LOOPS; i++) {
+    const char *mypage = ControllerData->get_display_pageoption();
+    for (int p = 0; (p < 8) && (mypage[p] != 0); p++) {
+      pages += (mypage[p] == '1') ? 1 : 0;
+    }
+  }
+  CHECK(pages > 0);
+  printf("page option       %lu allocations per call\n", (allocs - before) / LOOPS);
+  CHECK(allocs == before);
+
+  // the colours of the web pages
+  before = allocs;
+  for (int i = 0; i < LOOPS; i++) {
+    len += strlen(ControllerData->get_wp_titlecolor());
+    len += strlen(ControllerData->get_wp_subtitlecolor());
+    len += strlen(ControllerData->get_wp_headercolor());
+    len += strlen(ControllerData->get_wp_textcolor());
+    len += strlen(ControllerData->get_wp_backcolor());
+  }
+  printf("page colours      %lu allocations per call\n", (allocs - before) / LOOPS);
+  CHECK(allocs == before);
+}
+
+
+// ----------------------------------------------------------------------
+// TCP dispatch, a client on a loopback socket sends the workload and the
+// server loop runs until every reply is back
+// ----------------------------------------------------------------------
+static bool round_trip(int fd) {
+  char buf[1024];
+  int replies = 0;
+  if (send(fd, workload, strlen(workload), 0) != (ssize_t)strlen(workload)) {
+    return false;
+  }
+  for (int wait = 0; (wait < 20000) && (replies < WORKLOADREPLIES); wait++) {
+    tcpipsrvr->loop(false);
+    int r = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    for (int i = 0; i < r; i++) {
+      replies += (buf[i] == '#') ? 1 : 0;
+    }
+    if (r <= 0) {
+      usleep(50);
+    }
+  }
+  return replies == WORKLOADREPLIES;
+}
+
+static void test_dispatch(void) {
+  // a free port of the loopback interface
+  struct sockaddr_in addr = {};
+  socklen_t addrlen = sizeof(addr);
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  int probe = socket(AF_INET, SOCK_STREAM, 0);
+  bind(probe, (struct sockaddr *)&addr, sizeof(addr));
+  getsockname(probe, (struct sockaddr *)&addr, &addrlen);
+  close(probe);
+
+  ControllerData->set_tcpipsrvr_enable(V_ENABLED);
+  tcpipsrvr = new TCPIP_SERVER();
+  CHECK(tcpipsrvr->start(ntohs(addr.sin_port)));
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  CHECK(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+
+  // the client slot and the buffers are set up on the first round
+  CHECK(round_trip(fd));
+  unsigned long before = allocs;
+  bool ok = true;
+  for (int i = 0; i < ROUNDS; i++) {
+    ok = ok && round_trip(fd);
+  }
+  CHECK(ok);
+  printf("tcp :NN# dispatch %lu allocations in %d commands\n", allocs - before, ROUNDS * WORKLOADCMDS);
+  CHECK(allocs == before);
+
+  close(fd);
+  tcpipsrvr->stop();
+}
+
+int main(void) {
+  signal(SIGPIPE, SIG_IGN);
+  char root[] = "/tmp/alloc_testXXXXXX";
+  if (mkdtemp(root) == nullptr) {
+    return 2;
+  }
+  SPIFFS.begin(root);
+  ControllerData = new CONTROLLER_DATA();
+  focuserstate = new FOCUSER_STATE();
+  focuserstate->publish(5000, 5000, false, 20.0);
+
+  test_getters();
+  test_dispatch();
+
+  char cmd[64];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s", root);
+  system(cmd);
+  printf("alloc_test %d checks, %d failed\n", checks, failed);
+  return (failed == 0) ? 0 : 1;
+}
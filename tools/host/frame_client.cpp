@@ -0,0 +1,196 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// frame_client.cpp
+// Reference client of the binary frames of the tcp/ip port
+// ----------------------------------------------------------------------
+
+#include <string.h>
+#include "frame_client.h"
+
+
+// ----------------------------------------------------------------------
+// OPCODE OF NN, AS tcp_opcode() IN tcpip_commands.h
+// ----------------------------------------------------------------------
+int fc_opcode(const char *op) {
+  if ((op[1] < '0') || (op[1] > '9')) {
+    return -1;
+  }
+  if ((op[0] >= '0') && (op[0] <= '9')) {
+    return ((op[0] - '0') * 10) + (op[1] - '0');
+  }
+  if ((op[0] >= 'A') && (op[0] <= 'C')) {
+    return 100 + ((op[0] - 'A') * 10) + (op[1] - '0');
+  }
+  return -1;
+}
+
+// ----------------------------------------------------------------------
+// CRC16-CCITT
+// ----------------------------------------------------------------------
+static uint16_t crc_byte(uint16_t crc, uint8_t data) {
+  crc ^= (uint16_t)data << 8;
+  for (int i = 0; i < 8; i++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+  }
+  return crc;
+}
+
+uint16_t fc_crc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc = crc_byte(crc, data[i]);
+  }
+  return crc;
+}
+
+
+// ----------------------------------------------------------------------
+// ENCODER
+// ----------------------------------------------------------------------
+size_t fc_encode(uint8_t *frame, uint8_t opcode, uint8_t seq, const void *payload, uint8_t len) {
+  size_t n = 0;
+  frame[n++] = FCSOF;
+  frame[n++] = opcode;
+  frame[n++] = seq;
+  frame[n++] = len;
+  if (len > 0) {
+    memcpy(&frame[n], payload, len);
+    n += len;
+  }
+  // the crc does not cover the SOF
+  uint16_t crc = fc_crc16(&frame[1], n - 1);
+  frame[n++] = crc & 0xff;
+  frame[n++] = crc >> 8;
+  return n;
+}
+
+size_t fc_encode_none(uint8_t *frame, uint8_t opcode, uint8_t seq) {
+  return fc_encode(frame, opcode, seq, nullptr, 0);
+}
+
+size_t fc_encode_digit(uint8_t *frame, uint8_t opcode, uint8_t seq, uint8_t digit) {
+  return fc_encode(frame, opcode, seq, &digit, 1);
+}
+
+size_t fc_encode_long(uint8_t *frame, uint8_t opcode, uint8_t seq, int32_t value) {
+  uint32_t u = (uint32_t)value;
+  uint8_t le[4] = { (uint8_t)u, (uint8_t)(u >> 8), (uint8_t)(u >> 16), (uint8_t)(u >> 24) };
+  return fc_encode(frame, opcode, seq, le, sizeof(le));
+}
+
+size_t fc_encode_text(uint8_t *frame, uint8_t opcode, uint8_t seq, const char *text) {
+  size_t len = strlen(text);
+  len = (len > FCMAXPAYLOAD) ? FCMAXPAYLOAD : len;
+  return fc_encode(frame, opcode, seq, text, (uint8_t)len);
+}
+
+
+// ----------------------------------------------------------------------
+// DECODER
+// ----------------------------------------------------------------------
+FC_DECODER::FC_DECODER() {
+  reset();
+}
+
+void FC_DECODER::reset(void) {
+  _state = Fc_Sof;
+  _pos = 0;
+  _crc = 0xFFFF;
+  _rxcrc = 0;
+}
+
+const Fc_Frame &FC_DECODER::frame(void) const {
+  return _frame;
+}
+
+bool FC_DECODER::put(uint8_t c) {
+  switch (_state) {
+    case Fc_Sof:
+      if (c == FCSOF) {
+        _crc = 0xFFFF;
+        _state = Fc_Opcode;
+      }
+      return false;
+
+    case Fc_Opcode:
+      _crc = crc_byte(_crc, c);
+      _frame.opcode = c;
+      _state = Fc_Seq;
+      return false;
+
+    case Fc_Seq:
+      _crc = crc_byte(_crc, c);
+      _frame.seq = c;
+      _state = Fc_Len;
+      return false;
+
+    case Fc_Len:
+      _crc = crc_byte(_crc, c);
+      _frame.len = c;
+      _pos = 0;
+      _state = (c == 0) ? Fc_CrcLo : Fc_Payload;
+      return false;
+
+    case Fc_Payload:
+      _crc = crc_byte(_crc, c);
+      _frame.payload[_pos++] = c;
+      if (_pos == _frame.len) {
+        _state = Fc_CrcLo;
+      }
+      return false;
+
+    case Fc_CrcLo:
+      _rxcrc = c;
+      _state = Fc_CrcHi;
+      return false;
+
+    default:
+      _rxcrc |= (uint16_t)c << 8;
+      _frame.crcok = (_rxcrc == _crc);
+      _state = Fc_Sof;
+      return true;
+  }
+}
+
+static int32_t get_le32(const uint8_t *p) {
+  return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+bool fc_next_reply(const Fc_Frame &frame, size_t &pos, Fc_Reply &reply) {
+  if ((pos + 2) > frame.len) {
+    return false;
+  }
+  reply.token = (char)frame.payload[pos];
+  reply.type = frame.payload[pos + 1];
+  pos += 2;
+  switch (reply.type) {
+    case Fc_Long:
+    case Fc_Float:
+      {
+        if ((pos + 4) > frame.len) {
+          return false;
+        }
+        int32_t v = get_le32(&frame.payload[pos]);
+        reply.value = v;
+        memcpy(&reply.fvalue, &v, sizeof(reply.fvalue));
+        pos += 4;
+      }
+      return true;
+    case Fc_Text:
+      {
+        if ((pos + 1) > frame.len) {
+          return false;
+        }
+        size_t len = frame.payload[pos++];
+        if ((pos + len) > frame.len) {
+          return false;
+        }
+        memcpy(reply.text, &frame.payload[pos], len);
+        reply.text[len] = 0;
+        pos += len;
+      }
+      return true;
+    default:
+      return false;
+  }
+}
@@ -0,0 +1,96 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// frame_client.h
+// Reference client of the binary frames of the tcp/ip port, see BINARY
+// FRAMES in tcpip_parser.h. Plain C++, it does not use the firmware
+// sources, so an application can copy frame_client.h and .cpp
+//
+// frame     SOF opcode seq len payload crclo crchi
+// crc       CRC16-CCITT, 0x1021 start 0xFFFF, of opcode to payload
+// request   Arg_None none, Arg_Digit 1 byte, Arg_Long int32 LE, Arg_Text
+// response  per reply: token type value, value is int32 LE, float32 LE,
+//           or len + text. Pushes of :C1 have seq 0
+// ----------------------------------------------------------------------
+
+#if !defined(_frame_client_h)
+#define _frame_client_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FCSOF 0xB5
+#define FCERROR 0xFF                // opcode of an error response
+#define FCMAXPAYLOAD 255
+#define FCMAXFRAME (FCMAXPAYLOAD + 6)
+
+enum Fc_Types { Fc_Long,
+                Fc_Float,
+                Fc_Text };
+
+
+// ----------------------------------------------------------------------
+// A received frame, and one reply of its payload
+// ----------------------------------------------------------------------
+struct Fc_Frame {
+  uint8_t opcode;
+  uint8_t seq;
+  uint8_t len;
+  uint8_t payload[FCMAXPAYLOAD];
+  bool crcok;
+};
+
+struct Fc_Reply {
+  char token;
+  uint8_t type;                  // Fc_Types
+  int32_t value;                 // Fc_Long
+  float fvalue;                  // Fc_Float
+  char text[FCMAXPAYLOAD + 1];   // Fc_Text, terminated
+};
+
+
+// ----------------------------------------------------------------------
+// ENCODER
+// Each returns the frame size, frame must hold FCMAXFRAME bytes
+// ----------------------------------------------------------------------
+int fc_opcode(const char *);  // "05" is 5, "A0" is 100, else -1
+uint16_t fc_crc16(const uint8_t *, size_t);
+size_t fc_encode(uint8_t *, uint8_t, uint8_t, const void *, uint8_t);
+size_t fc_encode_none(uint8_t *, uint8_t, uint8_t);
+size_t fc_encode_digit(uint8_t *, uint8_t, uint8_t, uint8_t);
+size_t fc_encode_long(uint8_t *, uint8_t, uint8_t, int32_t);
+size_t fc_encode_text(uint8_t *, uint8_t, uint8_t, const char *);
+
+
+// ----------------------------------------------------------------------
+// DECODER
+// Fed the bytes received in any pieces, put() returns true when a frame
+// is complete in frame(). Bytes before a SOF are skipped
+// ----------------------------------------------------------------------
+class FC_DECODER {
+public:
+  FC_DECODER();
+  void reset(void);
+  bool put(uint8_t);
+  const Fc_Frame &frame(void) const;
+
+private:
+  enum Fc_States { Fc_Sof,
+                   Fc_Opcode,
+                   Fc_Seq,
+                   Fc_Len,
+                   Fc_Payload,
+                   Fc_CrcLo,
+                   Fc_CrcHi };
+  Fc_Frame _frame;
+  uint8_t _state;
+  uint8_t _pos;
+  uint16_t _crc;
+  uint16_t _rxcrc;
+};
+
+// next reply of a response payload, pos starts at 0, false at the end
+// or if the payload is malformed
+bool fc_next_reply(const Fc_Frame &, size_t &, Fc_Reply &);
+
+
+#endif  // #if !defined(_frame_client_h)
@@ -0,0 +1,234 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// frame_test.cpp
+// Round trip of binary frames between the reference client, frame_client,
+// and the firmware, tcpip_parser. Requests encoded by the client must be
+// parsed by tcp_next_command(), responses built by tcp_add_payload() and
+// tcp_build_frame(), as TCPIP_SERVER::send_frame() does, must be decoded
+// by the client. Then times the round trip
+// ----------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <chrono>
+#include "tcpip_commands.h"
+#include "tcpip_parser.h"
+#include "frame_client.h"
+
+static int checks = 0;
+static int failed = 0;
+
+#define CHECK(c) \
+  do { \
+    checks++; \
+    if (!(c)) { \
+      failed++; \
+      printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c); \
+    } \
+  } while (0)
+
+
+// ----------------------------------------------------------------------
+// Client to firmware, the request is fed in pieces of step bytes as the
+// socket may deliver it
+// ----------------------------------------------------------------------
+static bool to_firmware(Tcp_Rx &rx, const uint8_t *frame, size_t n, size_t step) {
+  size_t done = 0;
+  bool found = false;
+  while (done < n) {
+    size_t piece = ((n - done) > step) ? step : (n - done);
+    int put = tcp_rx_put(rx, (const char *)&frame[done], piece);
+    done += put;
+    if (tcp_next_command(rx)) {
+      found = true;
+    }
+  }
+  return found && (rx.tail == rx.head);
+}
+
+static void test_requests(void) {
+  uint8_t frame[FCMAXFRAME];
+  Tcp_Rx rx;
+
+  for (size_t step = 1; step <= 8; step++) {
+    tcp_rx_reset(rx);
+
+    // Arg_None, the first byte selects binary frames
+    size_t n = fc_encode_none(frame, fc_opcode("00"), 1);
+    CHECK(to_firmware(rx, frame, n, step));
+    CHECK(rx.mode == Mode_Binary);
+    CHECK(rx.opcode == tcp_opcode("00"));
+    CHECK(rx.seq == 1);
+    CHECK(rx.plen == 0);
+    CHECK(rx.bad == false);
+
+    // Arg_Digit
+    n = fc_encode_digit(frame, fc_opcode("12"), 2, 1);
+    CHECK(to_firmware(rx, frame, n, step));
+    CHECK(rx.opcode == tcp_opcode("12"));
+    CHECK((rx.plen == 1) && ((uint8_t)rx.param[0] == 1));
+    CHECK(rx.bad == false);
+
+    // Arg_Long, little endian
+    n = fc_encode_long(frame, fc_opcode("05"), 200, -123456);
+    CHECK(to_firmware(rx, frame, n, step));
+    int32_t val;
+    memcpy(&val, rx.param, sizeof(val));
+    CHECK((rx.plen == 4) && (val == -123456));
+    CHECK(rx.seq == 200);
+    CHECK(rx.bad == false);
+
+    // Arg_Text
+    n = fc_encode_text(frame, fc_opcode("19"), 3, "1.25");
+    CHECK(to_firmware(rx, frame, n, step));
+    CHECK((rx.plen == 4) && (strcmp(rx.param, "1.25") == 0));
+    CHECK(rx.bad == false);
+
+    // a wrong crc is reported, the next frame is still found
+    n = fc_encode_none(frame, fc_opcode("01"), 4);
+    frame[n - 1] ^= 0x55;
+    CHECK(to_firmware(rx, frame, n, step));
+    CHECK(rx.bad == true);
+    n = fc_encode_none(frame, fc_opcode("01"), 5);
+    CHECK(to_firmware(rx, frame, n, step));
+    CHECK((rx.bad == false) && (rx.seq == 5));
+
+    // a payload longer than the parameter buffer is marked bad
+    char longtext[TCPPARAMLEN + 8];
+    memset(longtext, 'x', sizeof(longtext) - 1);
+    longtext[sizeof(longtext) - 1] = 0;
+    n = fc_encode_text(frame, fc_opcode("19"), 6, longtext);
+    CHECK(to_firmware(rx, frame, n, step));
+    CHECK(rx.bad == true);
+  }
+
+  // every opcode of the command table
+#define X(op, name, cmdclass, argtype) CHECK(fc_opcode(#op) == tcp_opcode(#op));
+  TCP_COMMANDS(X)
+#undef X
+}
+
+
+// ----------------------------------------------------------------------
+// Firmware to client
+// ----------------------------------------------------------------------
+static size_t build_response(uint8_t *frame, uint8_t opcode, uint8_t seq) {
+  uint8_t payload[TCPPAYLOADLEN];
+  uint8_t paylen = 0;
+  int32_t pos = 12345;
+  float temp = -3.25f;
+  paylen = tcp_add_payload(payload, paylen, 'P', Bin_Long, &pos, sizeof(pos));
+  paylen = tcp_add_payload(payload, paylen, 'Z', Bin_Float, &temp, sizeof(temp));
+  paylen = tcp_add_payload(payload, paylen, 'F', Bin_Text, "306_07", 6);
+  return tcp_build_frame(frame, opcode, seq, payload, paylen);
+}
+
+static void test_responses(void) {
+  uint8_t frame[TCPPAYLOADLEN + TCPFRAMEOVERHEAD];
+  FC_DECODER dec;
+  Fc_Reply reply;
+  size_t pos;
+
+  // junk before the SOF is skipped
+  CHECK(dec.put(0x00) == false);
+  CHECK(dec.put('#') == false);
+
+  size_t n = build_response(frame, tcp_opcode("00"), 77);
+  int complete = 0;
+  for (size_t i = 0; i < n; i++) {
+    complete += dec.put(frame[i]);
+  }
+  CHECK(complete == 1);
+  const Fc_Frame &f = dec.frame();
+  CHECK(f.crcok);
+  CHECK((f.opcode == tcp_opcode("00")) && (f.seq == 77));
+  pos = 0;
+  CHECK(fc_next_reply(f, pos, reply) && (reply.token == 'P') && (reply.type == Fc_Long) && (reply.value == 12345));
+  CHECK(fc_next_reply(f, pos, reply) && (reply.token == 'Z') && (reply.type == Fc_Float) && (reply.fvalue == -3.25f));
+  CHECK(fc_next_reply(f, pos, reply) && (reply.token == 'F') && (reply.type == Fc_Text) && (strcmp(reply.text, "306_07") == 0));
+  CHECK(fc_next_reply(f, pos, reply) == false);
+
+  // a push has seq 0
+  int32_t p = 500;
+  uint8_t payload[TCPPAYLOADLEN];
+  uint8_t paylen = tcp_add_payload(payload, 0, 'P', Bin_Long, &p, sizeof(p));
+  n = tcp_build_frame(frame, tcp_opcode("C1"), 0, payload, paylen);
+  complete = 0;
+  for (size_t i = 0; i < n; i++) {
+    complete += dec.put(frame[i]);
+  }
+  CHECK((complete == 1) && dec.frame().crcok);
+  CHECK((dec.frame().opcode == fc_opcode("C1")) && (dec.frame().seq == 0));
+
+  // an error response
+  uint8_t err = Frame_Busy;
+  n = tcp_build_frame(frame, TCPFRAMEERROR, 9, &err, 1);
+  for (size_t i = 0; i < n; i++) {
+    dec.put(frame[i]);
+  }
+  CHECK(dec.frame().crcok && (dec.frame().opcode == FCERROR) && (dec.frame().payload[0] == Frame_Busy));
+
+  // a damaged response fails the crc
+  n = build_response(frame, 1, 2);
+  frame[5] ^= 0x01;
+  for (size_t i = 0; i < n; i++) {
+    dec.put(frame[i]);
+  }
+  CHECK(dec.frame().crcok == false);
+
+  // text that does not fit is truncated to the payload
+  char longtext[TCPPAYLOADLEN + 10];
+  memset(longtext, 'y', sizeof(longtext));
+  paylen = tcp_add_payload(payload, 0, 'F', Bin_Text, longtext, sizeof(longtext));
+  CHECK(paylen == TCPPAYLOADLEN);
+  paylen = tcp_add_payload(payload, paylen, 'P', Bin_Long, &p, sizeof(p));
+  CHECK(paylen == TCPPAYLOADLEN);
+}
+
+
+// ----------------------------------------------------------------------
+// Round trips per second, client request to firmware response to client
+// ----------------------------------------------------------------------
+#define LOOPS 1000000
+
+static void bench(void) {
+  uint8_t req[FCMAXFRAME];
+  uint8_t resp[TCPPAYLOADLEN + TCPFRAMEOVERHEAD];
+  static Tcp_Rx rx;
+  FC_DECODER dec;
+  long sum = 0;
+
+  tcp_rx_reset(rx);
+  auto t0 = std::chrono::steady_clock::now();
+  for (int lp = 0; lp < LOOPS; lp++) {
+    size_t n = fc_encode_long(req, fc_opcode("05"), (uint8_t)lp, lp);
+    tcp_rx_put(rx, (const char *)req, n);
+    if (tcp_next_command(rx) && (rx.bad == false)) {
+      int32_t val;
+      memcpy(&val, rx.param, sizeof(val));
+      uint8_t payload[TCPPAYLOADLEN];
+      uint8_t paylen = tcp_add_payload(payload, 0, 'P', Bin_Long, &val, sizeof(val));
+      n = tcp_build_frame(resp, rx.opcode, rx.seq, payload, paylen);
+      for (size_t i = 0; i < n; i++) {
+        if (dec.put(resp[i])) {
+          size_t pos = 0;
+          Fc_Reply reply;
+          if (dec.frame().crcok && fc_next_reply(dec.frame(), pos, reply)) {
+            sum += reply.value;
+          }
+        }
+      }
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double secs = std::chrono::duration<double>(t1 - t0).count();
+  CHECK(sum == ((long)LOOPS * (LOOPS - 1)) / 2);
+  printf("round trip %12.0f frames/s  %6.1f ns/frame\n", LOOPS / secs, (secs * 1e9) / LOOPS);
+}
+
+int main() {
+  test_requests();
+  test_responses();
+  bench();
+  printf("frame_test %d checks, %d failed\n", checks, failed);
+  return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// http_load.cpp
+// HTTP_SERVER, the file cache and send_file() on POSIX sockets, the
+// server for the load test http_load.py, which starts it. Built with
+// AddressSanitizer, a reply sent after its data was freed is reported
+//
+//   http_load PORT DIR [shared]
+//
+// DIR holds the files, /page.html, /big.png and /cntlr_config.jsn, and
+// the uploads. shared is a second server on PORT + 1 with the same
+// engine. The server stops when DIR/stop exists
+// ----------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <signal.h>
+#include <algorithm>
+#include "controller_config.h"
+#include "http_server.h"
+#include "file_cache.h"
+#include "file_server.h"
+
+FILE_CACHE *filecache;
+
+static HTTP_SERVER *srv;
+static HTTP_SERVER *two;
+static WiFiClient events;
+static FILE *upfile;
+static String dir;
+
+// the debug server of the main sketch, not used here
+void debug_server_print(const char *) {}
+void debug_server_print(String) {}
+void debug_server_println(const char *) {}
+void debug_server_println(const int) {}
+void debug_server_println(String) {}
+
+
+// ----------------------------------------------------------------------
+// Handlers, as the firmware servers write their replies
+// ----------------------------------------------------------------------
+static void get_page(void) {
+  // in pieces through content(), as HTML_TEMPLATE renders
+  std::string page(8000, 'x');
+  page = "<html>" + page + "</html>";
+  srv->setContentLength(page.size());
+  srv->send(NORMALWEBPAGE, TEXTPAGETYPE, "");
+  for (size_t i = 0; i < page.size(); i += 512) {
+    srv->content().write((const uint8_t *)page.data() + i, std::min((size_t)512, page.size() - i));
+  }
+}
+
+static void get_status(void) {
+  // a stack buffer is copied, as STATUS_EVENTS send_status()
+  char buf[64];
+  int len = snprintf(buf, sizeof(buf), "{\"seq\":5,\"inm\":\"%s\"}", srv->header("If-None-Match").c_str());
+  srv->setContentLength(len);
+  srv->send(NORMALWEBPAGE, JSONPAGETYPE, "");
+  srv->sendContent(buf, len);
+}
+
+static void post_form(void) {
+  String reply;
+  for (int i = 0; i < srv->args(); i++) {
+    reply += srv->argName(i) + "=" + srv->arg(i) + ";";
+  }
+  srv->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, reply);
+}
+
+static void get_events(void) {
+  // written to client(), the server no longer owns the connection
+  WiFiClient &c = srv->client();
+  c.print("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\ndata: hello\n\n");
+  events = c;
+}
+
+static void post_upload(void) {
+  srv->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String("done ") + String((unsigned long)srv->upload().totalSize) + " note=" + srv->arg("note"));
+}
+
+static void upload_file(void) {
+  HTTPUpload &u = srv->upload();
+  switch (u.status) {
+    case UPLOAD_FILE_START:
+      upfile = fopen((dir + "/out_" + u.filename).c_str(), "wb");
+      break;
+    case UPLOAD_FILE_WRITE:
+      fwrite(u.buf, 1, u.currentSize, upfile);
+      break;
+    case UPLOAD_FILE_END:
+      fclose(upfile);
+      // as the Management Server after an upload
+      filecache->changed();
+      break;
+    case UPLOAD_FILE_ABORTED:
+      fclose(upfile);
+      fprintf(stderr, "upload aborted\n");
+      break;
+  }
+}
+
+static void get_list(void) {
+  // a listing, chunked
+  srv->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  srv->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, "");
+  char buf[HTTPSENDCHUNK];
+  size_t len = 0;
+  for (int i = 0; i < 3000; i++) {
+    len += snprintf(buf + len, sizeof(buf) - len, "file%05d.html\n", i);
+    if ((len + 32) > sizeof(buf)) {
+      srv->sendContent(buf, len);
+      len = 0;
+    }
+  }
+  srv->sendContent(buf, len);
+  srv->sendContent("");
+}
+
+static void not_found(void) {
+  if (send_file(srv, srv->uri()) == false) {
+    srv->send(NOTFOUNDWEBPAGE, PLAINTEXTPAGETYPE, "nf " + srv->uri());
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    fprintf(stderr, "http_load PORT DIR [shared]\n");
+    return 2;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  int port = atoi(argv[1]);
+  dir = argv[2];
+  SPIFFS.begin(argv[2]);
+  filecache = new FILE_CACHE();
+
+  HTTP_ENGINE *engine = (argc > 3) ? new HTTP_ENGINE() : NULL;
+  srv = new HTTP_SERVER(port, engine);
+  file_headers(srv);
+  srv->on("/", HTTP_GET, get_page);
+  srv->on("/status", HTTP_GET, get_status);
+  srv->on("/form", HTTP_POST, post_form);
+  srv->on("/config", HTTP_POST, []() {
+    srv->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String("plain:") + srv->arg("plain"));
+  });
+  srv->on("/get", []() {
+    srv->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, srv->argName(0) + "|" + srv->arg(0) + "|" + srv->arg("b"));
+  });
+  srv->on("/auth", HTTP_GET, []() {
+    if (srv->authenticate("admin", "pw") == false) {
+      srv->requestAuthentication();
+      return;
+    }
+    srv->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, "welcome");
+  });
+  srv->on("/events", HTTP_GET, get_events);
+  srv->on("/upload", HTTP_POST, post_upload, upload_file);
+  srv->on("/changed", HTTP_GET, []() {
+    filecache->changed();
+    srv->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, "changed");
+  });
+  srv->on("/list", HTTP_GET, get_list);
+  srv->onNotFound(not_found);
+  srv->begin();
+  if (engine != NULL) {
+    two = new HTTP_SERVER(port + 1, engine);
+    two->on("/two", HTTP_GET, []() {
+      two->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, "two " + two->arg("x"));
+    });
+    two->onNotFound([]() {
+      two->send(NOTFOUNDWEBPAGE, PLAINTEXTPAGETYPE, "nf-two");
+    });
+    two->begin();
+  }
+
+  // no handleClient() may wait on a client
+  String stop = dir + "/stop";
+  unsigned long maxloop = 0;
+  unsigned long lastevent = 0;
+  while (access(stop.c_str(), F_OK) != 0) {
+    unsigned long t0 = millis();
+    if (engine != NULL) {
+      engine->handleClient();
+    } else {
+      srv->handleClient();
+    }
+    maxloop = std::max(maxloop, millis() - t0);
+    if (events && ((millis() - lastevent) > 200)) {
+      events.print("data: tick\n\n");
+      lastevent = millis();
+    }
+    usleep(200);
+  }
+
+  srv->stop();
+  delete srv;
+  if (engine != NULL) {
+    two->stop();
+    delete two;
+    delete engine;
+  }
+  events.stop();
+  printf("max handleClient %lu ms\n", maxloop);
+  return 0;
+}
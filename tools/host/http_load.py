@@ -0,0 +1,218 @@
+# ----------------------------------------------------------------------
+# myFP2ESP32 HOST TOOLS
+# http_load.py
+# Load test of HTTP_SERVER, run by make load. Starts http_load, then
+# CLIENTS parallel clients send requests for SECONDS, each reply is
+# checked. A client that connects and sends nothing, one that does not
+# read the cached page and one that sends its request a byte at a time
+# run at the same time, no other client may wait on them. The cached page
+# is dropped from the file cache while it is sent. Then the listing, the
+# settings file that must not be sent, and two servers sharing an engine
+#
+#   python3 http_load.py ./http_load [CLIENTS [SECONDS]]
+# ----------------------------------------------------------------------
+
+import os
+import random
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+server = sys.argv[1]
+clients = int(sys.argv[2]) if len(sys.argv) > 2 else 16
+seconds = int(sys.argv[3]) if len(sys.argv) > 3 else 6
+
+root = tempfile.mkdtemp(prefix='http_load')
+page = bytes(random.getrandbits(8) for _ in range(8000))       # kept in the file cache
+big = bytes(random.getrandbits(8) for _ in range(300000))      # too big, sent from the file
+open(os.path.join(root, 'page.html'), 'wb').write(page)
+open(os.path.join(root, 'big.png'), 'wb').write(big)
+open(os.path.join(root, 'cntlr_config.jsn'), 'w').write('{"ota_pwd":"secret"}')   # never sent
+
+stats = {'ok': 0, 'bad': 0}
+times = []
+lock = threading.Lock()
+
+
+def free_port():
+    s = socket.socket()
+    s.bind(('127.0.0.1', 0))
+    port = s.getsockname()[1]
+    s.close()
+    return port
+
+
+def start(port, shared=False):
+    args = [server, str(port), root] + (['shared'] if shared else [])
+    proc = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    for _ in range(100):
+        try:
+            socket.create_connection(('127.0.0.1', port), timeout=1).close()
+            return proc
+        except OSError:
+            time.sleep(0.05)
+    sys.exit('server did not start')
+
+
+def stop(proc):
+    open(os.path.join(root, 'stop'), 'w').close()
+    out, err = proc.communicate(timeout=30)
+    os.remove(os.path.join(root, 'stop'))
+    out = out.decode(errors='replace')
+    err = err.decode(errors='replace')
+    sys.stdout.write(out)
+    if err:
+        sys.stdout.write(err)
+    return (proc.returncode == 0) and ('Sanitizer' not in err) and ('runtime error' not in err)
+
+
+def request(port, raw, timeout=10):
+    s = socket.create_connection(('127.0.0.1', port), timeout=timeout)
+    s.sendall(raw)
+    data = b''
+    while True:
+        c = s.recv(65536)
+        if not c:
+            break
+        data += c
+    s.close()
+    return data
+
+
+def body(reply):
+    return reply.split(b'\r\n\r\n', 1)[1]
+
+
+def unchunk(data):
+    out = b''
+    while True:
+        size, data = data.split(b'\r\n', 1)
+        n = int(size, 16)
+        if n == 0:
+            return out
+        out += data[:n]
+        data = data[n + 2:]
+
+
+def check(name, ok):
+    with lock:
+        stats['ok' if ok else 'bad'] += 1
+        if not ok:
+            print('bad', name)
+
+
+# ----------------------------------------------------------------------
+# Parallel clients
+# ----------------------------------------------------------------------
+def upload(port, i):
+    data = bytes(random.getrandbits(8) for _ in range(random.randint(1, 6000)))
+    b = b'----B%d' % i
+    mp = (b'--' + b + b'\r\nContent-Disposition: form-data; name="note"\r\n\r\nn%d\r\n--' % i + b +
+          b'\r\nContent-Disposition: form-data; name="file"; filename="t%d"\r\nContent-Type: application/octet-stream\r\n\r\n' % i +
+          data + b'\r\n--' + b + b'--\r\n')
+    r = body(request(port, b'POST /upload HTTP/1.1\r\nContent-Type: multipart/form-data; boundary=' + b +
+                     b'\r\nContent-Length: %d\r\n\r\n' % len(mp) + mp))
+    if r == b'Service Unavailable':
+        return True
+    return (r == b'done %d note=n%d' % (len(data), i)) and (open(os.path.join(root, 'out_t%d' % i), 'rb').read() == data)
+
+
+def worker(port, i):
+    end = time.time() + seconds
+    while time.time() < end:
+        kind = random.choice(['page', 'status', 'form', 'json', 'file', 'gone', 'big', 'upload'])
+        t0 = time.time()
+        try:
+            if kind == 'page':
+                ok = len(body(request(port, b'GET / HTTP/1.1\r\nHost: x\r\n\r\n'))) == 8013
+            elif kind == 'status':
+                ok = body(request(port, b'GET /status HTTP/1.1\r\nIf-None-Match: "7"\r\n\r\n')) == b'{"seq":5,"inm":""7""}'
+            elif kind == 'form':
+                ok = body(request(port, b'POST /form HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: 7\r\n\r\na=1&b=2')) == b'a=1;b=2;'
+            elif kind == 'json':
+                ok = body(request(port, b'POST /config HTTP/1.1\r\nContent-Type: application/json\r\nContent-Length: 7\r\n\r\n{"a":1}')) == b'plain:{"a":1}'
+            elif kind == 'file':
+                ok = body(request(port, b'GET /page.html HTTP/1.1\r\n\r\n')) == page
+            elif kind == 'gone':
+                ok = body(request(port, b'GET /changed HTTP/1.1\r\n\r\n')) == b'changed'
+            elif kind == 'big':
+                ok = body(request(port, b'GET /big.png HTTP/1.1\r\n\r\n')) == big
+            else:
+                ok = upload(port, i)
+        except Exception as e:
+            print('error', kind, e)
+            ok = False
+        check(kind, ok)
+        with lock:
+            times.append((time.time() - t0, kind))
+
+
+def idle(port):
+    s = socket.create_connection(('127.0.0.1', port))
+    s.settimeout(30)
+    t0 = time.time()
+    d = s.recv(1000)
+    print('idle client closed after %.1fs: %s' % (time.time() - t0, d.split(b'\r\n')[0].decode()))
+
+
+def noread(port):
+    # the cached page does not fit in the socket buffers, it stays held
+    s = socket.socket()
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1024)
+    s.connect(('127.0.0.1', port))
+    s.sendall(b'GET /page.html HTTP/1.1\r\n\r\n')
+    time.sleep(seconds + 2)
+    s.close()
+
+
+def trickle(port):
+    s = socket.create_connection(('127.0.0.1', port))
+    for ch in b'GET /status HTTP/1.1\r\nX: y\r\n\r\n':
+        s.send(bytes([ch]))
+        time.sleep(0.05)
+    check('trickle', body(s.recv(1000)).startswith(b'{"seq":5'))
+
+
+port = free_port()
+proc = start(port)
+threads = [threading.Thread(target=f, args=(port,)) for f in (idle, noread, trickle)]
+threads += [threading.Thread(target=worker, args=(port, i)) for i in range(clients)]
+for t in threads:
+    t.start()
+for t in threads:
+    t.join()
+times.sort()
+print('%d clients %d requests  p50 %.1f ms  p99 %.1f ms  max %.1f ms (%s)' %
+      (clients, len(times), times[len(times) // 2][0] * 1000, times[int(len(times) * .99)][0] * 1000,
+       times[-1][0] * 1000, times[-1][1]))
+if proc.poll() is not None:
+    sys.stdout.write(proc.stderr.read().decode(errors='replace'))
+    sys.exit('server failed')
+
+# chunked listing
+lines = unchunk(body(request(port, b'GET /list HTTP/1.1\r\n\r\n'))).split(b'\n')
+check('list', (len(lines) == 3001) and (lines[2999] == b'file02999.html'))
+check('get', body(request(port, b'GET /get?a=1&b=x%20y HTTP/1.1\r\n\r\n')) == b'a|1|x y')
+check('auth', b' 401 ' in request(port, b'GET /auth HTTP/1.1\r\n\r\n').split(b'\r\n')[0])
+check('auth', body(request(port, b'GET /auth HTTP/1.1\r\nAuthorization: Basic YWRtaW46cHc=\r\n\r\n')) == b'welcome')
+check('notfound', body(request(port, b'GET /nothing HTTP/1.1\r\n\r\n')) == b'nf /nothing')
+check('settings', body(request(port, b'GET /cntlr_config.jsn HTTP/1.1\r\n\r\n')) == b'nf /cntlr_config.jsn')
+check('cors', b'Access-Control-Allow-Origin' not in request(port, b'GET /page.html HTTP/1.1\r\n\r\n'))
+check('server', stop(proc))
+
+# two servers, one engine
+port = free_port()
+proc = start(port, True)
+check('shared', body(request(port + 1, b'GET /two?x=3 HTTP/1.1\r\n\r\n')) == b'two 3')
+check('shared', body(request(port + 1, b'GET /status HTTP/1.1\r\n\r\n')) == b'nf-two')
+check('shared', body(request(port, b'GET /page.html HTTP/1.1\r\n\r\n')) == page)
+check('server', stop(proc))
+
+for name in os.listdir(root):
+    os.remove(os.path.join(root, name))
+os.rmdir(root)
+print('http_load %d ok, %d bad' % (stats['ok'], stats['bad']))
+sys.exit(0 if stats['bad'] == 0 else 1)
@@ -0,0 +1,170 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// render_bench.cpp
+// Render time and peak heap of a page with %FIELD%s, before and after the
+// template engine. before reads the page into a String and calls
+// String::replace() for each field, as the page handlers did, after is
+// HTML_TEMPLATE through the file cache. Both must send the same page.
+// Pages of 1 to 8 KB with a field per 100 bytes, the admin pages are
+// 3.6-7 KB with about 60 fields each. The render buffer of HTML_TEMPLATE,
+// TPLCHUNKSIZE, is on the stack and not counted
+// ----------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <chrono>
+#include <new>
+#include <malloc.h>
+#include "file_cache.h"
+#include "html_template.h"
+
+FILE_CACHE *filecache;
+
+
+// ----------------------------------------------------------------------
+// heap in use, counted through operator new
+// ----------------------------------------------------------------------
+static size_t heapnow = 0;
+static size_t heappeak = 0;
+
+// the replacements are inlined into callers that gcc then warns about
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void *operator new(size_t n) {
+  void *p = malloc(n ? n : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  heapnow += malloc_usable_size(p);
+  heappeak = (heapnow > heappeak) ? heapnow : heappeak;
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  if (p != nullptr) {
+    heapnow -= malloc_usable_size(p);
+    free(p);
+  }
+}
+
+void operator delete(void *p, size_t) noexcept {
+  operator delete(p);
+}
+
+
+// ----------------------------------------------------------------------
+// The socket, collects what is sent to compare the pages
+// ----------------------------------------------------------------------
+class Page_Out : public Print {
+public:
+  std::string sent;
+  size_t write(uint8_t c) {
+    sent += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *b, size_t n) {
+    sent.append((const char *)b, n);
+    return n;
+  }
+};
+
+static char root[] = "/tmp/render_benchXXXXXX";
+static char fieldname[100][16];
+static char fieldvalue[100][16];
+
+// a page of html text with fields fields, written to /pageN.html
+static void make_page(const char *path, int fields) {
+  String page = "<!DOCTYPE html><html><head><title>myFP2ESP32</title></head><body>\n";
+  for (int i = 0; i < fields; i++) {
+    page += "<tr><td class=\"name\">Setting</td><td><input type=\"text\" value=\"";
+    page += fieldname[i];
+    page += "\"></td></tr>\n";
+  }
+  page += "</body></html>\n";
+  File f = SPIFFS.open(path, "w");
+  f.write((const uint8_t *)page.c_str(), page.length());
+  f.close();
+}
+
+static void render_before(const char *path, int fields, Print &out) {
+  // the page from the file cache too, so only the rendering differs
+  Cache_File cf;
+  filecache->find(path, cf);
+  String page;
+  page.reserve(cf.size);
+  page.concat((const char *)cf.data, cf.size);
+  for (int i = 0; i < fields; i++) {
+    page.replace(fieldname[i], fieldvalue[i]);
+  }
+  out.print(page);
+}
+
+static void render_after(HTML_TEMPLATE &tpl, int fields, Print &out) {
+  tpl.load();
+  for (int i = 0; i < fields; i++) {
+    tpl.replace(fieldname[i], fieldvalue[i]);
+  }
+  tpl.render(out);
+}
+
+#define LOOPS 2000
+
+int main() {
+  if (mkdtemp(root) == nullptr) {
+    perror("mkdtemp");
+    return 1;
+  }
+  SPIFFS.begin(root);
+  filecache = new FILE_CACHE();
+  for (int i = 0; i < 100; i++) {
+    snprintf(fieldname[i], sizeof(fieldname[i]), "%%FIELD%d%%", i);
+    snprintf(fieldvalue[i], sizeof(fieldvalue[i]), "%d", 10000 + i * 7);
+  }
+
+  static const char *paths[] = { "/page1.html", "/page2.html", "/page4.html", "/page8.html" };
+  static const int fields[] = { 10, 20, 40, 80 };
+  int failed = 0;
+
+  printf("%-7s %6s  %12s %12s  %12s %12s\n", "page", "fields", "before us", "after us", "before heap", "after heap");
+  for (int p = 0; p < 4; p++) {
+    make_page(paths[p], fields[p]);
+    HTML_TEMPLATE tpl(paths[p]);
+    Page_Out a, b;
+
+    // the first render scans the page and fills the file cache
+    render_after(tpl, fields[p], a);
+    render_before(paths[p], fields[p], b);
+    if (a.sent != b.sent) {
+      printf("FAIL %s pages differ\n", paths[p]);
+      failed++;
+    }
+
+    double us[2];
+    size_t peak[2];
+    for (int which = 0; which < 2; which++) {
+      Page_Out out;
+      out.sent.reserve(a.sent.size() + 1);
+      size_t base = heapnow;
+      heappeak = heapnow;
+      auto t0 = std::chrono::steady_clock::now();
+      for (int lp = 0; lp < LOOPS; lp++) {
+        out.sent.clear();
+        if (which == 0) {
+          render_before(paths[p], fields[p], out);
+        } else {
+          render_after(tpl, fields[p], out);
+        }
+      }
+      auto t1 = std::chrono::steady_clock::now();
+      us[which] = std::chrono::duration<double, std::micro>(t1 - t0).count() / LOOPS;
+      peak[which] = heappeak - base;
+    }
+    printf("%-7u %6d  %12.2f %12.2f  %12zu %12zu\n", (unsigned)a.sent.size(), fields[p], us[0], us[1], peak[0], peak[1]);
+  }
+
+  for (int p = 0; p < 4; p++) {
+    SPIFFS.remove(paths[p]);
+  }
+  rmdir(root);
+  return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// Arduino.h for the host, the parts of String, Print and Stream that the
+// firmware sources built by tools/host use
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cctype>
+#include <strings.h>
+#include <time.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+
+inline unsigned long millis() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000UL + t.tv_nsec / 1000000;
+}
+
+inline bool psramFound() {
+  return false;
+}
+
+inline void *ps_malloc(size_t n) {
+  return malloc(n);
+}
+
+#if !defined(__GLIBC__) || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+inline size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size > 0) {
+    size_t n = (len >= size) ? size - 1 : len;
+    memcpy(dst, src, n);
+    dst[n] = 0;
+  }
+  return len;
+}
+#endif
+
+inline char *itoa(int value, char *str, int base) {
+  snprintf(str, 34, (base == 16) ? "%x" : "%d", value);
+  return str;
+}
+
+// FreeRTOS critical sections, one task on the host
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) (void)(mux)
+#define portEXIT_CRITICAL(mux) (void)(mux)
+
+
+// ----------------------------------------------------------------------
+// String, on std::string so it allocates like the Arduino String
+// ----------------------------------------------------------------------
+class String {
+public:
+  std::string s;
+  String() {}
+  String(const char *c) : s(c ? c : "") {}
+  String(const String &o) : s(o.s) {}
+  explicit String(char c) : s(1, c) {}
+  explicit String(int v) : s(std::to_string(v)) {}
+  explicit String(long v) : s(std::to_string(v)) {}
+  explicit String(unsigned long v) : s(std::to_string(v)) {}
+  String &operator=(const String &o) { s = o.s; return *this; }
+  String &operator=(const char *c) { s = c ? c : ""; return *this; }
+  String &operator+=(const String &o) { s += o.s; return *this; }
+  String &operator+=(const char *o) { s += o; return *this; }
+  String &operator+=(char o) { s += o; return *this; }
+  friend String operator+(const String &a, const String &b) { String r(a); r.s += b.s; return r; }
+  friend String operator+(const String &a, const char *b) { String r(a); r.s += b; return r; }
+  friend String operator+(const String &a, char b) { String r(a); r.s += b; return r; }
+  friend String operator+(const char *a, const String &b) { String r(a); r.s += b.s; return r; }
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  char operator[](unsigned i) const { return (i < s.size()) ? s[i] : 0; }
+  unsigned length() const { return s.size(); }
+  const char *c_str() const { return s.c_str(); }
+  String substring(unsigned a, unsigned b) const {
+    if (a > s.size()) {
+      return String();
+    }
+    return String(s.substr(a, b - a).c_str());
+  }
+  String substring(unsigned a) const {
+    if (a > s.size()) {
+      return String();
+    }
+    return String(s.substr(a).c_str());
+  }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  void reserve(unsigned n) { s.reserve(n); }
+  bool endsWith(const String &o) const { return s.size() >= o.s.size() && s.compare(s.size() - o.s.size(), o.s.size(), o.s) == 0; }
+  bool startsWith(const String &o) const { return s.compare(0, o.s.size(), o.s) == 0; }
+  int indexOf(char c, unsigned f = 0) const { auto p = s.find(c, f); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const String &o, unsigned f = 0) const { auto p = s.find(o.s, f); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const char *o, unsigned f = 0) const { auto p = s.find(o, f); return p == std::string::npos ? -1 : (int)p; }
+  void replace(const String &a, const String &b) {
+    size_t p = 0;
+    while ((p = s.find(a.s, p)) != std::string::npos) {
+      s.replace(p, a.s.size(), b.s);
+      p += b.s.size();
+    }
+  }
+  void trim() {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    size_t b = s.find_last_not_of(" \t\r\n");
+    s = (a == std::string::npos) ? "" : s.substr(a, b - a + 1);
+  }
+  bool equals(const String &o) const { return s == o.s; }
+  bool equalsIgnoreCase(const String &o) const { return strcasecmp(s.c_str(), o.s.c_str()) == 0; }
+  bool concat(const char *c, unsigned n) { s.append(c, n); return true; }
+  void toCharArray(char *buf, unsigned size) const {
+    if (size > 0) {
+      size_t n = std::min((size_t)size - 1, s.size());
+      memcpy(buf, s.data(), n);
+      buf[n] = 0;
+    }
+  }
+};
+
+
+// ----------------------------------------------------------------------
+// Print and Stream
+// ----------------------------------------------------------------------
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t *b, size_t n) {
+    size_t r = 0;
+    while (n--) {
+      r += write(*b++);
+    }
+    return r;
+  }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(const char *c) { return write((const uint8_t *)c, strlen(c)); }
+  size_t print(const String &c) { return write((const uint8_t *)c.c_str(), c.length()); }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  // as the Arduino Stream, one read() and one String append per character
+  String readStringUntil(char terminator) {
+    String ret;
+    int c = read();
+    while ((c >= 0) && (c != terminator)) {
+      ret += (char)c;
+      c = read();
+    }
+    return ret;
+  }
+};
@@ -0,0 +1,108 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// ArduinoJson.h for the host, the types the firmware sources use so they
+// compile. Documents stay empty, nothing is parsed or written, a test
+// built with it starts from the default settings
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "Arduino.h"
+
+class JsonVariant {
+public:
+  template<typename T> JsonVariant &operator=(const T &) { return *this; }
+  JsonVariant operator[](int) const { return JsonVariant(); }
+  JsonVariant operator[](const char *) const { return JsonVariant(); }
+  template<typename T> T as() const { return T(); }
+  template<typename T> bool is() const { return false; }
+  template<typename T> operator T() const { return T(); }
+  bool isNull() const { return true; }
+  template<typename T> friend T operator|(const JsonVariant &, const T &d) { return d; }
+  friend const char *operator|(const JsonVariant &, const char *d) { return d; }
+};
+typedef JsonVariant JsonVariantConst;
+
+class JsonString {
+public:
+  const char *c_str() const { return ""; }
+  bool isNull() const { return true; }
+};
+
+class JsonPairConst {
+public:
+  JsonString key() const { return JsonString(); }
+  JsonVariantConst value() const { return JsonVariantConst(); }
+};
+
+class JsonObjectConst {
+public:
+  const JsonPairConst *begin() const { return nullptr; }
+  const JsonPairConst *end() const { return nullptr; }
+  JsonVariantConst operator[](const char *) const { return JsonVariantConst(); }
+  size_t size() const { return 0; }
+  bool isNull() const { return true; }
+};
+typedef JsonObjectConst JsonObject;
+
+class JsonArrayConst {
+public:
+  bool isNull() const { return true; }
+  size_t size() const { return 0; }
+  JsonVariantConst operator[](size_t) const { return JsonVariantConst(); }
+};
+
+class JsonDocument {
+public:
+  JsonVariant operator[](const char *) { return JsonVariant(); }
+  JsonVariant operator[](const String &) { return JsonVariant(); }
+  JsonVariant operator[](int) { return JsonVariant(); }
+  void clear() {}
+  size_t memoryUsage() const { return 0; }
+  template<typename T> T as() const { return T(); }
+  template<typename T> T to() { return T(); }
+  template<typename T> bool containsKey(T) const { return false; }
+  template<typename T> bool is() const { return false; }
+  bool overflowed() const { return false; }
+  bool isNull() const { return true; }
+};
+
+template<size_t N> class StaticJsonDocument : public JsonDocument {};
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+  DynamicJsonDocument(size_t) {}
+};
+
+class DeserializationError {
+public:
+  enum Code { Ok,
+              NoMemory,
+              InvalidInput };
+  DeserializationError(Code c = Ok) : _c(c) {}
+  explicit operator bool() const { return _c != Ok; }
+  bool operator==(Code c) const { return _c == c; }
+  const char *c_str() const { return ""; }
+
+private:
+  Code _c;
+};
+
+template<typename S> DeserializationError deserializeJson(JsonDocument &, const S &) {
+  return DeserializationError();
+}
+template<typename S> DeserializationError deserializeJson(JsonDocument &, S *) {
+  return DeserializationError();
+}
+template<typename S> size_t serializeJson(const JsonDocument &, S &) {
+  return 0;
+}
+inline size_t serializeJson(const JsonDocument &, char *, size_t) {
+  return 0;
+}
+inline size_t measureJson(const JsonDocument &) {
+  return 0;
+}
+inline const char *serialized(const String &s) {
+  return s.c_str();
+}
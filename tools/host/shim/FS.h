@@ -0,0 +1,68 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// FS.h for the host, a File on a stdio FILE
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "Arduino.h"
+#include <memory>
+#include <sys/stat.h>
+
+struct File_Impl {
+  FILE *f = nullptr;
+  std::string name;
+  ~File_Impl() {
+    if (f) {
+      fclose(f);
+    }
+  }
+};
+
+class File : public Stream {
+public:
+  std::shared_ptr<File_Impl> p;
+  File() {}
+  File(const char *path, const char *mode = "rb") {
+    FILE *f = fopen(path, mode);
+    if (f) {
+      p = std::make_shared<File_Impl>();
+      p->f = f;
+      p->name = path;
+    }
+  }
+  operator bool() const { return p && p->f; }
+  void close() {
+    if (p && p->f) {
+      fclose(p->f);
+      p->f = nullptr;
+    }
+    p = nullptr;
+  }
+  size_t size() {
+    long c = ftell(p->f);
+    fseek(p->f, 0, SEEK_END);
+    long s = ftell(p->f);
+    fseek(p->f, c, SEEK_SET);
+    return s;
+  }
+  time_t getLastWrite() {
+    struct stat st;
+    return (stat(p->name.c_str(), &st) == 0) ? st.st_mtime : 0;
+  }
+  bool seek(size_t pos) { return fseek(p->f, pos, SEEK_SET) == 0; }
+  int read() { return fgetc(p->f); }
+  int read(uint8_t *b, size_t n) { return fread(b, 1, n, p->f); }
+  int available() {
+    long c = ftell(p->f);
+    return size() - c;
+  }
+  size_t write(uint8_t c) { return fputc(c, p->f) == EOF ? 0 : 1; }
+  size_t write(const uint8_t *b, size_t n) { return fwrite(b, 1, n, p->f); }
+  const char *name() { return p->name.c_str(); }
+  bool isDirectory() {
+    struct stat st;
+    return p && (stat(p->name.c_str(), &st) == 0) && S_ISDIR(st.st_mode);
+  }
+  File openNextFile() { return File(); }  // directories are not listed
+};
@@ -0,0 +1,14 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// OneWire.h for the host, no bus
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "Arduino.h"
+
+class OneWire {
+public:
+  OneWire(int = 0) {}
+  void begin(int) {}
+};
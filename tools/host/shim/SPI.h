@@ -0,0 +1,8 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// SPI.h for the host, nothing of it is used
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "Arduino.h"
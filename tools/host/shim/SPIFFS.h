@@ -0,0 +1,28 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// SPIFFS.h for the host, the files of a directory given to begin()
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "FS.h"
+#include <unistd.h>
+
+class SPIFFS_FS {
+public:
+  bool begin(const char *root) {
+    _root = root;
+    return true;
+  }
+  bool begin() { return true; }  // the firmware begin(), the root stays
+  bool format() { return true; }
+  bool exists(const String &path) { return access((_root + path).c_str(), F_OK) == 0; }
+  File open(const String &path, const char *mode = "r") { return File((_root + path).c_str(), (mode[0] == 'w') ? "wb" : "rb"); }
+  bool remove(const String &path) { return unlink((_root + path).c_str()) == 0; }
+  bool rename(const String &from, const String &to) { return ::rename((_root + from).c_str(), (_root + to).c_str()) == 0; }
+
+private:
+  String _root;
+};
+
+inline SPIFFS_FS SPIFFS;
@@ -0,0 +1,36 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// WebServer.h for the host, the types HTTP_SERVER takes from it
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "FS.h"
+
+#define HTTP_UPLOAD_BUFLEN 1436
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+enum HTTPMethod { HTTP_ANY,
+                  HTTP_GET,
+                  HTTP_HEAD,
+                  HTTP_POST,
+                  HTTP_PUT,
+                  HTTP_PATCH,
+                  HTTP_DELETE,
+                  HTTP_OPTIONS };
+
+enum HTTPUploadStatus { UPLOAD_FILE_START,
+                        UPLOAD_FILE_WRITE,
+                        UPLOAD_FILE_END,
+                        UPLOAD_FILE_ABORTED };
+
+struct HTTPUpload {
+  HTTPUploadStatus status;
+  String filename;
+  String name;
+  String type;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[HTTP_UPLOAD_BUFLEN];
+};
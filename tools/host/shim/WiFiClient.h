@@ -0,0 +1,90 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// WiFiClient.h for the host, a POSIX socket. Copies share the socket as
+// on the ESP32, it is closed with the last copy
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <memory>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+struct Wifi_Sock {
+  int fd = -1;
+  ~Wifi_Sock() {
+    ::close(fd);
+  }
+};
+
+class WiFiClient : public Stream {
+public:
+  std::shared_ptr<Wifi_Sock> h;
+  WiFiClient() {}
+  explicit WiFiClient(int fd) {
+    h = std::make_shared<Wifi_Sock>();
+    h->fd = fd;
+  }
+  int fd() const { return h ? h->fd : -1; }
+  IPAddress remoteIP() { return IPAddress(127, 0, 0, 1); }
+  void setNoDelay(bool) {}
+  operator bool() { return (bool)h; }
+  int available() {
+    int n = 0;
+    if (h) {
+      ioctl(h->fd, FIONREAD, &n);
+    }
+    return n;
+  }
+  int read() {
+    uint8_t c;
+    return (read(&c, 1) == 1) ? c : -1;
+  }
+  int read(uint8_t *b, size_t n) {
+    int r = h ? recv(h->fd, b, n, MSG_DONTWAIT) : -1;
+    return (r < 0) ? -1 : r;
+  }
+  uint8_t connected() {
+    if (!h) {
+      return 0;
+    }
+    char c;
+    int r = recv(h->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (r >= 0) {
+      return (r > 0) ? 1 : 0;
+    }
+    return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? 1 : 0;
+  }
+  // drops this copy only, as on the ESP32
+  void stop() {
+    h = nullptr;
+  }
+  size_t write(uint8_t c) { return write(&c, 1); }
+  // blocks until sent or a second without progress, as the ESP32 WiFiClient
+  size_t write(const uint8_t *b, size_t n) {
+    size_t done = 0;
+    while (h && (done < n)) {
+      int r = send(h->fd, b + done, n - done, MSG_DONTWAIT | MSG_NOSIGNAL);
+      if (r > 0) {
+        done += r;
+        continue;
+      }
+      if ((r < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+        pollfd p = { h->fd, POLLOUT, 0 };
+        if (poll(&p, 1, 1000) > 0) {
+          continue;
+        }
+      }
+      break;
+    }
+    return done;
+  }
+};
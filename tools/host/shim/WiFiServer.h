@@ -0,0 +1,56 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// WiFiServer.h for the host, a non blocking listen socket on loopback.
+// Clients get a send buffer as small as on the ESP32
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "WiFiClient.h"
+
+class WiFiServer {
+public:
+  WiFiServer(uint16_t port = 80, uint8_t clients = 4) : _port(port), _clients(clients) {}
+  void begin(uint16_t port) {
+    _port = port;
+    begin();
+  }
+  void begin() {
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_port = htons(_port);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(_fd, (sockaddr *)&a, sizeof(a)) < 0) {
+      perror("bind");
+      exit(1);
+    }
+    listen(_fd, _clients);
+    fcntl(_fd, F_SETFL, O_NONBLOCK);
+  }
+  void setNoDelay(bool) {}
+  void stop() {
+    ::close(_fd);
+    _fd = -1;
+  }
+  WiFiClient available() {
+    int c = accept(_fd, nullptr, nullptr);
+    if (c < 0) {
+      return WiFiClient();
+    }
+    fcntl(c, F_SETFL, O_NONBLOCK);
+    int one = 1;
+    setsockopt(c, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    // the send buffer of lwIP on the ESP32, TCP_SND_BUF
+    int sndbuf = 5744;
+    setsockopt(c, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    return WiFiClient(c);
+  }
+
+private:
+  uint16_t _port;
+  uint8_t _clients;
+  int _fd = -1;
+};
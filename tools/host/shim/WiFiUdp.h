@@ -0,0 +1,24 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// WiFiUdp.h for the host, no packets arrive
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "WiFiClient.h"
+
+class WiFiUDP : public Stream {
+public:
+  uint8_t begin(uint16_t) { return 1; }
+  void stop() {}
+  int parsePacket() { return 0; }
+  int read() { return -1; }
+  int read(char *, size_t) { return 0; }
+  int read(unsigned char *, size_t) { return 0; }
+  IPAddress remoteIP() { return IPAddress(); }
+  uint16_t remotePort() { return 0; }
+  int beginPacket(IPAddress, uint16_t) { return 1; }
+  int endPacket() { return 1; }
+  size_t write(uint8_t) { return 1; }
+  using Print::write;
+};
@@ -0,0 +1,17 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// lwip/sockets.h for the host, the lwIP calls on POSIX sockets
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include <sys/socket.h>
+#include <errno.h>
+
+inline int lwip_send(int s, const void *data, size_t len, int flags) {
+  return send(s, data, len, flags | MSG_NOSIGNAL);
+}
+
+inline int lwip_shutdown(int s, int how) {
+  return shutdown(s, how);
+}
@@ -0,0 +1,27 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// mbedtls/base64.h for the host, the encoder only
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+
+inline int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen, const unsigned char *src, size_t slen) {
+  static const char *t = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t n = ((slen + 2) / 3) * 4;
+  if (dlen < (n + 1)) {
+    return -1;
+  }
+  size_t o = 0;
+  for (size_t i = 0; i < slen; i += 3) {
+    unsigned v = (src[i] << 16) | (((i + 1) < slen) ? (src[i + 1] << 8) : 0) | (((i + 2) < slen) ? src[i + 2] : 0);
+    dst[o++] = t[(v >> 18) & 63];
+    dst[o++] = t[(v >> 12) & 63];
+    dst[o++] = ((i + 1) < slen) ? t[(v >> 6) & 63] : '=';
+    dst[o++] = ((i + 2) < slen) ? t[v & 63] : '=';
+  }
+  dst[o] = 0;
+  *olen = o;
+  return 0;
+}
@@ -0,0 +1,25 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// myDallasTemperature.h for the host, no probe is found
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "OneWire.h"
+
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature {
+public:
+  DallasTemperature(OneWire *) {}
+  void begin() {}
+  uint8_t getDeviceCount() { return 0; }
+  bool getAddress(uint8_t *, uint8_t) { return false; }
+  void setResolution(uint8_t *, uint8_t) {}
+  void setResolution(uint8_t) {}
+  void setWaitForConversion(bool) {}
+  void requestTemperatures() {}
+  float getTempC(uint8_t *) { return 0; }
+  float getTempCByIndex(uint8_t) { return 0; }
+  bool isConnected(uint8_t *) { return false; }
+};
@@ -0,0 +1,24 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// myHalfStepperESP32.h for the host, the stepper types of driver_board.h
+// ----------------------------------------------------------------------
+
+#pragma once
+
+#include "Arduino.h"
+
+enum class SteppingMode { FULL,
+                          HALF };
+
+class Stepper {
+public:
+  Stepper(int, int, int, int, int) {}
+  void setSpeed(long) {}
+  void step(int) {}
+};
+
+class HalfStepper : public Stepper {
+public:
+  HalfStepper(int a, int b, int c, int d, int e) : Stepper(a, b, c, d, e) {}
+  void SetSteppingMode(SteppingMode) {}
+};
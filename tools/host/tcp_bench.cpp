@@ -0,0 +1,142 @@
+// ----------------------------------------------------------------------
+// myFP2ESP32 HOST TOOLS
+// tcp_bench.cpp
+// Commands per second of the tcp/ip command parser, before and after the
+// receive ring buffer. before is the readStringUntil() parser that
+// TCPIP_SERVER::process_command() used, after is tcpip_parser.cpp.
+// Heap allocations are counted by replacing operator new. std::string,
+// like the ESP32 String, keeps short strings without the heap
+// ----------------------------------------------------------------------
+
+#include <Arduino.h>
+#include <chrono>
+#include <new>
+#include "tcpip_commands.h"
+#include "tcpip_parser.h"
+
+static unsigned long allocs = 0;
+
+void *operator new(size_t n) {
+  allocs++;
+  void *p = malloc(n ? n : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+// a typical poll of an application, position, moving, temperature,
+// a move and a preset
+static const char workload[] = ":00#:01#:06#:0512345#:08#:B1#:9012#:13#";
+#define WORKLOADCMDS 8
+#define LOOPS 200000
+
+
+// ----------------------------------------------------------------------
+// before, the bytes of the socket as a Stream
+// ----------------------------------------------------------------------
+class MemStream : public Stream {
+public:
+  MemStream(const char *d, size_t n) : _d(d), _n(n) {}
+  int available() { return _n - _pos; }
+  int read() { return (_pos < _n) ? (uint8_t)_d[_pos++] : -1; }
+  size_t write(uint8_t) { return 0; }
+private:
+  const char *_d;
+  size_t _n;
+  size_t _pos = 0;
+};
+
+static long before_command(Stream &client) {
+  String receiveString = "";
+  String WorkString = "";
+  int cmdvalue;
+
+  receiveString = client.readStringUntil('#');
+  receiveString = receiveString + '#' + "";
+
+  String cmdstr = receiveString.substring(1, 3);
+  if (cmdstr[0] == 'A') {
+    cmdvalue = 100 + (cmdstr[1] - '0');
+  } else if (cmdstr[0] == 'B') {
+    cmdvalue = 110 + (cmdstr[1] - '0');
+  } else if (cmdstr[0] == 'C') {
+    cmdvalue = 120 + (cmdstr[1] - '0');
+  } else {
+    cmdvalue = cmdstr.toInt();
+  }
+  // each command with a parameter took it from the String
+  WorkString = receiveString.substring(3, receiveString.length() - 1);
+  return cmdvalue + WorkString.toInt();
+}
+
+static long run_before(void) {
+  long sum = 0;
+  for (int lp = 0; lp < LOOPS; lp++) {
+    MemStream client(workload, sizeof(workload) - 1);
+    while (client.available()) {
+      sum += before_command(client);
+    }
+  }
+  return sum;
+}
+
+
+// ----------------------------------------------------------------------
+// after, the ring buffer is filled as TCPIP_SERVER::read_client() does,
+// a segment at a time, and the argument parsed as process_command() does
+// ----------------------------------------------------------------------
+static long run_after(void) {
+  static Tcp_Rx rx;
+  long sum = 0;
+  tcp_rx_reset(rx);
+  for (int lp = 0; lp < LOOPS; lp++) {
+    const char *p = workload;
+    int left = sizeof(workload) - 1;
+    while (left > 0) {
+      int n = tcp_rx_put(rx, p, left);
+      p += n;
+      left -= n;
+      while (tcp_next_command(rx)) {
+        sum += tcp_opcode(rx.cmd) + atol(rx.param);
+      }
+    }
+  }
+  return sum;
+}
+
+
+// ----------------------------------------------------------------------
+// Both parsers must find the same commands
+// ----------------------------------------------------------------------
+typedef long (*Bench_Func)(void);
+
+static long bench(const char *name, Bench_Func fn) {
+  unsigned long a = allocs;
+  auto t0 = std::chrono::steady_clock::now();
+  long sum = fn();
+  auto t1 = std::chrono::steady_clock::now();
+  double secs = std::chrono::duration<double>(t1 - t0).count();
+  double cmds = (double)LOOPS * WORKLOADCMDS;
+  printf("%-8s %12.0f commands/s  %6.1f ns/command  %5.2f allocations/command\n",
+         name, cmds / secs, (secs * 1e9) / cmds, (double)(allocs - a) / cmds);
+  return sum;
+}
+
+int main() {
+  long b = bench("before", run_before);
+  long a = bench("after", run_after);
+  if (a != b) {
+    printf("FAIL parsers differ, %ld %ld\n", b, a);
+    return 1;
+  }
+  return 0;
+}
@@ -18,7 +18,10 @@
 #include <WiFi.h>
 #include "SPIFFS.h"
 #include <SPI.h>
-#include <WebServer.h>
+#include "http_server.h"
+extern HTTP_ENGINE *httpengine;
+#include "html_template.h"
+#include "file_server.h"
 
 
 // -----------------------------------------------------------------------
@@ -39,18 +42,21 @@ extern DRIVER_BOARD *driverboard;
 #include "temp_probe.h"
 extern TEMP_PROBE *tempprobe;
 
+// focuser state snapshot
+#include "focuser_state.h"
+extern FOCUSER_STATE *focuserstate;
+
 
 // ----------------------------------------------------------------------
 // EXTERNS
 // ----------------------------------------------------------------------
 extern char ipStr[];
 extern char systemuptime[12];
+extern void publish_focuser_state(void);
 extern long ftargetPosition;
 extern bool isMoving;
 extern bool filesystemloaded;
 
-extern float temp;
-
 extern volatile bool halt_alert;
 extern portMUX_TYPE halt_alertMux;
 
@@ -73,11 +79,6 @@ extern char backcolor[8];
 #define T_MOVE "move.html"
 #define T_PRESETS "presets.html"
 
-#define INDEX_PG_SIZE 5800     // 5614
-#define MOVE_PG_SIZE 3800      // 3708
-#define PRESETS_PG_SIZE 5500   // 5388
-#define NOTFOUND_PG_SIZE 1100  // 906
-
 // index HTML page
 // position
 #define H_FPSTART "<form action=\"/\" method =\"post\">"
@@ -192,6 +193,14 @@ void wsget_position(void) {
   websrvr->get_position();
 }
 
+void wsget_events(void) {
+  websrvr->get_events();
+}
+
+void wsget_status(void) {
+  websrvr->get_status();
+}
+
 void wsget_ismoving(void) {
   websrvr->get_ismoving();
 }
@@ -248,7 +257,7 @@ bool WEB_SERVER::start(unsigned long port) {
   }
 
   // create the web server
-  _web_server = new WebServer(this->_port);
+  _web_server = new HTTP_SERVER(this->_port, httpengine);
 
   // Web pages
   _web_server->on("/", HTTP_GET, wsget_index);
@@ -266,11 +275,14 @@ bool WEB_SERVER::start(unsigned long port) {
   _web_server->on("/tm", wsget_temperature);
   _web_server->on("/pa", wsget_park);
   _web_server->on("/cp", wsget_coilpower);
+  _web_server->on("/events", HTTP_GET, wsget_events);
+  _web_server->on("/status", HTTP_GET, wsget_status);
 
   _web_server->onNotFound([]() {
     wsget_notfound();
   });
 
+  file_headers(_web_server);
   _web_server->begin();
   this->_loaded = true;
   this->_state = true;
@@ -287,6 +299,7 @@ void WEB_SERVER::stop(void) {
   debug_server_print(T_WEBSERVER);
   debug_server_println(T_STOP);
   if (this->_loaded == true) {
+    _events.stop();
     if (this->_state == V_RUNNING) {
       _web_server->stop();
     }
@@ -307,6 +320,7 @@ void WEB_SERVER::loop(bool parked) {
   }
   _parked = parked;
   _web_server->handleClient();
+  _events.loop(parked);
 }
 
 
@@ -317,8 +331,7 @@ void WEB_SERVER::file_sys_error(void) {
   // SPIFFS file system not loaded
   debug_server_print(T_WEBSERVER);
   debug_server_println(T_ERRORFILESYSTEM);
-  this->send_myheader();
-  this->send_mycontent(H_FSNOTLOADEDSTR);
+  _web_server->send(NORMALWEBPAGE, TEXTPAGETYPE, H_FSNOTLOADEDSTR);
 }
 
 // ----------------------------------------------------------------------
@@ -333,10 +346,9 @@ void WEB_SERVER::send_redirect(String pg) {
 // handler for /index
 // ----------------------------------------------------------------------
 void WEB_SERVER::get_index(void) {
-  String WSpg;
+  static HTML_TEMPLATE WSpg("/index.html");
   String tmp;
 
-  WSpg.reserve(INDEX_PG_SIZE);
 
   debug_server_print(T_WEBSERVER);
   debug_server_println(T_INDEX);
@@ -475,11 +487,7 @@ void WEB_SERVER::get_index(void) {
   }
 
 Get_Handler:
-  if (SPIFFS.exists("/index.html")) {
-    File file = SPIFFS.open("/index.html", "r");
-    WSpg = file.readString();
-    file.close();
-
+  if (WSpg.load()) {
     WSpg.replace("%PGT%", devicename);
     // Web page colors
     WSpg.replace("%TIC%", titlecolor);
@@ -488,8 +496,11 @@ Get_Handler:
     WSpg.replace("%TXC%", textcolor);
     WSpg.replace("%BKC%", backcolor);
 
+    // publish any move started by the post, then build the page from one snapshot
+    publish_focuser_state();
+    Focuser_Status fs = focuserstate->get();
     // First cache the current position as it will be used multiple times
-    String pos_c = String(driverboard->getposition());
+    String pos_c = String(fs.position);
     // Insert start of form
     WSpg.replace("%FPOS%", H_FPSTART);
 
@@ -508,9 +519,9 @@ Get_Handler:
     // Check if prior command was a GOTO command
     tmp = _web_server->arg("gotopos");
     if (tmp != "") {
-      WSpg.replace("%TAR%", String(ftargetPosition));
+      WSpg.replace("%TAR%", String(fs.target));
     } else {
-      WSpg.replace("%TAR%", String(driverboard->getposition()));
+      WSpg.replace("%TAR%", pos_c);
     }
 
     // Goto position button
@@ -532,7 +543,7 @@ Get_Handler:
     WSpg.replace("%BMAXFS%", H_BMAXFS);
 
     // isMoving
-    if (isMoving == true) {
+    if (fs.ismoving == true) {
       WSpg.replace("%MOV%", T_TRUE);
     } else {
       WSpg.replace("%MOV%", T_FALSE);
@@ -543,12 +554,12 @@ Get_Handler:
 
     // temperature mode, celsius or fahrenheit
     if (ControllerData->get_tempmode() == V_CELSIUS) {
-      String tpstr = String(temp, 2);
+      String tpstr = String(fs.temp, 2);
       WSpg.replace("%TEM%", tpstr);
       WSpg.replace("%TUN%", "C");
       WSpg.replace("%BTUN%", H_TEMPFAHRENHEIT);
     } else {
-      float ft = temp;
+      float ft = fs.temp;
       ft = (ft * 1.8) + 32;
       String tpstr = String(ft, 2);
       WSpg.replace("%TEM%", tpstr);
@@ -635,12 +646,12 @@ Get_Handler:
     WSpg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    WSpg = H_FILENOTFOUNDSTR;
+    WSpg.set_text(H_FILENOTFOUNDSTR);
   }
   debug_server_print(T_INDEX);
   debug_server_println(WSpg.length());
-  send_myheader();
-  send_mycontent(WSpg);
+  send_myheader(WSpg.length());
+  WSpg.render(_web_server->content());
 }
 
 
@@ -648,8 +659,7 @@ Get_Handler:
 // handler for /move
 // ----------------------------------------------------------------------
 void WEB_SERVER::get_move(void) {
-  String WSpg;
-  WSpg.reserve(MOVE_PG_SIZE);
+  static HTML_TEMPLATE WSpg("/move.html");
 
   debug_server_print(T_WEBSERVER);
   debug_server_println(T_MOVE);
@@ -734,11 +744,7 @@ void WEB_SERVER::get_move(void) {
   // end of move_post
 
 Get_Handler:
-  if (SPIFFS.exists("/move.html")) {
-    File file = SPIFFS.open("/move.html", "r");
-    WSpg = file.readString();
-    file.close();
-
+  if (WSpg.load()) {
     WSpg.replace("%PGT%", devicename);
     // Web page colors
     WSpg.replace("%TIC%", titlecolor);
@@ -747,12 +753,13 @@ Get_Handler:
     WSpg.replace("%TXC%", textcolor);
     WSpg.replace("%BKC%", backcolor);
 
-    String pos = String(driverboard->getposition());
-
-    //WSpg.replace("%CPO%", String(driverboard->getposition()));
+    // publish any move started by the post, then build the page from one snapshot
+    publish_focuser_state();
+    Focuser_Status fs = focuserstate->get();
+    String pos = String(fs.position);
     WSpg.replace("%CPO%", pos);
-    WSpg.replace("%TPO%", String(ftargetPosition));
-    if (isMoving == true) {
+    WSpg.replace("%TPO%", String(fs.target));
+    if (fs.ismoving == true) {
       WSpg.replace("%MOV%", T_TRUE);
     } else {
       WSpg.replace("%MOV%", T_FALSE);
@@ -784,12 +791,12 @@ Get_Handler:
     WSpg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    WSpg = H_FILENOTFOUNDSTR;
+    WSpg.set_text(H_FILENOTFOUNDSTR);
   }
   debug_server_print(T_MOVE);
   debug_server_println(WSpg.length());
-  send_myheader();
-  send_mycontent(WSpg);
+  send_myheader(WSpg.length());
+  WSpg.render(_web_server->content());
 }
 
 // ----------------------------------------------------------------------
@@ -797,8 +804,7 @@ Get_Handler:
 // ----------------------------------------------------------------------
 void WEB_SERVER::get_presets(void) {
   String tmp;
-  String WSpg;
-  WSpg.reserve(PRESETS_PG_SIZE);
+  static HTML_TEMPLATE WSpg("/presets.html");
 
   debug_server_print(T_WEBSERVER);
   debug_server_println(T_PRESETS);
@@ -1107,11 +1113,7 @@ void WEB_SERVER::get_presets(void) {
 
 Get_Handler:
 
-  if (SPIFFS.exists("/presets.html")) {
-    File file = SPIFFS.open("/presets.html", "r");
-    WSpg = file.readString();
-    file.close();
-
+  if (WSpg.load()) {
     WSpg.replace("%PGT%", devicename);
     // Web page colors
     WSpg.replace("%TIC%", titlecolor);
@@ -1120,9 +1122,11 @@ Get_Handler:
     WSpg.replace("%TXC%", textcolor);
     WSpg.replace("%BKC%", backcolor);
 
-    WSpg.replace("%CPO%", String(driverboard->getposition()));
-    WSpg.replace("%TPO%", String(ftargetPosition));
-    if (isMoving == true) {
+    publish_focuser_state();
+    Focuser_Status fs = focuserstate->get();
+    WSpg.replace("%CPO%", String(fs.position));
+    WSpg.replace("%TPO%", String(fs.target));
+    if (fs.ismoving == true) {
       WSpg.replace("%MOV%", T_TRUE);
     } else {
       WSpg.replace("%MOV%", T_FALSE);
@@ -1167,12 +1171,12 @@ Get_Handler:
     WSpg.replace("%SUT%", systemuptime);
   } else {
     debug_server_println(T_NOTFOUND);
-    WSpg = H_FILENOTFOUNDSTR;
+    WSpg.set_text(H_FILENOTFOUNDSTR);
   }
   debug_server_print(T_PRESETS);
   debug_server_println(WSpg.length());
-  send_myheader();
-  send_mycontent(WSpg);
+  send_myheader(WSpg.length());
+  WSpg.render(_web_server->content());
 }
 
 // ----------------------------------------------------------------------
@@ -1181,7 +1185,7 @@ Get_Handler:
 // ----------------------------------------------------------------------
 void WEB_SERVER::get_position() {
   // Send position value only to client ajax request
-  _web_server->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(driverboard->getposition()));
+  _web_server->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(focuserstate->get_position()));
 }
 
 // ----------------------------------------------------------------------
@@ -1190,7 +1194,7 @@ void WEB_SERVER::get_position() {
 // ----------------------------------------------------------------------
 void WEB_SERVER::get_ismoving() {
   // Send isMoving value only to client ajax request
-  if (isMoving == true) {
+  if (focuserstate->get_ismoving() == true) {
     _web_server->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, T_TRUE);
   } else {
     _web_server->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, T_FALSE);
@@ -1203,7 +1207,7 @@ void WEB_SERVER::get_ismoving() {
 // ----------------------------------------------------------------------
 void WEB_SERVER::get_targetposition() {
   //Send targetPosition value only to client ajax request
-  _web_server->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(ftargetPosition));
+  _web_server->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(focuserstate->get_target()));
 }
 
 // ----------------------------------------------------------------------
@@ -1212,7 +1216,7 @@ void WEB_SERVER::get_targetposition() {
 // ----------------------------------------------------------------------
 void WEB_SERVER::get_temperature() {
   //Send temperature value only to client ajax request
-  _web_server->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(temp, 2));
+  _web_server->send(NORMALWEBPAGE, PLAINTEXTPAGETYPE, String(focuserstate->get_temp(), 2));
 }
 
 // ----------------------------------------------------------------------
@@ -1241,12 +1245,25 @@ void WEB_SERVER::get_coilpower() {
   }
 }
 
+// ----------------------------------------------------------------------
+// subscribe to status events
+// ----------------------------------------------------------------------
+void WEB_SERVER::get_events() {
+  _events.subscribe(_web_server);
+}
+
+// ----------------------------------------------------------------------
+// get all status fields in one reply
+// ----------------------------------------------------------------------
+void WEB_SERVER::get_status() {
+  send_status(_web_server, _parked);
+}
+
 // ----------------------------------------------------------------------
 // get notfound and send to web client
 // ----------------------------------------------------------------------
 void WEB_SERVER::get_notfound(void) {
-  String WSpg;
-  WSpg.reserve(6000);
+  static HTML_TEMPLATE WSpg("/notfound.html");
 
   debug_server_print(T_WEBSERVER);
   debug_server_println(T_NOTFOUND);
@@ -1256,33 +1273,11 @@ void WEB_SERVER::get_notfound(void) {
   debug_server_print("ws: -uri !found ");
   debug_server_println(p);
 
-  // get the MIME type
-  String contenttype = get_contenttype(p);
-  if (SPIFFS.exists(p)) {
-    debug_server_print("-File ");
-    debug_server_print(p);
-    debug_server_println(" found");
-
-    File file = SPIFFS.open(p, "r");
-    WSpg = file.readString();
-    file.close();
-    debug_server_print("-send file ");
-    debug_server_print(p);
-    debug_server_println(" to client now");
-    if (WSpg[0] == '{') {
-      // a json file
-      send_json(WSpg);
-      return;
-    }
-    // for non jsn types like .ico
-    _web_server->send(NORMALWEBPAGE, contenttype, WSpg);
+  // send the file if it exists, gzip and ETag in file_server.cpp
+  if (send_file(_web_server, p)) {
     return;
   } else {
-    if (SPIFFS.exists("/notfound.html")) {
-      File file = SPIFFS.open("/notfound.html", "r");
-      WSpg = file.readString();
-      file.close();
-
+    if (WSpg.load()) {
       // process for dynamic data
       WSpg.replace("%PGT%", devicename);
       WSpg.replace("%IP%", ipStr);
@@ -1290,14 +1285,10 @@ void WEB_SERVER::get_notfound(void) {
       WSpg.replace("%VER%", String(program_version));
       WSpg.replace("%NAM%", ControllerData->get_brdname());
 
-      String tmp = ControllerData->get_wp_titlecolor();
-      WSpg.replace("%TIC%", tmp);
-      tmp = ControllerData->get_wp_headercolor();
-      WSpg.replace("%HEC%", tmp);
-      tmp = ControllerData->get_wp_textcolor();
-      WSpg.replace("%TXC%", tmp);
-      tmp = ControllerData->get_wp_backcolor();
-      WSpg.replace("%BKC%", tmp);
+      WSpg.replace("%TIC%", titlecolor);
+      WSpg.replace("%HEC%", headercolor);
+      WSpg.replace("%TXC%", textcolor);
+      WSpg.replace("%BKC%", backcolor);
 
       WSpg.replace("%NAM%", ControllerData->get_brdname());
       WSpg.replace("%VER%", String(program_version));
@@ -1306,12 +1297,12 @@ void WEB_SERVER::get_notfound(void) {
       WSpg.replace("%SUT%", systemuptime);
     } else {
       debug_server_println(T_NOTFOUND);
-      WSpg = H_FILENOTFOUNDSTR;
+      WSpg.set_text(H_FILENOTFOUNDSTR);
     }
     debug_server_print(T_NOTFOUND);
     debug_server_println(WSpg.length());
-    send_myheader();
-    send_mycontent(WSpg);
+    send_myheader(WSpg.length());
+    WSpg.render(_web_server->content());
   }
 }
 
@@ -1325,10 +1316,9 @@ void WEB_SERVER::send_ACAOheader(void) {
 // ----------------------------------------------------------------------
 // send HTML header to client
 // ----------------------------------------------------------------------
-void WEB_SERVER::send_myheader(void) {
-  _web_server->client().println("HTTP/1.1 200 OK");
-  _web_server->client().println("Content-type:text/html");
-  _web_server->client().println();
+void WEB_SERVER::send_myheader(size_t len) {
+  _web_server->setContentLength(len);
+  _web_server->send(NORMALWEBPAGE, TEXTPAGETYPE, "");
 }
 
 // ----------------------------------------------------------------------
@@ -1347,31 +1337,6 @@ void WEB_SERVER::send_json(String str) {
   _web_server->send(NORMALWEBPAGE, JSONPAGETYPE, str);
 }
 
-// ----------------------------------------------------------------------
-// send HTML page to client
-// ----------------------------------------------------------------------
-void WEB_SERVER::send_mycontent(String pg) {
-  _web_server->client().print(pg);
-}
-
-// ----------------------------------------------------------------------
-// convert the file extension to the MIME type
-// ----------------------------------------------------------------------
-String WEB_SERVER::get_contenttype(String filename) {
-  String retval = "text/plain";
-  if (filename.endsWith(".html")) {
-    retval = "text/html";
-  } else if (filename.endsWith(".css")) {
-    retval = "text/css";
-  } else if (filename.endsWith(".js")) {
-    retval = "application/javascript";
-  } else if (filename.endsWith(".ico")) {
-    retval = "image/x-icon";
-  }
-  //retval = "application/octet-stream";
-  return retval;
-}
-
 // ----------------------------------------------------------------------
 // send the right file to the client (if it exists)
 // ----------------------------------------------------------------------
@@ -15,7 +15,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include "SPIFFS.h"
-#include "WebServer.h"
+#include "http_server.h"
+#include "status_events.h"
 
 
 // ----------------------------------------------------------------------
@@ -48,18 +49,19 @@ public:
   void get_temperature(void);
   void get_park(void);
   void get_coilpower(void);
+  void get_events(void);
+  void get_status(void);
 
 private:
   void file_sys_error(void);
-  void send_myheader(void);
-  void send_mycontent(String);
+  void send_myheader(size_t);
   void send_json(String);
   void send_xhtml(String);
   void send_ACAOheader(void);
-  String get_contenttype(String filename);
   bool is_hexdigit(char);
 
-  WebServer *_web_server;
+  HTTP_SERVER *_web_server;
+  STATUS_EVENTS _events;
   unsigned long int _port = WEBSERVERPORT;
   bool _loaded = false;
   bool _parked = true;